@@ -1,4 +1,8 @@
+#ifdef JIT_STATS_ENABLED
+#include <chrono>
+#endif
 #include "BasicBlock.h"
+#include "CodeArena.h"
 #include "MemStream.h"
 #include "offsetof_def.h"
 #include "MipsJitter.h"
@@ -42,6 +46,22 @@ extern "C"
 
 #define INVALID_LINK_SLOT (~0U)
 
+static uintptr_t GetLinkSlotTrampoline(LINK_SLOT linkSlot)
+{
+	switch(linkSlot)
+	{
+	case LINK_SLOT_NEXT:
+		return reinterpret_cast<uintptr_t>(&NextBlockTrampoline);
+	case LINK_SLOT_BRANCH:
+		return reinterpret_cast<uintptr_t>(&BranchBlockTrampoline);
+	case LINK_SLOT_TRACE_EXIT:
+		return reinterpret_cast<uintptr_t>(&TraceExitBlockTrampoline);
+	default:
+		assert(false);
+		return 0;
+	}
+}
+
 CBasicBlock::CBasicBlock(CMIPS& context, uint32 begin, uint32 end, BLOCK_CATEGORY category)
     : m_begin(begin)
     , m_end(end)
@@ -61,6 +81,26 @@ CBasicBlock::CBasicBlock(CMIPS& context, uint32 begin, uint32 end, BLOCK_CATEGOR
 	}
 }
 
+#ifdef JIT_STATS_ENABLED
+
+std::mutex CBasicBlock::m_compileStatsMutex;
+CBasicBlock::CompileStatsMap CBasicBlock::m_compileStats;
+
+BLOCK_COMPILE_STATS CBasicBlock::GetCompileStats(BLOCK_CATEGORY category)
+{
+	std::lock_guard<std::mutex> lock(m_compileStatsMutex);
+	auto statsIterator = m_compileStats.find(category);
+	return (statsIterator != std::end(m_compileStats)) ? statsIterator->second : BLOCK_COMPILE_STATS();
+}
+
+void CBasicBlock::ResetCompileStats()
+{
+	std::lock_guard<std::mutex> lock(m_compileStatsMutex);
+	m_compileStats.clear();
+}
+
+#endif
+
 #ifdef AOT_BUILD_CACHE
 
 Framework::CStdStream* CBasicBlock::m_aotBlockOutputStream(nullptr);
@@ -78,6 +118,10 @@ void CBasicBlock::Compile()
 {
 #ifndef AOT_USE_CACHE
 
+#ifdef JIT_STATS_ENABLED
+	auto compileStartTime = std::chrono::high_resolution_clock::now();
+#endif
+
 	Framework::CMemStream stream;
 	{
 		static
@@ -98,7 +142,18 @@ void CBasicBlock::Compile()
 		jitter->End();
 	}
 
-	m_function = CMemoryFunction(stream.GetBuffer(), stream.GetSize());
+	SetCode(stream.GetBuffer(), stream.GetSize());
+
+#ifdef JIT_STATS_ENABLED
+	{
+		auto compileTime = std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::high_resolution_clock::now() - compileStartTime);
+		std::lock_guard<std::mutex> lock(m_compileStatsMutex);
+		auto& stats = m_compileStats[m_category];
+		stats.blockCount++;
+		stats.codeSize += stream.GetSize();
+		stats.compileTime += compileTime.count();
+	}
+#endif
 
 #ifdef VTUNE_ENABLED
 	if(iJIT_IsProfilingActive() == iJIT_SAMPLING_ON)
@@ -108,8 +163,8 @@ void CBasicBlock::Compile()
 		jmethod.class_file_name = "";
 		jmethod.source_file_name = __FILE__;
 
-		jmethod.method_load_address = m_function.GetCode();
-		jmethod.method_size = m_function.GetSize();
+		jmethod.method_load_address = GetCode();
+		jmethod.method_size = GetCodeSize();
 		jmethod.line_number_size = 0;
 
 		auto functionName = string_format("BasicBlock_0x%08X_0x%08X", m_begin, m_end);
@@ -218,23 +273,177 @@ void CBasicBlock::CompileRange(CMipsJitter* jitter)
 		return target == m_begin;
 	}();
 
+	//Blocks can be traces made of several segments, each one ending with a conditional branch.
+	//Exit early if the branch was taken or if something raised an exception. Otherwise, keep going
+	//without checking the cycle quota, it's updated with the right instruction count when leaving.
+	//A taken branch goes through its own link slot, it can jump to the target block directly.
+	bool hasTraceExit = false;
+	Jitter::CJitter::LABEL traceExitLabel = 0;
+	auto compileTraceExit =
+	    [&](uint32 segmentEndAddress) {
+		    //Only one side exit can be linked
+		    assert(!hasTraceExit);
+		    traceExitLabel = jitter->CreateLabel();
+		    hasTraceExit = true;
+
+		    uint32 instructionCount = ((segmentEndAddress - m_begin) / 4) + 1;
+
+		    jitter->PushCst(MIPS_INVALID_PC);
+		    jitter->PushRel(offsetof(CMIPS, m_State.nDelayedJumpAddr));
+		    jitter->BeginIf(Jitter::CONDITION_NE);
+		    {
+			    CompileQuotaUpdate(jitter, instructionCount);
+
+			    jitter->PushRel(offsetof(CMIPS, m_State.nDelayedJumpAddr));
+			    jitter->PullRel(offsetof(CMIPS, m_State.nPC));
+
+			    jitter->PushCst(MIPS_INVALID_PC);
+			    jitter->PullRel(offsetof(CMIPS, m_State.nDelayedJumpAddr));
+
+#if !defined(AOT_BUILD_CACHE) && !defined(__EMSCRIPTEN__)
+			    jitter->PushRel(offsetof(CMIPS, m_State.nHasException));
+			    jitter->PushCst(0);
+			    jitter->BeginIf(Jitter::CONDITION_EQ);
+			    {
+				    jitter->JumpToDynamic(reinterpret_cast<void*>(&TraceExitBlockTrampoline));
+			    }
+			    jitter->EndIf();
+#endif
+
+			    jitter->Goto(traceExitLabel);
+		    }
+		    jitter->EndIf();
+
+		    jitter->PushRel(offsetof(CMIPS, m_State.nHasException));
+		    jitter->PushCst(0);
+		    jitter->BeginIf(Jitter::CONDITION_NE);
+		    {
+			    CompileQuotaUpdate(jitter, instructionCount);
+
+			    jitter->PushRel(offsetof(CMIPS, m_State.nPC));
+			    jitter->PushCst(segmentEndAddress - m_begin + 4);
+			    jitter->Add();
+			    jitter->PullRel(offsetof(CMIPS, m_State.nPC));
+
+			    jitter->Goto(traceExitLabel);
+		    }
+		    jitter->EndIf();
+	    };
+
+	auto deadRegisterWrites = ComputeDeadRegisterWrites();
+
 	m_context.m_pArch->SetCompileHints(m_blockCompileHints);
 
 	CompileProlog(jitter);
 	jitter->MarkFirstBlockLabel();
 
+	//Register values that are known at compile time, from constants loaded earlier in the block.
+	//These are only handed to the jitter for the operands an instruction reads, to fold them.
+	CMIPSArchitecture::REGISTER_VALUES knownValues;
+
+	bool inDelaySlot = false;
 	for(uint32 address = m_begin; address <= m_end; address += 4)
 	{
+		uint32 opcode = m_context.m_pMemoryMap->GetInstruction(address);
+
+		auto knownInputs = m_context.m_pArch->GetInstructionConstantInputs(&m_context, address, opcode) & knownValues.known;
+		if(knownInputs.any())
+		{
+			for(unsigned int word = 0; word < CMIPSArchitecture::REGISTER_WORD_COUNT; word++)
+			{
+				if(!knownInputs.test(word)) continue;
+				jitter->SetKnownVariableValue(CMIPSArchitecture::GetRegisterWordOffset(word), knownValues.values[word]);
+			}
+		}
+
+		const auto& deadWrites = deadRegisterWrites[(address - m_begin) / 4];
+		if(deadWrites.any())
+		{
+			for(unsigned int word = 0; word < CMIPSArchitecture::REGISTER_WORD_COUNT; word++)
+			{
+				if(!deadWrites.test(word)) continue;
+				jitter->SetVariableAsDead(CMIPSArchitecture::GetRegisterWordOffset(word));
+			}
+		}
+
 		m_context.m_pArch->CompileInstruction(
 		    address,
 		    jitter,
 		    &m_context, address - m_begin);
 		//Sanity check
 		assert(jitter->IsStackEmpty());
+
+		jitter->ClearDeadVariables();
+		jitter->ClearKnownVariableValues();
+
+		m_context.m_pArch->PropagateInstructionConstants(&m_context, address, opcode, knownValues);
+
+		if(inDelaySlot && (address != m_end))
+		{
+			jitter->MarkLastBlockLabel();
+			compileTraceExit(address);
+
+			//Next segment can be reached without going through a branch likely's delay slot
+			knownValues.known.reset();
+		}
+
+		inDelaySlot = !inDelaySlot && (m_context.m_pArch->IsInstructionBranch(&m_context, address, opcode) == MIPS_BRANCH_NORMAL);
 	}
 
 	jitter->MarkLastBlockLabel();
 	CompileEpilog(jitter, loopsOnItself);
+
+	if(hasTraceExit)
+	{
+		jitter->MarkLabel(traceExitLabel);
+	}
+}
+
+//Finds register writes that are overwritten by a later instruction of the same block before anything
+//can read them. Those values can stay in host registers and never be written back to the context.
+//Instructions with other side effects (memory accesses, branches, etc.) are barriers, everything needs
+//to be written back before them. The end of each trace segment is also an exit point.
+std::vector<CMIPSArchitecture::RegisterWordSet> CBasicBlock::ComputeDeadRegisterWrites() const
+{
+	uint32 instructionCount = ((m_end - m_begin) / 4) + 1;
+	std::vector<CMIPSArchitecture::RegisterWordSet> result(instructionCount);
+
+#ifdef DEBUGGER_INCLUDED
+	if(HasBreakpoint())
+	{
+		return result;
+	}
+#endif
+
+	//Words that will be overwritten before being read, going backwards from the end of the block
+	CMIPSArchitecture::RegisterWordSet overwritten;
+	for(uint32 index = instructionCount; index != 0; index--)
+	{
+		uint32 address = m_begin + ((index - 1) * 4);
+		if(address != m_begin)
+		{
+			uint32 prevOpcode = m_context.m_pMemoryMap->GetInstruction(address - 4);
+			if(m_context.m_pArch->IsInstructionBranch(&m_context, address - 4, prevOpcode) == MIPS_BRANCH_NORMAL)
+			{
+				//Delay slot, block might be exited after this
+				overwritten.reset();
+			}
+		}
+
+		uint32 opcode = m_context.m_pMemoryMap->GetInstruction(address);
+		CMIPSArchitecture::REGISTER_USAGE usage;
+		if(!m_context.m_pArch->GetInstructionRegisterUsage(&m_context, address, opcode, usage))
+		{
+			overwritten.reset();
+			continue;
+		}
+
+		result[index - 1] = usage.writes & overwritten & ~usage.selfReads;
+		overwritten |= usage.writes;
+		overwritten &= ~usage.reads;
+	}
+
+	return result;
 }
 
 void CBasicBlock::CompileProlog(CMipsJitter* jitter)
@@ -258,21 +467,7 @@ void CBasicBlock::CompileProlog(CMipsJitter* jitter)
 void CBasicBlock::CompileEpilog(CMipsJitter* jitter, bool loopsOnItself)
 {
 	//Update cycle quota
-	jitter->PushRel(offsetof(CMIPS, m_State.cycleQuota));
-	jitter->PushCst(((m_end - m_begin) / 4) + 1);
-	jitter->Sub();
-	jitter->PullRel(offsetof(CMIPS, m_State.cycleQuota));
-
-	jitter->PushRel(offsetof(CMIPS, m_State.cycleQuota));
-	jitter->PushCst(0);
-	jitter->BeginIf(Jitter::CONDITION_LE);
-	{
-		jitter->PushRel(offsetof(CMIPS, m_State.nHasException));
-		jitter->PushCst(MIPS_EXCEPTION_STATUS_QUOTADONE);
-		jitter->Or();
-		jitter->PullRel(offsetof(CMIPS, m_State.nHasException));
-	}
-	jitter->EndIf();
+	CompileQuotaUpdate(jitter, ((m_end - m_begin) / 4) + 1);
 
 	//We probably don't need to pay for this since we know in advance if there's a branch
 	jitter->PushCst(MIPS_INVALID_PC);
@@ -328,9 +523,39 @@ void CBasicBlock::CompileEpilog(CMipsJitter* jitter, bool loopsOnItself)
 	jitter->EndIf();
 }
 
+void CBasicBlock::CompileQuotaUpdate(CMipsJitter* jitter, uint32 instructionCount)
+{
+	jitter->PushRel(offsetof(CMIPS, m_State.cycleQuota));
+	jitter->PushCst(instructionCount);
+	jitter->Sub();
+	jitter->PullRel(offsetof(CMIPS, m_State.cycleQuota));
+
+	jitter->PushRel(offsetof(CMIPS, m_State.cycleQuota));
+	jitter->PushCst(0);
+	jitter->BeginIf(Jitter::CONDITION_LE);
+	{
+		jitter->PushRel(offsetof(CMIPS, m_State.nHasException));
+		jitter->PushCst(MIPS_EXCEPTION_STATUS_QUOTADONE);
+		jitter->Or();
+		jitter->PullRel(offsetof(CMIPS, m_State.nHasException));
+	}
+	jitter->EndIf();
+}
+
 void CBasicBlock::Execute()
 {
+#ifndef AOT_USE_CACHE
+	if(m_arenaCode)
+	{
+		reinterpret_cast<void (*)(void*)>(m_arenaCode)(&m_context);
+	}
+	else
+	{
+		m_function(&m_context);
+	}
+#else
 	m_function(&m_context);
+#endif
 
 	assert(m_context.m_State.nGPR[0].nV0 == 0);
 	assert(m_context.m_State.nGPR[0].nV1 == 0);
@@ -357,7 +582,7 @@ uint32 CBasicBlock::GetEndAddress() const
 bool CBasicBlock::IsCompiled() const
 {
 #ifndef AOT_USE_CACHE
-	return !m_function.IsEmpty();
+	return (m_arenaCode != nullptr) || !m_function.IsEmpty();
 #else
 	return (m_function != nullptr);
 #endif
@@ -379,6 +604,26 @@ void CBasicBlock::SetRecycleCount(uint32 recycleCount)
 	m_recycleCount = recycleCount;
 }
 
+uint32 CBasicBlock::GetLastExecutedEpoch() const
+{
+	return m_lastExecutedEpoch;
+}
+
+void CBasicBlock::SetLastExecutedEpoch(uint32 lastExecutedEpoch)
+{
+	m_lastExecutedEpoch = lastExecutedEpoch;
+}
+
+size_t CBasicBlock::GetCodeSize() const
+{
+#ifndef AOT_USE_CACHE
+	return m_arenaCode ? m_arenaCodeSize : m_function.GetSize();
+#else
+	//Code is part of the executable image
+	return 0;
+#endif
+}
+
 bool CBasicBlock::HasLinkSlot(LINK_SLOT linkSlot) const
 {
 	return m_linkBlockTrampolineOffset[linkSlot] != INVALID_LINK_SLOT;
@@ -407,11 +652,8 @@ void CBasicBlock::LinkBlock(LINK_SLOT linkSlot, CBasicBlock* otherBlock)
 	assert(m_linkBlock[linkSlot] == nullptr);
 	m_linkBlock[linkSlot] = otherBlock;
 #endif
-	auto patchValue = reinterpret_cast<uintptr_t>(otherBlock->m_function.GetCode());
-	auto code = reinterpret_cast<uint8*>(m_function.GetCode());
-	m_function.BeginModify();
-	*reinterpret_cast<uintptr_t*>(code + m_linkBlockTrampolineOffset[linkSlot]) = patchValue;
-	m_function.EndModify();
+	auto patchValue = reinterpret_cast<uintptr_t>(otherBlock->GetCode());
+	PatchCode(m_linkBlockTrampolineOffset[linkSlot], patchValue);
 #endif //!AOT_ENABLED && !__EMSCRIPTEN__
 }
 
@@ -425,14 +667,52 @@ void CBasicBlock::UnlinkBlock(LINK_SLOT linkSlot)
 	assert(m_linkBlock[linkSlot] != nullptr);
 	m_linkBlock[linkSlot] = nullptr;
 #endif
-	auto patchValue = (linkSlot == LINK_SLOT_NEXT) ? reinterpret_cast<uintptr_t>(&NextBlockTrampoline) : reinterpret_cast<uintptr_t>(&BranchBlockTrampoline);
-	auto code = reinterpret_cast<uint8*>(m_function.GetCode());
-	m_function.BeginModify();
-	*reinterpret_cast<uintptr_t*>(code + m_linkBlockTrampolineOffset[linkSlot]) = patchValue;
-	m_function.EndModify();
+	PatchCode(m_linkBlockTrampolineOffset[linkSlot], GetLinkSlotTrampoline(linkSlot));
 #endif //!AOT_ENABLED && !__EMSCRIPTEN__
 }
 
+#ifndef AOT_USE_CACHE
+
+void CBasicBlock::SetCode(const void* code, size_t size)
+{
+	//Try to place the code in the executor's arena first, fallback on a separate allocation if it's full
+	if(auto codeArena = m_context.m_codeArena)
+	{
+		m_arenaCode = codeArena->Allocate(code, size);
+		if(m_arenaCode)
+		{
+			m_arenaCodeSize = size;
+			m_codeArena = codeArena;
+			return;
+		}
+	}
+	m_function = CMemoryFunction(code, size);
+}
+
+void* CBasicBlock::GetCode() const
+{
+	return m_arenaCode ? m_arenaCode : m_function.GetCode();
+}
+
+void CBasicBlock::PatchCode(uint32 offset, uintptr_t value)
+{
+	auto code = reinterpret_cast<uint8*>(GetCode()) + offset;
+	if(m_arenaCode)
+	{
+		m_codeArena->BeginModify(code, sizeof(uintptr_t));
+		*reinterpret_cast<uintptr_t*>(code) = value;
+		m_codeArena->EndModify(code, sizeof(uintptr_t));
+	}
+	else
+	{
+		m_function.BeginModify();
+		*reinterpret_cast<uintptr_t*>(code) = value;
+		m_function.EndModify();
+	}
+}
+
+#endif
+
 void CBasicBlock::HandleExternalFunctionReference(uintptr_t symbol, uint32 offset, Jitter::CCodeGen::SYMBOL_REF_TYPE refType)
 {
 	if(symbol == reinterpret_cast<uintptr_t>(&NextBlockTrampoline))
@@ -447,33 +727,41 @@ void CBasicBlock::HandleExternalFunctionReference(uintptr_t symbol, uint32 offse
 		assert(m_linkBlockTrampolineOffset[LINK_SLOT_BRANCH] == INVALID_LINK_SLOT);
 		m_linkBlockTrampolineOffset[LINK_SLOT_BRANCH] = offset;
 	}
+	else if(symbol == reinterpret_cast<uintptr_t>(&TraceExitBlockTrampoline))
+	{
+		assert(refType == Jitter::CCodeGen::SYMBOL_REF_TYPE::NATIVE_POINTER);
+		assert(m_linkBlockTrampolineOffset[LINK_SLOT_TRACE_EXIT] == INVALID_LINK_SLOT);
+		m_linkBlockTrampolineOffset[LINK_SLOT_TRACE_EXIT] = offset;
+	}
 }
 
 void CBasicBlock::CopyFunctionFrom(const std::shared_ptr<CBasicBlock>& other)
 {
 #ifndef AOT_USE_CACHE
-	m_function = other->m_function.CreateInstance();
+	if(other->m_arenaCode)
+	{
+		SetCode(other->m_arenaCode, other->m_arenaCodeSize);
+	}
+	else
+	{
+		m_function = other->m_function.CreateInstance();
+	}
 	std::copy(std::begin(other->m_linkBlockTrampolineOffset), std::end(other->m_linkBlockTrampolineOffset), m_linkBlockTrampolineOffset);
 #ifdef _DEBUG
 	std::copy(std::begin(other->m_linkBlock), std::end(other->m_linkBlock), m_linkBlock);
 #endif
-	if(
-	    HasLinkSlot(LINK_SLOT_NEXT)
-#ifdef _DEBUG
-	    && m_linkBlock[LINK_SLOT_NEXT]
-#endif
-	)
+	for(uint32 i = 0; i < LINK_SLOT_MAX; i++)
 	{
-		UnlinkBlock(LINK_SLOT_NEXT);
-	}
-	if(
-	    HasLinkSlot(LINK_SLOT_BRANCH)
+		auto linkSlot = static_cast<LINK_SLOT>(i);
+		if(
+		    HasLinkSlot(linkSlot)
 #ifdef _DEBUG
-	    && m_linkBlock[LINK_SLOT_BRANCH]
+		    && m_linkBlock[linkSlot]
 #endif
-	)
-	{
-		UnlinkBlock(LINK_SLOT_BRANCH);
+		)
+		{
+			UnlinkBlock(linkSlot);
+		}
 	}
 #else
 	m_function = basicBlock->m_function;
@@ -512,3 +800,7 @@ void NextBlockTrampoline(CMIPS* context)
 void BranchBlockTrampoline(CMIPS* context)
 {
 }
+
+void TraceExitBlockTrampoline(CMIPS* context)
+{
+}
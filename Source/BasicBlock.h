@@ -1,10 +1,13 @@
 #pragma once
 
+#include <map>
+#include <mutex>
+#include <vector>
 #include "MIPS.h"
 #include "MemoryFunction.h"
+#include "BlockOutLinkTable.h"
 #ifdef AOT_BUILD_CACHE
 #include "StdStream.h"
-#include <mutex>
 #endif
 
 enum BLOCK_CATEGORY : uint32
@@ -43,30 +46,16 @@ extern "C"
 	void EmptyBlockHandler(CMIPS*);
 	void NextBlockTrampoline(CMIPS*);
 	void BranchBlockTrampoline(CMIPS*);
+	void TraceExitBlockTrampoline(CMIPS*);
 }
 
-enum LINK_SLOT
-{
-	LINK_SLOT_NEXT,
-	LINK_SLOT_BRANCH,
-	LINK_SLOT_MAX,
-};
-
-//Block outgoing link
-struct BLOCK_OUT_LINK
+struct BLOCK_COMPILE_STATS
 {
-	LINK_SLOT slot;    //slot used in the source block
-	uint32 srcAddress; //address of source block
-	bool live;         //live if linked to another block, otherwise, link is pending
+	uint32 blockCount = 0;
+	uint64 codeSize = 0;
+	uint64 compileTime = 0; //In nanoseconds
 };
 
-//Block outgoing links map (key: target link address, value: struct describing link status)
-typedef std::multimap<uint32, BLOCK_OUT_LINK> BlockOutLinkMap;
-
-//When block linking is used, each basic block will maintain pointers
-//to their outgoing link definitions inside the map
-typedef BlockOutLinkMap::iterator BlockOutLinkPointer;
-
 class CBasicBlock : public std::enable_shared_from_this<CBasicBlock>
 {
 public:
@@ -86,6 +75,12 @@ public:
 	uint32 GetRecycleCount() const;
 	void SetRecycleCount(uint32);
 
+	//Set by the executor when it dispatches the block, used to find blocks that haven't run in a while
+	uint32 GetLastExecutedEpoch() const;
+	void SetLastExecutedEpoch(uint32);
+
+	size_t GetCodeSize() const;
+
 	bool HasLinkSlot(LINK_SLOT) const;
 	BlockOutLinkPointer GetOutLink(LINK_SLOT) const;
 	void SetOutLink(LINK_SLOT, BlockOutLinkPointer);
@@ -99,6 +94,11 @@ public:
 
 	void CopyFunctionFrom(const std::shared_ptr<CBasicBlock>& basicBlock);
 
+#ifdef JIT_STATS_ENABLED
+	static BLOCK_COMPILE_STATS GetCompileStats(BLOCK_CATEGORY);
+	static void ResetCompileStats();
+#endif
+
 protected:
 	uint32 m_begin;
 	uint32 m_end;
@@ -110,8 +110,16 @@ protected:
 	virtual void CompileProlog(CMipsJitter*);
 	virtual void CompileEpilog(CMipsJitter*, bool);
 
+	void CompileQuotaUpdate(CMipsJitter*, uint32);
+
 private:
 	void HandleExternalFunctionReference(uintptr_t, uint32, Jitter::CCodeGen::SYMBOL_REF_TYPE);
+#ifndef AOT_USE_CACHE
+	void SetCode(const void*, size_t);
+	void* GetCode() const;
+	void PatchCode(uint32, uintptr_t);
+#endif
+	std::vector<CMIPSArchitecture::RegisterWordSet> ComputeDeadRegisterWrites() const;
 
 #ifdef DEBUGGER_INCLUDED
 	bool HasBreakpoint() const;
@@ -119,6 +127,13 @@ private:
 	static void BreakpointHandler(CMIPS*);
 #endif
 
+#ifdef JIT_STATS_ENABLED
+	typedef std::map<BLOCK_CATEGORY, BLOCK_COMPILE_STATS> CompileStatsMap;
+
+	static std::mutex m_compileStatsMutex;
+	static CompileStatsMap m_compileStats;
+#endif
+
 #ifdef AOT_BUILD_CACHE
 	static Framework::CStdStream* m_aotBlockOutputStream;
 	static std::mutex m_aotBlockOutputStreamMutex;
@@ -126,10 +141,15 @@ private:
 
 #ifndef AOT_USE_CACHE
 	CMemoryFunction m_function;
+	//Used instead of m_function when code was allocated in the executor's code arena
+	void* m_arenaCode = nullptr;
+	size_t m_arenaCodeSize = 0;
+	CCodeArena* m_codeArena = nullptr;
 #else
 	void (*m_function)(void*);
 #endif
 	uint32 m_recycleCount = 0;
+	uint32 m_lastExecutedEpoch = 0;
 	BlockOutLinkPointer m_outLinks[LINK_SLOT_MAX];
 	uint32 m_linkBlockTrampolineOffset[LINK_SLOT_MAX];
 #ifdef _DEBUG
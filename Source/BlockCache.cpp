@@ -0,0 +1,113 @@
+#include <cassert>
+#include "BlockCache.h"
+
+BasicBlockPtr CBlockCache::Find(const KeyType& key)
+{
+	return Find(key, [](const BasicBlockPtr&) { return true; });
+}
+
+BasicBlockPtr CBlockCache::Find(const KeyType& key, const BlockPredicate& predicate)
+{
+	auto range = m_entryMap.equal_range(key);
+	for(auto entryIterator = range.first; entryIterator != range.second; entryIterator++)
+	{
+		auto listIterator = entryIterator->second;
+		if(!predicate(listIterator->block)) continue;
+		if(!listIterator->pinned)
+		{
+			m_entries.splice(std::begin(m_entries), m_entries, listIterator);
+		}
+		return listIterator->block;
+	}
+	return BasicBlockPtr();
+}
+
+void CBlockCache::Insert(const KeyType& key, BasicBlockPtr block)
+{
+	if(m_evictedKeys.erase(key) != 0)
+	{
+		m_recompiledBlockCount++;
+	}
+	assert(m_blockEntries.find(block.get()) == std::end(m_blockEntries));
+	m_codeSize += block->GetCodeSize();
+	m_entries.push_front(ENTRY{key, std::move(block)});
+	m_entryMap.insert(std::make_pair(key, std::begin(m_entries)));
+	m_blockEntries.insert(std::make_pair(m_entries.front().block.get(), std::begin(m_entries)));
+}
+
+void CBlockCache::Clear()
+{
+	m_entryMap.clear();
+	m_blockEntries.clear();
+	m_entries.clear();
+	m_pinnedEntries.clear();
+	m_evictedKeys.clear();
+	m_codeSize = 0;
+}
+
+void CBlockCache::Pin(const CBasicBlock* block)
+{
+	auto blockEntryIterator = m_blockEntries.find(block);
+	if(blockEntryIterator == std::end(m_blockEntries)) return;
+	auto listIterator = blockEntryIterator->second;
+	if(listIterator->pinned) return;
+	listIterator->pinned = true;
+	m_pinnedEntries.splice(std::end(m_pinnedEntries), m_entries, listIterator);
+	m_codeSize -= block->GetCodeSize();
+}
+
+void CBlockCache::Unpin(const CBasicBlock* block)
+{
+	auto blockEntryIterator = m_blockEntries.find(block);
+	if(blockEntryIterator == std::end(m_blockEntries)) return;
+	auto listIterator = blockEntryIterator->second;
+	if(!listIterator->pinned) return;
+	listIterator->pinned = false;
+	m_entries.splice(std::begin(m_entries), m_pinnedEntries, listIterator);
+	m_codeSize += block->GetCodeSize();
+}
+
+void CBlockCache::Trim(uint64 maxCodeSize)
+{
+	while((m_codeSize > maxCodeSize) && !m_entries.empty())
+	{
+		auto listIterator = std::prev(std::end(m_entries));
+		auto range = m_entryMap.equal_range(listIterator->key);
+		for(auto entryIterator = range.first; entryIterator != range.second; entryIterator++)
+		{
+			if(entryIterator->second != listIterator) continue;
+			m_entryMap.erase(entryIterator);
+			break;
+		}
+		if(m_evictedKeys.size() >= MAX_EVICTED_KEYS)
+		{
+			m_evictedKeys.clear();
+		}
+		m_evictedKeys.insert(listIterator->key);
+		m_blockEntries.erase(listIterator->block.get());
+		m_codeSize -= listIterator->block->GetCodeSize();
+		m_evictedBlockCount++;
+		//Block is only freed here if it isn't active in the executor anymore
+		m_entries.erase(listIterator);
+	}
+}
+
+uint64 CBlockCache::GetBlockCount() const
+{
+	return m_entries.size();
+}
+
+uint64 CBlockCache::GetCodeSize() const
+{
+	return m_codeSize;
+}
+
+uint64 CBlockCache::GetEvictedBlockCount() const
+{
+	return m_evictedBlockCount;
+}
+
+uint64 CBlockCache::GetRecompiledBlockCount() const
+{
+	return m_recompiledBlockCount;
+}
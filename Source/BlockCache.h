@@ -0,0 +1,69 @@
+#pragma once
+
+#include <functional>
+#include <list>
+#include <map>
+#include <memory>
+#include <set>
+#include <unordered_map>
+#include "BasicBlock.h"
+
+typedef std::shared_ptr<CBasicBlock> BasicBlockPtr;
+
+//Keeps compiled blocks indexed by a hash of their code, so that they can be reused when the same
+//code is seen again after being invalidated. Blocks that are active in the executor are pinned: they
+//can't be evicted and are not counted in the cache's code size. Least recently used blocks are evicted
+//first when trimming.
+class CBlockCache
+{
+public:
+	typedef std::pair<uint128, uint32> KeyType;
+	typedef std::function<bool(const BasicBlockPtr&)> BlockPredicate;
+
+	BasicBlockPtr Find(const KeyType&);
+	BasicBlockPtr Find(const KeyType&, const BlockPredicate&);
+	void Insert(const KeyType&, BasicBlockPtr);
+	void Clear();
+
+	//Blocks that are not in the cache are ignored
+	void Pin(const CBasicBlock*);
+	void Unpin(const CBasicBlock*);
+
+	//Evicts unpinned blocks until their code size is below the specified size
+	void Trim(uint64);
+
+	//Only unpinned blocks are counted
+	uint64 GetBlockCount() const;
+	uint64 GetCodeSize() const;
+
+	uint64 GetEvictedBlockCount() const;
+	uint64 GetRecompiledBlockCount() const;
+
+private:
+	enum
+	{
+		//Only used for statistics, forget about old evictions instead of growing forever
+		MAX_EVICTED_KEYS = 0x10000,
+	};
+
+	struct ENTRY
+	{
+		KeyType key;
+		BasicBlockPtr block;
+		bool pinned = false;
+	};
+
+	typedef std::list<ENTRY> EntryList;
+	typedef std::multimap<KeyType, EntryList::iterator> EntryMap;
+	typedef std::unordered_map<const CBasicBlock*, EntryList::iterator> BlockEntryMap;
+	typedef std::set<KeyType> KeySet;
+
+	EntryList m_entries; //Most recently used first
+	EntryList m_pinnedEntries;
+	EntryMap m_entryMap;
+	BlockEntryMap m_blockEntries;
+	KeySet m_evictedKeys;
+	uint64 m_codeSize = 0;
+	uint64 m_evictedBlockCount = 0;
+	uint64 m_recompiledBlockCount = 0;
+};
@@ -0,0 +1,92 @@
+#include <cassert>
+#include "BlockOutLinkTable.h"
+
+BlockOutLinkPointer CBlockOutLinkTable::Insert(uint32 targetAddress, const BLOCK_OUT_LINK& link)
+{
+	BlockOutLinkPointer index = m_freeHead;
+	if(index != INVALID_LINK)
+	{
+		m_freeHead = m_entries[index].next;
+	}
+	else
+	{
+		index = static_cast<BlockOutLinkPointer>(m_entries.size());
+		m_entries.emplace_back();
+	}
+
+	auto& entry = m_entries[index];
+	entry.link = link;
+	entry.targetAddress = targetAddress;
+	entry.prev = INVALID_LINK;
+
+	auto headIterator = m_heads.find(targetAddress);
+	if(headIterator != std::end(m_heads))
+	{
+		entry.next = headIterator->second;
+		m_entries[entry.next].prev = index;
+		headIterator->second = index;
+	}
+	else
+	{
+		entry.next = INVALID_LINK;
+		m_heads.insert(std::make_pair(targetAddress, index));
+	}
+
+	m_linkCount++;
+	return index;
+}
+
+void CBlockOutLinkTable::Erase(BlockOutLinkPointer index)
+{
+	assert(index < m_entries.size());
+	auto& entry = m_entries[index];
+	if(entry.prev != INVALID_LINK)
+	{
+		m_entries[entry.prev].next = entry.next;
+	}
+	else
+	{
+		auto headIterator = m_heads.find(entry.targetAddress);
+		assert(headIterator != std::end(m_heads));
+		assert(headIterator->second == index);
+		if(entry.next != INVALID_LINK)
+		{
+			headIterator->second = entry.next;
+		}
+		else
+		{
+			m_heads.erase(headIterator);
+		}
+	}
+	if(entry.next != INVALID_LINK)
+	{
+		m_entries[entry.next].prev = entry.prev;
+	}
+
+	entry.prev = INVALID_LINK;
+	entry.next = m_freeHead;
+	m_freeHead = index;
+
+	assert(m_linkCount != 0);
+	m_linkCount--;
+}
+
+void CBlockOutLinkTable::Clear()
+{
+	//Keep the storage around, it will most likely be needed again
+	m_entries.clear();
+	m_heads.clear();
+	m_freeHead = INVALID_LINK;
+	m_linkCount = 0;
+}
+
+bool CBlockOutLinkTable::IsEmpty() const
+{
+	return (m_linkCount == 0);
+}
+
+BLOCK_OUT_LINK& CBlockOutLinkTable::GetLink(BlockOutLinkPointer index)
+{
+	assert(index < m_entries.size());
+	return m_entries[index].link;
+}
@@ -0,0 +1,71 @@
+#pragma once
+
+#include <unordered_map>
+#include <vector>
+#include "Types.h"
+
+enum LINK_SLOT
+{
+	LINK_SLOT_NEXT,
+	LINK_SLOT_BRANCH,
+	LINK_SLOT_TRACE_EXIT, //Taken branch leaving a trace early
+	LINK_SLOT_MAX,
+};
+
+//Block outgoing link
+struct BLOCK_OUT_LINK
+{
+	LINK_SLOT slot;    //slot used in the source block
+	uint32 srcAddress; //address of source block
+	bool live;         //live if linked to another block, otherwise, link is pending
+};
+
+//When block linking is used, each basic block will keep the index of their outgoing link definitions inside the table
+typedef uint32 BlockOutLinkPointer;
+
+//Block outgoing links table. Links are kept in a flat array and recycled, links that
+//target the same address are chained together to allow finding them quickly.
+class CBlockOutLinkTable
+{
+public:
+	enum : BlockOutLinkPointer
+	{
+		INVALID_LINK = ~0U,
+	};
+
+	BlockOutLinkPointer Insert(uint32, const BLOCK_OUT_LINK&);
+	void Erase(BlockOutLinkPointer);
+	void Clear();
+	bool IsEmpty() const;
+
+	BLOCK_OUT_LINK& GetLink(BlockOutLinkPointer);
+
+	//Calls the function for every link targetting the specified address
+	template <typename FunctionType>
+	void ForEachLinkTo(uint32 targetAddress, const FunctionType& function)
+	{
+		auto headIterator = m_heads.find(targetAddress);
+		if(headIterator == std::end(m_heads)) return;
+		for(auto index = headIterator->second; index != INVALID_LINK; index = m_entries[index].next)
+		{
+			function(m_entries[index].link);
+		}
+	}
+
+private:
+	struct ENTRY
+	{
+		BLOCK_OUT_LINK link;
+		uint32 targetAddress = 0;
+		BlockOutLinkPointer prev = INVALID_LINK;
+		BlockOutLinkPointer next = INVALID_LINK;
+	};
+
+	typedef std::vector<ENTRY> EntryArray;
+	typedef std::unordered_map<uint32, BlockOutLinkPointer> HeadMap;
+
+	EntryArray m_entries;
+	HeadMap m_heads;
+	BlockOutLinkPointer m_freeHead = INVALID_LINK;
+	uint32 m_linkCount = 0;
+};
@@ -577,6 +577,15 @@ void CCOP_FPU::CVT_S_W()
 //31
 void CCOP_FPU::LWC1()
 {
+	if(IsMemAccessPageMapped())
+	{
+		ComputeMemAccessRefIdx(4);
+
+		m_codeGen->LoadFromRefIdx(1);
+		m_codeGen->PullRel(offsetof(CMIPS, m_State.nCOP1[m_ft]));
+		return;
+	}
+
 	bool usePageLookup = (m_pCtx->m_pageLookup != nullptr);
 
 	if(usePageLookup)
@@ -616,6 +625,15 @@ void CCOP_FPU::LWC1()
 //39
 void CCOP_FPU::SWC1()
 {
+	if(IsMemAccessPageMapped())
+	{
+		ComputeMemAccessRefIdx(4);
+
+		m_codeGen->PushRel(offsetof(CMIPS, m_State.nCOP1[m_ft]));
+		m_codeGen->StoreAtRefIdx(1);
+		return;
+	}
+
 	bool usePageLookup = (m_pCtx->m_pageLookup != nullptr);
 
 	if(usePageLookup)
@@ -0,0 +1,147 @@
+#include <cassert>
+#include <cstring>
+#include "CodeArena.h"
+#include "AlignedAlloc.h"
+
+#if defined(_WIN32)
+#define NOMINMAX
+#include <Windows.h>
+#define CODE_ARENA_SUPPORTED
+#elif defined(__linux__) && !defined(__ANDROID__)
+#include <sys/mman.h>
+#define CODE_ARENA_SUPPORTED
+#endif
+
+//Other platforms need special handling for executable memory (ie.: W^X on Apple platforms),
+//blocks will keep allocating their own code there.
+
+CCodeArena::CCodeArena(size_t size)
+{
+#ifdef CODE_ARENA_SUPPORTED
+	m_pageSize = framework_getpagesize();
+	size = (size + m_pageSize - 1) & ~(m_pageSize - 1);
+#if defined(_WIN32)
+	//Only reserve address space, pages are committed as they get used
+	m_base = reinterpret_cast<uint8*>(VirtualAlloc(NULL, size, MEM_RESERVE, PAGE_NOACCESS));
+#else
+	void* base = mmap(nullptr, size, PROT_READ | PROT_WRITE | PROT_EXEC, MAP_PRIVATE | MAP_ANONYMOUS | MAP_NORESERVE, -1, 0);
+	m_base = (base != MAP_FAILED) ? reinterpret_cast<uint8*>(base) : nullptr;
+#endif
+	if(m_base != nullptr)
+	{
+		m_size = size;
+	}
+#endif
+}
+
+CCodeArena::~CCodeArena()
+{
+	if(m_base == nullptr) return;
+#if defined(_WIN32)
+	VirtualFree(m_base, 0, MEM_RELEASE);
+#elif defined(CODE_ARENA_SUPPORTED)
+	munmap(m_base, m_size);
+#endif
+}
+
+bool CCodeArena::IsSupported()
+{
+#ifdef CODE_ARENA_SUPPORTED
+	return true;
+#else
+	return false;
+#endif
+}
+
+void* CCodeArena::Allocate(const void* code, size_t size)
+{
+	size_t alignedSize = (size + CODE_ALIGNMENT - 1) & ~static_cast<size_t>(CODE_ALIGNMENT - 1);
+	if(alignedSize > (m_size - m_usedSize))
+	{
+		m_overflowed = true;
+		return nullptr;
+	}
+	if(!Commit(m_usedSize + alignedSize))
+	{
+		//Callers fallback on separate allocations, treat this like running out of space
+		m_overflowed = true;
+		return nullptr;
+	}
+	auto result = m_base + m_usedSize;
+	BeginModify(result, size);
+	memcpy(result, code, size);
+	EndModify(result, size);
+	m_usedSize += alignedSize;
+	return result;
+}
+
+void CCodeArena::Reset()
+{
+	if(m_base == nullptr) return;
+	//Give the memory back to the system, it will be faulted in again when used
+#if defined(_WIN32)
+	if(m_committedSize != 0)
+	{
+		VirtualFree(m_base, m_committedSize, MEM_DECOMMIT);
+	}
+#elif defined(CODE_ARENA_SUPPORTED)
+	if(m_usedSize != 0)
+	{
+		size_t usedPagesSize = (m_usedSize + m_pageSize - 1) & ~(m_pageSize - 1);
+		madvise(m_base, usedPagesSize, MADV_DONTNEED);
+	}
+#endif
+	m_usedSize = 0;
+	m_committedSize = 0;
+	m_overflowed = false;
+}
+
+void CCodeArena::BeginModify(void*, size_t)
+{
+	//Memory is always writable on the platforms we support
+}
+
+void CCodeArena::EndModify(void* code, size_t size)
+{
+	InvalidateInstructionCache(code, size);
+}
+
+size_t CCodeArena::GetSize() const
+{
+	return m_size;
+}
+
+size_t CCodeArena::GetUsedSize() const
+{
+	return m_usedSize;
+}
+
+bool CCodeArena::HasOverflowed() const
+{
+	return m_overflowed;
+}
+
+bool CCodeArena::Commit(size_t size)
+{
+	if(size <= m_committedSize) return true;
+	size_t committedSize = (size + m_pageSize - 1) & ~(m_pageSize - 1);
+#if defined(_WIN32)
+	auto result = VirtualAlloc(m_base + m_committedSize, committedSize - m_committedSize, MEM_COMMIT, PAGE_EXECUTE_READWRITE);
+	if(result == NULL)
+	{
+		return false;
+	}
+#endif
+	m_committedSize = committedSize;
+	return true;
+}
+
+void CCodeArena::InvalidateInstructionCache(void* code, size_t size)
+{
+#if defined(_WIN32)
+	::FlushInstructionCache(GetCurrentProcess(), code, size);
+#elif defined(CODE_ARENA_SUPPORTED)
+	auto begin = reinterpret_cast<char*>(code);
+	__builtin___clear_cache(begin, begin + size);
+#endif
+}
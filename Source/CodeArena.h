@@ -0,0 +1,48 @@
+#pragma once
+
+#include <cstddef>
+#include "Types.h"
+
+//Contiguous executable memory region where compiled code is allocated linearly.
+//Code can't be freed individually, everything is released at once when the arena is reset.
+//This keeps code close together and avoids an allocation and a protection change per block.
+class CCodeArena
+{
+public:
+	CCodeArena(size_t);
+	virtual ~CCodeArena();
+
+	CCodeArena(const CCodeArena&) = delete;
+	CCodeArena& operator=(const CCodeArena&) = delete;
+
+	static bool IsSupported();
+
+	//Copies code in the arena, returns nullptr if there's no space left
+	void* Allocate(const void*, size_t);
+	void Reset();
+
+	void BeginModify(void*, size_t);
+	void EndModify(void*, size_t);
+
+	size_t GetSize() const;
+	size_t GetUsedSize() const;
+
+	//Set when an allocation couldn't be satisfied, cleared on reset
+	bool HasOverflowed() const;
+
+private:
+	enum
+	{
+		CODE_ALIGNMENT = 0x10,
+	};
+
+	bool Commit(size_t);
+	void InvalidateInstructionCache(void*, size_t);
+
+	uint8* m_base = nullptr;
+	size_t m_size = 0;
+	size_t m_usedSize = 0;
+	size_t m_committedSize = 0;
+	size_t m_pageSize = 0;
+	bool m_overflowed = false;
+};
@@ -1,5 +1,9 @@
+#include <algorithm>
 #include <cstring>
+#include <stdexcept>
+#include <zstd.h>
 #include "FrameDump.h"
+#include "FrameDumpWriter.h"
 #include "states/MemoryStateFile.h"
 #include "states/RegisterStateFile.h"
 
@@ -78,6 +82,17 @@ void CFrameDump::Read(Framework::CStream& input)
 {
 	Reset();
 
+	{
+		FrameDumpFormat::HEADER header = {};
+		uint64 readSize = input.Read(&header, sizeof(FrameDumpFormat::HEADER));
+		input.Seek(0, Framework::STREAM_SEEK_SET);
+		if((readSize == sizeof(FrameDumpFormat::HEADER)) && (memcmp(header.magic, FrameDumpFormat::MAGIC, sizeof(header.magic)) == 0))
+		{
+			ReadCompact(input);
+			return;
+		}
+	}
+
 	Framework::CZipArchiveReader archive(input);
 
 	archive.BeginReadFile(STATE_INITIAL_GSRAM)->Read(m_initialGsRam, CGSHandler::RAMSIZE);
@@ -132,6 +147,153 @@ void CFrameDump::Read(Framework::CStream& input)
 	}
 }
 
+void CFrameDump::ReadCompact(Framework::CStream& input)
+{
+	using namespace FrameDumpFormat;
+
+	HEADER header = {};
+	input.Read(&header, sizeof(HEADER));
+	if(header.version != VERSION)
+	{
+		throw std::runtime_error("Unsupported frame dump version.");
+	}
+
+	//Metadata layout depends on build options, only keep what we can make sense of
+	std::vector<uint8> metadata(header.metadataSize, 0);
+	bool canUseMetadata = (header.metadataSize == sizeof(CGsPacketMetadata));
+	if(header.metadataSize < sizeof(unsigned int))
+	{
+		throw std::runtime_error("Invalid frame dump metadata size.");
+	}
+
+	std::vector<uint8> compressedData;
+	std::vector<uint8> chunkData;
+	bool hasInitState = false;
+
+	while(1)
+	{
+		CHUNK_HEADER chunkHeader = {};
+		if(input.Read(&chunkHeader, sizeof(CHUNK_HEADER)) != sizeof(CHUNK_HEADER)) break;
+
+		chunkData.resize(chunkHeader.rawSize);
+		if(chunkHeader.rawSize != 0)
+		{
+			compressedData.resize(chunkHeader.compressedSize);
+			if(input.Read(compressedData.data(), compressedData.size()) != compressedData.size())
+			{
+				throw std::runtime_error("Frame dump is truncated.");
+			}
+			size_t decompressedSize = ZSTD_decompress(chunkData.data(), chunkData.size(), compressedData.data(), compressedData.size());
+			if(ZSTD_isError(decompressedSize) || (decompressedSize != chunkHeader.rawSize))
+			{
+				throw std::runtime_error("Failed to decompress frame dump chunk.");
+			}
+		}
+
+		switch(chunkHeader.type)
+		{
+		case CHUNK_TYPE_INITSTATE:
+		{
+			if(hasInitState) break;
+			if(chunkData.size() != (CGSHandler::RAMSIZE + (sizeof(uint64) * CGSHandler::REGISTER_MAX) + sizeof(uint64)))
+			{
+				throw std::runtime_error("Invalid frame dump initial state.");
+			}
+			auto dataPtr = chunkData.data();
+			memcpy(m_initialGsRam, dataPtr, CGSHandler::RAMSIZE);
+			dataPtr += CGSHandler::RAMSIZE;
+			memcpy(m_initialGsRegisters, dataPtr, sizeof(uint64) * CGSHandler::REGISTER_MAX);
+			dataPtr += sizeof(uint64) * CGSHandler::REGISTER_MAX;
+			memcpy(&m_initialSMODE2, dataPtr, sizeof(uint64));
+			hasInitState = true;
+		}
+		break;
+		case CHUNK_TYPE_PACKETS:
+		{
+			const uint8* dataPtr = chunkData.data();
+			const uint8* dataEnd = chunkData.data() + chunkData.size();
+			auto readData = [&](void* output, size_t size) {
+				if((dataPtr + size) > dataEnd)
+				{
+					throw std::runtime_error("Invalid frame dump packet chunk.");
+				}
+				memcpy(output, dataPtr, size);
+				dataPtr += size;
+			};
+
+			while(dataPtr != dataEnd)
+			{
+				CGsPacket packet;
+
+				uint8 flags = 0;
+				readData(&flags, sizeof(uint8));
+
+				if(flags & PACKET_HAS_METADATA_DELTA)
+				{
+					uint32 changedBlockCount = 0;
+					readData(&changedBlockCount, sizeof(uint32));
+					for(uint32 i = 0; i < changedBlockCount; i++)
+					{
+						uint32 blockIndex = 0;
+						readData(&blockIndex, sizeof(uint32));
+						uint32 blockOffset = blockIndex * METADATA_BLOCK_SIZE;
+						if(blockOffset >= metadata.size())
+						{
+							throw std::runtime_error("Invalid frame dump packet metadata.");
+						}
+						uint32 blockSize = std::min<uint32>(METADATA_BLOCK_SIZE, metadata.size() - blockOffset);
+						readData(metadata.data() + blockOffset, blockSize);
+					}
+				}
+
+				if(flags & PACKET_HAS_REGISTERWRITES)
+				{
+					if(canUseMetadata)
+					{
+						memcpy(&packet.metadata, metadata.data(), sizeof(CGsPacketMetadata));
+					}
+					else
+					{
+						memcpy(&packet.metadata.pathIndex, metadata.data(), sizeof(unsigned int));
+					}
+
+					uint32 writeCount = 0;
+					readData(&writeCount, sizeof(uint32));
+					packet.registerWrites.resize(writeCount);
+					for(auto& registerWrite : packet.registerWrites)
+					{
+						readData(&registerWrite.first, sizeof(uint8));
+					}
+					for(auto& registerWrite : packet.registerWrites)
+					{
+						readData(&registerWrite.second, sizeof(uint64));
+					}
+				}
+
+				if(flags & PACKET_HAS_IMAGEDATA)
+				{
+					uint32 imageDataSize = 0;
+					readData(&imageDataSize, sizeof(uint32));
+					packet.imageData.resize(imageDataSize);
+					readData(packet.imageData.data(), imageDataSize);
+				}
+
+				m_packets.push_back(std::move(packet));
+			}
+		}
+		break;
+		case CHUNK_TYPE_FRAMEEND:
+		default:
+			break;
+		}
+	}
+
+	if(!hasInitState)
+	{
+		throw std::runtime_error("Frame dump doesn't have an initial state.");
+	}
+}
+
 void CFrameDump::Write(Framework::CStream& output) const
 {
 	Framework::CZipArchiveWriter archive;
@@ -87,6 +87,8 @@ public:
 	const DrawingKickInfoMap& GetDrawingKicks() const;
 
 private:
+	void ReadCompact(Framework::CStream&);
+
 	uint8* m_initialGsRam = nullptr;
 	uint64 m_initialGsRegisters[CGSHandler::REGISTER_MAX];
 	uint64 m_initialSMODE2 = 0;
@@ -0,0 +1,213 @@
+#include <algorithm>
+#include <cstring>
+#include <stdexcept>
+#include <zstd.h>
+#include "FrameDumpWriter.h"
+
+using namespace FrameDumpFormat;
+
+//Packets are accumulated until they reach this size before being handed to the worker
+#define PACKET_CHUNK_SIZE 0x100000
+#define MAX_PENDING_CHUNKS 32
+#define COMPRESSION_LEVEL 3
+
+CFrameDumpWriter::CFrameDumpWriter(std::shared_ptr<Framework::CStream> stream)
+    : m_stream(std::move(stream))
+    , m_prevMetadata(sizeof(CGsPacketMetadata), 0)
+{
+	HEADER header = {};
+	memcpy(header.magic, MAGIC, sizeof(MAGIC));
+	header.version = VERSION;
+	header.metadataSize = sizeof(CGsPacketMetadata);
+	m_stream->Write(&header, sizeof(HEADER));
+
+	m_packetBuffer.reserve(PACKET_CHUNK_SIZE);
+	m_thread = std::thread([this]() { ThreadProc(); });
+}
+
+CFrameDumpWriter::~CFrameDumpWriter()
+{
+	Close();
+}
+
+void CFrameDumpWriter::WriteInitialState(const uint8* gsRam, const uint64* gsRegisters, uint64 smode2)
+{
+	CHUNK chunk;
+	chunk.type = CHUNK_TYPE_INITSTATE;
+	chunk.data.resize(CGSHandler::RAMSIZE + (sizeof(uint64) * CGSHandler::REGISTER_MAX) + sizeof(uint64));
+	auto dataPtr = chunk.data.data();
+	memcpy(dataPtr, gsRam, CGSHandler::RAMSIZE);
+	dataPtr += CGSHandler::RAMSIZE;
+	memcpy(dataPtr, gsRegisters, sizeof(uint64) * CGSHandler::REGISTER_MAX);
+	dataPtr += sizeof(uint64) * CGSHandler::REGISTER_MAX;
+	memcpy(dataPtr, &smode2, sizeof(uint64));
+	QueueChunk(std::move(chunk));
+}
+
+void CFrameDumpWriter::AddRegisterPacket(const CGSHandler::RegisterWrite* registerWrites, uint32 count, const CGsPacketMetadata* metadata)
+{
+	CGsPacketMetadata packetMetadata;
+	if(metadata)
+	{
+		packetMetadata = *metadata;
+	}
+
+	bool metadataChanged = memcmp(m_prevMetadata.data(), &packetMetadata, sizeof(CGsPacketMetadata)) != 0;
+
+	uint8 flags = PACKET_HAS_REGISTERWRITES;
+	flags |= metadataChanged ? PACKET_HAS_METADATA_DELTA : 0;
+	AppendValue(flags);
+
+	if(metadataChanged)
+	{
+		AppendMetadataDelta(packetMetadata);
+	}
+
+	//Registers and values are stored separately, values compress better this way
+	AppendValue(count);
+	for(uint32 i = 0; i < count; i++)
+	{
+		AppendValue(registerWrites[i].first);
+	}
+	for(uint32 i = 0; i < count; i++)
+	{
+		AppendValue(registerWrites[i].second);
+	}
+
+	if(m_packetBuffer.size() >= PACKET_CHUNK_SIZE)
+	{
+		FlushPackets();
+	}
+}
+
+void CFrameDumpWriter::AddImagePacket(const uint8* imageData, uint32 size)
+{
+	uint8 flags = PACKET_HAS_IMAGEDATA;
+	AppendValue(flags);
+	AppendValue(size);
+	m_packetBuffer.insert(m_packetBuffer.end(), imageData, imageData + size);
+
+	if(m_packetBuffer.size() >= PACKET_CHUNK_SIZE)
+	{
+		FlushPackets();
+	}
+}
+
+void CFrameDumpWriter::EndFrame()
+{
+	FlushPackets();
+	CHUNK chunk;
+	chunk.type = CHUNK_TYPE_FRAMEEND;
+	QueueChunk(std::move(chunk));
+}
+
+void CFrameDumpWriter::Close()
+{
+	if(m_closed) return;
+	FlushPackets();
+	CHUNK chunk;
+	chunk.isLast = true;
+	QueueChunk(std::move(chunk));
+	m_thread.join();
+	m_closed = true;
+}
+
+bool CFrameDumpWriter::HasFailed() const
+{
+	return m_failed;
+}
+
+void CFrameDumpWriter::AppendMetadataDelta(const CGsPacketMetadata& metadata)
+{
+	auto metadataPtr = reinterpret_cast<const uint8*>(&metadata);
+	uint32 blockCount = (sizeof(CGsPacketMetadata) + METADATA_BLOCK_SIZE - 1) / METADATA_BLOCK_SIZE;
+
+	//Reserve space for the changed block count, we'll fill it after
+	size_t blockCountOffset = m_packetBuffer.size();
+	AppendValue(uint32(0));
+
+	uint32 changedBlockCount = 0;
+	for(uint32 blockIndex = 0; blockIndex < blockCount; blockIndex++)
+	{
+		uint32 blockOffset = blockIndex * METADATA_BLOCK_SIZE;
+		uint32 blockSize = std::min<uint32>(METADATA_BLOCK_SIZE, sizeof(CGsPacketMetadata) - blockOffset);
+		if(memcmp(m_prevMetadata.data() + blockOffset, metadataPtr + blockOffset, blockSize) == 0) continue;
+		AppendValue(blockIndex);
+		m_packetBuffer.insert(m_packetBuffer.end(), metadataPtr + blockOffset, metadataPtr + blockOffset + blockSize);
+		changedBlockCount++;
+	}
+
+	memcpy(m_packetBuffer.data() + blockCountOffset, &changedBlockCount, sizeof(uint32));
+	memcpy(m_prevMetadata.data(), metadataPtr, sizeof(CGsPacketMetadata));
+}
+
+void CFrameDumpWriter::FlushPackets()
+{
+	if(m_packetBuffer.empty()) return;
+	CHUNK chunk;
+	chunk.type = CHUNK_TYPE_PACKETS;
+	chunk.data = std::move(m_packetBuffer);
+	m_packetBuffer = Buffer();
+	m_packetBuffer.reserve(PACKET_CHUNK_SIZE);
+	QueueChunk(std::move(chunk));
+}
+
+void CFrameDumpWriter::QueueChunk(CHUNK chunk)
+{
+	assert(!m_closed);
+	std::unique_lock chunksLock(m_chunksMutex);
+	//Don't let the backlog grow indefinitely if the worker can't keep up
+	m_chunksCondVar.wait(chunksLock, [this]() { return m_chunks.size() < MAX_PENDING_CHUNKS; });
+	m_chunks.push_back(std::move(chunk));
+	m_chunksCondVar.notify_all();
+}
+
+void CFrameDumpWriter::ThreadProc()
+{
+	auto compressContext = ZSTD_createCCtx();
+	Buffer compressedData;
+
+	while(1)
+	{
+		CHUNK chunk;
+		{
+			std::unique_lock chunksLock(m_chunksMutex);
+			m_chunksCondVar.wait(chunksLock, [this]() { return !m_chunks.empty(); });
+			chunk = std::move(m_chunks.front());
+			m_chunks.pop_front();
+			m_chunksCondVar.notify_all();
+		}
+
+		if(chunk.isLast) break;
+		if(m_failed) continue;
+
+		try
+		{
+			CHUNK_HEADER chunkHeader = {};
+			chunkHeader.type = chunk.type;
+			chunkHeader.rawSize = static_cast<uint32>(chunk.data.size());
+
+			if(!chunk.data.empty())
+			{
+				compressedData.resize(ZSTD_compressBound(chunk.data.size()));
+				size_t compressedSize = ZSTD_compressCCtx(compressContext, compressedData.data(), compressedData.size(),
+				                                          chunk.data.data(), chunk.data.size(), COMPRESSION_LEVEL);
+				if(ZSTD_isError(compressedSize))
+				{
+					throw std::runtime_error("Failed to compress frame dump chunk.");
+				}
+				chunkHeader.compressedSize = static_cast<uint32>(compressedSize);
+			}
+
+			m_stream->Write(&chunkHeader, sizeof(CHUNK_HEADER));
+			m_stream->Write(compressedData.data(), chunkHeader.compressedSize);
+		}
+		catch(...)
+		{
+			m_failed = true;
+		}
+	}
+
+	ZSTD_freeCCtx(compressContext);
+	m_stream.reset();
+}
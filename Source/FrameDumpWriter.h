@@ -0,0 +1,104 @@
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+#include "Types.h"
+#include "Stream.h"
+#include "FrameDump.h"
+
+namespace FrameDumpFormat
+{
+	//File layout:
+	//- Header (magic, version, size of packet metadata)
+	//- Chunks: type, raw size, compressed size followed by zstd compressed payload
+	static const char MAGIC[8] = {'P', 'L', 'A', 'Y', 'F', 'D', 'M', 'P'};
+	static constexpr uint32 VERSION = 1;
+
+	enum CHUNK_TYPE : uint32
+	{
+		CHUNK_TYPE_INITSTATE = 1,
+		CHUNK_TYPE_PACKETS = 2,
+		CHUNK_TYPE_FRAMEEND = 3,
+	};
+
+	enum PACKET_FLAGS : uint8
+	{
+		PACKET_HAS_REGISTERWRITES = 0x01,
+		PACKET_HAS_IMAGEDATA = 0x02,
+		PACKET_HAS_METADATA_DELTA = 0x04,
+	};
+
+	//Packet metadata is stored as a list of blocks that changed since the last register packet
+	static constexpr uint32 METADATA_BLOCK_SIZE = 0x40;
+
+	struct HEADER
+	{
+		char magic[8];
+		uint32 version;
+		uint32 metadataSize;
+	};
+	static_assert(sizeof(HEADER) == 0x10);
+
+	struct CHUNK_HEADER
+	{
+		uint32 type;
+		uint32 rawSize;
+		uint32 compressedSize;
+	};
+	static_assert(sizeof(CHUNK_HEADER) == 0x0C);
+}
+
+//Writes frame dumps in a chunked and compressed format, suitable for capturing several frames.
+//Packets are serialized on the calling thread, compression and output happen on a worker thread.
+class CFrameDumpWriter
+{
+public:
+	CFrameDumpWriter(std::shared_ptr<Framework::CStream>);
+	virtual ~CFrameDumpWriter();
+
+	void WriteInitialState(const uint8*, const uint64*, uint64);
+	void AddRegisterPacket(const CGSHandler::RegisterWrite*, uint32, const CGsPacketMetadata*);
+	void AddImagePacket(const uint8*, uint32);
+	void EndFrame();
+	void Close();
+
+	bool HasFailed() const;
+
+private:
+	typedef std::vector<uint8> Buffer;
+
+	struct CHUNK
+	{
+		uint32 type = 0;
+		Buffer data;
+		bool isLast = false;
+	};
+
+	void AppendMetadataDelta(const CGsPacketMetadata&);
+	void FlushPackets();
+	void QueueChunk(CHUNK);
+	void ThreadProc();
+
+	template <typename ValueType>
+	void AppendValue(const ValueType& value)
+	{
+		auto valuePtr = reinterpret_cast<const uint8*>(&value);
+		m_packetBuffer.insert(m_packetBuffer.end(), valuePtr, valuePtr + sizeof(ValueType));
+	}
+
+	std::shared_ptr<Framework::CStream> m_stream;
+	Buffer m_packetBuffer;
+	Buffer m_prevMetadata;
+
+	std::thread m_thread;
+	std::mutex m_chunksMutex;
+	std::condition_variable m_chunksCondVar;
+	std::deque<CHUNK> m_chunks;
+	std::atomic<bool> m_failed{false};
+	bool m_closed = false;
+};
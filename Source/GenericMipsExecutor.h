@@ -1,8 +1,16 @@
 #pragma once
 
+#include <algorithm>
+#include <cstring>
 #include <unordered_set>
+#include <vector>
+#include "AlignedAlloc.h"
+#include "xxhash.h"
 #include "MIPS.h"
 #include "BasicBlock.h"
+#include "BlockCache.h"
+#include "BlockOutLinkTable.h"
+#include "CodeArena.h"
 
 #include "BlockLookupOneWay.h"
 #include "BlockLookupTwoWay.h"
@@ -16,7 +24,6 @@ static bool RangesOverlap(uint32 x1, uint32 x2, uint32 y1, uint32 y2)
 }
 
 typedef uint32 (*TranslateFunctionType)(CMIPS*, uint32);
-typedef std::shared_ptr<CBasicBlock> BasicBlockPtr;
 
 template <typename BlockLookupType, uint32 instructionSize = 4>
 class CGenericMipsExecutor : public CMipsExecutor
@@ -32,8 +39,23 @@ public:
 		RECYCLE_NOLINK_THRESHOLD = 16,
 	};
 
+	//Each side exit of a trace needs its own link slot, blocks only have one for now.
+	//Longer traces should only be allowed if benchmarks show they are worth it.
+	enum
+	{
+		MAX_TRACE_SEGMENTS = 2,
+	};
+
+	//Only address space is reserved, pages are used as code gets compiled. On 64-bit platforms, this is
+	//larger than the default code cache budget so that the budget decides when the arena is recycled.
+	enum : size_t
+	{
+		CODE_ARENA_SIZE = (sizeof(void*) == 8) ? 0x40000000 : 0x1000000,
+	};
+
 	CGenericMipsExecutor(CMIPS& context, uint32 maxAddress, BLOCK_CATEGORY blockCategory)
-	    : m_emptyBlock(std::make_shared<CBasicBlock>(context, MIPS_INVALID_PC, MIPS_INVALID_PC, blockCategory))
+	    : m_codeArena(CODE_ARENA_SIZE)
+	    , m_emptyBlock(std::make_shared<CBasicBlock>(context, MIPS_INVALID_PC, MIPS_INVALID_PC, blockCategory))
 	    , m_context(context)
 	    , m_maxAddress(maxAddress)
 	    , m_addressMask(maxAddress - 1)
@@ -43,6 +65,13 @@ public:
 		m_emptyBlock->Compile();
 		ResetBlockOutLinks(m_emptyBlock.get());
 
+		//Empty block is compiled before the arena is used, it must survive arena resets
+		if(CCodeArena::IsSupported() && (m_codeArena.GetSize() != 0))
+		{
+			assert(!context.m_codeArena);
+			context.m_codeArena = &m_codeArena;
+		}
+
 		assert(!context.m_emptyBlockHandler);
 		context.m_emptyBlockHandler =
 		    [&](CMIPS* context) {
@@ -58,6 +87,15 @@ public:
 
 	int Execute(int cycles) override
 	{
+		if(m_codeArena.HasOverflowed() || m_mustResetCodeArena)
+		{
+			ResetCodeArena();
+		}
+		else if(m_mustEvictActiveBlocks)
+		{
+			EvictColdActiveBlocks();
+		}
+		m_executeEpoch++;
 		m_context.m_State.cycleQuota = cycles;
 #ifdef DEBUGGER_INCLUDED
 		m_mustBreak = false;
@@ -67,6 +105,7 @@ public:
 		{
 			uint32 address = m_context.m_State.nPC & m_addressMask;
 			auto block = m_blockLookup.FindBlockAt(address);
+			block->SetLastExecutedEpoch(m_executeEpoch);
 			block->Execute();
 		}
 		m_context.m_State.nHasException &= ~MIPS_EXCEPTION_STATUS_QUOTADONE;
@@ -90,7 +129,12 @@ public:
 	{
 		m_blockLookup.Clear();
 		m_blocks.clear();
-		m_blockOutLinks.clear();
+		m_blockOutLinks.Clear();
+		m_cachedBlocks.Clear();
+		m_codeArena.Reset();
+		m_activeCodeSize = 0;
+		m_mustEvictActiveBlocks = false;
+		m_mustResetCodeArena = false;
 #ifdef DEBUGGER_INCLUDED
 		m_mustBreak = false;
 #endif
@@ -107,6 +151,27 @@ public:
 		ClearActiveBlocksInRangeInternal(start, end, currentBlock);
 	}
 
+	void SetCodeCacheBudget(uint64 codeCacheBudget) override
+	{
+		m_codeCacheBudget = codeCacheBudget;
+		EnforceCodeCacheBudget();
+	}
+
+	CODE_CACHE_STATS GetCodeCacheStats() const override
+	{
+		CODE_CACHE_STATS stats;
+		stats.activeBlockCount = m_blocks.size();
+		stats.activeCodeSize = m_activeCodeSize;
+		stats.cachedBlockCount = m_cachedBlocks.GetBlockCount();
+		stats.cachedCodeSize = m_cachedBlocks.GetCodeSize();
+		stats.evictedBlockCount = m_cachedBlocks.GetEvictedBlockCount();
+		stats.recompiledBlockCount = m_cachedBlocks.GetRecompiledBlockCount();
+		stats.evictedActiveBlockCount = m_evictedActiveBlockCount;
+		stats.flushCount = m_flushCount;
+		stats.arenaUsedSize = m_codeArena.GetUsedSize();
+		return stats;
+	}
+
 #ifdef DEBUGGER_INCLUDED
 	bool MustBreak() const override
 	{
@@ -138,15 +203,101 @@ protected:
 		assert(!HasBlockAt(start));
 		auto block = BlockFactory(m_context, start, end);
 		ResetBlockOutLinks(block.get());
+		block->SetLastExecutedEpoch(m_executeEpoch);
+		m_cachedBlocks.Pin(block.get());
 		m_blockLookup.AddBlock(block.get());
+		m_activeCodeSize += block->GetCodeSize();
 		m_blocks.insert(std::move(block));
+		EnforceCodeCacheBudget();
+	}
+
+	//Active blocks are pinned in the cache and only counted once. Blocks that are only held by the cache
+	//are evicted first, least recently used ones first. Active blocks can't be removed while they could be
+	//executing, the least recently executed ones are moved back to the cache the next time the executor is entered.
+	//Evicting blocks doesn't give back arena space, the whole arena is recycled once it goes over the budget.
+	void EnforceCodeCacheBudget()
+	{
+		if(m_codeCacheBudget == 0) return;
+		uint64 cachedCodeBudget = (m_activeCodeSize < m_codeCacheBudget) ? (m_codeCacheBudget - m_activeCodeSize) : 0;
+		m_cachedBlocks.Trim(cachedCodeBudget);
+		if(m_activeCodeSize > m_codeCacheBudget)
+		{
+			m_mustEvictActiveBlocks = true;
+		}
+		if(m_codeArena.GetUsedSize() > m_codeCacheBudget)
+		{
+			m_mustResetCodeArena = true;
+		}
+	}
+
+	void FlushActiveBlocks()
+	{
+		//Links only exist between active blocks, orphaning all of them clears every link
+		for(const auto& block : m_blocks)
+		{
+			OrphanBlock(block.get());
+			m_blockLookup.DeleteBlock(block.get());
+			m_cachedBlocks.Unpin(block.get());
+		}
+		assert(m_blockOutLinks.IsEmpty());
+		m_blocks.clear();
+		m_activeCodeSize = 0;
+		m_mustEvictActiveBlocks = false;
+		m_flushCount++;
+	}
+
+	//Epochs are only updated when blocks are dispatched by the executor. Blocks that are only reached
+	//through links can look cold, if they get evicted, links to them are undone and they will be brought
+	//back from the cache (without being compiled again) the next time they are needed.
+	void EvictColdActiveBlocks()
+	{
+		m_mustEvictActiveBlocks = false;
+		if(m_codeCacheBudget == 0) return;
+
+		std::vector<CBasicBlock*> blocks;
+		blocks.reserve(m_blocks.size());
+		for(const auto& block : m_blocks)
+		{
+			blocks.push_back(block.get());
+		}
+		std::sort(blocks.begin(), blocks.end(),
+		          [this](const CBasicBlock* lhs, const CBasicBlock* rhs) {
+			          return (m_executeEpoch - lhs->GetLastExecutedEpoch()) > (m_executeEpoch - rhs->GetLastExecutedEpoch());
+		          });
+
+		//Go a bit under the budget to avoid having to do this again right away
+		uint64 targetCodeSize = m_codeCacheBudget - (m_codeCacheBudget / 4);
+		uint64 activeCodeSize = m_activeCodeSize;
+		std::set<CBasicBlock*> evictedBlocks;
+		for(auto* block : blocks)
+		{
+			if(activeCodeSize <= targetCodeSize) break;
+			activeCodeSize -= block->GetCodeSize();
+			evictedBlocks.insert(block);
+		}
+
+		ClearActiveBlocks(evictedBlocks);
+		m_evictedActiveBlockCount += evictedBlocks.size();
+
+		//Evicted blocks are now counted in the cache
+		EnforceCodeCacheBudget();
+	}
+
+	//Blocks compiled after the arena was filled up use separate allocations. All blocks are
+	//thrown away at once to allow the arena to be reused, this doesn't happen often.
+	void ResetCodeArena()
+	{
+		FlushActiveBlocks();
+		m_cachedBlocks.Clear();
+		m_codeArena.Reset();
+		m_mustResetCodeArena = false;
 	}
 
 	void ResetBlockOutLinks(CBasicBlock* block)
 	{
 		for(uint32 i = 0; i < LINK_SLOT_MAX; i++)
 		{
-			block->SetOutLink(static_cast<LINK_SLOT>(i), std::end(m_blockOutLinks));
+			block->SetOutLink(static_cast<LINK_SLOT>(i), CBlockOutLinkTable::INVALID_LINK);
 		}
 	}
 
@@ -157,6 +308,45 @@ protected:
 		return result;
 	}
 
+	CBlockCache::KeyType GetCachedBlockKey(uint32 start, uint32 end) const
+	{
+		uint32 blockSize = (end - start) + 4;
+
+		auto blockMemory = reinterpret_cast<uint32*>(alloca(blockSize));
+		for(uint32 address = start; address <= end; address += 4)
+		{
+			uint32 index = (address - start) / 4;
+			uint32 opcode = m_context.m_pMemoryMap->GetInstruction(address);
+			blockMemory[index] = opcode;
+		}
+
+		auto xxHash = XXH3_128bits(blockMemory, blockSize);
+		uint128 hash;
+		memcpy(&hash, &xxHash, sizeof(xxHash));
+		static_assert(sizeof(hash) == sizeof(xxHash));
+		return std::make_pair(hash, blockSize);
+	}
+
+	//Looks for a block with the same code in the cache. If it covers the same range, it is reused as is,
+	//otherwise, a new block sharing its compiled code is created. Returns nullptr if there's no such block.
+	template <typename BasicBlockType>
+	BasicBlockPtr FindCachedBlock(CMIPS& context, const CBlockCache::KeyType& blockKey, uint32 start, uint32 end)
+	{
+		auto basicBlock = m_cachedBlocks.Find(blockKey);
+		if(!basicBlock) return BasicBlockPtr();
+
+		if(basicBlock->GetBeginAddress() == start && basicBlock->GetEndAddress() == end)
+		{
+			uint32 recycleCount = basicBlock->GetRecycleCount();
+			basicBlock->SetRecycleCount(std::min<uint32>(RECYCLE_NOLINK_THRESHOLD, recycleCount + 1));
+			return basicBlock;
+		}
+
+		auto result = std::make_shared<BasicBlockType>(context, start, end, m_blockCategory);
+		result->CopyFunctionFrom(basicBlock);
+		return result;
+	}
+
 	void SetupBlockLinks(uint32 startAddress, uint32 endAddress, uint32 branchAddress)
 	{
 		auto block = m_blockLookup.FindBlockAt(startAddress);
@@ -164,56 +354,69 @@ protected:
 		{
 			uint32 nextBlockAddress = (endAddress + 4) & m_addressMask;
 			const auto linkSlot = LINK_SLOT_NEXT;
-			auto link = m_blockOutLinks.insert(std::make_pair(nextBlockAddress, BLOCK_OUT_LINK{linkSlot, startAddress, false}));
+			auto link = m_blockOutLinks.Insert(nextBlockAddress, BLOCK_OUT_LINK{linkSlot, startAddress, false});
 			block->SetOutLink(linkSlot, link);
 
 			auto nextBlock = m_blockLookup.FindBlockAt(nextBlockAddress);
 			if(!nextBlock->IsEmpty())
 			{
 				block->LinkBlock(linkSlot, nextBlock);
-				link->second.live = true;
+				m_blockOutLinks.GetLink(link).live = true;
 			}
 		}
 
-		if((branchAddress != MIPS_INVALID_PC) && block->HasLinkSlot(LINK_SLOT_BRANCH))
-		{
-			branchAddress &= m_addressMask;
-			const auto linkSlot = LINK_SLOT_BRANCH;
-			auto link = m_blockOutLinks.insert(std::make_pair(branchAddress, BLOCK_OUT_LINK{linkSlot, startAddress, false}));
-			block->SetOutLink(linkSlot, link);
+		auto setupTargetLinkSlot =
+		    [&](LINK_SLOT linkSlot, uint32 targetAddress) {
+			    if((targetAddress == MIPS_INVALID_PC) || !block->HasLinkSlot(linkSlot))
+			    {
+				    block->SetOutLink(linkSlot, CBlockOutLinkTable::INVALID_LINK);
+				    return;
+			    }
 
-			auto branchBlock = m_blockLookup.FindBlockAt(branchAddress);
-			if(!branchBlock->IsEmpty())
-			{
-				block->LinkBlock(linkSlot, branchBlock);
-				link->second.live = true;
-			}
+			    targetAddress &= m_addressMask;
+			    auto link = m_blockOutLinks.Insert(targetAddress, BLOCK_OUT_LINK{linkSlot, startAddress, false});
+			    block->SetOutLink(linkSlot, link);
+
+			    auto targetBlock = m_blockLookup.FindBlockAt(targetAddress);
+			    if(!targetBlock->IsEmpty())
+			    {
+				    block->LinkBlock(linkSlot, targetBlock);
+				    m_blockOutLinks.GetLink(link).live = true;
+			    }
+		    };
+
+		setupTargetLinkSlot(LINK_SLOT_BRANCH, branchAddress);
+
+		if(block->HasLinkSlot(LINK_SLOT_TRACE_EXIT))
+		{
+			setupTargetLinkSlot(LINK_SLOT_TRACE_EXIT, GetTraceExitAddress(startAddress, endAddress));
 		}
 		else
 		{
-			block->SetOutLink(LINK_SLOT_BRANCH, std::end(m_blockOutLinks));
+			block->SetOutLink(LINK_SLOT_TRACE_EXIT, CBlockOutLinkTable::INVALID_LINK);
 		}
 
 		//Resolve any block links that could be valid now that block has been created
-		{
-			auto lowerBound = m_blockOutLinks.lower_bound(startAddress);
-			auto upperBound = m_blockOutLinks.upper_bound(startAddress);
-			for(auto blockLinkIterator = lowerBound; blockLinkIterator != upperBound; blockLinkIterator++)
-			{
-				auto& blockLink = blockLinkIterator->second;
-				if(blockLink.live) continue;
-				auto referringBlock = m_blockLookup.FindBlockAt(blockLink.srcAddress);
-				if(referringBlock->IsEmpty()) continue;
-				referringBlock->LinkBlock(blockLink.slot, block);
-				blockLink.live = true;
-			}
-		}
+		m_blockOutLinks.ForEachLinkTo(startAddress,
+		                              [&](BLOCK_OUT_LINK& blockLink) {
+			                              if(blockLink.live) return;
+			                              auto referringBlock = m_blockLookup.FindBlockAt(blockLink.srcAddress);
+			                              if(referringBlock->IsEmpty()) return;
+			                              referringBlock->LinkBlock(blockLink.slot, block);
+			                              blockLink.live = true;
+		                              });
 	}
 
 	virtual void PartitionFunction(uint32 startAddress)
 	{
 		uint32 endAddress = startAddress + MAX_BLOCK_SIZE;
 		uint32 branchAddress = MIPS_INVALID_PC;
+		//End of the last complete trace segment, used if the trace can't be terminated properly
+		uint32 traceEndAddress = MIPS_INVALID_PC;
+		uint32 traceBranchAddress = MIPS_INVALID_PC;
+		uint32 traceSegmentCount = 1;
+		bool canExtendTrace = CanExtendTrace(startAddress);
+		bool foundBlockEnd = false;
 		for(uint32 address = startAddress; address < endAddress; address += 4)
 		{
 			uint32 opcode = m_context.m_pMemoryMap->GetInstruction(address);
@@ -233,14 +436,35 @@ protected:
 						endAddress = address;
 					}
 				}
+				//Keep going through the fall-through path of forward conditional branches to form a trace.
+				//The block will exit early if the branch is taken.
+				if(canExtendTrace && (endAddress != address) && (traceSegmentCount < MAX_TRACE_SEGMENTS) &&
+				   IsTraceBranch(address, opcode, branchAddress) && CanExtendTrace(endAddress + 4))
+				{
+					traceEndAddress = endAddress;
+					traceBranchAddress = branchAddress;
+					traceSegmentCount++;
+					address = endAddress;
+					endAddress = startAddress + MAX_BLOCK_SIZE;
+					branchAddress = MIPS_INVALID_PC;
+					continue;
+				}
+				foundBlockEnd = true;
 				break;
 			}
 			else if(branchType == MIPS_BRANCH_NODELAY)
 			{
 				endAddress = address;
+				foundBlockEnd = true;
 				break;
 			}
 		}
+		if(!foundBlockEnd && (traceEndAddress != MIPS_INVALID_PC))
+		{
+			//Only keep complete segments in the trace
+			endAddress = traceEndAddress;
+			branchAddress = traceBranchAddress;
+		}
 		assert((endAddress - startAddress) <= MAX_BLOCK_SIZE);
 		assert(endAddress <= m_maxAddress);
 		CreateBlock(startAddress, endAddress);
@@ -251,24 +475,81 @@ protected:
 		}
 	}
 
+	//Target of the branch that can leave a trace before its end, branches inside the block
+	//are the ones that have their delay slot before the end of the block
+	uint32 GetTraceExitAddress(uint32 startAddress, uint32 endAddress) const
+	{
+		for(uint32 address = startAddress; (address + 4) < endAddress; address += 4)
+		{
+			uint32 opcode = m_context.m_pMemoryMap->GetInstruction(address);
+			if(m_context.m_pArch->IsInstructionBranch(&m_context, address, opcode) == MIPS_BRANCH_NORMAL)
+			{
+				return m_context.m_pArch->GetInstructionEffectiveAddress(&m_context, address, opcode);
+			}
+		}
+		return MIPS_INVALID_PC;
+	}
+
+	//Allows derived executors to prevent code at some address from being merged in a trace
+	virtual bool CanExtendTrace(uint32)
+	{
+		return true;
+	}
+
+	//Traces follow the fall-through path of forward conditional branches, assuming they are not taken.
+	//Backward branches are usually loop-back edges, they end the trace and get handled by the block epilog.
+	static bool IsTraceBranch(uint32 address, uint32 opcode, uint32 branchAddress)
+	{
+		if(branchAddress == MIPS_INVALID_PC) return false;
+		if(branchAddress <= address) return false;
+
+		uint32 op = (opcode >> 26) & 0x3F;
+		uint32 rs = (opcode >> 21) & 0x1F;
+		uint32 rt = (opcode >> 16) & 0x1F;
+		switch(op)
+		{
+		case 0x01:
+			//REGIMM: BGEZ variants always branch when used with R0
+			return !((rs == 0) && ((rt & 0x01) != 0));
+		case 0x04:
+		case 0x14:
+			//BEQ/BEQL: always branches if both operands are the same
+			return (rs != rt);
+		case 0x05:
+		case 0x06:
+		case 0x07:
+		case 0x10:
+		case 0x11:
+		case 0x12:
+		case 0x15:
+		case 0x16:
+		case 0x17:
+			return true;
+		default:
+			//J, JAL, JR, JALR: no fall-through path
+			return false;
+		}
+	}
+
 	//Unlink and removes block from all of our bookkeeping structures
 	void OrphanBlock(CBasicBlock* block)
 	{
 		auto orphanBlockLinkSlot =
 		    [&](LINK_SLOT linkSlot) {
 			    auto link = block->GetOutLink(linkSlot);
-			    if(link != std::end(m_blockOutLinks))
+			    if(link != CBlockOutLinkTable::INVALID_LINK)
 			    {
-				    if(link->second.live)
+				    if(m_blockOutLinks.GetLink(link).live)
 				    {
 					    block->UnlinkBlock(linkSlot);
 				    }
-				    block->SetOutLink(linkSlot, std::end(m_blockOutLinks));
-				    m_blockOutLinks.erase(link);
+				    block->SetOutLink(linkSlot, CBlockOutLinkTable::INVALID_LINK);
+				    m_blockOutLinks.Erase(link);
 			    }
 		    };
 		orphanBlockLinkSlot(LINK_SLOT_NEXT);
 		orphanBlockLinkSlot(LINK_SLOT_BRANCH);
+		orphanBlockLinkSlot(LINK_SLOT_TRACE_EXIT);
 	}
 
 	void ClearActiveBlocksInRangeInternal(uint32 start, uint32 end, CBasicBlock* protectedBlock)
@@ -286,6 +567,16 @@ protected:
 			if(block == protectedBlock) continue;
 			if(!RangesOverlap(block->GetBeginAddress(), block->GetEndAddress(), start, end)) continue;
 			clearedBlocks.insert(block);
+		}
+
+		ClearActiveBlocks(clearedBlocks);
+	}
+
+	//Cleared blocks stay in the cache if they were held by it
+	void ClearActiveBlocks(const std::set<CBasicBlock*>& clearedBlocks)
+	{
+		for(auto& block : clearedBlocks)
+		{
 			m_blockLookup.DeleteBlock(block);
 		}
 
@@ -298,28 +589,29 @@ protected:
 		//Undo all stale links
 		for(auto& block : clearedBlocks)
 		{
-			auto lowerBound = m_blockOutLinks.lower_bound(block->GetBeginAddress());
-			auto upperBound = m_blockOutLinks.upper_bound(block->GetBeginAddress());
-			for(auto blockLinkIterator = lowerBound; blockLinkIterator != upperBound; blockLinkIterator++)
-			{
-				auto& blockLink = blockLinkIterator->second;
-				if(!blockLink.live) continue;
-				auto referringBlock = m_blockLookup.FindBlockAt(blockLink.srcAddress);
-				if(referringBlock->IsEmpty()) continue;
-				referringBlock->UnlinkBlock(blockLink.slot);
-				blockLink.live = false;
-			}
+			m_blockOutLinks.ForEachLinkTo(block->GetBeginAddress(),
+			                              [&](BLOCK_OUT_LINK& blockLink) {
+				                              if(!blockLink.live) return;
+				                              auto referringBlock = m_blockLookup.FindBlockAt(blockLink.srcAddress);
+				                              if(referringBlock->IsEmpty()) return;
+				                              referringBlock->UnlinkBlock(blockLink.slot);
+				                              blockLink.live = false;
+			                              });
 		}
 
 		for(auto* clearedBlock : clearedBlocks)
 		{
+			m_activeCodeSize -= clearedBlock->GetCodeSize();
+			m_cachedBlocks.Unpin(clearedBlock);
 			m_blocks.erase(clearedBlock->shared_from_this());
 		}
 	}
 
+	//Must be declared before anything holding blocks, it needs to outlive them
+	CCodeArena m_codeArena;
 	BlockStore m_blocks;
 	BasicBlockPtr m_emptyBlock;
-	BlockOutLinkMap m_blockOutLinks;
+	CBlockOutLinkTable m_blockOutLinks;
 	CMIPS& m_context;
 	uint32 m_maxAddress = 0;
 	uint32 m_addressMask = 0;
@@ -327,6 +619,15 @@ protected:
 
 	BlockLookupType m_blockLookup;
 
+	CBlockCache m_cachedBlocks;
+	uint64 m_codeCacheBudget = 0;
+	uint64 m_activeCodeSize = 0;
+	uint64 m_evictedActiveBlockCount = 0;
+	uint64 m_flushCount = 0;
+	uint32 m_executeEpoch = 0;
+	bool m_mustEvictActiveBlocks = false;
+	bool m_mustResetCodeArena = false;
+
 #ifdef DEBUGGER_INCLUDED
 	bool m_mustBreak = false;
 	bool m_breakpointsDisabledOnce = false;
@@ -211,6 +211,18 @@ extern "C" void SDR_Proxy(uint32 address, uint64 rt, CMIPS* context)
 	MemoryUtils_SetDoubleProxy(context, memory, alignedAddress);
 }
 
+extern "C" uint32 HleCall_Proxy(CMIPS* context)
+{
+	if(!context->m_hleCallHandler) return 0;
+	return context->m_hleCallHandler(context) ? 1 : 0;
+}
+
+extern "C" uint32 Syscall_Proxy(CMIPS* context)
+{
+	if(!context->m_syscallHandler) return 0;
+	return context->m_syscallHandler(context) ? 1 : 0;
+}
+
 CMA_MIPSIV::CMA_MIPSIV(MIPS_REGSIZE nRegSize)
     : CMIPSArchitecture(nRegSize)
 {
@@ -375,8 +387,17 @@ void CMA_MIPSIV::ADDIU()
 
 		m_codeGen->PullRel(offsetof(CMIPS, m_State.nCOP0[CCOP_SCU::EPC]));
 
-		m_codeGen->PushCst(MIPS_EXCEPTION_SYSCALL);
-		m_codeGen->PullRel(offsetof(CMIPS, m_State.nHasException));
+		//Try to call the handler directly, raise a SYSCALL exception if it couldn't
+		m_codeGen->PushCtx();
+		m_codeGen->Call(reinterpret_cast<void*>(&HleCall_Proxy), 1, Jitter::CJitter::RETURN_VALUE_32);
+
+		m_codeGen->PushCst(0);
+		m_codeGen->BeginIf(Jitter::CONDITION_EQ);
+		{
+			m_codeGen->PushCst(MIPS_EXCEPTION_SYSCALL);
+			m_codeGen->PullRel(offsetof(CMIPS, m_State.nHasException));
+		}
+		m_codeGen->EndIf();
 	}
 	else
 	{
@@ -770,6 +791,15 @@ void CMA_MIPSIV::LD()
 	if(!Ensure64BitRegs()) return;
 	if(m_nRT == 0) return;
 
+	if(IsMemAccessPageMapped())
+	{
+		ComputeMemAccessRefIdx(8);
+
+		m_codeGen->Load64FromRefIdx(1);
+		m_codeGen->PullRel64(offsetof(CMIPS, m_State.nGPR[m_nRT]));
+		return;
+	}
+
 	ComputeMemAccessPageRef();
 
 	m_codeGen->PushCst(0);
@@ -825,6 +855,15 @@ void CMA_MIPSIV::SD()
 {
 	if(!Ensure64BitRegs()) return;
 
+	if(IsMemAccessPageMapped())
+	{
+		ComputeMemAccessRefIdx(8);
+
+		m_codeGen->PushRel64(offsetof(CMIPS, m_State.nGPR[m_nRT]));
+		m_codeGen->Store64AtRefIdx(1);
+		return;
+	}
+
 	ComputeMemAccessPageRef();
 
 	m_codeGen->PushCst(0);
@@ -943,8 +982,18 @@ void CMA_MIPSIV::SYSCALL()
 	m_codeGen->Add();
 
 	m_codeGen->PullRel(offsetof(CMIPS, m_State.nCOP0[CCOP_SCU::EPC]));
-	m_codeGen->PushCst(MIPS_EXCEPTION_SYSCALL);
-	m_codeGen->PullRel(offsetof(CMIPS, m_State.nHasException));
+
+	//Give the OS a chance to handle the call without leaving the block, raise a SYSCALL exception if it couldn't
+	m_codeGen->PushCtx();
+	m_codeGen->Call(reinterpret_cast<void*>(&Syscall_Proxy), 1, Jitter::CJitter::RETURN_VALUE_32);
+
+	m_codeGen->PushCst(0);
+	m_codeGen->BeginIf(Jitter::CONDITION_EQ);
+	{
+		m_codeGen->PushCst(MIPS_EXCEPTION_SYSCALL);
+		m_codeGen->PullRel(offsetof(CMIPS, m_State.nHasException));
+	}
+	m_codeGen->EndIf();
 }
 
 //0D
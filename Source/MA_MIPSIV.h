@@ -14,6 +14,9 @@ public:
 	void GetInstructionOperands(CMIPS*, uint32, uint32, char*, unsigned int) override;
 	MIPS_BRANCH_TYPE IsInstructionBranch(CMIPS*, uint32, uint32) override;
 	uint32 GetInstructionEffectiveAddress(CMIPS*, uint32, uint32) override;
+	bool GetInstructionRegisterUsage(CMIPS*, uint32, uint32, REGISTER_USAGE&) override;
+	RegisterWordSet GetInstructionConstantInputs(CMIPS*, uint32, uint32) override;
+	void PropagateInstructionConstants(CMIPS*, uint32, uint32, REGISTER_VALUES&) override;
 
 protected:
 	enum
@@ -56,6 +59,8 @@ protected:
 	static MIPS_BRANCH_TYPE ReflCOPIsBranch(MIPSReflection::INSTRUCTION*, CMIPS*, uint32);
 	static uint32 ReflCOPEffeAddr(MIPSReflection::INSTRUCTION*, CMIPS*, uint32, uint32);
 
+	static bool IsMemoryAccessOp(uint32);
+
 	MIPSReflection::INSTRUCTION m_ReflGeneral[MAX_GENERAL_OPS];
 	MIPSReflection::INSTRUCTION m_ReflSpecial[MAX_SPECIAL_OPS];
 	MIPSReflection::INSTRUCTION m_ReflRegImm[MAX_REGIMM_OPS];
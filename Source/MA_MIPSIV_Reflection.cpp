@@ -1,3 +1,4 @@
+#include <assert.h>
 #include <string.h>
 #include <stdio.h>
 #include "MA_MIPSIV.h"
@@ -476,3 +477,416 @@ uint32 CMA_MIPSIV::GetInstructionEffectiveAddress(CMIPS* pCtx, uint32 nAddress,
 	Instr.pSubTable = &m_ReflGeneralTable;
 	return Instr.pGetEffectiveAddress(&Instr, pCtx, nAddress, nOpcode);
 }
+
+bool CMA_MIPSIV::GetInstructionRegisterUsage(CMIPS* pCtx, uint32 nAddress, uint32 nOpcode, REGISTER_USAGE& usage)
+{
+	usage = REGISTER_USAGE();
+
+	if(nOpcode == 0) return true;
+
+	uint32 op = (nOpcode >> 26) & 0x3F;
+	uint32 rs = (nOpcode >> 21) & 0x1F;
+	uint32 rt = (nOpcode >> 16) & 0x1F;
+	uint32 rd = (nOpcode >> 11) & 0x1F;
+	uint32 special = nOpcode & 0x3F;
+
+	bool is64 = (m_regSize == MIPS_REGSIZE_64);
+	//Number of words written by 32-bit operations (upper half is sign extended on 64-bit CPUs)
+	unsigned int resultWordCount = is64 ? 2 : 1;
+
+	//Reads are conservative and cover the whole register
+	auto readReg =
+	    [&](uint32 reg) {
+		    for(unsigned int i = 0; i < 4; i++)
+		    {
+			    usage.reads.set((reg * 4) + i);
+		    }
+	    };
+
+	//R0 isn't tracked, writes to it are either skipped or ignored
+	auto writeReg =
+	    [&](uint32 reg, unsigned int wordCount) {
+		    if(reg == 0) return;
+		    for(unsigned int i = 0; i < wordCount; i++)
+		    {
+			    usage.writes.set((reg * 4) + i);
+		    }
+	    };
+
+	auto setHiLo =
+	    [&](RegisterWordSet& set, unsigned int base, unsigned int wordCount) {
+		    for(unsigned int i = 0; i < wordCount; i++)
+		    {
+			    set.set(base + i);
+		    }
+	    };
+
+	switch(op)
+	{
+	case 0x00:
+		switch(special)
+		{
+		case 0x00: //SLL
+		case 0x02: //SRL
+		case 0x03: //SRA
+			readReg(rt);
+			writeReg(rd, resultWordCount);
+			return true;
+		case 0x04: //SLLV
+		case 0x06: //SRLV
+		case 0x07: //SRAV
+		case 0x20: //ADD
+		case 0x21: //ADDU
+		case 0x22: //SUB
+		case 0x23: //SUBU
+		case 0x24: //AND
+		case 0x25: //OR
+		case 0x26: //XOR
+		case 0x27: //NOR
+		case 0x2A: //SLT
+		case 0x2B: //SLTU
+			readReg(rs);
+			readReg(rt);
+			writeReg(rd, resultWordCount);
+			return true;
+		case 0x10: //MFHI
+			setHiLo(usage.reads, REGISTER_WORD_HI, 2);
+			writeReg(rd, 2);
+			return true;
+		case 0x12: //MFLO
+			setHiLo(usage.reads, REGISTER_WORD_LO, 2);
+			writeReg(rd, 2);
+			return true;
+		case 0x11: //MTHI
+			readReg(rs);
+			setHiLo(usage.writes, REGISTER_WORD_HI, 2);
+			return true;
+		case 0x13: //MTLO
+			readReg(rs);
+			setHiLo(usage.writes, REGISTER_WORD_LO, 2);
+			return true;
+		case 0x18: //MULT
+		case 0x19: //MULTU
+			readReg(rs);
+			readReg(rt);
+			setHiLo(usage.writes, REGISTER_WORD_LO, resultWordCount);
+			setHiLo(usage.writes, REGISTER_WORD_HI, resultWordCount);
+			if(rd != 0)
+			{
+				//LO is copied to rd after being computed
+				setHiLo(usage.selfReads, REGISTER_WORD_LO, resultWordCount);
+				if(!is64)
+				{
+					usage.reads.set(REGISTER_WORD_LO + 1);
+				}
+				writeReg(rd, 2);
+			}
+			return true;
+		case 0x1A: //DIV
+		case 0x1B: //DIVU
+			readReg(rs);
+			readReg(rt);
+			setHiLo(usage.writes, REGISTER_WORD_LO, resultWordCount);
+			setHiLo(usage.writes, REGISTER_WORD_HI, resultWordCount);
+			if(is64)
+			{
+				//Lower words are read back to compute the sign extension
+				usage.selfReads.set(REGISTER_WORD_LO);
+				usage.selfReads.set(REGISTER_WORD_HI);
+			}
+			return true;
+		case 0x14: //DSLLV
+		case 0x16: //DSRLV
+		case 0x17: //DSRAV
+		case 0x2C: //DADD
+		case 0x2D: //DADDU
+		case 0x2E: //DSUB
+		case 0x2F: //DSUBU
+			if(!is64) return false;
+			readReg(rs);
+			readReg(rt);
+			writeReg(rd, 2);
+			return true;
+		case 0x38: //DSLL
+		case 0x3A: //DSRL
+		case 0x3B: //DSRA
+		case 0x3C: //DSLL32
+		case 0x3E: //DSRL32
+		case 0x3F: //DSRA32
+			if(!is64) return false;
+			readReg(rt);
+			writeReg(rd, 2);
+			return true;
+		default:
+			return false;
+		}
+	case 0x09: //ADDIU
+		//ADDIU R0, R0, $x is used for HLE calls on the IOP
+		if((rs == 0) && (rt == 0)) return false;
+		[[fallthrough]];
+	case 0x08: //ADDI
+	case 0x0A: //SLTI
+	case 0x0B: //SLTIU
+	case 0x0C: //ANDI
+		readReg(rs);
+		writeReg(rt, resultWordCount);
+		return true;
+	case 0x0D: //ORI
+		//Upper word is only copied if registers are different
+		readReg(rs);
+		writeReg(rt, (is64 && (rs != rt)) ? 2 : 1);
+		return true;
+	case 0x0E: //XORI
+		readReg(rs);
+		writeReg(rt, 2);
+		return true;
+	case 0x0F: //LUI
+		writeReg(rt, resultWordCount);
+		return true;
+	case 0x18: //DADDI
+	case 0x19: //DADDIU
+		if(!is64) return false;
+		readReg(rs);
+		writeReg(rt, 2);
+		return true;
+	default:
+		return false;
+	}
+}
+
+CMIPSArchitecture::RegisterWordSet CMA_MIPSIV::GetInstructionConstantInputs(CMIPS* pCtx, uint32 nAddress, uint32 nOpcode)
+{
+	REGISTER_USAGE usage;
+	if(GetInstructionRegisterUsage(pCtx, nAddress, nOpcode, usage))
+	{
+		return usage.reads;
+	}
+
+	RegisterWordSet result;
+	uint32 op = (nOpcode >> 26) & 0x3F;
+	if(IsMemoryAccessOp(op))
+	{
+		//Only the base address register is used, other operands might be written in ways we can't track
+		uint32 rs = (nOpcode >> 21) & 0x1F;
+		result.set(rs * 4);
+	}
+	return result;
+}
+
+void CMA_MIPSIV::PropagateInstructionConstants(CMIPS* pCtx, uint32 nAddress, uint32 nOpcode, REGISTER_VALUES& values)
+{
+	if(nOpcode == 0) return;
+
+	uint32 op = (nOpcode >> 26) & 0x3F;
+	uint32 rs = (nOpcode >> 21) & 0x1F;
+	uint32 rt = (nOpcode >> 16) & 0x1F;
+	uint32 rd = (nOpcode >> 11) & 0x1F;
+	uint32 sa = (nOpcode >> 6) & 0x1F;
+	uint32 special = nOpcode & 0x3F;
+	uint16 immediate = static_cast<uint16>(nOpcode & 0xFFFF);
+
+	bool is64 = (m_regSize == MIPS_REGSIZE_64);
+
+	auto invalidateReg =
+	    [&](uint32 reg) {
+		    for(unsigned int i = 0; i < 4; i++)
+		    {
+			    values.known.reset((reg * 4) + i);
+		    }
+	    };
+
+	REGISTER_USAGE usage;
+	if(!GetInstructionRegisterUsage(pCtx, nAddress, nOpcode, usage))
+	{
+		//Only forget about registers that can be written by the instruction
+		switch(op)
+		{
+		case 0x00:
+			if((special == 0x0C) || (special == 0x0D))
+			{
+				//SYSCALL, BREAK: handlers can change anything
+				values.known.reset();
+			}
+			else
+			{
+				invalidateReg(rd);
+			}
+			break;
+		case 0x01:
+		case 0x03:
+			//REGIMM and JAL: link register
+			invalidateReg(31);
+			break;
+		case 0x02:
+		case 0x04:
+		case 0x05:
+		case 0x06:
+		case 0x07:
+		case 0x14:
+		case 0x15:
+		case 0x16:
+		case 0x17:
+			break;
+		case 0x10:
+		case 0x11:
+		case 0x12:
+		case 0x13:
+			//Coprocessor moves
+			invalidateReg(rt);
+			break;
+		default:
+			if(IsMemoryAccessOp(op))
+			{
+				invalidateReg(rt);
+			}
+			else
+			{
+				values.known.reset();
+			}
+			break;
+		}
+		return;
+	}
+
+	auto isKnown =
+	    [&](uint32 reg, unsigned int word) {
+		    return (reg == 0) || values.known.test((reg * 4) + word);
+	    };
+
+	auto getValue =
+	    [&](uint32 reg, unsigned int word) -> uint32 {
+		    return (reg == 0) ? 0 : values.values[(reg * 4) + word];
+	    };
+
+	//Results are computed before forgetting about the written words, sources can be the same as the destination
+	struct RESULT
+	{
+		uint32 reg;
+		unsigned int word;
+		uint32 value;
+	};
+	RESULT results[2];
+	unsigned int resultCount = 0;
+
+	auto addResult =
+	    [&](uint32 reg, unsigned int word, uint32 value) {
+		    assert(resultCount < 2);
+		    results[resultCount++] = {reg, word, value};
+	    };
+
+	//32-bit results are sign extended on 64-bit CPUs
+	auto addResult32 =
+	    [&](uint32 reg, uint32 value) {
+		    addResult(reg, 0, value);
+		    if(is64)
+		    {
+			    addResult(reg, 1, (value & 0x80000000) ? 0xFFFFFFFF : 0);
+		    }
+	    };
+
+	switch(op)
+	{
+	case 0x00:
+		switch(special)
+		{
+		case 0x00: //SLL
+			if(isKnown(rt, 0)) addResult32(rd, getValue(rt, 0) << sa);
+			break;
+		case 0x02: //SRL
+			if(isKnown(rt, 0)) addResult32(rd, getValue(rt, 0) >> sa);
+			break;
+		case 0x03: //SRA
+			if(isKnown(rt, 0)) addResult32(rd, static_cast<int32>(getValue(rt, 0)) >> sa);
+			break;
+		case 0x20: //ADD
+		case 0x21: //ADDU
+			if(isKnown(rs, 0) && isKnown(rt, 0)) addResult32(rd, getValue(rs, 0) + getValue(rt, 0));
+			break;
+		case 0x22: //SUB
+		case 0x23: //SUBU
+			if(isKnown(rs, 0) && isKnown(rt, 0)) addResult32(rd, getValue(rs, 0) - getValue(rt, 0));
+			break;
+		case 0x24: //AND
+		case 0x25: //OR
+		case 0x26: //XOR
+		case 0x27: //NOR
+			for(unsigned int i = 0; i < (is64 ? 2 : 1); i++)
+			{
+				if(!isKnown(rs, i) || !isKnown(rt, i)) continue;
+				uint32 src1 = getValue(rs, i);
+				uint32 src2 = getValue(rt, i);
+				switch(special)
+				{
+				case 0x24:
+					addResult(rd, i, src1 & src2);
+					break;
+				case 0x25:
+					addResult(rd, i, src1 | src2);
+					break;
+				case 0x26:
+					addResult(rd, i, src1 ^ src2);
+					break;
+				case 0x27:
+					addResult(rd, i, ~(src1 | src2));
+					break;
+				}
+			}
+			break;
+		case 0x2D: //DADDU
+			if(isKnown(rs, 0) && isKnown(rs, 1) && isKnown(rt, 0) && isKnown(rt, 1))
+			{
+				uint64 src1 = static_cast<uint64>(getValue(rs, 0)) | (static_cast<uint64>(getValue(rs, 1)) << 32);
+				uint64 src2 = static_cast<uint64>(getValue(rt, 0)) | (static_cast<uint64>(getValue(rt, 1)) << 32);
+				uint64 result = src1 + src2;
+				addResult(rd, 0, static_cast<uint32>(result));
+				addResult(rd, 1, static_cast<uint32>(result >> 32));
+			}
+			break;
+		}
+		break;
+	case 0x08: //ADDI
+	case 0x09: //ADDIU
+		if(isKnown(rs, 0)) addResult32(rt, getValue(rs, 0) + static_cast<int16>(immediate));
+		break;
+	case 0x0C: //ANDI
+		if(isKnown(rs, 0)) addResult(rt, 0, getValue(rs, 0) & immediate);
+		if(is64) addResult(rt, 1, 0);
+		break;
+	case 0x0D: //ORI
+		if(isKnown(rs, 0)) addResult(rt, 0, getValue(rs, 0) | immediate);
+		if(is64 && (rs != rt) && isKnown(rs, 1)) addResult(rt, 1, getValue(rs, 1));
+		break;
+	case 0x0E: //XORI
+		if(isKnown(rs, 0)) addResult(rt, 0, getValue(rs, 0) ^ immediate);
+		if(isKnown(rs, 1)) addResult(rt, 1, getValue(rs, 1));
+		break;
+	case 0x0F: //LUI
+		addResult32(rt, static_cast<uint32>(immediate) << 16);
+		break;
+	case 0x19: //DADDIU
+		if(isKnown(rs, 0) && isKnown(rs, 1))
+		{
+			uint64 src = static_cast<uint64>(getValue(rs, 0)) | (static_cast<uint64>(getValue(rs, 1)) << 32);
+			uint64 result = src + static_cast<int64>(static_cast<int16>(immediate));
+			addResult(rt, 0, static_cast<uint32>(result));
+			addResult(rt, 1, static_cast<uint32>(result >> 32));
+		}
+		break;
+	}
+
+	values.known &= ~usage.writes;
+	for(unsigned int i = 0; i < resultCount; i++)
+	{
+		const auto& result = results[i];
+		if(result.reg == 0) continue;
+		uint32 word = (result.reg * 4) + result.word;
+		values.known.set(word);
+		values.values[word] = result.value;
+	}
+}
+
+bool CMA_MIPSIV::IsMemoryAccessOp(uint32 op)
+{
+	//LDL, LDR, LQ, SQ and all standard loads, stores and coprocessor transfers
+	return (op == 0x1A) || (op == 0x1B) || (op == 0x1E) || (op == 0x1F) || (op >= 0x20);
+}
@@ -94,6 +94,14 @@ void CMA_MIPSIV::Template_Load32Idx(const MemoryAccessIdxTraits& traits)
 		    m_codeGen->PullRel(offsetof(CMIPS, m_State.nGPR[m_nRT].nV[0]));
 	    };
 
+	if(IsMemAccessPageMapped())
+	{
+		ComputeMemAccessRefIdx(traits.elementSize);
+		((m_codeGen)->*(traits.loadFunction))(1);
+		finishLoad();
+		return;
+	}
+
 	bool usePageLookup = (m_pCtx->m_pageLookup != nullptr);
 
 	if(usePageLookup)
@@ -133,6 +141,15 @@ void CMA_MIPSIV::Template_Store32Idx(const MemoryAccessIdxTraits& traits)
 {
 	CheckTLBExceptions(true);
 
+	if(IsMemAccessPageMapped())
+	{
+		ComputeMemAccessRefIdx(traits.elementSize);
+
+		m_codeGen->PushRel(offsetof(CMIPS, m_State.nGPR[m_nRT].nV[0]));
+		((m_codeGen)->*(traits.storeFunction))(1);
+		return;
+	}
+
 	bool usePageLookup = (m_pCtx->m_pageLookup != nullptr);
 
 	if(usePageLookup)
@@ -10,6 +10,8 @@
 #include "uint128.h"
 #include <set>
 
+class CCodeArena;
+
 struct REGISTER_PIPELINE
 {
 	uint32 counter;
@@ -172,6 +174,9 @@ public:
 	void** m_pageLookup = nullptr;
 
 	std::function<void(CMIPS*)> m_emptyBlockHandler;
+	CCodeArena* m_codeArena = nullptr;
+	std::function<bool(CMIPS*)> m_hleCallHandler;
+	std::function<bool(CMIPS*)> m_syscallHandler;
 
 	CMIPSArchitecture* m_pArch = nullptr;
 	CMIPSCoprocessor* m_pCOP[4];
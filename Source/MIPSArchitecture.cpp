@@ -1,6 +1,41 @@
 #include "MIPSArchitecture.h"
+#include "MIPS.h"
+#include "offsetof_def.h"
 
 CMIPSArchitecture::CMIPSArchitecture(MIPS_REGSIZE regSize)
     : CMIPSInstructionFactory(regSize)
 {
 }
+
+bool CMIPSArchitecture::GetInstructionRegisterUsage(CMIPS*, uint32, uint32, REGISTER_USAGE&)
+{
+	return false;
+}
+
+CMIPSArchitecture::RegisterWordSet CMIPSArchitecture::GetInstructionConstantInputs(CMIPS*, uint32, uint32)
+{
+	return RegisterWordSet();
+}
+
+void CMIPSArchitecture::PropagateInstructionConstants(CMIPS*, uint32, uint32, REGISTER_VALUES& values)
+{
+	//Nothing is known about this instruction, it could have modified anything
+	values.known.reset();
+}
+
+size_t CMIPSArchitecture::GetRegisterWordOffset(unsigned int word)
+{
+	assert(word < REGISTER_WORD_COUNT);
+	if(word >= REGISTER_WORD_LO)
+	{
+		return offsetof(CMIPS, m_State.nLO[word - REGISTER_WORD_LO]);
+	}
+	else if(word >= REGISTER_WORD_HI)
+	{
+		return offsetof(CMIPS, m_State.nHI[word - REGISTER_WORD_HI]);
+	}
+	else
+	{
+		return offsetof(CMIPS, m_State.nGPR[word / 4].nV[word % 4]);
+	}
+}
@@ -1,14 +1,51 @@
 #pragma once
 
+#include <bitset>
 #include "MIPSInstructionFactory.h"
 
 class CMIPSArchitecture : public CMIPSInstructionFactory
 {
 public:
+	enum
+	{
+		//Register words tracked by liveness analysis: 4 words for each GPR, followed by HI and LO
+		REGISTER_WORD_HI = 0x80,
+		REGISTER_WORD_LO = 0x82,
+		REGISTER_WORD_COUNT = 0x84,
+	};
+
+	typedef std::bitset<REGISTER_WORD_COUNT> RegisterWordSet;
+
+	struct REGISTER_USAGE
+	{
+		RegisterWordSet reads;     //Words read before the instruction writes anything
+		RegisterWordSet writes;    //Words always overwritten by the instruction
+		RegisterWordSet selfReads; //Words written, then read back by the instruction itself
+	};
+
+	//Register values known at compile time
+	struct REGISTER_VALUES
+	{
+		RegisterWordSet known;
+		uint32 values[REGISTER_WORD_COUNT] = {};
+	};
+
 	CMIPSArchitecture(MIPS_REGSIZE);
 	virtual ~CMIPSArchitecture() = default;
 	virtual void GetInstructionMnemonic(CMIPS*, uint32, uint32, char*, unsigned int) = 0;
 	virtual void GetInstructionOperands(CMIPS*, uint32, uint32, char*, unsigned int) = 0;
 	virtual MIPS_BRANCH_TYPE IsInstructionBranch(CMIPS*, uint32, uint32) = 0;
 	virtual uint32 GetInstructionEffectiveAddress(CMIPS*, uint32, uint32) = 0;
+
+	//Returns false if the instruction might do more than computing registers from other registers
+	//(memory accesses, branches, exceptions, etc.) or if its register usage isn't known.
+	virtual bool GetInstructionRegisterUsage(CMIPS*, uint32, uint32, REGISTER_USAGE&);
+
+	//Returns the register words that can be replaced by a value known at compile time when compiling an instruction
+	virtual RegisterWordSet GetInstructionConstantInputs(CMIPS*, uint32, uint32);
+
+	//Updates register values known at compile time with the effects of an instruction
+	virtual void PropagateInstructionConstants(CMIPS*, uint32, uint32, REGISTER_VALUES&);
+
+	static size_t GetRegisterWordOffset(unsigned int);
 };
@@ -165,6 +165,21 @@ void CMIPSInstructionFactory::ComputeMemAccessPageRef()
 	m_codeGen->LoadRefFromRefIdx();
 }
 
+//Checks if the effective address is known at compile time and lies in a directly mapped page,
+//in which case the page lookup check can be skipped
+bool CMIPSInstructionFactory::IsMemAccessPageMapped()
+{
+	if(m_pCtx->m_pageLookup == nullptr) return false;
+
+	auto rs = static_cast<uint8>((m_nOpcode >> 21) & 0x001F);
+	auto immediate = static_cast<int16>((m_nOpcode >> 0) & 0xFFFF);
+	auto baseValue = m_codeGen->GetKnownVariableValue(offsetof(CMIPS, m_State.nGPR[rs].nV[0]));
+	if(!baseValue) return false;
+
+	uint32 address = baseValue.value() + immediate;
+	return m_pCtx->m_pageLookup[address / MIPS_PAGE_SIZE] != nullptr;
+}
+
 void CMIPSInstructionFactory::Branch(Jitter::CONDITION condition)
 {
 	uint16 nImmediate = (uint16)(m_nOpcode & 0xFFFF);
@@ -32,6 +32,7 @@ protected:
 	void ComputeMemAccessAddrNoXlat();
 	void ComputeMemAccessRefIdx(uint32);
 	void ComputeMemAccessPageRef();
+	bool IsMemAccessPageMapped();
 
 	void CheckTLBExceptions(bool);
 	void CheckTrap();
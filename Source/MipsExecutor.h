@@ -2,6 +2,19 @@
 
 #include "Types.h"
 
+struct CODE_CACHE_STATS
+{
+	uint64 activeBlockCount = 0;
+	uint64 activeCodeSize = 0;
+	uint64 cachedBlockCount = 0;
+	uint64 cachedCodeSize = 0;
+	uint64 evictedBlockCount = 0;
+	uint64 recompiledBlockCount = 0;    //Blocks compiled again after having been evicted
+	uint64 evictedActiveBlockCount = 0; //Active blocks moved back to the cache because they didn't fit in the budget
+	uint64 flushCount = 0;              //Number of times all active blocks were thrown away to recycle the code arena
+	uint64 arenaUsedSize = 0;           //Includes code of evicted blocks, only given back when the arena is reset
+};
+
 class CMipsExecutor
 {
 public:
@@ -10,6 +23,10 @@ public:
 	virtual int Execute(int) = 0;
 	virtual void ClearActiveBlocksInRange(uint32 start, uint32 end, bool executing) = 0;
 
+	//Budget (in bytes) for the compiled code held by the executor, 0 means no limit
+	virtual void SetCodeCacheBudget(uint64) = 0;
+	virtual CODE_CACHE_STATS GetCodeCacheStats() const = 0;
+
 #ifdef DEBUGGER_INCLUDED
 	virtual bool MustBreak() const = 0;
 	virtual void DisableBreakpointsOnce() = 0;
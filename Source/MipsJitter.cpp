@@ -21,6 +21,8 @@ void CMipsJitter::Begin()
 	CJitter::Begin();
 	m_firstBlockLabel = -1;
 	m_lastBlockLabel = -1;
+	m_deadVariables.clear();
+	m_knownVariableValues.clear();
 }
 
 void CMipsJitter::PushRel(size_t offset)
@@ -28,7 +30,15 @@ void CMipsJitter::PushRel(size_t offset)
 	VARIABLESTATUS* status = GetVariableStatus(offset);
 	if(status == NULL)
 	{
-		CJitter::PushRel(offset);
+		auto knownValueIterator = m_knownVariableValues.find(offset);
+		if(knownValueIterator != std::end(m_knownVariableValues))
+		{
+			CJitter::PushCst(knownValueIterator->second);
+		}
+		else
+		{
+			CJitter::PushRel(offset);
+		}
 	}
 	else
 	{
@@ -50,7 +60,17 @@ void CMipsJitter::PushRel64(size_t offset)
 	VARIABLESTATUS* statusHi = GetVariableStatus(offset + 4);
 	if(statusLo == NULL || statusHi == NULL)
 	{
-		CJitter::PushRel64(offset);
+		auto knownLo = m_knownVariableValues.find(offset + 0);
+		auto knownHi = m_knownVariableValues.find(offset + 4);
+		if((knownLo != std::end(m_knownVariableValues)) && (knownHi != std::end(m_knownVariableValues)))
+		{
+			uint64 result = static_cast<uint64>(knownLo->second) | (static_cast<uint64>(knownHi->second) << 32);
+			CJitter::PushCst64(result);
+		}
+		else
+		{
+			CJitter::PushRel64(offset);
+		}
 	}
 	else
 	{
@@ -66,6 +86,43 @@ void CMipsJitter::PushRel64(size_t offset)
 	}
 }
 
+void CMipsJitter::PullRel(size_t offset)
+{
+	m_knownVariableValues.erase(offset);
+	if(GetVariableStatus(offset) != NULL)
+	{
+		//Writes to constant variables ($zero) are discarded
+		PullTop();
+	}
+	else if(m_deadVariables.count(offset) != 0)
+	{
+		//Value will be overwritten before anything reads it, no need to write it back
+		PullTop();
+	}
+	else
+	{
+		CJitter::PullRel(offset);
+	}
+}
+
+void CMipsJitter::PullRel64(size_t offset)
+{
+	m_knownVariableValues.erase(offset + 0);
+	m_knownVariableValues.erase(offset + 4);
+	if((GetVariableStatus(offset + 0) != NULL) && (GetVariableStatus(offset + 4) != NULL))
+	{
+		PullTop();
+	}
+	else if((m_deadVariables.count(offset + 0) != 0) && (m_deadVariables.count(offset + 4) != 0))
+	{
+		PullTop();
+	}
+	else
+	{
+		CJitter::PullRel64(offset);
+	}
+}
+
 Jitter::CJitter::LABEL CMipsJitter::GetFirstBlockLabel()
 {
 	assert(m_firstBlockLabel != -1);
@@ -92,6 +149,8 @@ void CMipsJitter::MarkLastBlockLabel()
 	if(m_lastBlockLabel != -1)
 	{
 		MarkLabel(m_lastBlockLabel);
+		//Blocks can contain more than one branch, next one will need its own label
+		m_lastBlockLabel = -1;
 	}
 }
 
@@ -103,6 +162,45 @@ void CMipsJitter::SetVariableAsConstant(size_t variableId, uint32 value)
 	SetVariableStatus(variableId, status);
 }
 
+void CMipsJitter::SetVariableAsDead(size_t variableId)
+{
+	m_deadVariables.insert(variableId);
+}
+
+void CMipsJitter::ClearDeadVariables()
+{
+	m_deadVariables.clear();
+}
+
+void CMipsJitter::SetKnownVariableValue(size_t variableId, uint32 value)
+{
+	m_knownVariableValues[variableId] = value;
+}
+
+void CMipsJitter::ClearKnownVariableValues()
+{
+	m_knownVariableValues.clear();
+}
+
+std::optional<uint32> CMipsJitter::GetKnownVariableValue(size_t variableId)
+{
+	auto status = GetVariableStatus(variableId);
+	if(status != nullptr)
+	{
+		if(status->operandType == Jitter::SYM_CONSTANT)
+		{
+			return status->operandValue;
+		}
+		return std::nullopt;
+	}
+	auto knownValueIterator = m_knownVariableValues.find(variableId);
+	if(knownValueIterator == std::end(m_knownVariableValues))
+	{
+		return std::nullopt;
+	}
+	return knownValueIterator->second;
+}
+
 CMipsJitter::VARIABLESTATUS* CMipsJitter::GetVariableStatus(size_t variableId)
 {
 	auto statusIterator(m_variableStatus.find(variableId));
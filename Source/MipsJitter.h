@@ -1,6 +1,8 @@
 #pragma once
 
 #include <map>
+#include <optional>
+#include <set>
 #include "Jitter.h"
 
 class CMipsJitter : public Jitter::CJitter
@@ -12,9 +14,19 @@ public:
 	void Begin() override;
 	void PushRel(size_t) override;
 	void PushRel64(size_t) override;
+	void PullRel(size_t);
+	void PullRel64(size_t);
 
 	void SetVariableAsConstant(size_t, uint32);
 
+	void SetVariableAsDead(size_t);
+	void ClearDeadVariables();
+
+	//Values known at compile time (ie.: from constant propagation), only valid for the instruction being compiled
+	void SetKnownVariableValue(size_t, uint32);
+	void ClearKnownVariableValues();
+	std::optional<uint32> GetKnownVariableValue(size_t);
+
 	LABEL GetFirstBlockLabel();
 	LABEL GetLastBlockLabel();
 
@@ -29,11 +41,15 @@ private:
 	};
 
 	typedef std::map<size_t, VARIABLESTATUS> VariableStatusMap;
+	typedef std::set<size_t> VariableSet;
+	typedef std::map<size_t, uint32> VariableValueMap;
 
 	VARIABLESTATUS* GetVariableStatus(size_t);
 	void SetVariableStatus(size_t, const VARIABLESTATUS&);
 
 	VariableStatusMap m_variableStatus;
+	VariableSet m_deadVariables;
+	VariableValueMap m_knownVariableValues;
 	LABEL m_firstBlockLabel = -1;
 	LABEL m_lastBlockLabel = -1;
 };
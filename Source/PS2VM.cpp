@@ -52,6 +52,9 @@
 #define PREF_PS2_HDD_DIRECTORY_DEFAULT ("vfs/hdd")
 #define PREF_PS2_ARCADEROMS_DIRECTORY_DEFAULT ("arcaderoms")
 
+//Budget for the compiled code of each processor, in megabytes (0 means no limit)
+#define PREF_PS2_CODECACHE_BUDGET_DEFAULT (256)
+
 CPS2VM::CPS2VM()
     : m_eeProfilerZone(CProfiler::GetInstance().RegisterZone("EE"))
     , m_iopProfilerZone(CProfiler::GetInstance().RegisterZone("IOP"))
@@ -99,6 +102,8 @@ CPS2VM::CPS2VM()
 
 	CAppConfig::GetInstance().RegisterPreferenceBoolean(PREF_PS2_ARCADE_IO_SERVER_ENABLED, false);
 	CAppConfig::GetInstance().RegisterPreferenceInteger(PREF_PS2_ARCADE_IO_SERVER_PORT, 9876);
+
+	CAppConfig::GetInstance().RegisterPreferenceInteger(PREF_PS2_CODECACHE_BUDGET, PREF_PS2_CODECACHE_BUDGET_DEFAULT);
 }
 
 //////////////////////////////////////////////////
@@ -475,6 +480,7 @@ void CPS2VM::CreateVM()
 	m_ee = std::make_unique<Ee::CSubSystem>(m_iop->m_ram, *iopOs);
 	m_OnRequestLoadExecutableConnection = m_ee->m_os->OnRequestLoadExecutable.Connect(std::bind(&CPS2VM::ReloadExecutable, this, std::placeholders::_1, std::placeholders::_2));
 	m_OnCrtModeChangeConnection = m_ee->m_os->OnCrtModeChange.Connect(std::bind(&CPS2VM::OnCrtModeChange, this));
+	m_OnExecutableChangeConnection = m_ee->m_os->OnExecutableChange.Connect(std::bind(&CPS2VM::OnExecutableChange, this));
 
 	ResetVM();
 }
@@ -490,6 +496,14 @@ void CPS2VM::ResetVM()
 	m_ee->Reset(m_eeRamSize);
 	m_iop->Reset();
 
+	{
+		auto codeCacheBudget = static_cast<uint64>(std::max<int>(CAppConfig::GetInstance().GetPreferenceInteger(PREF_PS2_CODECACHE_BUDGET), 0)) * 0x100000;
+		m_ee->m_EE.m_executor->SetCodeCacheBudget(codeCacheBudget);
+		m_ee->m_VU0.m_executor->SetCodeCacheBudget(codeCacheBudget);
+		m_ee->m_VU1.m_executor->SetCodeCacheBudget(codeCacheBudget);
+		m_iop->m_cpu.m_executor->SetCodeCacheBudget(codeCacheBudget);
+	}
+
 	if(m_ee->m_gs != NULL)
 	{
 		m_ee->m_gs->Reset();
@@ -886,6 +900,14 @@ void CPS2VM::OnCrtModeChange()
 	ReloadFrameRateLimit();
 }
 
+void CPS2VM::OnExecutableChange()
+{
+	if(m_ee->m_gs)
+	{
+		m_ee->m_gs->NotifyTitleChanged(m_ee->m_os->GetExecutableName());
+	}
+}
+
 void CPS2VM::EmuThread()
 {
 	CreateVM();
@@ -124,6 +124,7 @@ private:
 
 	void ReloadExecutable(const char*, const CPS2OS::ArgumentList&);
 	void OnCrtModeChange();
+	void OnExecutableChange();
 
 	void PauseImpl();
 	void DestroyImpl();
@@ -204,4 +205,5 @@ private:
 
 	CPS2OS::RequestLoadExecutableEvent::Connection m_OnRequestLoadExecutableConnection;
 	Framework::CSignal<void()>::Connection m_OnCrtModeChangeConnection;
+	Framework::CSignal<void()>::Connection m_OnExecutableChangeConnection;
 };
@@ -14,6 +14,8 @@
 
 #define PREF_PS2_LIMIT_FRAMERATE ("ps2.limitframerate")
 
+#define PREF_PS2_CODECACHE_BUDGET ("ps2.codecache.budget")
+
 #define PREF_AUDIO_SPUBLOCKCOUNT ("audio.spublockcount")
 
 #define PREF_SYSTEM_LANGUAGE ("system.language")
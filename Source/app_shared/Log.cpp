@@ -1,6 +1,13 @@
 #include "Log.h"
 #include <set>
+#include <algorithm>
+#include <cctype>
 #include <cstdarg>
+#include <cstring>
+#include <cstddef>
+#include <cstdint>
+#include <cassert>
+#include <chrono>
 #include "AppConfig.h"
 #include "PathUtils.h"
 #include "StdStreamUtils.h"
@@ -11,6 +18,12 @@
 
 #if LOGGING_ENABLED
 
+//Size of each thread's ring, must be a power of 2
+#define RING_SIZE 0x40000
+#define MAX_RECORD_SIZE (RING_SIZE / 4)
+#define MAX_STRING_ARG_SIZE 0x400
+#define WRITER_IDLE_WAIT_MS 5
+
 // clang-format off
 static const std::set<std::string, std::less<>> g_allowedLogs =
 {
@@ -18,44 +31,564 @@ static const std::set<std::string, std::less<>> g_allowedLogs =
 };
 // clang-format on
 
+//Ring record layout (all fields unaligned, record size is a multiple of 8):
+//- RECORD_HEADER
+//- Log name (uint32 length + characters)
+//- Preformatted message (uint32 length + characters) or encoded arguments
+enum RECORD_FLAGS : uint32
+{
+	RECORD_FLAG_PADDING = 0x01,
+	RECORD_FLAG_PREFORMATTED = 0x02,
+};
+
+struct RECORD_HEADER
+{
+	uint32 size;
+	uint32 flags;
+	const char* format;
+};
+
+enum ARG_TYPE
+{
+	ARG_TYPE_NONE,
+	ARG_TYPE_INT,
+	ARG_TYPE_LONG,
+	ARG_TYPE_LONGLONG,
+	ARG_TYPE_INTMAX,
+	ARG_TYPE_SIZE,
+	ARG_TYPE_PTRDIFF,
+	ARG_TYPE_DOUBLE,
+	ARG_TYPE_POINTER,
+	ARG_TYPE_STRING,
+	ARG_TYPE_UNSUPPORTED,
+};
+
+struct CLog::RING
+{
+	uint8 buffer[RING_SIZE];
+	std::atomic<uint64> writePosition{0};
+	std::atomic<uint64> readPosition{0};
+	std::atomic<uint32> droppedCount{0};
+	std::atomic<bool> abandoned{false};
+
+	//Only accessed by the writer thread
+	uint32 pendingDroppedCount = 0;
+};
+
+struct CLog::THREAD_RING_HOLDER
+{
+	~THREAD_RING_HOLDER()
+	{
+		if(ring)
+		{
+			ring->abandoned = true;
+		}
+	}
+
+	RingPtr ring;
+};
+
+//Finds the next conversion specification starting at 'format'. Returns the end of the specification
+//and sets 'specBegin' to its start, or returns nullptr if there is none left.
+static const char* ParseConversion(const char* format, const char*& specBegin, ARG_TYPE& argType)
+{
+	specBegin = strchr(format, '%');
+	if(!specBegin) return nullptr;
+
+	const char* ptr = specBegin + 1;
+	if(*ptr == '%')
+	{
+		argType = ARG_TYPE_NONE;
+		return ptr + 1;
+	}
+
+	while(strchr("-+ #0", *ptr) && (*ptr != 0)) ptr++;
+	while(isdigit(*ptr)) ptr++;
+	if(*ptr == '.')
+	{
+		ptr++;
+		while(isdigit(*ptr)) ptr++;
+	}
+	if(*ptr == '*')
+	{
+		//Variable width or precision, let the caller format this one
+		argType = ARG_TYPE_UNSUPPORTED;
+		return ptr;
+	}
+
+	ARG_TYPE intType = ARG_TYPE_INT;
+	bool hasLength = false;
+	bool isLongDouble = false;
+	switch(*ptr)
+	{
+	case 'h':
+		ptr++;
+		if(*ptr == 'h') ptr++;
+		hasLength = true;
+		break;
+	case 'l':
+		ptr++;
+		intType = ARG_TYPE_LONG;
+		if(*ptr == 'l')
+		{
+			ptr++;
+			intType = ARG_TYPE_LONGLONG;
+		}
+		hasLength = true;
+		break;
+	case 'q':
+		ptr++;
+		intType = ARG_TYPE_LONGLONG;
+		hasLength = true;
+		break;
+	case 'j':
+		ptr++;
+		intType = ARG_TYPE_INTMAX;
+		hasLength = true;
+		break;
+	case 'z':
+		ptr++;
+		intType = ARG_TYPE_SIZE;
+		hasLength = true;
+		break;
+	case 't':
+		ptr++;
+		intType = ARG_TYPE_PTRDIFF;
+		hasLength = true;
+		break;
+	case 'L':
+		ptr++;
+		isLongDouble = true;
+		hasLength = true;
+		break;
+	case 'I':
+		//MSVC specific length modifiers
+		ptr++;
+		hasLength = true;
+		if((ptr[0] == '6') && (ptr[1] == '4'))
+		{
+			ptr += 2;
+			intType = ARG_TYPE_LONGLONG;
+		}
+		else if((ptr[0] == '3') && (ptr[1] == '2'))
+		{
+			ptr += 2;
+		}
+		else
+		{
+			intType = ARG_TYPE_SIZE;
+		}
+		break;
+	}
+
+	switch(*ptr)
+	{
+	case 'd':
+	case 'i':
+	case 'o':
+	case 'u':
+	case 'x':
+	case 'X':
+		argType = isLongDouble ? ARG_TYPE_UNSUPPORTED : intType;
+		break;
+	case 'c':
+		argType = hasLength ? ARG_TYPE_UNSUPPORTED : ARG_TYPE_INT;
+		break;
+	case 'f':
+	case 'F':
+	case 'e':
+	case 'E':
+	case 'g':
+	case 'G':
+	case 'a':
+	case 'A':
+		argType = isLongDouble ? ARG_TYPE_UNSUPPORTED : ARG_TYPE_DOUBLE;
+		break;
+	case 's':
+		argType = hasLength ? ARG_TYPE_UNSUPPORTED : ARG_TYPE_STRING;
+		break;
+	case 'p':
+		argType = ARG_TYPE_POINTER;
+		break;
+	default:
+		argType = ARG_TYPE_UNSUPPORTED;
+		return ptr;
+	}
+
+	return ptr + 1;
+}
+
+template <typename ValueType>
+static void AppendValue(std::vector<uint8>& buffer, const ValueType& value)
+{
+	auto valuePtr = reinterpret_cast<const uint8*>(&value);
+	buffer.insert(buffer.end(), valuePtr, valuePtr + sizeof(ValueType));
+}
+
+template <typename ValueType>
+static ValueType ReadValue(const uint8*& ptr)
+{
+	ValueType value;
+	memcpy(&value, ptr, sizeof(ValueType));
+	ptr += sizeof(ValueType);
+	return value;
+}
+
+static void AppendString(std::vector<uint8>& buffer, const char* string, size_t maxLength)
+{
+	uint32 length = static_cast<uint32>(strnlen(string, maxLength));
+	AppendValue(buffer, length);
+	buffer.insert(buffer.end(), string, string + length);
+}
+
+//Copies the arguments referenced by the format string in the record. Returns false if
+//the format string uses something we can't defer, in which case nothing is consumed from 'args'.
+static bool EncodeArguments(std::vector<uint8>& buffer, const char* format, va_list args)
+{
+	va_list argsCopy;
+	va_copy(argsCopy, args);
+	bool succeeded = true;
+	const char* specBegin = nullptr;
+	ARG_TYPE argType = ARG_TYPE_NONE;
+	while((format = ParseConversion(format, specBegin, argType)))
+	{
+		switch(argType)
+		{
+		case ARG_TYPE_NONE:
+			break;
+		case ARG_TYPE_INT:
+			AppendValue(buffer, static_cast<uint64>(va_arg(argsCopy, int)));
+			break;
+		case ARG_TYPE_LONG:
+			AppendValue(buffer, static_cast<uint64>(va_arg(argsCopy, long)));
+			break;
+		case ARG_TYPE_LONGLONG:
+			AppendValue(buffer, static_cast<uint64>(va_arg(argsCopy, long long)));
+			break;
+		case ARG_TYPE_INTMAX:
+			AppendValue(buffer, static_cast<uint64>(va_arg(argsCopy, intmax_t)));
+			break;
+		case ARG_TYPE_SIZE:
+			AppendValue(buffer, static_cast<uint64>(va_arg(argsCopy, size_t)));
+			break;
+		case ARG_TYPE_PTRDIFF:
+			AppendValue(buffer, static_cast<uint64>(va_arg(argsCopy, ptrdiff_t)));
+			break;
+		case ARG_TYPE_DOUBLE:
+			AppendValue(buffer, va_arg(argsCopy, double));
+			break;
+		case ARG_TYPE_POINTER:
+			AppendValue(buffer, va_arg(argsCopy, void*));
+			break;
+		case ARG_TYPE_STRING:
+		{
+			//Strings are often temporaries, they need to be copied
+			auto string = va_arg(argsCopy, const char*);
+			AppendString(buffer, string ? string : "(null)", MAX_STRING_ARG_SIZE);
+		}
+		break;
+		default:
+			succeeded = false;
+			break;
+		}
+		if(!succeeded) break;
+	}
+	va_end(argsCopy);
+	return succeeded;
+}
+
+static std::string DecodeArguments(const char* format, const uint8* ptr)
+{
+	std::string result;
+	char spec[64];
+	char value[128];
+	const char* specBegin = nullptr;
+	ARG_TYPE argType = ARG_TYPE_NONE;
+	while(true)
+	{
+		auto specEnd = ParseConversion(format, specBegin, argType);
+		if(!specEnd)
+		{
+			result += format;
+			break;
+		}
+		result.append(format, specBegin);
+		format = specEnd;
+
+		if(argType == ARG_TYPE_NONE)
+		{
+			result += '%';
+			continue;
+		}
+
+		size_t specLength = std::min<size_t>(specEnd - specBegin, sizeof(spec) - 1);
+		memcpy(spec, specBegin, specLength);
+		spec[specLength] = 0;
+
+		int length = 0;
+		switch(argType)
+		{
+		case ARG_TYPE_INT:
+			length = snprintf(value, sizeof(value), spec, static_cast<int>(ReadValue<uint64>(ptr)));
+			break;
+		case ARG_TYPE_LONG:
+			length = snprintf(value, sizeof(value), spec, static_cast<long>(ReadValue<uint64>(ptr)));
+			break;
+		case ARG_TYPE_LONGLONG:
+			length = snprintf(value, sizeof(value), spec, static_cast<long long>(ReadValue<uint64>(ptr)));
+			break;
+		case ARG_TYPE_INTMAX:
+			length = snprintf(value, sizeof(value), spec, static_cast<intmax_t>(ReadValue<uint64>(ptr)));
+			break;
+		case ARG_TYPE_SIZE:
+			length = snprintf(value, sizeof(value), spec, static_cast<size_t>(ReadValue<uint64>(ptr)));
+			break;
+		case ARG_TYPE_PTRDIFF:
+			length = snprintf(value, sizeof(value), spec, static_cast<ptrdiff_t>(ReadValue<uint64>(ptr)));
+			break;
+		case ARG_TYPE_DOUBLE:
+			length = snprintf(value, sizeof(value), spec, ReadValue<double>(ptr));
+			break;
+		case ARG_TYPE_POINTER:
+			length = snprintf(value, sizeof(value), spec, ReadValue<void*>(ptr));
+			break;
+		case ARG_TYPE_STRING:
+		{
+			uint32 stringLength = ReadValue<uint32>(ptr);
+			std::string string(reinterpret_cast<const char*>(ptr), stringLength);
+			ptr += stringLength;
+			int formattedLength = snprintf(nullptr, 0, spec, string.c_str());
+			if(formattedLength > 0)
+			{
+				std::string formatted(formattedLength, 0);
+				snprintf(formatted.data(), formattedLength + 1, spec, string.c_str());
+				result += formatted;
+			}
+		}
+		break;
+		default:
+			assert(false);
+			break;
+		}
+		if(length > 0)
+		{
+			result.append(value, std::min<size_t>(length, sizeof(value) - 1));
+		}
+	}
+	return result;
+}
+
 CLog::CLog()
 {
 	m_logBasePath = CAppConfig::GetInstance().GetBasePath() / LOG_PATH;
 	Framework::PathUtils::EnsurePathExists(m_logBasePath);
 	CAppConfig::GetInstance().RegisterPreferenceBoolean(PREF_LOG_SHOWPRINTS, false);
 	m_showPrints = CAppConfig::GetInstance().GetPreferenceBoolean(PREF_LOG_SHOWPRINTS);
+	m_writerThread = std::thread([this]() { WriterThreadProc(); });
+}
+
+CLog::~CLog()
+{
+	m_writerThreadDone = true;
+	m_writerThread.join();
 }
 
 void CLog::Print(const char* logName, const char* format, ...)
 {
 	if(!m_showPrints && !g_allowedLogs.count(logName)) return;
-	auto& logStream(GetLog(logName));
 	va_list args;
 	va_start(args, format);
-	vfprintf(logStream, format, args);
+	Post(logName, format, args);
 	va_end(args);
-	logStream.Flush();
 }
 
 void CLog::Warn(const char* logName, const char* format, ...)
 {
-	auto& logStream(GetLog(logName));
 	va_list args;
 	va_start(args, format);
-	vfprintf(logStream, format, args);
+	Post(logName, format, args);
 	va_end(args);
-	logStream.Flush();
 }
 
-Framework::CStdStream& CLog::GetLog(const char* logName)
+uint64 CLog::GetDroppedRecordCount() const
+{
+	return m_droppedRecordCount;
+}
+
+void CLog::Post(const char* logName, const char* format, va_list args)
+{
+	thread_local std::vector<uint8> record;
+	record.clear();
+
+	RECORD_HEADER header = {};
+	header.format = format;
+	AppendValue(record, header);
+	AppendString(record, logName, MAX_STRING_ARG_SIZE);
+
+	size_t argsOffset = record.size();
+	if(!EncodeArguments(record, format, args))
+	{
+		record.resize(argsOffset);
+		char message[MAX_STRING_ARG_SIZE];
+		vsnprintf(message, sizeof(message), format, args);
+		AppendString(record, message, sizeof(message));
+		header.flags |= RECORD_FLAG_PREFORMATTED;
+	}
+
+	record.resize((record.size() + 7) & ~7);
+	header.size = static_cast<uint32>(record.size());
+	memcpy(record.data(), &header, sizeof(RECORD_HEADER));
+
+	auto& ring = GetThreadRing();
+	if(header.size > MAX_RECORD_SIZE)
+	{
+		ring.droppedCount++;
+		return;
+	}
+
+	uint64 writePosition = ring.writePosition.load(std::memory_order_relaxed);
+	uint64 readPosition = ring.readPosition.load(std::memory_order_acquire);
+	uint32 offset = writePosition & (RING_SIZE - 1);
+	uint32 contiguousSize = RING_SIZE - offset;
+	uint32 neededSize = (contiguousSize < header.size) ? (contiguousSize + header.size) : header.size;
+	if(((writePosition - readPosition) + neededSize) > RING_SIZE)
+	{
+		ring.droppedCount++;
+		return;
+	}
+
+	if(contiguousSize < header.size)
+	{
+		//Not enough room before the end of the ring, skip to the beginning
+		uint32 padding[2] = {contiguousSize, RECORD_FLAG_PADDING};
+		memcpy(ring.buffer + offset, padding, sizeof(padding));
+		writePosition += contiguousSize;
+		offset = 0;
+	}
+
+	memcpy(ring.buffer + offset, record.data(), header.size);
+	ring.writePosition.store(writePosition + header.size, std::memory_order_release);
+}
+
+CLog::RING& CLog::GetThreadRing()
+{
+	thread_local THREAD_RING_HOLDER holder;
+	if(!holder.ring)
+	{
+		holder.ring = std::make_shared<RING>();
+		std::lock_guard ringsLock(m_ringsMutex);
+		m_rings.push_back(holder.ring);
+	}
+	return *holder.ring;
+}
+
+void CLog::WriterThreadProc()
+{
+	while(true)
+	{
+		bool done = m_writerThreadDone;
+		bool drained = DrainRings();
+		if(done && !drained) break;
+		if(!drained)
+		{
+			std::this_thread::sleep_for(std::chrono::milliseconds(WRITER_IDLE_WAIT_MS));
+		}
+	}
+}
+
+bool CLog::DrainRings()
+{
+	std::vector<RingPtr> rings;
+	{
+		std::lock_guard ringsLock(m_ringsMutex);
+		//Rings of threads that are gone can be released once they are empty
+		auto ringIterator = std::remove_if(m_rings.begin(), m_rings.end(),
+		                                   [](const RingPtr& ring) {
+			                                   return ring->abandoned &&
+			                                          (ring->readPosition == ring->writePosition) &&
+			                                          (ring->droppedCount == 0);
+		                                   });
+		m_rings.erase(ringIterator, m_rings.end());
+		rings = m_rings;
+	}
+
+	bool drained = false;
+	for(const auto& ring : rings)
+	{
+		uint64 readPosition = ring->readPosition.load(std::memory_order_relaxed);
+		uint64 writePosition = ring->writePosition.load(std::memory_order_acquire);
+		while(readPosition != writePosition)
+		{
+			uint32 offset = readPosition & (RING_SIZE - 1);
+			uint32 recordInfo[2];
+			memcpy(recordInfo, ring->buffer + offset, sizeof(recordInfo));
+			uint32 recordSize = recordInfo[0];
+			if(!(recordInfo[1] & RECORD_FLAG_PADDING))
+			{
+				WriteRecord(ring->buffer + offset, recordSize, ring->pendingDroppedCount);
+				ring->pendingDroppedCount = 0;
+				drained = true;
+			}
+			readPosition += recordSize;
+			ring->readPosition.store(readPosition, std::memory_order_release);
+		}
+		//Records are dropped when the ring is full, report them before the next record that goes through
+		if(uint32 droppedCount = ring->droppedCount.exchange(0))
+		{
+			ring->pendingDroppedCount += droppedCount;
+			m_droppedRecordCount += droppedCount;
+		}
+	}
+
+	if(drained)
+	{
+		for(auto& log : m_logs)
+		{
+			log.second.Flush();
+		}
+	}
+
+	return drained;
+}
+
+void CLog::WriteRecord(const uint8* record, uint32 recordSize, uint32 droppedCount)
+{
+	RECORD_HEADER header;
+	memcpy(&header, record, sizeof(RECORD_HEADER));
+	assert(header.size == recordSize);
+
+	auto ptr = record + sizeof(RECORD_HEADER);
+	uint32 logNameLength = ReadValue<uint32>(ptr);
+	std::string_view logName(reinterpret_cast<const char*>(ptr), logNameLength);
+	ptr += logNameLength;
+
+	auto& logStream(GetLog(logName));
+	if(droppedCount != 0)
+	{
+		auto droppedMessage = std::string("*** ") + std::to_string(droppedCount) + " log records dropped ***\r\n";
+		logStream.Write(droppedMessage.data(), droppedMessage.size());
+	}
+
+	if(header.flags & RECORD_FLAG_PREFORMATTED)
+	{
+		uint32 messageLength = ReadValue<uint32>(ptr);
+		logStream.Write(ptr, messageLength);
+	}
+	else
+	{
+		auto message = DecodeArguments(header.format, ptr);
+		logStream.Write(message.data(), message.size());
+	}
+}
+
+Framework::CStdStream& CLog::GetLog(std::string_view logName)
 {
 	auto logIterator(m_logs.find(logName));
 	if(logIterator == std::end(m_logs))
 	{
 		auto logPath = m_logBasePath / (std::string(logName) + ".log");
 		auto logStream = Framework::CreateOutputStdStream(logPath.native());
-		m_logs[logName] = std::move(logStream);
-		logIterator = m_logs.find(logName);
+		logIterator = m_logs.emplace(std::string(logName), std::move(logStream)).first;
 	}
 	return logIterator->second;
 }
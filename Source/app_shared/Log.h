@@ -1,7 +1,15 @@
 #pragma once
 
 #include <string>
+#include <string_view>
 #include <map>
+#include <memory>
+#include <vector>
+#include <mutex>
+#include <thread>
+#include <atomic>
+#include <cstdarg>
+#include "Types.h"
 #include "filesystem_def.h"
 #include "StdStream.h"
 #include "Singleton.h"
@@ -20,19 +28,37 @@ class CLog : public CSingleton<CLog>
 {
 public:
 	CLog();
-	virtual ~CLog() = default;
+	virtual ~CLog();
 
 	void Print(const char*, const char*, ...);
 	void Warn(const char*, const char*, ...);
 
+	uint64 GetDroppedRecordCount() const;
+
 private:
-	typedef std::map<std::string, Framework::CStdStream> LogMapType;
+	//Records are posted to a ring owned by the calling thread and formatted by the writer thread
+	struct RING;
+	struct THREAD_RING_HOLDER;
+	typedef std::shared_ptr<RING> RingPtr;
+	typedef std::map<std::string, Framework::CStdStream, std::less<>> LogMapType;
+
+	void Post(const char*, const char*, va_list);
+	RING& GetThreadRing();
 
-	Framework::CStdStream& GetLog(const char*);
+	void WriterThreadProc();
+	bool DrainRings();
+	void WriteRecord(const uint8*, uint32, uint32);
+	Framework::CStdStream& GetLog(std::string_view);
 
 	fs::path m_logBasePath;
 	LogMapType m_logs;
 	bool m_showPrints = false;
+
+	std::mutex m_ringsMutex;
+	std::vector<RingPtr> m_rings;
+	std::thread m_writerThread;
+	std::atomic<bool> m_writerThreadDone{false};
+	std::atomic<uint64> m_droppedRecordCount{0};
 };
 
 #else
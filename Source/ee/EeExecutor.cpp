@@ -3,7 +3,6 @@
 #include "AlignedAlloc.h"
 #include "EeBasicBlock.h"
 #include "MA_EE.h"
-#include "xxhash.h"
 
 #if defined(__unix__) || defined(__ANDROID__) || defined(__APPLE__)
 #include <sys/mman.h>
@@ -130,7 +129,6 @@ void CEeExecutor::AttachExceptionHandlerToThread()
 void CEeExecutor::Reset()
 {
 	SetMemoryProtected(m_ram, PS2::EE_RAM_SIZE, false);
-	m_cachedBlocks.clear();
 	m_blockFpRoundingModes.clear();
 	m_idleLoopBlocks.clear();
 	CGenericMipsExecutor::Reset();
@@ -155,19 +153,7 @@ BasicBlockPtr CEeExecutor::BlockFactory(CMIPS& context, uint32 start, uint32 end
 		SetMemoryProtected(m_ram + start, blockSize, true);
 	}
 
-	auto blockMemory = reinterpret_cast<uint32*>(alloca(blockSize));
-	for(uint32 address = start; address <= end; address += 4)
-	{
-		uint32 index = (address - start) / 4;
-		uint32 opcode = m_context.m_pMemoryMap->GetInstruction(address);
-		blockMemory[index] = opcode;
-	}
-
-	auto xxHash = XXH3_128bits(blockMemory, blockSize);
-	uint128 hash;
-	memcpy(&hash, &xxHash, sizeof(xxHash));
-	static_assert(sizeof(hash) == sizeof(xxHash));
-	auto blockKey = std::make_pair(hash, blockSize);
+	auto blockKey = GetCachedBlockKey(start, end);
 
 	bool hasBreakpoint = m_context.HasBreakpointInRange(start, end);
 
@@ -194,22 +180,9 @@ BasicBlockPtr CEeExecutor::BlockFactory(CMIPS& context, uint32 start, uint32 end
 	bool isCacheableBlock = !hasBreakpoint && !blockFpRoundingModeOverride.has_value() && !isIdleLoopBlockOverride && !fpUseAccurateAddSub;
 	if(isCacheableBlock)
 	{
-		auto blockIterator = m_cachedBlocks.find(blockKey);
-		if(blockIterator != std::end(m_cachedBlocks))
+		if(auto basicBlock = FindCachedBlock<CEeBasicBlock>(context, blockKey, start, end))
 		{
-			const auto& basicBlock(blockIterator->second);
-			if(basicBlock->GetBeginAddress() == start && basicBlock->GetEndAddress() == end)
-			{
-				uint32 recycleCount = basicBlock->GetRecycleCount();
-				basicBlock->SetRecycleCount(std::min<uint32>(RECYCLE_NOLINK_THRESHOLD, recycleCount + 1));
-				return basicBlock;
-			}
-			else
-			{
-				auto result = std::make_shared<CEeBasicBlock>(context, start, end, m_blockCategory);
-				result->CopyFunctionFrom(basicBlock);
-				return result;
-			}
+			return basicBlock;
 		}
 	}
 
@@ -230,11 +203,19 @@ BasicBlockPtr CEeExecutor::BlockFactory(CMIPS& context, uint32 start, uint32 end
 	result->Compile();
 	if(isCacheableBlock)
 	{
-		m_cachedBlocks.insert(std::make_pair(blockKey, result));
+		m_cachedBlocks.Insert(blockKey, result);
 	}
 	return result;
 }
 
+bool CEeExecutor::CanExtendTrace(uint32 address)
+{
+	//Blocks with per-block overrides must keep their original boundaries
+	return (m_idleLoopBlocks.count(address) == 0) &&
+	       (m_blockFpRoundingModes.count(address) == 0) &&
+	       (m_blockFpUseAccurateAddSub.count(address) == 0);
+}
+
 bool CEeExecutor::HandleAccessFault(intptr_t ptr)
 {
 	ptrdiff_t addr = reinterpret_cast<uint8*>(ptr) - m_ram;
@@ -18,7 +18,7 @@
 class CEeExecutor : public CGenericMipsExecutor<BlockLookupTwoWay>
 {
 public:
-	using CachedBlockKey = std::pair<uint128, uint32>;
+	using CachedBlockKey = CBlockCache::KeyType;
 	using IdleLoopBlockMap = std::map<uint32, std::optional<CachedBlockKey>>;
 	using BlockFpUseAccurateAddSubSet = std::set<uint32>;
 	using BlockFpRoundingModeMap = std::map<uint32, Jitter::CJitter::ROUNDINGMODE>;
@@ -40,10 +40,10 @@ public:
 
 	BasicBlockPtr BlockFactory(CMIPS&, uint32, uint32) override;
 
-private:
-	typedef std::map<CachedBlockKey, BasicBlockPtr> CachedBlockMap;
-	CachedBlockMap m_cachedBlocks;
+protected:
+	bool CanExtendTrace(uint32) override;
 
+private:
 	IdleLoopBlockMap m_idleLoopBlocks;
 	BlockFpUseAccurateAddSubSet m_blockFpUseAccurateAddSub;
 	BlockFpRoundingModeMap m_blockFpRoundingModes;
@@ -133,7 +133,9 @@ CSubSystem::CSubSystem(uint8* iopRam, CIopBios& iopBios)
 
 	//Vector Unit 1 context setup
 	{
-		m_VU1.m_executor = std::make_unique<CVuExecutor>(m_VU1, PS2::MICROMEM1SIZE);
+		auto vu1Executor = std::make_unique<CVuExecutor>(m_VU1, PS2::MICROMEM1SIZE);
+		vu1Executor->SetProgramAnalysisEnabled(true);
+		m_VU1.m_executor = std::move(vu1Executor);
 
 		m_VU1.m_pMemoryMap->InsertReadMap(0x00000000, 0x00003FFF, m_vuMem1, 0x00);
 		m_VU1.m_pMemoryMap->InsertReadMap(0x00008000, 0x00008FFF, std::bind(&CSubSystem::Vu1IoPortReadHandler, this, PLACEHOLDER_1), 0x01);
@@ -161,7 +163,9 @@ CSubSystem::CSubSystem(uint8* iopRam, CIopBios& iopBios)
 	m_ipu.SetDMA3ReceiveHandler(std::bind(&CDMAC::ResumeDMA3, &m_dmac, PLACEHOLDER_1, PLACEHOLDER_2));
 
 	m_os = new CPS2OS(m_EE, m_ram, m_bios, m_spr, m_gs, m_sif, iopBios);
+	m_EE.m_syscallHandler = [this](CMIPS*) { return m_os->HandleSyscallFast(); };
 	m_OnRequestInstructionCacheFlushConnection = m_os->OnRequestInstructionCacheFlush.Connect(std::bind(&CSubSystem::FlushInstructionCache, this));
+	m_OnExecutableChangeConnection = m_os->OnExecutableChange.Connect(std::bind(&CSubSystem::ApplyVuGameConfig, this));
 
 	SetupEePageTable();
 }
@@ -828,6 +832,13 @@ void CSubSystem::FlushInstructionCache()
 	m_EE.m_executor->Reset();
 }
 
+void CSubSystem::ApplyVuGameConfig()
+{
+	bool vuUseAccurateAddSub = m_os->GetVuUseAccurateAddSub();
+	static_cast<CVuExecutor*>(m_VU0.m_executor.get())->SetAccurateAddSubEnabled(vuUseAccurateAddSub);
+	static_cast<CVuExecutor*>(m_VU1.m_executor.get())->SetAccurateAddSubEnabled(vuUseAccurateAddSub);
+}
+
 void CSubSystem::LoadBIOS()
 {
 	auto biosPath = CAppConfig::GetInstance().GetBasePath() / "bios/scph10000.bin";
@@ -106,6 +106,7 @@ namespace Ee
 		void CheckPendingInterrupts();
 
 		void FlushInstructionCache();
+		void ApplyVuGameConfig();
 
 		void LoadBIOS();
 		void FillFakeIopRam();
@@ -121,6 +122,7 @@ namespace Ee
 		CCOP_VU m_COP_VU;
 
 		Framework::CSignal<void()>::Connection m_OnRequestInstructionCacheFlushConnection;
+		Framework::CSignal<void()>::Connection m_OnExecutableChangeConnection;
 		CVpu::VuStateChangedEvent::Connection m_vu0StateChangedConnection;
 		CVpu::VuInterruptTriggeredEvent::Connection m_vu1InterruptTriggeredConnection;
 	};
@@ -3,8 +3,16 @@
 
 #include <limits.h>
 #include <cstdint>
+#include <cstring>
 #include "FpAddTruncate.h"
 #include "BitManip.h"
+#include "SimdDefs.h"
+
+#if defined(FRAMEWORK_SIMD_USE_SSE)
+#include <emmintrin.h>
+#elif defined(FRAMEWORK_SIMD_USE_NEON)
+#include <arm_neon.h>
+#endif
 
 typedef uint32 rep_t;
 typedef int32 srep_t;
@@ -176,3 +184,270 @@ uint32 FpAddTruncate(uint32 a, uint32 b)
 
 	return result;
 }
+
+//Vectorized versions
+//Lanes where one of the operands is zero, infinity or NaN are rare and are handed to the scalar version.
+//Sticky bits are never needed since the result is truncated, which makes all lanes follow the same path.
+
+#if defined(FRAMEWORK_SIMD_USE_SSE)
+
+static inline __m128i SelectBits(__m128i mask, __m128i trueValue, __m128i falseValue)
+{
+	return _mm_or_si128(_mm_and_si128(mask, trueValue), _mm_andnot_si128(mask, falseValue));
+}
+
+//Shifts each lane right by a variable amount (0 to 31)
+static inline __m128i ShiftRightVariable(__m128i value, __m128i shift)
+{
+	__m128i mask;
+#define SHIFT_STEP(amount)                                                                              \
+	mask = _mm_cmpeq_epi32(_mm_and_si128(shift, _mm_set1_epi32(amount)), _mm_set1_epi32(amount)); \
+	value = SelectBits(mask, _mm_srli_epi32(value, amount), value);
+	SHIFT_STEP(1)
+	SHIFT_STEP(2)
+	SHIFT_STEP(4)
+	SHIFT_STEP(8)
+	SHIFT_STEP(16)
+#undef SHIFT_STEP
+	return value;
+}
+
+static __m128i AddTruncate4(__m128i a, __m128i b, __m128i& specialMask)
+{
+	const __m128i absMaskVec = _mm_set1_epi32(absMask);
+	const __m128i significandMaskVec = _mm_set1_epi32(significandMask);
+	const __m128i exponentMaskVec = _mm_set1_epi32(maxExponent);
+	const __m128i implicitBitVec = _mm_set1_epi32(implicitBit);
+	const __m128i zero = _mm_setzero_si128();
+
+	__m128i aAbs = _mm_and_si128(a, absMaskVec);
+	__m128i bAbs = _mm_and_si128(b, absMaskVec);
+
+	//Absolute values are positive, signed comparisons can be used
+	const __m128i maxFiniteVec = _mm_set1_epi32(infRep - 1);
+	specialMask = _mm_or_si128(
+	    _mm_or_si128(_mm_cmpeq_epi32(aAbs, zero), _mm_cmpgt_epi32(aAbs, maxFiniteVec)),
+	    _mm_or_si128(_mm_cmpeq_epi32(bAbs, zero), _mm_cmpgt_epi32(bAbs, maxFiniteVec)));
+
+	//Make sure x has the larger absolute value
+	__m128i swap = _mm_cmpgt_epi32(bAbs, aAbs);
+	__m128i x = SelectBits(swap, b, a);
+	__m128i y = SelectBits(swap, a, b);
+
+	__m128i xExponent = _mm_and_si128(_mm_srli_epi32(x, significandBits), exponentMaskVec);
+	__m128i yExponent = _mm_and_si128(_mm_srli_epi32(y, significandBits), exponentMaskVec);
+	__m128i xSignificand = _mm_slli_epi32(_mm_or_si128(_mm_and_si128(x, significandMaskVec), implicitBitVec), 3);
+	__m128i ySignificand = _mm_slli_epi32(_mm_or_si128(_mm_and_si128(y, significandMaskVec), implicitBitVec), 3);
+
+	__m128i resultSign = _mm_and_si128(x, _mm_set1_epi32(signBit));
+	__m128i subtraction = _mm_srai_epi32(_mm_xor_si128(x, y), 31);
+
+	//Align y, shifting by 31 or more clears the significand
+	{
+		__m128i align = _mm_sub_epi32(xExponent, yExponent);
+		__m128i alignOver = _mm_cmpgt_epi32(align, _mm_set1_epi32(31));
+		__m128i alignZero = _mm_cmpeq_epi32(align, zero);
+		align = SelectBits(alignOver, _mm_set1_epi32(31), align);
+		ySignificand = ShiftRightVariable(ySignificand, align);
+		ySignificand = _mm_andnot_si128(_mm_andnot_si128(alignZero, _mm_set1_epi32(0x03)), ySignificand);
+	}
+
+	//Addition, handle carry
+	__m128i sumSignificand = _mm_add_epi32(xSignificand, ySignificand);
+	__m128i sumExponent = xExponent;
+	{
+		__m128i carryBit = _mm_set1_epi32(implicitBit << 4);
+		__m128i carry = _mm_cmpeq_epi32(_mm_and_si128(sumSignificand, carryBit), carryBit);
+		sumSignificand = SelectBits(carry, _mm_srli_epi32(sumSignificand, 1), sumSignificand);
+		sumExponent = _mm_sub_epi32(sumExponent, carry);
+	}
+
+	//Subtraction, normalize after cancellation
+	__m128i diffSignificand = _mm_sub_epi32(xSignificand, ySignificand);
+	__m128i diffExponent = xExponent;
+	__m128i diffZero = _mm_cmpeq_epi32(diffSignificand, zero);
+	{
+		__m128i mask;
+#define NORMALIZE_STEP(amount)                                                                         \
+	mask = _mm_cmplt_epi32(diffSignificand, _mm_set1_epi32(1 << (significandBits + 4 - amount)));    \
+	diffSignificand = SelectBits(mask, _mm_slli_epi32(diffSignificand, amount), diffSignificand); \
+	diffExponent = _mm_sub_epi32(diffExponent, _mm_and_si128(mask, _mm_set1_epi32(amount)));
+		NORMALIZE_STEP(16)
+		NORMALIZE_STEP(8)
+		NORMALIZE_STEP(4)
+		NORMALIZE_STEP(2)
+		NORMALIZE_STEP(1)
+#undef NORMALIZE_STEP
+	}
+
+	__m128i significand = SelectBits(subtraction, diffSignificand, sumSignificand);
+	__m128i exponent = SelectBits(subtraction, diffExponent, sumExponent);
+
+	__m128i overflow = _mm_cmpgt_epi32(exponent, _mm_set1_epi32(maxExponent - 1));
+
+	//Denormal result
+	{
+		__m128i denormal = _mm_cmplt_epi32(exponent, _mm_set1_epi32(1));
+		__m128i shift = _mm_sub_epi32(_mm_set1_epi32(1), exponent);
+		shift = SelectBits(_mm_cmpgt_epi32(shift, _mm_set1_epi32(31)), _mm_set1_epi32(31), shift);
+		shift = _mm_and_si128(denormal, shift);
+		significand = ShiftRightVariable(significand, shift);
+		exponent = _mm_andnot_si128(denormal, exponent);
+	}
+
+	__m128i result = _mm_and_si128(_mm_srli_epi32(significand, 3), significandMaskVec);
+	result = _mm_or_si128(result, _mm_slli_epi32(exponent, significandBits));
+	result = _mm_or_si128(result, resultSign);
+	result = SelectBits(overflow, _mm_or_si128(_mm_set1_epi32(infRep), resultSign), result);
+	result = _mm_andnot_si128(_mm_and_si128(subtraction, diffZero), result);
+
+	return result;
+}
+
+static void FpAddTruncate4Impl(uint32* result, const uint32* a, const uint32* b, uint32 bSignFlip)
+{
+	__m128i aVec = _mm_loadu_si128(reinterpret_cast<const __m128i*>(a));
+	__m128i bVec = _mm_xor_si128(_mm_loadu_si128(reinterpret_cast<const __m128i*>(b)), _mm_set1_epi32(bSignFlip));
+	__m128i specialMask;
+	__m128i resultVec = AddTruncate4(aVec, bVec, specialMask);
+	int specialLanes = _mm_movemask_ps(_mm_castsi128_ps(specialMask));
+	if(specialLanes == 0)
+	{
+		_mm_storeu_si128(reinterpret_cast<__m128i*>(result), resultVec);
+		return;
+	}
+	alignas(16) uint32 values[4];
+	_mm_store_si128(reinterpret_cast<__m128i*>(values), resultVec);
+	for(unsigned int i = 0; i < 4; i++)
+	{
+		if(specialLanes & (1 << i))
+		{
+			values[i] = FpAddTruncate(a[i], b[i] ^ bSignFlip);
+		}
+	}
+	memcpy(result, values, sizeof(values));
+}
+
+#elif defined(FRAMEWORK_SIMD_USE_NEON)
+
+static uint32x4_t AddTruncate4(uint32x4_t a, uint32x4_t b, uint32x4_t& specialMask)
+{
+	const uint32x4_t significandMaskVec = vdupq_n_u32(significandMask);
+	const uint32x4_t implicitBitVec = vdupq_n_u32(implicitBit);
+
+	uint32x4_t aAbs = vandq_u32(a, vdupq_n_u32(absMask));
+	uint32x4_t bAbs = vandq_u32(b, vdupq_n_u32(absMask));
+
+	//Detect zero, infinity or NaN with the same unsigned wrap around trick as the scalar version
+	const uint32x4_t one = vdupq_n_u32(1);
+	const uint32x4_t maxFiniteVec = vdupq_n_u32(infRep - 1);
+	specialMask = vorrq_u32(vcgeq_u32(vsubq_u32(aAbs, one), maxFiniteVec), vcgeq_u32(vsubq_u32(bAbs, one), maxFiniteVec));
+
+	//Make sure x has the larger absolute value
+	uint32x4_t swap = vcgtq_u32(bAbs, aAbs);
+	uint32x4_t x = vbslq_u32(swap, b, a);
+	uint32x4_t y = vbslq_u32(swap, a, b);
+
+	int32x4_t xExponent = vreinterpretq_s32_u32(vandq_u32(vshrq_n_u32(x, significandBits), vdupq_n_u32(maxExponent)));
+	int32x4_t yExponent = vreinterpretq_s32_u32(vandq_u32(vshrq_n_u32(y, significandBits), vdupq_n_u32(maxExponent)));
+	uint32x4_t xSignificand = vshlq_n_u32(vorrq_u32(vandq_u32(x, significandMaskVec), implicitBitVec), 3);
+	uint32x4_t ySignificand = vshlq_n_u32(vorrq_u32(vandq_u32(y, significandMaskVec), implicitBitVec), 3);
+
+	uint32x4_t resultSign = vandq_u32(x, vdupq_n_u32(signBit));
+	uint32x4_t subtraction = vreinterpretq_u32_s32(vshrq_n_s32(vreinterpretq_s32_u32(veorq_u32(x, y)), 31));
+
+	//Align y, shifting by 32 or more clears the significand
+	{
+		int32x4_t align = vsubq_s32(xExponent, yExponent);
+		uint32x4_t alignNonZero = vmvnq_u32(vceqq_s32(align, vdupq_n_s32(0)));
+		align = vminq_s32(align, vdupq_n_s32(32));
+		ySignificand = vshlq_u32(ySignificand, vnegq_s32(align));
+		ySignificand = vbicq_u32(ySignificand, vandq_u32(alignNonZero, vdupq_n_u32(0x03)));
+	}
+
+	//Addition, handle carry
+	uint32x4_t sumSignificand = vaddq_u32(xSignificand, ySignificand);
+	int32x4_t sumExponent = xExponent;
+	{
+		uint32x4_t carry = vtstq_u32(sumSignificand, vdupq_n_u32(implicitBit << 4));
+		sumSignificand = vbslq_u32(carry, vshrq_n_u32(sumSignificand, 1), sumSignificand);
+		sumExponent = vsubq_s32(sumExponent, vreinterpretq_s32_u32(carry));
+	}
+
+	//Subtraction, normalize after cancellation
+	uint32x4_t diffSignificand = vsubq_u32(xSignificand, ySignificand);
+	int32x4_t diffExponent = xExponent;
+	uint32x4_t diffZero = vceqq_u32(diffSignificand, vdupq_n_u32(0));
+	{
+		int32x4_t shift = vsubq_s32(vreinterpretq_s32_u32(vclzq_u32(diffSignificand)), vdupq_n_s32(rep_clz(implicitBit << 3)));
+		shift = vmaxq_s32(shift, vdupq_n_s32(0));
+		diffSignificand = vshlq_u32(diffSignificand, shift);
+		diffExponent = vsubq_s32(diffExponent, shift);
+	}
+
+	uint32x4_t significand = vbslq_u32(subtraction, diffSignificand, sumSignificand);
+	int32x4_t exponent = vbslq_s32(subtraction, diffExponent, sumExponent);
+
+	uint32x4_t overflow = vcgtq_s32(exponent, vdupq_n_s32(maxExponent - 1));
+
+	//Denormal result
+	{
+		uint32x4_t denormal = vcltq_s32(exponent, vdupq_n_s32(1));
+		int32x4_t shift = vminq_s32(vsubq_s32(vdupq_n_s32(1), exponent), vdupq_n_s32(32));
+		shift = vandq_s32(vreinterpretq_s32_u32(denormal), shift);
+		significand = vshlq_u32(significand, vnegq_s32(shift));
+		exponent = vbicq_s32(exponent, vreinterpretq_s32_u32(denormal));
+	}
+
+	uint32x4_t result = vandq_u32(vshrq_n_u32(significand, 3), significandMaskVec);
+	result = vorrq_u32(result, vshlq_n_u32(vreinterpretq_u32_s32(exponent), significandBits));
+	result = vorrq_u32(result, resultSign);
+	result = vbslq_u32(overflow, vorrq_u32(vdupq_n_u32(infRep), resultSign), result);
+	result = vbicq_u32(result, vandq_u32(subtraction, diffZero));
+
+	return result;
+}
+
+static void FpAddTruncate4Impl(uint32* result, const uint32* a, const uint32* b, uint32 bSignFlip)
+{
+	uint32x4_t aVec = vld1q_u32(a);
+	uint32x4_t bVec = veorq_u32(vld1q_u32(b), vdupq_n_u32(bSignFlip));
+	uint32x4_t specialMask;
+	uint32x4_t resultVec = AddTruncate4(aVec, bVec, specialMask);
+	uint32 specialLanes[4];
+	vst1q_u32(specialLanes, specialMask);
+	uint32 values[4];
+	vst1q_u32(values, resultVec);
+	for(unsigned int i = 0; i < 4; i++)
+	{
+		if(specialLanes[i])
+		{
+			values[i] = FpAddTruncate(a[i], b[i] ^ bSignFlip);
+		}
+	}
+	memcpy(result, values, sizeof(values));
+}
+
+#else
+
+static void FpAddTruncate4Impl(uint32* result, const uint32* a, const uint32* b, uint32 bSignFlip)
+{
+	uint32 values[4];
+	for(unsigned int i = 0; i < 4; i++)
+	{
+		values[i] = FpAddTruncate(a[i], b[i] ^ bSignFlip);
+	}
+	memcpy(result, values, sizeof(values));
+}
+
+#endif
+
+void FpAddTruncate4(uint32* result, const uint32* a, const uint32* b)
+{
+	FpAddTruncate4Impl(result, a, b, 0);
+}
+
+void FpSubTruncate4(uint32* result, const uint32* a, const uint32* b)
+{
+	FpAddTruncate4Impl(result, a, b, signBit);
+}
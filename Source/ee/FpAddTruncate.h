@@ -3,3 +3,8 @@
 #include "Types.h"
 
 uint32 FpAddTruncate(uint32, uint32);
+
+//Four lane versions of FpAddTruncate, results are bit-exact with the scalar version.
+//result can alias a or b.
+void FpAddTruncate4(uint32* result, const uint32* a, const uint32* b);
+void FpSubTruncate4(uint32* result, const uint32* a, const uint32* b);
@@ -50,6 +50,8 @@ void CGIF::Reset()
 	m_regs = 0;
 	m_regsTemp = 0;
 	m_regList = 0;
+	memset(m_regDescs, 0, sizeof(m_regDescs));
+	m_packedVertexHandler = nullptr;
 	m_eop = false;
 	m_qtemp = QTEMP_INIT;
 	m_signalState = SIGNAL_STATE_NONE;
@@ -77,6 +79,8 @@ void CGIF::LoadState(Framework::CZipArchiveReader& archive)
 		m_fifoIndex = registerFile.GetRegister32(STATE_REGS_FIFO_INDEX);
 	}
 
+	PrepareRegisterDescriptors();
+
 	archive.BeginReadFile(STATE_FIFO_BUFFER)->Read(m_fifoBuffer, FIFO_SIZE);
 }
 
@@ -102,16 +106,154 @@ void CGIF::SaveState(Framework::CZipArchiveWriter& archive)
 	archive.InsertFile(std::make_unique<CMemoryStateFile>(STATE_FIFO_BUFFER, m_fifoBuffer, FIFO_SIZE));
 }
 
+static inline CGSHandler::RegisterWrite DecodePackedRgba(const uint128& packet, uint32 qtemp)
+{
+	uint64 temp = (packet.nV[0] & 0xFF);
+	temp |= (packet.nV[1] & 0xFF) << 8;
+	temp |= (packet.nV[2] & 0xFF) << 16;
+	temp |= (packet.nV[3] & 0xFF) << 24;
+	temp |= (static_cast<uint64>(qtemp) << 32);
+	return CGSHandler::RegisterWrite(GS_REG_RGBAQ, temp);
+}
+
+static inline CGSHandler::RegisterWrite DecodePackedUv(const uint128& packet)
+{
+	uint64 temp = (packet.nV[0] & 0x7FFF);
+	temp |= (packet.nV[1] & 0x7FFF) << 16;
+	return CGSHandler::RegisterWrite(GS_REG_UV, temp);
+}
+
+static inline CGSHandler::RegisterWrite DecodePackedXyzf2(const uint128& packet)
+{
+	uint64 temp = (packet.nV[0] & 0xFFFF);
+	temp |= (packet.nV[1] & 0xFFFF) << 16;
+	temp |= static_cast<uint64>(packet.nV[2] & 0x0FFFFFF0) << 28;
+	temp |= static_cast<uint64>(packet.nV[3] & 0x00000FF0) << 52;
+	uint8 reg = (packet.nV[3] & 0x8000) ? GS_REG_XYZF3 : GS_REG_XYZF2;
+	return CGSHandler::RegisterWrite(reg, temp);
+}
+
+static inline CGSHandler::RegisterWrite DecodePackedXyz2(const uint128& packet)
+{
+	uint64 temp = (packet.nV[0] & 0xFFFF);
+	temp |= (packet.nV[1] & 0xFFFF) << 16;
+	temp |= static_cast<uint64>(packet.nV[2]) << 32;
+	uint8 reg = (packet.nV[3] & 0x8000) ? GS_REG_XYZ3 : GS_REG_XYZ2;
+	return CGSHandler::RegisterWrite(reg, temp);
+}
+
+void CGIF::PrepareRegisterDescriptors()
+{
+	assert(m_regs <= MAX_REGDESC_COUNT);
+	for(uint32 i = 0; i < m_regs; i++)
+	{
+		m_regDescs[i] = static_cast<uint8>((m_regList >> (i * 4)) & 0x0F);
+	}
+
+	//Check if register descriptors match a common vertex layout we can process in bulk
+	m_packedVertexHandler = nullptr;
+	if(m_cmd != 0) return;
+	if(m_regs == 3)
+	{
+		uint32 layout = m_regDescs[0] | (m_regDescs[1] << 4) | (m_regDescs[2] << 8);
+		switch(layout)
+		{
+		case (PACKED_REGDESC_STQ | (PACKED_REGDESC_RGBA << 4) | (PACKED_REGDESC_XYZ2 << 8)):
+			m_packedVertexHandler = &CGIF::ProcessPackedVertices<PACKED_REGDESC_STQ, PACKED_REGDESC_XYZ2>;
+			break;
+		case (PACKED_REGDESC_STQ | (PACKED_REGDESC_RGBA << 4) | (PACKED_REGDESC_XYZF2 << 8)):
+			m_packedVertexHandler = &CGIF::ProcessPackedVertices<PACKED_REGDESC_STQ, PACKED_REGDESC_XYZF2>;
+			break;
+		case (PACKED_REGDESC_UV | (PACKED_REGDESC_RGBA << 4) | (PACKED_REGDESC_XYZ2 << 8)):
+			m_packedVertexHandler = &CGIF::ProcessPackedVertices<PACKED_REGDESC_UV, PACKED_REGDESC_XYZ2>;
+			break;
+		case (PACKED_REGDESC_UV | (PACKED_REGDESC_RGBA << 4) | (PACKED_REGDESC_XYZF2 << 8)):
+			m_packedVertexHandler = &CGIF::ProcessPackedVertices<PACKED_REGDESC_UV, PACKED_REGDESC_XYZF2>;
+			break;
+		}
+	}
+	else if(m_regs == 2)
+	{
+		uint32 layout = m_regDescs[0] | (m_regDescs[1] << 4);
+		switch(layout)
+		{
+		case (PACKED_REGDESC_RGBA | (PACKED_REGDESC_XYZ2 << 4)):
+			m_packedVertexHandler = &CGIF::ProcessPackedVertices<PACKED_REGDESC_NOP, PACKED_REGDESC_XYZ2>;
+			break;
+		case (PACKED_REGDESC_RGBA | (PACKED_REGDESC_XYZF2 << 4)):
+			m_packedVertexHandler = &CGIF::ProcessPackedVertices<PACKED_REGDESC_NOP, PACKED_REGDESC_XYZF2>;
+			break;
+		}
+	}
+}
+
 uint32 CGIF::ProcessPacked(const uint8* memory, uint32 address, uint32 end)
 {
 	uint32 start = address;
 
+	if(m_packedVertexHandler && (m_regsTemp == m_regs))
+	{
+		address += (this->*m_packedVertexHandler)(memory, address, end);
+	}
+
+	address += ProcessPackedGeneric(memory, address, end);
+
+	return address - start;
+}
+
+//Processes as many complete loops as possible for "[STQ|UV] RGBA XYZ(F)2" register layouts.
+//Register writes are emitted directly in the GS write buffer.
+template <uint32 texRegDesc, uint32 xyzRegDesc>
+uint32 CGIF::ProcessPackedVertices(const uint8* memory, uint32 address, uint32 end)
+{
+	static const uint32 regCount = (texRegDesc == PACKED_REGDESC_NOP) ? 2 : 3;
+	static const uint32 loopSize = regCount * 0x10;
+
+	uint32 loopCount = std::min<uint32>(m_loops, (end - address) / loopSize);
+	if(loopCount == 0) return 0;
+
+	auto writes = m_gs->ReserveRegisterWrites(loopCount * regCount);
+	if(!writes) return 0;
+
+	auto packets = reinterpret_cast<const uint128*>(memory + address);
+	for(uint32 loop = 0; loop < loopCount; loop++)
+	{
+		if(texRegDesc == PACKED_REGDESC_STQ)
+		{
+			m_qtemp = packets[0].nV2;
+			writes[0] = CGSHandler::RegisterWrite(GS_REG_ST, packets[0].nD0);
+		}
+		else if(texRegDesc == PACKED_REGDESC_UV)
+		{
+			writes[0] = DecodePackedUv(packets[0]);
+		}
+		writes[regCount - 2] = DecodePackedRgba(packets[regCount - 2], m_qtemp);
+		if(xyzRegDesc == PACKED_REGDESC_XYZ2)
+		{
+			writes[regCount - 1] = DecodePackedXyz2(packets[regCount - 1]);
+		}
+		else
+		{
+			writes[regCount - 1] = DecodePackedXyzf2(packets[regCount - 1]);
+		}
+		packets += regCount;
+		writes += regCount;
+	}
+
+	m_loops -= loopCount;
+
+	return loopCount * loopSize;
+}
+
+uint32 CGIF::ProcessPackedGeneric(const uint8* memory, uint32 address, uint32 end)
+{
+	uint32 start = address;
+
 	while((m_loops != 0) && (address < end))
 	{
 		while((m_regsTemp != 0) && (address < end))
 		{
-			uint64 temp = 0;
-			uint32 regDesc = (uint32)((m_regList >> ((m_regs - m_regsTemp) * 4)) & 0x0F);
+			uint32 regDesc = m_regDescs[m_regs - m_regsTemp];
 
 			uint128 packet = *reinterpret_cast<const uint128*>(memory + address);
 
@@ -123,12 +265,7 @@ uint32 CGIF::ProcessPacked(const uint8* memory, uint32 address, uint32 end)
 				break;
 			case 0x01:
 				//RGBA
-				temp = (packet.nV[0] & 0xFF);
-				temp |= (packet.nV[1] & 0xFF) << 8;
-				temp |= (packet.nV[2] & 0xFF) << 16;
-				temp |= (packet.nV[3] & 0xFF) << 24;
-				temp |= ((uint64)m_qtemp << 32);
-				m_gs->WriteRegister(CGSHandler::RegisterWrite(GS_REG_RGBAQ, temp));
+				m_gs->WriteRegister(DecodePackedRgba(packet, m_qtemp));
 				break;
 			case 0x02:
 				//ST
@@ -137,38 +274,15 @@ uint32 CGIF::ProcessPacked(const uint8* memory, uint32 address, uint32 end)
 				break;
 			case 0x03:
 				//UV
-				temp = (packet.nV[0] & 0x7FFF);
-				temp |= (packet.nV[1] & 0x7FFF) << 16;
-				m_gs->WriteRegister(CGSHandler::RegisterWrite(GS_REG_UV, temp));
+				m_gs->WriteRegister(DecodePackedUv(packet));
 				break;
 			case 0x04:
 				//XYZF2
-				temp = (packet.nV[0] & 0xFFFF);
-				temp |= (packet.nV[1] & 0xFFFF) << 16;
-				temp |= (uint64)(packet.nV[2] & 0x0FFFFFF0) << 28;
-				temp |= (uint64)(packet.nV[3] & 0x00000FF0) << 52;
-				if(packet.nV[3] & 0x8000)
-				{
-					m_gs->WriteRegister(CGSHandler::RegisterWrite(GS_REG_XYZF3, temp));
-				}
-				else
-				{
-					m_gs->WriteRegister(CGSHandler::RegisterWrite(GS_REG_XYZF2, temp));
-				}
+				m_gs->WriteRegister(DecodePackedXyzf2(packet));
 				break;
 			case 0x05:
 				//XYZ2
-				temp = (packet.nV[0] & 0xFFFF);
-				temp |= (packet.nV[1] & 0xFFFF) << 16;
-				temp |= (uint64)(packet.nV[2] & 0xFFFFFFFF) << 32;
-				if(packet.nV[3] & 0x8000)
-				{
-					m_gs->WriteRegister(CGSHandler::RegisterWrite(GS_REG_XYZ3, temp));
-				}
-				else
-				{
-					m_gs->WriteRegister(CGSHandler::RegisterWrite(GS_REG_XYZ2, temp));
-				}
+				m_gs->WriteRegister(DecodePackedXyz2(packet));
 				break;
 			case 0x06:
 				//TEX0_1
@@ -243,7 +357,7 @@ uint32 CGIF::ProcessRegList(const uint8* memory, uint32 address, uint32 end)
 	{
 		while((m_regsTemp != 0) && (address < end))
 		{
-			uint32 regDesc = (uint32)((m_regList >> ((m_regs - m_regsTemp) * 4)) & 0x0F);
+			uint32 regDesc = m_regDescs[m_regs - m_regsTemp];
 			uint64 packet = *reinterpret_cast<const uint64*>(memory + address);
 
 			address += 0x08;
@@ -345,6 +459,7 @@ uint32 CGIF::ProcessSinglePacket(const uint8* memory, uint32 memorySize, uint32
 			if(m_regs == 0) m_regs = 0x10;
 			m_regsTemp = m_regs;
 			m_activePath = packetMetadata.pathIndex;
+			PrepareRegisterDescriptors();
 			continue;
 		}
 		switch(m_cmd)
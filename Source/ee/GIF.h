@@ -90,7 +90,31 @@ private:
 		MASKED_PATH3_XFER_DONE,
 	};
 
+	enum PACKED_REGDESC
+	{
+		PACKED_REGDESC_PRIM = 0x00,
+		PACKED_REGDESC_RGBA = 0x01,
+		PACKED_REGDESC_STQ = 0x02,
+		PACKED_REGDESC_UV = 0x03,
+		PACKED_REGDESC_XYZF2 = 0x04,
+		PACKED_REGDESC_XYZ2 = 0x05,
+		PACKED_REGDESC_AD = 0x0E,
+		PACKED_REGDESC_NOP = 0x0F,
+	};
+
+	enum
+	{
+		MAX_REGDESC_COUNT = 0x10,
+	};
+
+	typedef uint32 (CGIF::*PackedVertexHandler)(const uint8*, uint32, uint32);
+
+	void PrepareRegisterDescriptors();
+
 	uint32 ProcessPacked(const uint8*, uint32, uint32);
+	uint32 ProcessPackedGeneric(const uint8*, uint32, uint32);
+	template <uint32, uint32>
+	uint32 ProcessPackedVertices(const uint8*, uint32, uint32);
 	uint32 ProcessRegList(const uint8*, uint32, uint32);
 	uint32 ProcessImage(const uint8*, uint32, uint32, uint32);
 
@@ -109,6 +133,8 @@ private:
 	uint8 m_regs = 0;
 	uint8 m_regsTemp = 0;
 	uint64 m_regList = 0;
+	uint8 m_regDescs[MAX_REGDESC_COUNT] = {};
+	PackedVertexHandler m_packedVertexHandler = nullptr;
 	bool m_eop = false;
 	uint32 m_qtemp;
 	SIGNAL_STATE m_signalState = SIGNAL_STATE_NONE;
@@ -107,6 +107,15 @@ void CMA_EE::LQ()
 {
 	if(m_nRT == 0) return;
 
+	if(IsMemAccessPageMapped())
+	{
+		ComputeMemAccessRefIdx(0x10);
+
+		m_codeGen->MD_LoadFromRefIdx(1);
+		m_codeGen->MD_PullRel(offsetof(CMIPS, m_State.nGPR[m_nRT]));
+		return;
+	}
+
 	ComputeMemAccessPageRef();
 
 	m_codeGen->PushCst(0);
@@ -153,6 +162,15 @@ void CMA_EE::LQ()
 //1F
 void CMA_EE::SQ()
 {
+	if(IsMemAccessPageMapped())
+	{
+		ComputeMemAccessRefIdx(0x10);
+
+		m_codeGen->MD_PushRel(offsetof(CMIPS, m_State.nGPR[m_nRT]));
+		m_codeGen->MD_StoreAtRefIdx(1);
+		return;
+	}
+
 	ComputeMemAccessPageRef();
 
 	m_codeGen->PushCst(0);
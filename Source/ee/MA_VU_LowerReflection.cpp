@@ -282,13 +282,13 @@ void CMA_VU::CLower::ReflOpAffWrItBv(VUINSTRUCTION*, CMIPS*, uint32, uint32 opco
 	operandSet.branchValue = true;
 }
 
-void CMA_VU::CLower::ReflOpAffWrItBvRdFmac(VUINSTRUCTION*, CMIPS*, uint32, uint32 opcode, OPERANDSET& operandSet)
+void CMA_VU::CLower::ReflOpAffWrItBvRdFsf(VUINSTRUCTION*, CMIPS*, uint32, uint32 opcode, OPERANDSET& operandSet)
 {
 	auto it = static_cast<uint8>((opcode >> 16) & 0x001F);
 
 	operandSet.writeI = it;
 	operandSet.branchValue = true;
-	operandSet.readMACflags = true;
+	operandSet.readStatusFlags = true;
 }
 
 void CMA_VU::CLower::ReflOpAffWrItRdFsf(VUINSTRUCTION*, CMIPS*, uint32, uint32 opcode, OPERANDSET& operandSet)
@@ -825,8 +825,8 @@ VUINSTRUCTION CMA_VU::CLower::m_cVuReflGeneral[128] =
 	{	"FCOR",		NULL,			ReflOpAffWrVi1Bv	},
 	{	NULL,		NULL,			NULL				},
 	{	"FSSET",	NULL,			ReflOpAffNone		},
-	{	"FSAND",	NULL,			ReflOpAffWrItBvRdFmac		},
-	{	"FSOR",		NULL,			ReflOpAffWrItBvRdFmac		},
+	{	"FSAND",	NULL,			ReflOpAffWrItBvRdFsf		},
+	{	"FSOR",		NULL,			ReflOpAffWrItBvRdFsf		},
 	//0x18
 	{	"FMEQ",		NULL,			ReflOpAffWrItBvRdFmacIs	},
 	{	NULL,		NULL,			NULL				},
@@ -373,6 +373,11 @@ const char* CPS2OS::GetExecutableName() const
 	return m_executableName.c_str();
 }
 
+bool CPS2OS::GetVuUseAccurateAddSub() const
+{
+	return m_vuUseAccurateAddSub;
+}
+
 std::pair<uint32, uint32> CPS2OS::GetExecutableRange() const
 {
 	uint32 minAddr = 0xFFFFFFF0;
@@ -571,6 +576,8 @@ uint32 CPS2OS::LoadExecutable(const char* path, const char* section)
 
 void CPS2OS::ApplyGameConfig()
 {
+	m_vuUseAccurateAddSub = false;
+
 	std::unique_ptr<Framework::Xml::CNode> document;
 	try
 	{
@@ -714,6 +721,8 @@ void CPS2OS::ApplyGameConfig()
 			idleLoopBlocks.insert(std::make_pair(address, checkBlockKey));
 		}
 
+		m_vuUseAccurateAddSub = (gameConfigNode->Select("VuUseAccurateAddSub") != nullptr);
+
 		auto executor = static_cast<CEeExecutor*>(m_ee.m_executor.get());
 		executor->SetBlockFpRoundingModes(std::move(blockFpRoundingModes));
 		executor->SetBlockFpUseAccurateAddSub(std::move(blockFpUseAccurateAddSub));
@@ -3386,6 +3395,85 @@ void CPS2OS::HandleSyscall()
 	m_ee.m_State.nHasException = MIPS_EXCEPTION_NONE;
 }
 
+//Called from jitted code on a SYSCALL instruction. Handles system calls that don't need to
+//leave the block unless they switch threads. Returns false if HandleSyscall needs to be used.
+bool CPS2OS::HandleSyscallFast()
+{
+	//SYSCALL in a delay slot, let the exception handler deal with it after the branch
+	if(m_ee.m_State.nDelayedJumpAddr != MIPS_INVALID_PC)
+	{
+		return false;
+	}
+
+	uint32 func = m_ee.m_State.nGPR[CMIPS::V1].nV[0];
+	if(func & 0x80000000)
+	{
+		func = 0 - func;
+	}
+	if(!IsFastSysCall(func)) return false;
+	if(GetCustomSyscallTable()[func] != 0) return false;
+
+	//Save for custom handler
+	m_ee.m_State.nGPR[3].nV[0] = func;
+
+#ifdef _DEBUG
+	DisassembleSysCall(static_cast<uint8>(func & 0xFF));
+#endif
+
+	//Handlers expect PC to be after the SYSCALL instruction, as it would be when going through HandleSyscall
+	uint32 blockAddress = m_ee.m_State.nPC;
+	uint32 returnAddress = m_ee.m_State.nCOP0[CCOP_SCU::EPC] + 4;
+	uint32 currentThreadId = m_currentThreadId;
+	m_ee.m_State.nPC = returnAddress;
+
+	((this)->*(m_sysCall[func]))();
+
+	if((m_ee.m_State.nPC == returnAddress) && (m_currentThreadId == currentThreadId))
+	{
+		//Block epilog will move PC past the SYSCALL and link to the next block
+		m_ee.m_State.nPC = blockAddress;
+	}
+	else
+	{
+		//Thread switch happened, have the block epilog jump to the new thread
+		m_ee.m_State.nDelayedJumpAddr = m_ee.m_State.nPC;
+		m_ee.m_State.nPC = blockAddress;
+	}
+
+	return true;
+}
+
+bool CPS2OS::IsFastSysCall(uint32 func)
+{
+	//System calls that only touch OS state and registers. Some of them might
+	//reschedule, this is detected after the call.
+	switch(func)
+	{
+	case 0x2F: //GetThreadId
+	case 0x30: //ReferThreadStatus
+	case 0x31: //iReferThreadStatus
+	case 0x33: //WakeupThread
+	case 0x34: //iWakeupThread
+	case 0x35: //CancelWakeupThread
+	case 0x36: //iCancelWakeupThread
+	case 0x42: //SignalSema
+	case 0x43: //iSignalSema
+	case 0x45: //PollSema
+	case 0x46: //iPollSema
+	case 0x47: //ReferSemaStatus
+	case 0x48: //iReferSemaStatus
+	case 0x63: //GetCop0
+	case 0x64: //FlushCache
+	case 0x68: //iFlushCache
+	case 0x70: //GsGetIMR
+	case 0x7E: //MachineType
+	case 0x7F: //GetMemorySize
+		return true;
+	default:
+		return false;
+	}
+}
+
 void CPS2OS::HandleTLBException()
 {
 	assert(m_ee.CanGenerateInterrupt());
@@ -40,12 +40,14 @@ public:
 	CELF32* GetELF();
 	const char* GetExecutableName() const;
 	std::pair<uint32, uint32> GetExecutableRange() const;
+	bool GetVuUseAccurateAddSub() const;
 	uint32 LoadExecutable(const char*, const char*);
 
 	Ee::CLibMc2& GetLibMc2();
 
 	void HandleInterrupt(int32);
 	void HandleSyscall();
+	bool HandleSyscallFast();
 	void HandleReturnFromException();
 	void HandleTLBException();
 	bool CheckVBlankFlag();
@@ -348,6 +350,7 @@ private:
 	std::string GetSysCallDescription(uint8);
 
 	static SystemCallHandler m_sysCall[0x80];
+	static bool IsFastSysCall(uint32);
 
 	void AssembleCustomSyscallHandler();
 	void AssembleInterruptHandler();
@@ -474,6 +477,7 @@ private:
 
 	//For display purposes only
 	std::string m_executableName;
+	bool m_vuUseAccurateAddSub = false;
 
 	Ee::CIdleEvaluator m_idleEvaluator;
 
@@ -1,3 +1,4 @@
+#include <algorithm>
 #include <cstring>
 #include <stdio.h>
 #include "Log.h"
@@ -63,6 +64,7 @@ CSIF::CSIF(CDMAC& dmac, uint8* eeRam, uint8* iopRam)
     , m_eeRam(eeRam)
     , m_iopRam(iopRam)
 {
+	ResetPacketQueue();
 }
 
 void CSIF::Reset()
@@ -80,7 +82,8 @@ void CSIF::Reset()
 	m_cmdBufferAddress = 0;
 	m_cmdBufferSize = 0;
 
-	m_packetQueue.clear();
+	m_packetQueue = PacketQueue(PACKETQUEUE_INITIAL_SIZE);
+	ResetPacketQueue();
 	m_packetProcessed = true;
 
 	m_callReplies.clear();
@@ -249,29 +252,147 @@ void CSIF::SendPacket(const void* packet, uint32 size)
 
 void CSIF::SendPacketToAddress(const void* packet, uint32 size, uint32 dstAddr)
 {
-	m_packetQueue.insert(m_packetQueue.end(),
-	                     reinterpret_cast<const uint8*>(&size),
-	                     reinterpret_cast<const uint8*>(&size) + 4);
-	m_packetQueue.insert(m_packetQueue.end(),
-	                     reinterpret_cast<const uint8*>(&dstAddr),
-	                     reinterpret_cast<const uint8*>(&dstAddr) + 4);
-	m_packetQueue.insert(m_packetQueue.end(),
-	                     reinterpret_cast<const uint8*>(packet),
-	                     reinterpret_cast<const uint8*>(packet) + size);
+	auto frame = AllocatePacketFrame(GetPacketFrameSize(size));
+	auto header = reinterpret_cast<PACKETHEADER*>(frame);
+	header->size = size;
+	header->dstAddr = dstAddr;
+	memcpy(frame + sizeof(PACKETHEADER), packet, size);
 }
 
 void CSIF::CountTicks(uint32 ticks)
 {
 	CheckPendingBindRequests(ticks);
 
-	if(m_packetProcessed && !m_packetQueue.empty())
+	//Every packet needs to be acknowledged by the EE's SIF interrupt handler (see MarkPacketProcessed)
+	//before the next one can go through, only one packet is delivered at a time.
+	if(m_packetProcessed && (m_packetQueueCount != 0))
 	{
-		assert(m_packetQueue.size() > 8);
-		uint32 size = *reinterpret_cast<uint32*>(&m_packetQueue[0]);
-		uint32 dstAddr = *reinterpret_cast<uint32*>(&m_packetQueue[4]);
-		SendDMA(&m_packetQueue[8], dstAddr, size);
-		m_packetQueue.erase(m_packetQueue.begin(), m_packetQueue.begin() + 8 + size);
+		if(m_packetQueueReadPos == m_packetQueueWrapPos)
+		{
+			m_packetQueueReadPos = 0;
+			m_packetQueueWrapPos = static_cast<uint32>(m_packetQueue.size());
+		}
+		auto frame = m_packetQueue.data() + m_packetQueueReadPos;
+		const auto& header = *reinterpret_cast<const PACKETHEADER*>(frame);
+		SendDMA(frame + sizeof(PACKETHEADER), header.dstAddr, header.size);
+		m_packetQueueReadPos += GetPacketFrameSize(header.size);
 		m_packetProcessed = false;
+		m_packetQueueCount--;
+		if(m_packetQueueCount == 0)
+		{
+			m_packetQueueReadPos = 0;
+			m_packetQueueWritePos = 0;
+			m_packetQueueWrapPos = static_cast<uint32>(m_packetQueue.size());
+		}
+	}
+}
+
+void CSIF::ResetPacketQueue()
+{
+	if(m_packetQueue.empty())
+	{
+		m_packetQueue = PacketQueue(PACKETQUEUE_INITIAL_SIZE);
+	}
+	m_packetQueueReadPos = 0;
+	m_packetQueueWritePos = 0;
+	m_packetQueueWrapPos = static_cast<uint32>(m_packetQueue.size());
+	m_packetQueueCount = 0;
+}
+
+uint32 CSIF::GetPacketFrameSize(uint32 size)
+{
+	return sizeof(PACKETHEADER) + ((size + 3) & ~3);
+}
+
+uint8* CSIF::AllocatePacketFrame(uint32 frameSize)
+{
+	uint32 queueSize = static_cast<uint32>(m_packetQueue.size());
+	if(m_packetQueueCount == 0)
+	{
+		if(frameSize > queueSize)
+		{
+			GrowPacketQueue(frameSize);
+		}
+	}
+	else if(m_packetQueueWritePos > m_packetQueueReadPos)
+	{
+		//Not wrapped, try the end of the buffer first, then the beginning.
+		//The beginning is only used if we don't reach the read position, to keep full and empty states distinct.
+		if((queueSize - m_packetQueueWritePos) < frameSize)
+		{
+			if(frameSize < m_packetQueueReadPos)
+			{
+				m_packetQueueWrapPos = m_packetQueueWritePos;
+				m_packetQueueWritePos = 0;
+			}
+			else
+			{
+				GrowPacketQueue(frameSize);
+			}
+		}
+	}
+	else
+	{
+		//Wrapped, space is available up to the read position
+		if((m_packetQueueReadPos - m_packetQueueWritePos) <= frameSize)
+		{
+			GrowPacketQueue(frameSize);
+		}
+	}
+	auto frame = m_packetQueue.data() + m_packetQueueWritePos;
+	m_packetQueueWritePos += frameSize;
+	m_packetQueueCount++;
+	return frame;
+}
+
+void CSIF::GrowPacketQueue(uint32 frameSize)
+{
+	auto packetQueueStream = SerializePacketQueue();
+	uint32 queueSize = static_cast<uint32>(m_packetQueue.size());
+	uint32 requiredSize = static_cast<uint32>(packetQueueStream.size()) + (m_packetQueueCount * 4) + frameSize;
+	while(queueSize <= requiredSize)
+	{
+		queueSize = std::max<uint32>(queueSize * 2, PACKETQUEUE_INITIAL_SIZE);
+	}
+	CLog::GetInstance().Warn(LOG_NAME, "Packet queue full, growing to 0x%08X bytes.\r\n", queueSize);
+	m_packetQueue = PacketQueue(queueSize);
+	DeserializePacketQueue(packetQueueStream);
+}
+
+CSIF::PacketQueueStream CSIF::SerializePacketQueue() const
+{
+	//Pending packets are saved back to back (header and unpadded payload) to stay
+	//compatible with the format used by the previous vector based queue
+	PacketQueueStream stream;
+	uint32 readPos = m_packetQueueReadPos;
+	uint32 wrapPos = m_packetQueueWrapPos;
+	for(uint32 i = 0; i < m_packetQueueCount; i++)
+	{
+		if(readPos == wrapPos)
+		{
+			readPos = 0;
+			wrapPos = static_cast<uint32>(m_packetQueue.size());
+		}
+		auto frame = m_packetQueue.data() + readPos;
+		const auto& header = *reinterpret_cast<const PACKETHEADER*>(frame);
+		stream.insert(std::end(stream), frame, frame + sizeof(PACKETHEADER) + header.size);
+		readPos += GetPacketFrameSize(header.size);
+	}
+	return stream;
+}
+
+void CSIF::DeserializePacketQueue(const PacketQueueStream& stream)
+{
+	ResetPacketQueue();
+	uint32 streamPos = 0;
+	while((streamPos + sizeof(PACKETHEADER)) <= stream.size())
+	{
+		PACKETHEADER header;
+		memcpy(&header, stream.data() + streamPos, sizeof(PACKETHEADER));
+		streamPos += sizeof(PACKETHEADER);
+		assert((streamPos + header.size) <= stream.size());
+		SendPacketToAddress(stream.data() + streamPos, header.size, header.dstAddr);
+		streamPos += header.size;
 	}
 }
 
@@ -304,7 +425,7 @@ void CSIF::LoadState(Framework::CZipArchiveReader& archive)
 		m_packetProcessed = registerFile.GetRegister32(STATE_REG_PACKETPROCESSED) != 0;
 	}
 
-	m_packetQueue = LoadPacketQueue(archive);
+	DeserializePacketQueue(LoadPacketQueue(archive));
 
 	m_callReplies = LoadCallReplies(archive);
 	m_bindReplies = LoadBindReplies(archive);
@@ -324,7 +445,10 @@ void CSIF::SaveState(Framework::CZipArchiveWriter& archive)
 		archive.InsertFile(std::move(registerFile));
 	}
 
-	archive.InsertFile(std::make_unique<CMemoryStateFile>(STATE_PACKETQUEUE, m_packetQueue.data(), m_packetQueue.size()));
+	{
+		auto packetQueueStream = SerializePacketQueue();
+		archive.InsertFile(std::make_unique<CMemoryStateFile>(STATE_PACKETQUEUE, packetQueueStream.data(), packetQueueStream.size()));
+	}
 
 	SaveCallReplies(archive);
 	SaveBindReplies(archive);
@@ -364,9 +488,9 @@ void CSIF::SaveBindReplies(Framework::CZipArchiveWriter& archive)
 	archive.InsertFile(std::move(bindRepliesFile));
 }
 
-CSIF::PacketQueue CSIF::LoadPacketQueue(Framework::CZipArchiveReader& archive)
+CSIF::PacketQueueStream CSIF::LoadPacketQueue(Framework::CZipArchiveReader& archive)
 {
-	PacketQueue packetQueue;
+	PacketQueueStream packetQueue;
 	auto file = archive.BeginReadFile(STATE_PACKETQUEUE);
 	while(1)
 	{
@@ -59,19 +59,42 @@ private:
 		SIFRPCREQUESTEND reply;
 	};
 
+	enum
+	{
+		PACKETQUEUE_INITIAL_SIZE = 0x10000,
+	};
+
+	//Packets are framed in place inside the queue: header followed by payload
+	//padded to a word boundary. A frame is never split across the end of the
+	//buffer, so it can be handed to SendDMA directly.
+	struct PACKETHEADER
+	{
+		uint32 size;
+		uint32 dstAddr;
+	};
+	static_assert(sizeof(PACKETHEADER) == 8, "Size of PACKETHEADER must be 8 bytes.");
+
 	typedef std::map<uint32, CSifModule*> ModuleMap;
 	typedef std::vector<uint8> PacketQueue;
+	typedef std::vector<uint8> PacketQueueStream;
 	typedef std::map<uint32, CALLREQUESTINFO> CallReplyMap;
 	typedef std::map<uint32, BINDREQUESTINFO> BindReplyMap;
 
 	void CheckPendingBindRequests(uint32);
 
+	void ResetPacketQueue();
+	uint8* AllocatePacketFrame(uint32);
+	void GrowPacketQueue(uint32);
+	PacketQueueStream SerializePacketQueue() const;
+	void DeserializePacketQueue(const PacketQueueStream&);
+	static uint32 GetPacketFrameSize(uint32);
+
 	void DeleteModules();
 
 	void SaveCallReplies(Framework::CZipArchiveWriter&);
 	void SaveBindReplies(Framework::CZipArchiveWriter&);
 
-	static PacketQueue LoadPacketQueue(Framework::CZipArchiveReader&);
+	static PacketQueueStream LoadPacketQueue(Framework::CZipArchiveReader&);
 	static CallReplyMap LoadCallReplies(Framework::CZipArchiveReader&);
 	static BindReplyMap LoadBindReplies(Framework::CZipArchiveReader&);
 
@@ -108,6 +131,10 @@ private:
 	ModuleMap m_modules;
 
 	PacketQueue m_packetQueue;
+	uint32 m_packetQueueReadPos = 0;
+	uint32 m_packetQueueWritePos = 0;
+	uint32 m_packetQueueWrapPos = 0;
+	uint32 m_packetQueueCount = 0;
 	bool m_packetProcessed;
 
 	CallReplyMap m_callReplies;
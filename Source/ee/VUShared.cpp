@@ -1,3 +1,5 @@
+#include <algorithm>
+#include <cstring>
 #include "VUShared.h"
 #include "BitManip.h"
 #include "../MIPS.h"
@@ -161,6 +163,49 @@ void CheckVectorNaN(CMipsJitter* codeGen, uint8 dest, size_t vector)
 	codeGen->Call(reinterpret_cast<void*>(&TestVectorNaN), 3, Jitter::CJitter::RETURN_VALUE_NONE);
 }
 
+//Fetches fs for the accurate add/sub paths, clamping it the same way MD_ClampS does if needed
+//(+/-NaN and +/-Infinity become +/-FLT_MAX)
+static void LoadAccurateAddSubOperand(uint32* result, CMIPS* context, uint32 fsOffset, uint32 clampFs)
+{
+	memcpy(result, reinterpret_cast<uint8*>(context) + fsOffset, sizeof(uint128));
+	if(!clampFs) return;
+	for(unsigned int i = 0; i < 4; i++)
+	{
+		uint32 value = std::min<int32>(static_cast<int32>(result[i]), 0x7F7FFFFF);
+		result[i] = std::min<uint32>(value, 0xFF7FFFFF);
+	}
+}
+
+//Both of these work on the temporary register: nCOP2[32] = fs +/- nCOP2[32]
+static void AddTruncateVector(CMIPS* context, uint32 fsOffset, uint32 clampFs)
+{
+	alignas(16) uint32 fsValue[4];
+	LoadAccurateAddSubOperand(fsValue, context, fsOffset, clampFs);
+	auto temp = reinterpret_cast<uint32*>(&context->m_State.nCOP2[32]);
+	FpAddTruncate4(temp, fsValue, temp);
+}
+
+static void SubTruncateVector(CMIPS* context, uint32 fsOffset, uint32 clampFs)
+{
+	alignas(16) uint32 fsValue[4];
+	LoadAccurateAddSubOperand(fsValue, context, fsOffset, clampFs);
+	auto temp = reinterpret_cast<uint32*>(&context->m_State.nCOP2[32]);
+	FpSubTruncate4(temp, fsValue, temp);
+}
+
+//Expects the second operand on the stack and pushes the truncated result of fs +/- operand
+//All four lanes are computed with a single call
+static void PushAccurateAddSub(CMipsJitter* codeGen, size_t fs, bool subtract, bool clampFs)
+{
+	codeGen->MD_PullRel(offsetof(CMIPS, m_State.nCOP2[32]));
+	codeGen->PushCtx();
+	codeGen->PushCst(static_cast<uint32>(fs));
+	codeGen->PushCst(clampFs ? 1 : 0);
+	codeGen->Call(subtract ? reinterpret_cast<void*>(&SubTruncateVector) : reinterpret_cast<void*>(&AddTruncateVector),
+	              3, Jitter::CJitter::RETURN_VALUE_NONE);
+	codeGen->MD_PushRel(offsetof(CMIPS, m_State.nCOP2[32]));
+}
+
 void VUShared::PullVector(CMipsJitter* codeGen, uint8 dest, size_t vector)
 {
 	if(dest == 0)
@@ -426,6 +471,23 @@ void VUShared::SetStatus(CMipsJitter* codeGen, size_t srcOffset)
 
 void VUShared::ADD_base(CMipsJitter* codeGen, uint8 dest, size_t fd, size_t fs, size_t ft, bool expand, uint32 relativePipeTime, uint32 compileHints)
 {
+#if !defined(__EMSCRIPTEN__)
+	if(compileHints & COMPILEHINT_USE_ACCURATE_ADD_SUB)
+	{
+		if(expand)
+		{
+			PushBcElement(codeGen, ft);
+		}
+		else
+		{
+			codeGen->MD_PushRel(ft);
+		}
+		PushAccurateAddSub(codeGen, fs, false, true);
+		PullVector(codeGen, dest, fd);
+		TestSZFlags(codeGen, dest, fd, relativePipeTime, compileHints);
+		return;
+	}
+#endif
 	codeGen->MD_PushRel(fs);
 	codeGen->MD_ClampS();
 	if(expand)
@@ -459,7 +521,14 @@ void VUShared::ADDA_base(CMipsJitter* codeGen, uint8 dest, size_t fs, size_t ft,
 
 void VUShared::MADD_base(CMipsJitter* codeGen, uint8 dest, size_t fd, size_t fs, size_t ft, bool expand, uint32 relativePipeTime, uint32 compileHints)
 {
-	codeGen->MD_PushRel(offsetof(CMIPS, m_State.nCOP2A));
+	bool accurate = false;
+#if !defined(__EMSCRIPTEN__)
+	accurate = (compileHints & COMPILEHINT_USE_ACCURATE_ADD_SUB) != 0;
+#endif
+	if(!accurate)
+	{
+		codeGen->MD_PushRel(offsetof(CMIPS, m_State.nCOP2A));
+	}
 	codeGen->MD_PushRel(fs);
 	//Clamping is needed by Baldur's Gate Deadly Alliance here because it multiplies junk values (potentially NaN/INF) by 0
 	codeGen->MD_ClampS();
@@ -473,7 +542,14 @@ void VUShared::MADD_base(CMipsJitter* codeGen, uint8 dest, size_t fd, size_t fs,
 		codeGen->MD_PushRel(ft);
 	}
 	codeGen->MD_MulS();
-	codeGen->MD_AddS();
+	if(accurate)
+	{
+		PushAccurateAddSub(codeGen, offsetof(CMIPS, m_State.nCOP2A), false, false);
+	}
+	else
+	{
+		codeGen->MD_AddS();
+	}
 	PullVector(codeGen, dest, fd);
 	TestSZFlags(codeGen, dest, fd, relativePipeTime, compileHints);
 }
@@ -501,6 +577,24 @@ void VUShared::MADDA_base(CMipsJitter* codeGen, uint8 dest, size_t fs, size_t ft
 
 void VUShared::SUB_base(CMipsJitter* codeGen, uint8 dest, size_t fd, size_t fs, size_t ft, bool expand, uint32 relativePipeTime, uint32 compileHints)
 {
+#if !defined(__EMSCRIPTEN__)
+	if(compileHints & COMPILEHINT_USE_ACCURATE_ADD_SUB)
+	{
+		if(expand)
+		{
+			PushBcElement(codeGen, ft);
+		}
+		else
+		{
+			codeGen->MD_PushRel(ft);
+		}
+		codeGen->MD_ClampS();
+		PushAccurateAddSub(codeGen, fs, true, true);
+		PullVector(codeGen, dest, fd);
+		TestSZFlags(codeGen, dest, fd, relativePipeTime, compileHints);
+		return;
+	}
+#endif
 	codeGen->MD_PushRel(fs);
 	codeGen->MD_ClampS();
 	if(expand)
@@ -535,7 +629,14 @@ void VUShared::SUBA_base(CMipsJitter* codeGen, uint8 dest, size_t fs, size_t ft,
 
 void VUShared::MSUB_base(CMipsJitter* codeGen, uint8 dest, size_t fd, size_t fs, size_t ft, bool expand, uint32 relativePipeTime, uint32 compileHints)
 {
-	codeGen->MD_PushRel(offsetof(CMIPS, m_State.nCOP2A));
+	bool accurate = false;
+#if !defined(__EMSCRIPTEN__)
+	accurate = (compileHints & COMPILEHINT_USE_ACCURATE_ADD_SUB) != 0;
+#endif
+	if(!accurate)
+	{
+		codeGen->MD_PushRel(offsetof(CMIPS, m_State.nCOP2A));
+	}
 	codeGen->MD_PushRel(fs);
 	if(expand)
 	{
@@ -546,7 +647,14 @@ void VUShared::MSUB_base(CMipsJitter* codeGen, uint8 dest, size_t fd, size_t fs,
 		codeGen->MD_PushRel(ft);
 	}
 	codeGen->MD_MulS();
-	codeGen->MD_SubS();
+	if(accurate)
+	{
+		PushAccurateAddSub(codeGen, offsetof(CMIPS, m_State.nCOP2A), true, false);
+	}
+	else
+	{
+		codeGen->MD_SubS();
+	}
 	PullVector(codeGen, dest, fd);
 	TestSZFlags(codeGen, dest, fd, relativePipeTime, compileHints);
 }
@@ -732,17 +840,12 @@ void VUShared::ADDi(CMipsJitter* codeGen, uint8 nDest, uint8 nFd, uint8 nFs, uin
 	//On JavaScript, using it doesn't seem to help Tri-Ace games
 	//there's probably some other rounding issue on that platform
 #if !defined(__EMSCRIPTEN__)
-	if(compileHints & COMPILEHINT_USE_ACCURATE_ADDI)
+	if(compileHints & (COMPILEHINT_USE_ACCURATE_ADDI | COMPILEHINT_USE_ACCURATE_ADD_SUB))
 	{
-		for(unsigned int i = 0; i < 4; i++)
-		{
-			if(!VUShared::DestinationHasElement(nDest, i)) continue;
-
-			codeGen->PushRel(offsetof(CMIPS, m_State.nCOP2[nFs].nV[i]));
-			codeGen->PushRel(offsetof(CMIPS, m_State.nCOP2I));
-			codeGen->Call(reinterpret_cast<void*>(&FpAddTruncate), 2, Jitter::CJitter::RETURN_VALUE_32);
-			codeGen->PullRel(offsetof(CMIPS, m_State.nCOP2[nFd].nV[i]));
-		}
+		codeGen->PushRel(offsetof(CMIPS, m_State.nCOP2I));
+		codeGen->MD_ExpandW();
+		PushAccurateAddSub(codeGen, offsetof(CMIPS, m_State.nCOP2[nFs]), false, false);
+		PullVector(codeGen, nDest, offsetof(CMIPS, m_State.nCOP2[nFd]));
 	}
 	else
 #endif
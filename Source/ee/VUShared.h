@@ -72,6 +72,9 @@ namespace VUShared
 		bool readMACflags;
 		bool writeMACflags;
 
+		//Status Z/S bits are derived from the MAC flags, reading them is also a MAC flags use
+		bool readStatusFlags;
+
 		//When set, means that a branch following the instruction will be
 		//able to use the integer value directly
 		bool branchValue;
@@ -97,6 +100,7 @@ namespace VUShared
 	{
 		COMPILEHINT_SKIP_FMAC_UPDATE = (1 << 0),
 		COMPILEHINT_USE_ACCURATE_ADDI = (1 << 1), //For decompression in Tri-Ace games
+		COMPILEHINT_USE_ACCURATE_ADD_SUB = (1 << 2), //Truncated results for ADD, SUB, MADD and MSUB
 	};
 
 	uint32 MakeDestFromComponent(uint32);
@@ -1,7 +1,10 @@
+#include <algorithm>
+#include <cassert>
 #include "VuAnalysis.h"
 #include "../MIPS.h"
 #include "../Ps2Const.h"
 #include "VUShared.h"
+#include "MA_VU.h"
 
 void CVuAnalysis::Analyse(CMIPS* ctx, uint32 begin, uint32 end)
 {
@@ -115,3 +118,150 @@ void CVuAnalysis::Analyse(CMIPS* ctx, uint32 begin, uint32 end)
 		}
 	}
 }
+
+bool CVuAnalysis::GetSuccessors(CMIPS* ctx, uint32 address, uint32 size, std::vector<uint32>& successors)
+{
+	//Returns false if execution can leave the microprogram after this instruction pair
+	//or if we can't tell where it's going to go
+	uint32 addressMask = size - 1;
+	successors.clear();
+
+	uint32 lowerInstruction = ctx->m_pMemoryMap->GetInstruction(address + 0);
+	uint32 upperInstruction = ctx->m_pMemoryMap->GetInstruction(address + 4);
+
+	if(upperInstruction & (VUShared::VU_UPPEROP_BIT_D | VUShared::VU_UPPEROP_BIT_T))
+	{
+		return false;
+	}
+
+	uint32 prevAddress = (address - 8) & addressMask;
+	uint32 prevLowerInstruction = ctx->m_pMemoryMap->GetInstruction(prevAddress + 0);
+	uint32 prevUpperInstruction = ctx->m_pMemoryMap->GetInstruction(prevAddress + 4);
+
+	//We're in the delay slot of an E bit, program ends after this
+	if(prevUpperInstruction & VUShared::VU_UPPEROP_BIT_E)
+	{
+		return false;
+	}
+
+	if(ctx->m_pArch->IsInstructionBranch(ctx, prevAddress, prevLowerInstruction) == MIPS_BRANCH_NORMAL)
+	{
+		//Branch in a delay slot, too complicated to follow
+		if(ctx->m_pArch->IsInstructionBranch(ctx, address, lowerInstruction) == MIPS_BRANCH_NORMAL)
+		{
+			return false;
+		}
+
+		uint32 branchTarget = ctx->m_pArch->GetInstructionEffectiveAddress(ctx, prevAddress, prevLowerInstruction);
+		if(branchTarget == MIPS_INVALID_PC)
+		{
+			//JR/JALR
+			return false;
+		}
+		successors.push_back(branchTarget & addressMask);
+	}
+
+	//Also taken after a non conditional branch, which is fine since it only
+	//makes the analysis more conservative (this pair could be reached from somewhere else)
+	successors.push_back((address + 8) & addressMask);
+	return true;
+}
+
+CVuAnalysis::MacFlagsLiveness CVuAnalysis::ComputeMacFlagsLiveness(CMIPS* ctx, uint32 size)
+{
+	assert((size & (size - 1)) == 0);
+	auto arch = static_cast<CMA_VU*>(ctx->m_pArch);
+	uint32 pairCount = size / 8;
+
+	std::vector<bool> reads(pairCount);
+	std::vector<bool> writes(pairCount);
+	std::vector<bool> leaves(pairCount);
+	std::vector<std::vector<uint32>> successors(pairCount);
+	std::vector<std::vector<uint32>> predecessors(pairCount);
+
+	for(uint32 pairIndex = 0; pairIndex < pairCount; pairIndex++)
+	{
+		uint32 address = pairIndex * 8;
+		uint32 lowerInstruction = ctx->m_pMemoryMap->GetInstruction(address + 0);
+		uint32 upperInstruction = ctx->m_pMemoryMap->GetInstruction(address + 4);
+		auto loOps = arch->GetAffectedOperands(ctx, address + 0, lowerInstruction);
+		auto hiOps = arch->GetAffectedOperands(ctx, address + 4, upperInstruction);
+		reads[pairIndex] = loOps.readMACflags || loOps.readStatusFlags;
+		writes[pairIndex] = hiOps.writeMACflags;
+		std::vector<uint32> pairSuccessors;
+		leaves[pairIndex] = !GetSuccessors(ctx, address, size, pairSuccessors);
+		for(auto successor : pairSuccessors)
+		{
+			successors[pairIndex].push_back(successor / 8);
+			predecessors[successor / 8].push_back(pairIndex);
+		}
+	}
+
+	//A MAC write becomes visible LATENCY_MAC cycles after it's issued. Pairs executed in
+	//between still see the previous value. Stalls can only make the write visible sooner,
+	//so counting pairs instead of cycles stays on the safe side.
+	std::vector<bool> windowReads(pairCount);
+	for(uint32 pairIndex = 0; pairIndex < pairCount; pairIndex++)
+	{
+		if(!writes[pairIndex]) continue;
+		bool found = leaves[pairIndex];
+		std::vector<uint32> frontier = successors[pairIndex];
+		for(uint32 step = 1; (step < VUShared::LATENCY_MAC) && !found; step++)
+		{
+			std::vector<uint32> nextFrontier;
+			for(auto successor : frontier)
+			{
+				if(reads[successor] || leaves[successor])
+				{
+					found = true;
+					break;
+				}
+				nextFrontier.insert(nextFrontier.end(), successors[successor].begin(), successors[successor].end());
+			}
+			frontier = std::move(nextFrontier);
+		}
+		windowReads[pairIndex] = found;
+	}
+
+	//Seed with pairs that are live on their own and propagate backwards to predecessors
+	//that don't overwrite the flags. Leaving the program counts as a use since the flags
+	//can be read after the microprogram has ended.
+	MacFlagsLiveness liveIn(pairCount);
+	std::vector<uint32> worklist;
+	for(uint32 pairIndex = 0; pairIndex < pairCount; pairIndex++)
+	{
+		bool live = reads[pairIndex] || (writes[pairIndex] ? windowReads[pairIndex] : leaves[pairIndex]);
+		if(live)
+		{
+			liveIn[pairIndex] = true;
+			worklist.push_back(pairIndex);
+		}
+	}
+	while(!worklist.empty())
+	{
+		uint32 pairIndex = worklist.back();
+		worklist.pop_back();
+		for(auto predecessor : predecessors[pairIndex])
+		{
+			if(liveIn[predecessor] || writes[predecessor]) continue;
+			liveIn[predecessor] = true;
+			worklist.push_back(predecessor);
+		}
+	}
+
+	return liveIn;
+}
+
+bool CVuAnalysis::IsMacFlagsLiveAfter(CMIPS* ctx, const MacFlagsLiveness& liveness, uint32 address)
+{
+	//Checks if the MAC flags visible after the instruction pair at address can be observed
+	address &= ~0x07;
+	uint32 size = static_cast<uint32>(liveness.size()) * 8;
+	std::vector<uint32> successors;
+	if(!GetSuccessors(ctx, address & (size - 1), size, successors))
+	{
+		return true;
+	}
+	return std::any_of(successors.begin(), successors.end(),
+	                   [&](uint32 successor) { return liveness[successor / 8]; });
+}
@@ -9,8 +9,16 @@ class CMIPS;
 class CVuAnalysis
 {
 public:
+	//For every instruction pair of the microprogram, tells if the MAC flags
+	//value visible when entering that pair can be observed later on
+	typedef std::vector<bool> MacFlagsLiveness;
+
 	static void Analyse(CMIPS*, uint32, uint32);
 
+	static MacFlagsLiveness ComputeMacFlagsLiveness(CMIPS*, uint32);
+	static bool IsMacFlagsLiveAfter(CMIPS*, const MacFlagsLiveness&, uint32);
+
 private:
 	static uint32 FindBlockStart(CMIPS*, uint32);
+	static bool GetSuccessors(CMIPS*, uint32, uint32, std::vector<uint32>&);
 };
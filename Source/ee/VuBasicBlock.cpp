@@ -14,6 +14,16 @@ bool CVuBasicBlock::IsLinkable() const
 	return m_isLinkable;
 }
 
+bool CVuBasicBlock::GetMacFlagsLiveOut() const
+{
+	return m_macFlagsLiveOut;
+}
+
+void CVuBasicBlock::SetMacFlagsLiveOut(bool macFlagsLiveOut)
+{
+	m_macFlagsLiveOut = macFlagsLiveOut;
+}
+
 void CVuBasicBlock::CompileRange(CMipsJitter* jitter)
 {
 	CompileProlog(jitter);
@@ -618,7 +628,7 @@ void CVuBasicBlock::ComputeSkipFlagsHints(const std::vector<uint32>& fmacStallDe
 			    flagsResults.end(), instructionIndex);
 		}
 
-		if(loOps.readMACflags)
+		if(loOps.readMACflags || loOps.readStatusFlags)
 		{
 			uint32 pipeTimeForResult = flagsResults[relativePipeTime];
 			if(pipeTimeForResult != g_undefinedMACflagsResult)
@@ -631,12 +641,16 @@ void CVuBasicBlock::ComputeSkipFlagsHints(const std::vector<uint32>& fmacStallDe
 	}
 
 	//Simulate usage from outside our block
-	for(uint32 relativePipeTime = maxPipeTime; relativePipeTime < extendedMaxPipeTime; relativePipeTime++)
+	//Not needed if program analysis told us that nothing after this block will look at those results
+	if(m_macFlagsLiveOut)
 	{
-		uint32 pipeTimeForResult = flagsResults[relativePipeTime];
-		if(pipeTimeForResult != g_undefinedMACflagsResult)
+		for(uint32 relativePipeTime = maxPipeTime; relativePipeTime < extendedMaxPipeTime; relativePipeTime++)
 		{
-			resultUsed[pipeTimeForResult] = true;
+			uint32 pipeTimeForResult = flagsResults[relativePipeTime];
+			if(pipeTimeForResult != g_undefinedMACflagsResult)
+			{
+				resultUsed[pipeTimeForResult] = true;
+			}
 		}
 	}
 
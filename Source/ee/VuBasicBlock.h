@@ -10,6 +10,9 @@ public:
 
 	bool IsLinkable() const;
 
+	bool GetMacFlagsLiveOut() const;
+	void SetMacFlagsLiveOut(bool);
+
 protected:
 	void CompileRange(CMipsJitter*) override;
 
@@ -45,4 +48,8 @@ private:
 	static void EmitXgKick(CMipsJitter*);
 
 	bool m_isLinkable = true;
+
+	//Set to false when we know that no code executed after this block reads
+	//the MAC flags this block produces
+	bool m_macFlagsLiveOut = true;
 };
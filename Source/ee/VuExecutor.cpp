@@ -16,12 +16,80 @@ CVuExecutor::CVuExecutor(CMIPS& context, uint32 maxAddress)
 {
 }
 
+int CVuExecutor::Execute(int cycles)
+{
+	if(m_mustCheckMacFlagsLiveness)
+	{
+		ClearBlocksWithStaleMacFlagsLiveness();
+	}
+	return CGenericMipsExecutor::Execute(cycles);
+}
+
 void CVuExecutor::Reset()
 {
-	m_cachedBlocks.clear();
+	m_macFlagsLiveness.clear();
+	m_mustCheckMacFlagsLiveness = false;
 	CGenericMipsExecutor::Reset();
 }
 
+void CVuExecutor::ClearActiveBlocksInRange(uint32 start, uint32 end, bool executing)
+{
+	CGenericMipsExecutor::ClearActiveBlocksInRange(start, end, executing);
+	if(m_programAnalysisEnabled)
+	{
+		//Liveness information depends on the whole program. Blocks outside of the range
+		//are only thrown away if their liveness changed, this is done before running again.
+		m_macFlagsLiveness.clear();
+		m_mustCheckMacFlagsLiveness = true;
+	}
+}
+
+void CVuExecutor::SetProgramAnalysisEnabled(bool enabled)
+{
+	m_programAnalysisEnabled = enabled;
+	m_macFlagsLiveness.clear();
+	m_mustCheckMacFlagsLiveness = true;
+}
+
+void CVuExecutor::SetAccurateAddSubEnabled(bool enabled)
+{
+	if(m_accurateAddSubEnabled == enabled) return;
+	m_accurateAddSubEnabled = enabled;
+	//Cached blocks were compiled with the other setting
+	Reset();
+}
+
+bool CVuExecutor::IsMacFlagsLiveAfter(uint32 address)
+{
+	if(!m_programAnalysisEnabled)
+	{
+		return true;
+	}
+	if(m_macFlagsLiveness.empty())
+	{
+		m_macFlagsLiveness = CVuAnalysis::ComputeMacFlagsLiveness(&m_context, m_maxAddress);
+	}
+	return CVuAnalysis::IsMacFlagsLiveAfter(&m_context, m_macFlagsLiveness, address);
+}
+
+void CVuExecutor::ClearBlocksWithStaleMacFlagsLiveness()
+{
+	m_mustCheckMacFlagsLiveness = false;
+	std::vector<std::pair<uint32, uint32>> staleRanges;
+	for(const auto& block : m_blocks)
+	{
+		bool macFlagsLiveOut = IsMacFlagsLiveAfter(block->GetEndAddress() - 4);
+		if(static_cast<CVuBasicBlock*>(block.get())->GetMacFlagsLiveOut() != macFlagsLiveOut)
+		{
+			staleRanges.push_back(std::make_pair(block->GetBeginAddress(), block->GetEndAddress()));
+		}
+	}
+	for(const auto& staleRange : staleRanges)
+	{
+		CGenericMipsExecutor::ClearActiveBlocksInRange(staleRange.first, staleRange.second, false);
+	}
+}
+
 BasicBlockPtr CVuExecutor::BlockFactory(CMIPS& context, uint32 begin, uint32 end)
 {
 	uint32 blockSize = ((end - begin) + 4) / 4;
@@ -38,33 +106,41 @@ BasicBlockPtr CVuExecutor::BlockFactory(CMIPS& context, uint32 begin, uint32 end
 	static_assert(sizeof(hash) == sizeof(xxHash));
 	auto blockKey = std::make_pair(hash, blockSizeByte);
 
+	bool macFlagsLiveOut = IsMacFlagsLiveAfter(end - 4);
+
 	//Don't use the cached blocks of we have a breakpoint in our block range.
 	bool hasBreakpoint = m_context.HasBreakpointInRange(begin, end);
 	if(!hasBreakpoint)
 	{
-		auto beginBlockIterator = m_cachedBlocks.lower_bound(blockKey);
-		auto endBlockIterator = m_cachedBlocks.upper_bound(blockKey);
 		//Check if we have a block that has the same contents and the same range.
-		for(auto blockIterator = beginBlockIterator; blockIterator != endBlockIterator; blockIterator++)
+		//Blocks compiled with different MAC flags liveness can't be shared.
+		auto isCompatibleBlock =
+		    [&](const BasicBlockPtr& basicBlock) {
+			    return static_cast<CVuBasicBlock*>(basicBlock.get())->GetMacFlagsLiveOut() == macFlagsLiveOut;
+		    };
+		auto matchingBlock = m_cachedBlocks.Find(blockKey,
+		                                         [&](const BasicBlockPtr& basicBlock) {
+			                                         return basicBlock->GetBeginAddress() == begin && basicBlock->GetEndAddress() == end &&
+			                                                isCompatibleBlock(basicBlock);
+		                                         });
+		if(matchingBlock)
 		{
-			const auto& basicBlock(blockIterator->second);
-			if(basicBlock->GetBeginAddress() == begin && basicBlock->GetEndAddress() == end)
-			{
-				return basicBlock;
-			}
+			return matchingBlock;
 		}
 		//Check if we have a block that has the same contents but not the same range. Reuse the code of that block if that's the case.
-		if(beginBlockIterator != endBlockIterator)
+		if(auto compatibleBlock = m_cachedBlocks.Find(blockKey, isCompatibleBlock))
 		{
 			auto result = std::make_shared<CVuBasicBlock>(context, begin, end, m_blockCategory);
-			result->CopyFunctionFrom(beginBlockIterator->second);
-			m_cachedBlocks.insert(std::make_pair(blockKey, result));
+			result->SetMacFlagsLiveOut(macFlagsLiveOut);
+			result->CopyFunctionFrom(compatibleBlock);
+			m_cachedBlocks.Insert(blockKey, result);
 			return result;
 		}
 	}
 
 	//Totally new block, build it from scratch
 	auto result = std::make_shared<CVuBasicBlock>(context, begin, end, m_blockCategory);
+	result->SetMacFlagsLiveOut(macFlagsLiveOut);
 
 	auto blockCompileHintsIterator = std::find_if(std::begin(g_blockCompileHints), std::end(g_blockCompileHints),
 	                                              [&](const auto& item) { return item.blockKey == blockKey; });
@@ -72,11 +148,15 @@ BasicBlockPtr CVuExecutor::BlockFactory(CMIPS& context, uint32 begin, uint32 end
 	{
 		result->AddBlockCompileHints(blockCompileHintsIterator->hints);
 	}
+	if(m_accurateAddSubEnabled)
+	{
+		result->AddBlockCompileHints(VUShared::COMPILEHINT_USE_ACCURATE_ADD_SUB);
+	}
 
 	result->Compile();
 	if(!hasBreakpoint)
 	{
-		m_cachedBlocks.insert(std::make_pair(blockKey, result));
+		m_cachedBlocks.Insert(blockKey, result);
 	}
 	return result;
 }
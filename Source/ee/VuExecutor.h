@@ -2,6 +2,7 @@
 
 #include <map>
 #include "../GenericMipsExecutor.h"
+#include "VuAnalysis.h"
 
 class CVuExecutor : public CGenericMipsExecutor<BlockLookupOneWay, 8>
 {
@@ -9,11 +10,20 @@ public:
 	CVuExecutor(CMIPS&, uint32);
 	virtual ~CVuExecutor() = default;
 
+	int Execute(int) override;
 	void Reset() override;
+	void ClearActiveBlocksInRange(uint32, uint32, bool) override;
+
+	//When enabled, the whole microprogram is analysed before compiling blocks
+	//to find out which MAC flag updates are never observed
+	void SetProgramAnalysisEnabled(bool);
+
+	//When enabled, ADD, SUB, MADD and MSUB results are truncated like on the real hardware.
+	//Changing this throws away all compiled blocks.
+	void SetAccurateAddSubEnabled(bool);
 
 protected:
-	typedef std::pair<uint128, uint32> CachedBlockKey;
-	typedef std::multimap<CachedBlockKey, BasicBlockPtr> CachedBlockMap;
+	typedef CBlockCache::KeyType CachedBlockKey;
 
 	struct BLOCK_COMPILE_HINTS
 	{
@@ -24,6 +34,13 @@ protected:
 	BasicBlockPtr BlockFactory(CMIPS&, uint32, uint32) override;
 	void PartitionFunction(uint32) override;
 
+	bool IsMacFlagsLiveAfter(uint32);
+	void ClearBlocksWithStaleMacFlagsLiveness();
+
 	static const BLOCK_COMPILE_HINTS g_blockCompileHints[];
-	CachedBlockMap m_cachedBlocks;
+
+	bool m_programAnalysisEnabled = false;
+	bool m_accurateAddSubEnabled = false;
+	CVuAnalysis::MacFlagsLiveness m_macFlagsLiveness;
+	bool m_mustCheckMacFlagsLiveness = false;
 };
@@ -59,6 +59,7 @@ static uint32 MakeColor(uint8 r, uint8 g, uint8 b, uint8 a)
 CGSH_OpenGL::CGSH_OpenGL(bool gsThreaded)
     : CGSHandler(gsThreaded)
     , m_pCvtBuffer(nullptr)
+    , m_textureDecodeWorkers(CGsWorkerPool::GetDefaultThreadCount())
 {
 	RegisterPreferences();
 	LoadPreferences();
@@ -92,9 +93,11 @@ void CGSH_OpenGL::InitializeImpl()
 void CGSH_OpenGL::ReleaseImpl()
 {
 	ResetImpl();
+	ReleaseTextureStaging();
 
 	m_paletteCache.clear();
 	m_shaders.clear();
+	m_shaderBinaries.clear();
 	m_presentProgram.reset();
 	m_presentVertexBuffer.Reset();
 	m_presentVertexArray.Reset();
@@ -111,10 +114,10 @@ void CGSH_OpenGL::ReleaseImpl()
 void CGSH_OpenGL::ResetImpl()
 {
 	LoadPreferences();
+	CompletePendingTextureUploads();
 	m_textureCache.Flush();
 	PalCache_Flush();
-	m_framebuffers.clear();
-	m_depthbuffers.clear();
+	ClearFramebuffers();
 	m_vertexBuffer.clear();
 	m_renderState.isValid = false;
 	m_validGlState = 0;
@@ -137,23 +140,23 @@ void CGSH_OpenGL::FlipImpl(const DISPLAY_INFO& dispInfo)
 
 	if(dispLayer.enabled)
 	{
-		for(const auto& candidateFramebuffer : m_framebuffers)
+		if(auto candidateFramebuffers = FindFramebufferCandidates(dispLayer.bufPtr, dispLayer.bufWidth))
 		{
-			if(
-			    (candidateFramebuffer->m_basePtr == dispLayer.bufPtr) &&
-			    (GetFramebufferBitDepth(candidateFramebuffer->m_psm) == GetFramebufferBitDepth(dispLayer.psm)) &&
-			    (candidateFramebuffer->m_width == dispLayer.bufWidth))
+			for(const auto& candidateFramebuffer : *candidateFramebuffers)
 			{
-				//We have a winner
-				framebuffer = candidateFramebuffer;
-				break;
+				if(GetFramebufferBitDepth(candidateFramebuffer->m_psm) == GetFramebufferBitDepth(dispLayer.psm))
+				{
+					//We have a winner
+					framebuffer = candidateFramebuffer;
+					break;
+				}
 			}
 		}
 
 		if(!framebuffer && (dispLayer.bufWidth != 0))
 		{
 			framebuffer = FramebufferPtr(new CFramebuffer(dispLayer.bufPtr, dispLayer.bufWidth, FRAMEBUFFER_HEIGHT, dispLayer.psm, m_fbScale, m_multisampleEnabled));
-			m_framebuffers.push_back(framebuffer);
+			AddFramebuffer(framebuffer);
 			PopulateFramebuffer(framebuffer);
 		}
 	}
@@ -233,11 +236,20 @@ void CGSH_OpenGL::FlipImpl(const DISPLAY_INFO& dispInfo)
 	}
 
 	PresentBackbuffer();
+
+	{
+		std::lock_guard<std::mutex> statsLock(m_lastResourceCacheStatsMutex);
+		m_lastResourceCacheStats = m_resourceCacheStats;
+		m_resourceCacheStats = RESOURCE_CACHE_STATS();
+	}
+
 	CGSHandler::FlipImpl(dispInfo);
 }
 
 void CGSH_OpenGL::LoadState(Framework::CZipArchiveReader& archive)
 {
+	//Make sure workers are not reading GS memory while it's being replaced
+	SendGSCall([this]() { WaitTextureDecodes(); }, true);
 	CGSHandler::LoadState(archive);
 	SendGSCall(
 	    [this]() {
@@ -257,8 +269,7 @@ void CGSH_OpenGL::NotifyPreferencesChangedImpl()
 	LoadPreferences();
 	m_textureCache.Flush();
 	PalCache_Flush();
-	m_framebuffers.clear();
-	m_depthbuffers.clear();
+	ClearFramebuffers();
 	CGSHandler::NotifyPreferencesChangedImpl();
 }
 
@@ -276,6 +287,8 @@ void CGSH_OpenGL::InitializeRC()
 
 	CheckExtensions();
 	SetupTextureUpdaters();
+	CreateTextureStaging();
+	LoadShaderCache();
 
 	m_presentProgram = GeneratePresentProgram();
 	m_presentVertexBuffer = GeneratePresentVertexBuffer();
@@ -303,6 +316,14 @@ void CGSH_OpenGL::InitializeRC()
 
 void CGSH_OpenGL::CheckExtensions()
 {
+	{
+		GLint programBinaryFormatCount = 0;
+		glGetIntegerv(GL_NUM_PROGRAM_BINARY_FORMATS, &programBinaryFormatCount);
+		//Clear error in case the query isn't supported
+		glGetError();
+		m_hasProgramBinarySupport = (programBinaryFormatCount > 0);
+	}
+
 	GLint numExtensions = 0;
 	glGetIntegerv(GL_NUM_EXTENSIONS, &numExtensions);
 	for(GLint i = 0; i < numExtensions; i++)
@@ -316,6 +337,12 @@ void CGSH_OpenGL::CheckExtensions()
 		{
 			m_hasFramebufferFetchDepthExtension = true;
 		}
+#ifdef USE_PERSISTENT_TEXTURE_STAGING
+		else if(!strcmp(extensionName, "GL_ARB_buffer_storage"))
+		{
+			m_hasPersistentTextureStaging = true;
+		}
+#endif
 	}
 }
 
@@ -492,7 +519,13 @@ Framework::OpenGl::ProgramPtr CGSH_OpenGL::GetShaderFromCaps(const SHADERCAPS& s
 	auto shaderIterator = m_shaders.find(shaderCaps);
 	if(shaderIterator == m_shaders.end())
 	{
-		auto shader = GenerateShader(shaderCaps);
+		auto shader = LoadShaderFromCache(shaderCaps);
+		if(!shader)
+		{
+			shader = GenerateShader(shaderCaps);
+			SaveShaderToCache(shaderCaps, shader);
+		}
+		RecordTitleShader(shaderCaps);
 
 		glUseProgram(*shader);
 		m_validGlState &= ~GLSTATE_PROGRAM;
@@ -593,7 +626,7 @@ void CGSH_OpenGL::SetRenderingContext(uint64 primReg)
 	}
 
 	//--------------------------------------------------------
-	// Determine which states changed; perform a single flush before modifying any.
+	// Determine which states changed
 	//--------------------------------------------------------
 	uint64 prevPrimValue = m_renderState.isValid ? m_renderState.primReg : 0;
 	auto prevPrim = make_convertible<PRMODE>(prevPrimValue);
@@ -603,20 +636,41 @@ void CGSH_OpenGL::SetRenderingContext(uint64 primReg)
 	bool alphaChanged = !m_renderState.isValid || (m_renderState.alphaReg != alphaReg);
 	bool testChanged = !m_renderState.isValid || (m_renderState.testReg != testReg);
 	bool zbufChanged = !m_renderState.isValid || (m_renderState.zbufReg != zbufReg);
-	bool framebufferRelatedChanged = !m_renderState.isValid || !m_renderState.isFramebufferStateValid ||
-	                                 (m_renderState.frameReg != frameReg) || zbufChanged || (m_renderState.scissorReg != scissorReg) || testChanged;
+	bool frameChanged = !m_renderState.isValid || (m_renderState.frameReg != frameReg);
+	//FBMSK and ZMSK live in the upper 32 bits, they don't change the buffers we render to
+	bool framebufferChanged = !m_renderState.isValid || !m_renderState.isFramebufferStateValid ||
+	                          (static_cast<uint32>(m_renderState.frameReg) != static_cast<uint32>(frameReg)) ||
+	                          (static_cast<uint32>(m_renderState.zbufReg) != static_cast<uint32>(zbufReg)) ||
+	                          (m_renderState.scissorReg != scissorReg);
+	bool colorMaskChanged = framebufferChanged || frameChanged || testChanged;
 	bool textureEnableChanged = !m_renderState.isValid || (prevPrim.nTexture != prim.nTexture);
 	bool textureChanged = !m_renderState.isValid || !m_renderState.isTextureStateValid ||
 	                      (m_renderState.tex0Reg != tex0Reg) || (m_renderState.tex1Reg != tex1Reg) || (m_renderState.texAReg != texAReg) ||
 	                      (m_renderState.clampReg != clampReg) || textureEnableChanged;
 	bool fogColorChanged = !m_renderState.isValid || (m_renderState.fogColReg != fogColReg);
 
-	bool needFlush = shaderChanged || primChanged || alphaChanged || testChanged || zbufChanged || framebufferRelatedChanged || textureChanged || fogColorChanged;
-	if(needFlush)
+	//Setting up the framebuffer or the texture might touch GL objects (dirty page commits,
+	//texture uploads, framebuffer copies) and needs to happen after pending draws are done
+	if(framebufferChanged || textureChanged)
 	{
 		FlushVertexBuffer();
 	}
 
+	//Other changes are only recorded in the render state and are applied when drawing.
+	//Keep the state pending vertices were recorded with: if the new register values
+	//end up producing an equivalent draw state, subsequent vertices will be merged with them.
+	bool hasPendingDraw = !m_vertexBuffer.empty();
+	uint32 pendingValidGlState = m_validGlState;
+	RENDERSTATE pendingRenderState;
+	VERTEXPARAMS pendingVertexParams;
+	FRAGMENTPARAMS pendingFragmentParams;
+	if(hasPendingDraw)
+	{
+		pendingRenderState = m_renderState;
+		pendingVertexParams = m_vertexParams;
+		pendingFragmentParams = m_fragmentParams;
+	}
+
 	//--------------------------------------------------------
 	// Apply state changes (order kept similar to original when relevant)
 	//--------------------------------------------------------
@@ -652,9 +706,14 @@ void CGSH_OpenGL::SetRenderingContext(uint64 primReg)
 		CHECKGLERROR();
 	}
 
-	if(framebufferRelatedChanged)
+	if(colorMaskChanged)
+	{
+		SetupColorMask(frameReg, testReg);
+	}
+
+	if(framebufferChanged)
 	{
-		SetupFramebuffer(frameReg, zbufReg, scissorReg, testReg);
+		SetupFramebuffer(frameReg, zbufReg, scissorReg);
 		CHECKGLERROR();
 	}
 
@@ -670,6 +729,28 @@ void CGSH_OpenGL::SetRenderingContext(uint64 primReg)
 		CHECKGLERROR();
 	}
 
+	if(hasPendingDraw && !IsSameDrawState(pendingRenderState, pendingVertexParams, pendingFragmentParams))
+	{
+		//Draw pending vertices with the state they were recorded with, then restore the new state.
+		uint32 validGlStateForNewState = m_validGlState;
+		std::swap(m_renderState, pendingRenderState);
+		std::swap(m_vertexParams, pendingVertexParams);
+		std::swap(m_fragmentParams, pendingFragmentParams);
+		m_validGlState = pendingValidGlState;
+
+		FlushVertexBuffer();
+
+		GLuint boundShaderHandle = m_renderState.shaderHandle;
+		std::swap(m_renderState, pendingRenderState);
+		std::swap(m_vertexParams, pendingVertexParams);
+		std::swap(m_fragmentParams, pendingFragmentParams);
+		m_renderState.shaderHandle = boundShaderHandle;
+		//The draw applied the pending state on the GL context, everything that wasn't valid
+		//for the new state needs to be applied again, even if it was already invalid when
+		//the pending vertices were recorded.
+		m_validGlState &= validGlStateForNewState;
+	}
+
 	auto offset = make_convertible<XYOFFSET>(m_nReg[GS_REG_XYOFFSET_1 + context]);
 	m_nPrimOfsX = offset.GetX();
 	m_nPrimOfsY = offset.GetY();
@@ -703,208 +784,252 @@ void CGSH_OpenGL::SetupBlendingFunction(uint64 alphaReg)
 		return;
 	}
 
-	int nFunction = GL_FUNC_ADD;
+	GLenum nFunction = GL_FUNC_ADD;
+	GLenum srcFactor = GL_ONE;
+	GLenum dstFactor = GL_ZERO;
+	float blendConstant = 0;
 	if((alpha.nA == alpha.nB) && (alpha.nD == ALPHABLEND_ABD_CS))
 	{
 		//ab*0 (when a == b) - Cs
-		glBlendFuncSeparate(GL_ONE, GL_ZERO, GL_ONE, GL_ZERO);
+		srcFactor = GL_ONE;
+		dstFactor = GL_ZERO;
 	}
 	else if((alpha.nA == alpha.nB) && (alpha.nD == ALPHABLEND_ABD_CD))
 	{
 		//ab*1 (when a == b) - Cd
-		glBlendFuncSeparate(GL_ZERO, GL_ONE, GL_ONE, GL_ZERO);
+		srcFactor = GL_ZERO;
+		dstFactor = GL_ONE;
 	}
 	else if((alpha.nA == alpha.nB) && (alpha.nD == ALPHABLEND_ABD_ZERO))
 	{
 		//ab*2 (when a == b) - Zero
-		glBlendFuncSeparate(GL_ZERO, GL_ZERO, GL_ONE, GL_ZERO);
+		srcFactor = GL_ZERO;
+		dstFactor = GL_ZERO;
 	}
 	else if((alpha.nA == ALPHABLEND_ABD_CS) && (alpha.nB == ALPHABLEND_ABD_CD) && (alpha.nC == ALPHABLEND_C_AS) && (alpha.nD == ALPHABLEND_ABD_CD))
 	{
 		//0101 - Cs * As + Cd * (1 - As)
-		glBlendFuncSeparate(BLEND_SRC_ALPHA, BLEND_ONE_MINUS_SRC_ALPHA, GL_ONE, GL_ZERO);
+		srcFactor = BLEND_SRC_ALPHA;
+		dstFactor = BLEND_ONE_MINUS_SRC_ALPHA;
 	}
 	else if((alpha.nA == 0) && (alpha.nB == 1) && (alpha.nC == 1) && (alpha.nD == 1))
 	{
 		//Cs * Ad + Cd * (1 - Ad)
-		glBlendFuncSeparate(GL_DST_ALPHA, GL_ONE_MINUS_DST_ALPHA, GL_ONE, GL_ZERO);
+		srcFactor = GL_DST_ALPHA;
+		dstFactor = GL_ONE_MINUS_DST_ALPHA;
 	}
 	else if((alpha.nA == 0) && (alpha.nB == 1) && (alpha.nC == 2) && (alpha.nD == 1))
 	{
 		if(alpha.nFix == 0x80)
 		{
-			glBlendFuncSeparate(GL_ONE, GL_ZERO, GL_ONE, GL_ZERO);
+			srcFactor = GL_ONE;
+			dstFactor = GL_ZERO;
 		}
 		else
 		{
 			//Source alpha value is implied in the formula
 			//As = FIX / 0x80
-			glBlendColor(0.0f, 0.0f, 0.0f, (float)alpha.nFix / 128.0f);
-			glBlendFuncSeparate(GL_CONSTANT_ALPHA, GL_ONE_MINUS_CONSTANT_ALPHA, GL_ONE, GL_ZERO);
+			blendConstant = static_cast<float>(alpha.nFix) / 128.0f;
+			srcFactor = GL_CONSTANT_ALPHA;
+			dstFactor = GL_ONE_MINUS_CONSTANT_ALPHA;
 		}
 	}
 	else if((alpha.nA == 0) && (alpha.nB == 2) && (alpha.nC == 0) && (alpha.nD == 1))
 	{
-		glBlendFuncSeparate(BLEND_SRC_ALPHA, GL_ONE, GL_ONE, GL_ZERO);
+		srcFactor = BLEND_SRC_ALPHA;
+		dstFactor = GL_ONE;
 	}
 	else if((alpha.nA == 0) && (alpha.nB == 2) && (alpha.nC == 0) && (alpha.nD == 2))
 	{
 		//Cs * As
-		glBlendFuncSeparate(BLEND_SRC_ALPHA, GL_ZERO, GL_ONE, GL_ZERO);
+		srcFactor = BLEND_SRC_ALPHA;
+		dstFactor = GL_ZERO;
 	}
 	else if((alpha.nA == 0) && (alpha.nB == 2) && (alpha.nC == 1) && (alpha.nD == 1))
 	{
 		//Cs * Ad + Cd
-		glBlendFuncSeparate(GL_DST_ALPHA, GL_ONE, GL_ONE, GL_ZERO);
+		srcFactor = GL_DST_ALPHA;
+		dstFactor = GL_ONE;
 	}
 	else if((alpha.nA == 0) && (alpha.nB == 2) && (alpha.nC == 2) && (alpha.nD == 1))
 	{
 		if(alpha.nFix == 0x80)
 		{
-			glBlendFuncSeparate(GL_ONE, GL_ONE, GL_ONE, GL_ZERO);
+			srcFactor = GL_ONE;
+			dstFactor = GL_ONE;
 		}
 		else
 		{
 			//Cs * FIX + Cd
-			glBlendColor(0, 0, 0, static_cast<float>(alpha.nFix) / 128.0f);
-			glBlendFuncSeparate(GL_CONSTANT_ALPHA, GL_ONE, GL_ONE, GL_ZERO);
+			blendConstant = static_cast<float>(alpha.nFix) / 128.0f;
+			srcFactor = GL_CONSTANT_ALPHA;
+			dstFactor = GL_ONE;
 		}
 	}
 	else if((alpha.nA == ALPHABLEND_ABD_CS) && (alpha.nB == ALPHABLEND_ABD_ZERO) && (alpha.nC == ALPHABLEND_C_FIX) && (alpha.nD == ALPHABLEND_ABD_ZERO))
 	{
 		//0222 - Cs * FIX
-		glBlendColor(0, 0, 0, static_cast<float>(alpha.nFix) / 128.0f);
-		glBlendFuncSeparate(GL_CONSTANT_ALPHA, GL_ZERO, GL_ONE, GL_ZERO);
+		blendConstant = static_cast<float>(alpha.nFix) / 128.0f;
+		srcFactor = GL_CONSTANT_ALPHA;
+		dstFactor = GL_ZERO;
 	}
 	else if((alpha.nA == 1) && (alpha.nB == 0) && (alpha.nC == 0) && (alpha.nD == 0))
 	{
 		//(Cd - Cs) * As + Cs
-		glBlendFuncSeparate(BLEND_ONE_MINUS_SRC_ALPHA, BLEND_SRC_ALPHA, GL_ONE, GL_ZERO);
+		srcFactor = BLEND_ONE_MINUS_SRC_ALPHA;
+		dstFactor = BLEND_SRC_ALPHA;
 	}
 	else if((alpha.nA == ALPHABLEND_ABD_CD) && (alpha.nB == ALPHABLEND_ABD_CS) && (alpha.nC == ALPHABLEND_C_AS) && (alpha.nD == ALPHABLEND_ABD_CD))
 	{
 		//1001 -> (Cd - Cs) * As + Cd (Inaccurate, needs +1 to As)
 		nFunction = GL_FUNC_REVERSE_SUBTRACT;
-		glBlendFuncSeparate(BLEND_SRC_ALPHA, BLEND_SRC_ALPHA, GL_ONE, GL_ZERO);
+		srcFactor = BLEND_SRC_ALPHA;
+		dstFactor = BLEND_SRC_ALPHA;
 	}
 	else if((alpha.nA == ALPHABLEND_ABD_CD) && (alpha.nB == ALPHABLEND_ABD_CS) && (alpha.nC == ALPHABLEND_C_AS) && (alpha.nD == ALPHABLEND_ABD_ZERO))
 	{
 		//1002 -> (Cd - Cs) * As
 		nFunction = GL_FUNC_REVERSE_SUBTRACT;
-		glBlendFuncSeparate(BLEND_SRC_ALPHA, BLEND_SRC_ALPHA, GL_ONE, GL_ZERO);
+		srcFactor = BLEND_SRC_ALPHA;
+		dstFactor = BLEND_SRC_ALPHA;
 	}
 	else if((alpha.nA == ALPHABLEND_ABD_CD) && (alpha.nB == ALPHABLEND_ABD_CS) && (alpha.nC == ALPHABLEND_C_AD) && (alpha.nD == ALPHABLEND_ABD_CS))
 	{
 		//1010 -> Cs * (1 - Ad) + Cd * Ad
-		glBlendFuncSeparate(GL_ONE_MINUS_DST_ALPHA, GL_DST_ALPHA, GL_ONE, GL_ZERO);
+		srcFactor = GL_ONE_MINUS_DST_ALPHA;
+		dstFactor = GL_DST_ALPHA;
 	}
 	else if((alpha.nA == ALPHABLEND_ABD_CD) && (alpha.nB == ALPHABLEND_ABD_CS) && (alpha.nC == ALPHABLEND_C_FIX) && (alpha.nD == ALPHABLEND_ABD_CS))
 	{
 		//1020 -> Cs * (1 - FIX) + Cd * FIX
-		glBlendColor(0, 0, 0, static_cast<float>(alpha.nFix) / 128.0f);
-		glBlendFuncSeparate(GL_ONE_MINUS_CONSTANT_ALPHA, GL_CONSTANT_ALPHA, GL_ONE, GL_ZERO);
+		blendConstant = static_cast<float>(alpha.nFix) / 128.0f;
+		srcFactor = GL_ONE_MINUS_CONSTANT_ALPHA;
+		dstFactor = GL_CONSTANT_ALPHA;
 	}
 	else if((alpha.nA == ALPHABLEND_ABD_CD) && (alpha.nB == ALPHABLEND_ABD_CS) && (alpha.nC == ALPHABLEND_C_FIX) && (alpha.nD == ALPHABLEND_ABD_CD))
 	{
 		//1021 -> (Cd - Cs) * FIX + Cd
 		nFunction = GL_FUNC_REVERSE_SUBTRACT;
-		glBlendColor(0.0f, 0.0f, 0.0f, (float)alpha.nFix / 128.0f);
-		glBlendFuncSeparate(GL_CONSTANT_ALPHA, GL_ONE, GL_ONE, GL_ZERO);
+		blendConstant = static_cast<float>(alpha.nFix) / 128.0f;
+		srcFactor = GL_CONSTANT_ALPHA;
+		dstFactor = GL_ONE;
 	}
 	else if((alpha.nA == 1) && (alpha.nB == 0) && (alpha.nC == 2) && (alpha.nD == 2))
 	{
 		nFunction = GL_FUNC_REVERSE_SUBTRACT;
-		glBlendColor(0.0f, 0.0f, 0.0f, (float)alpha.nFix / 128.0f);
-		glBlendFuncSeparate(GL_CONSTANT_ALPHA, GL_CONSTANT_ALPHA, GL_ONE, GL_ZERO);
+		blendConstant = static_cast<float>(alpha.nFix) / 128.0f;
+		srcFactor = GL_CONSTANT_ALPHA;
+		dstFactor = GL_CONSTANT_ALPHA;
 	}
 	else if((alpha.nA == 1) && (alpha.nB == 2) && (alpha.nC == 0) && (alpha.nD == 0))
 	{
 		//Cd * As + Cs
-		glBlendFuncSeparate(GL_ONE, BLEND_SRC_ALPHA, GL_ONE, GL_ZERO);
+		srcFactor = GL_ONE;
+		dstFactor = BLEND_SRC_ALPHA;
 	}
 	else if((alpha.nA == ALPHABLEND_ABD_CD) && (alpha.nB == ALPHABLEND_ABD_ZERO) && (alpha.nC == ALPHABLEND_C_AS) && (alpha.nD == ALPHABLEND_ABD_CD))
 	{
 		//1201 -> Cd * (As + 1)
 		//Relies on colorOutputWhite shader cap
-		glBlendFuncSeparate(GL_DST_COLOR, BLEND_SRC_ALPHA, GL_ONE, GL_ZERO);
+		srcFactor = GL_DST_COLOR;
+		dstFactor = BLEND_SRC_ALPHA;
 	}
 	else if((alpha.nA == ALPHABLEND_ABD_CD) && (alpha.nB == ALPHABLEND_ABD_ZERO) && (alpha.nC == ALPHABLEND_C_AS) && (alpha.nD == ALPHABLEND_ABD_ZERO))
 	{
 		//1202 - Cd * As
-		glBlendFuncSeparate(GL_ZERO, BLEND_SRC_ALPHA, GL_ONE, GL_ZERO);
+		srcFactor = GL_ZERO;
+		dstFactor = BLEND_SRC_ALPHA;
 	}
 	else if((alpha.nA == ALPHABLEND_ABD_CD) && (alpha.nB == ALPHABLEND_ABD_ZERO) && (alpha.nC == ALPHABLEND_C_AD) && (alpha.nD == ALPHABLEND_ABD_CS))
 	{
 		//1210 - Cs + (Cd * Ad)
-		glBlendFuncSeparate(GL_ONE, GL_DST_ALPHA, GL_ONE, GL_ZERO);
+		srcFactor = GL_ONE;
+		dstFactor = GL_DST_ALPHA;
 	}
 	else if((alpha.nA == ALPHABLEND_ABD_CD) && (alpha.nB == ALPHABLEND_ABD_ZERO) && (alpha.nC == ALPHABLEND_C_AD) && (alpha.nD == ALPHABLEND_ABD_ZERO))
 	{
 		//1212 - Cd * Ad
-		glBlendFuncSeparate(GL_ZERO, GL_DST_ALPHA, GL_ONE, GL_ZERO);
+		srcFactor = GL_ZERO;
+		dstFactor = GL_DST_ALPHA;
 	}
 	else if((alpha.nA == ALPHABLEND_ABD_CD) && (alpha.nB == ALPHABLEND_ABD_ZERO) && (alpha.nC == ALPHABLEND_C_FIX) && (alpha.nD == ALPHABLEND_ABD_CS))
 	{
 		//1220 -> Cd * FIX + Cs
-		glBlendColor(0, 0, 0, static_cast<float>(alpha.nFix) / 128.0f);
-		glBlendFuncSeparate(GL_ONE, GL_CONSTANT_ALPHA, GL_ONE, GL_ZERO);
+		blendConstant = static_cast<float>(alpha.nFix) / 128.0f;
+		srcFactor = GL_ONE;
+		dstFactor = GL_CONSTANT_ALPHA;
 	}
 	else if((alpha.nA == ALPHABLEND_ABD_CD) && (alpha.nB == ALPHABLEND_ABD_ZERO) && (alpha.nC == ALPHABLEND_C_FIX) && (alpha.nD == ALPHABLEND_ABD_CD))
 	{
 		//1221 -> Cd * (1 + FIX)
 		//Relies on colorOutputWhite shader cap
-		glBlendColor(0, 0, 0, static_cast<float>(alpha.nFix) / 128.0f);
-		glBlendFuncSeparate(GL_DST_COLOR, GL_CONSTANT_ALPHA, GL_ONE, GL_ZERO);
+		blendConstant = static_cast<float>(alpha.nFix) / 128.0f;
+		srcFactor = GL_DST_COLOR;
+		dstFactor = GL_CONSTANT_ALPHA;
 	}
 	else if((alpha.nA == 1) && (alpha.nB == 2) && (alpha.nC == 2) && (alpha.nD == 2))
 	{
 		//1222 -> Cd * FIX
-		glBlendColor(0, 0, 0, static_cast<float>(alpha.nFix) / 128.0f);
-		glBlendFuncSeparate(GL_ZERO, GL_CONSTANT_ALPHA, GL_ONE, GL_ZERO);
+		blendConstant = static_cast<float>(alpha.nFix) / 128.0f;
+		srcFactor = GL_ZERO;
+		dstFactor = GL_CONSTANT_ALPHA;
 	}
 	else if((alpha.nA == ALPHABLEND_ABD_ZERO) && (alpha.nB == ALPHABLEND_ABD_CS) && (alpha.nC == ALPHABLEND_C_AS) && (alpha.nD == ALPHABLEND_ABD_CS))
 	{
 		//2000 -> Cs * (1 - As)
-		glBlendFuncSeparate(BLEND_ONE_MINUS_SRC_ALPHA, GL_ZERO, GL_ONE, GL_ZERO);
+		srcFactor = BLEND_ONE_MINUS_SRC_ALPHA;
+		dstFactor = GL_ZERO;
 	}
 	else if((alpha.nA == ALPHABLEND_ABD_ZERO) && (alpha.nB == ALPHABLEND_ABD_CS) && (alpha.nC == ALPHABLEND_C_AS) && (alpha.nD == ALPHABLEND_ABD_CD))
 	{
 		//2001 -> Cd - Cs * As
 		nFunction = GL_FUNC_REVERSE_SUBTRACT;
-		glBlendFuncSeparate(BLEND_SRC_ALPHA, GL_ONE, GL_ONE, GL_ZERO);
+		srcFactor = BLEND_SRC_ALPHA;
+		dstFactor = GL_ONE;
 	}
 	else if((alpha.nA == ALPHABLEND_ABD_ZERO) && (alpha.nB == ALPHABLEND_ABD_CS) && (alpha.nC == ALPHABLEND_C_AD) && (alpha.nD == ALPHABLEND_ABD_CD))
 	{
 		//2011 -> Cd - Cs * Ad
 		nFunction = GL_FUNC_REVERSE_SUBTRACT;
-		glBlendFuncSeparate(GL_DST_ALPHA, GL_ONE, GL_ONE, GL_ZERO);
+		srcFactor = GL_DST_ALPHA;
+		dstFactor = GL_ONE;
 	}
 	else if((alpha.nA == ALPHABLEND_ABD_ZERO) && (alpha.nB == ALPHABLEND_ABD_CS) && (alpha.nC == ALPHABLEND_C_FIX) && (alpha.nD == ALPHABLEND_ABD_CD))
 	{
 		//2021 -> Cd - Cs * FIX
 		nFunction = GL_FUNC_REVERSE_SUBTRACT;
-		glBlendColor(0, 0, 0, static_cast<float>(alpha.nFix) / 128.0f);
-		glBlendFuncSeparate(GL_CONSTANT_ALPHA, GL_ONE, GL_ONE, GL_ZERO);
+		blendConstant = static_cast<float>(alpha.nFix) / 128.0f;
+		srcFactor = GL_CONSTANT_ALPHA;
+		dstFactor = GL_ONE;
 	}
 	else if((alpha.nA == ALPHABLEND_ABD_ZERO) && (alpha.nB == ALPHABLEND_ABD_CD) && (alpha.nC == ALPHABLEND_C_AS) && (alpha.nD == ALPHABLEND_ABD_CD))
 	{
 		//2101 -> Cd * (1 - As)
-		glBlendFuncSeparate(GL_ZERO, BLEND_ONE_MINUS_SRC_ALPHA, GL_ONE, GL_ZERO);
+		srcFactor = GL_ZERO;
+		dstFactor = BLEND_ONE_MINUS_SRC_ALPHA;
 	}
 	else if((alpha.nA == ALPHABLEND_ABD_ZERO) && (alpha.nB == ALPHABLEND_ABD_CD) && (alpha.nC == ALPHABLEND_C_FIX) && (alpha.nD == ALPHABLEND_ABD_CD))
 	{
 		//2121 -> Cd * (1 - FIX)
-		glBlendColor(0, 0, 0, static_cast<float>(alpha.nFix) / 128.0f);
-		glBlendFuncSeparate(GL_ZERO, GL_ONE_MINUS_CONSTANT_ALPHA, GL_ONE, GL_ZERO);
+		blendConstant = static_cast<float>(alpha.nFix) / 128.0f;
+		srcFactor = GL_ZERO;
+		dstFactor = GL_ONE_MINUS_CONSTANT_ALPHA;
 	}
 	else
 	{
 		assert(0);
 		//Default blending
-		glBlendFuncSeparate(GL_ONE, GL_ZERO, GL_ONE, GL_ZERO);
+		srcFactor = GL_ONE;
+		dstFactor = GL_ZERO;
 	}
 
-	glBlendEquationSeparate(nFunction, GL_FUNC_ADD);
+	//Applied lazily in DoRenderPass, this allows draws using equivalent
+	//blending setups to be batched together
+	m_renderState.blendEquation = nFunction;
+	m_renderState.blendSrcFactor = srcFactor;
+	m_renderState.blendDstFactor = dstFactor;
+	m_renderState.blendConstant = blendConstant;
+	m_validGlState &= ~GLSTATE_BLENDFUNC;
 }
 
 void CGSH_OpenGL::SetupTestFunctions(uint64 testReg)
@@ -919,7 +1044,7 @@ void CGSH_OpenGL::SetupTestFunctions(uint64 testReg)
 
 	if(test.nDepthEnabled)
 	{
-		unsigned int nFunc = GL_NEVER;
+		GLenum nFunc = GL_NEVER;
 
 		switch(test.nDepthMethod)
 		{
@@ -937,7 +1062,8 @@ void CGSH_OpenGL::SetupTestFunctions(uint64 testReg)
 			break;
 		}
 
-		glDepthFunc(nFunc);
+		m_renderState.depthFunc = nFunc;
+		m_validGlState &= ~GLSTATE_DEPTHFUNC;
 	}
 }
 
@@ -959,13 +1085,11 @@ void CGSH_OpenGL::SetupDepthBuffer(uint64 zbufReg, uint64 testReg)
 	m_validGlState &= ~GLSTATE_DEPTHMASK;
 }
 
-void CGSH_OpenGL::SetupFramebuffer(uint64 frameReg, uint64 zbufReg, uint64 scissorReg, uint64 testReg)
+void CGSH_OpenGL::SetupColorMask(uint64 frameReg, uint64 testReg)
 {
 	if(frameReg == 0) return;
 
 	auto frame = make_convertible<FRAME>(frameReg);
-	auto zbuf = make_convertible<ZBUF>(zbufReg);
-	auto scissor = make_convertible<SCISSOR>(scissorReg);
 	auto test = make_convertible<TEST>(testReg);
 
 	bool r = (frame.nMask & 0x000000FF) == 0;
@@ -996,6 +1120,15 @@ void CGSH_OpenGL::SetupFramebuffer(uint64 frameReg, uint64 zbufReg, uint64 sciss
 	m_renderState.colorMaskB = b;
 	m_renderState.colorMaskA = a;
 	m_validGlState &= ~GLSTATE_COLORMASK;
+}
+
+void CGSH_OpenGL::SetupFramebuffer(uint64 frameReg, uint64 zbufReg, uint64 scissorReg)
+{
+	if(frameReg == 0) return;
+
+	auto frame = make_convertible<FRAME>(frameReg);
+	auto zbuf = make_convertible<ZBUF>(zbufReg);
+	auto scissor = make_convertible<SCISSOR>(scissorReg);
 
 	//Check if we're drawing into a buffer that's been used for depth before
 	{
@@ -1009,7 +1142,7 @@ void CGSH_OpenGL::SetupFramebuffer(uint64 frameReg, uint64 zbufReg, uint64 sciss
 	if(!framebuffer)
 	{
 		framebuffer = FramebufferPtr(new CFramebuffer(frame.GetBasePtr(), frame.GetWidth(), FRAMEBUFFER_HEIGHT, frame.nPsm, m_fbScale, m_multisampleEnabled));
-		m_framebuffers.push_back(framebuffer);
+		AddFramebuffer(framebuffer);
 		PopulateFramebuffer(framebuffer);
 	}
 
@@ -1019,7 +1152,7 @@ void CGSH_OpenGL::SetupFramebuffer(uint64 frameReg, uint64 zbufReg, uint64 sciss
 	if(!depthbuffer)
 	{
 		depthbuffer = DepthbufferPtr(new CDepthbuffer(zbuf.GetBasePtr(), frame.GetWidth(), FRAMEBUFFER_HEIGHT, zbuf.nPsm, m_fbScale, m_multisampleEnabled));
-		m_depthbuffers.push_back(depthbuffer);
+		AddDepthbuffer(depthbuffer);
 	}
 
 	assert(framebuffer->m_width == depthbuffer->m_width);
@@ -1070,6 +1203,56 @@ void CGSH_OpenGL::SetupFogColor(uint64 fogColReg)
 	m_validGlState &= ~GLSTATE_FRAGMENT_PARAMS;
 }
 
+bool CGSH_OpenGL::IsSameDrawState(const RENDERSTATE& renderState, const VERTEXPARAMS& vertexParams, const FRAGMENTPARAMS& fragmentParams) const
+{
+	//Checks if a draw recorded with the specified state would render the same way as one using the current state
+	const auto& currState = m_renderState;
+	if(static_cast<uint32>(currState.shaderCaps) != static_cast<uint32>(renderState.shaderCaps)) return false;
+	if(currState.framebufferHandle != renderState.framebufferHandle) return false;
+	if((currState.texture0Handle != renderState.texture0Handle) ||
+	   (currState.texture0MinFilter != renderState.texture0MinFilter) ||
+	   (currState.texture0MagFilter != renderState.texture0MagFilter) ||
+	   (currState.texture0WrapS != renderState.texture0WrapS) ||
+	   (currState.texture0WrapT != renderState.texture0WrapT) ||
+	   (currState.texture0AlphaAsIndex != renderState.texture0AlphaAsIndex) ||
+	   (currState.texture1Handle != renderState.texture1Handle))
+	{
+		return false;
+	}
+	if((currState.viewportWidth != renderState.viewportWidth) ||
+	   (currState.viewportHeight != renderState.viewportHeight) ||
+	   (currState.scissorX != renderState.scissorX) ||
+	   (currState.scissorY != renderState.scissorY) ||
+	   (currState.scissorWidth != renderState.scissorWidth) ||
+	   (currState.scissorHeight != renderState.scissorHeight))
+	{
+		return false;
+	}
+	if(currState.blendEnabled != renderState.blendEnabled) return false;
+	//Blending function doesn't matter if blending is disabled
+	if(currState.blendEnabled &&
+	   ((currState.blendEquation != renderState.blendEquation) ||
+	    (currState.blendSrcFactor != renderState.blendSrcFactor) ||
+	    (currState.blendDstFactor != renderState.blendDstFactor) ||
+	    (currState.blendConstant != renderState.blendConstant)))
+	{
+		return false;
+	}
+	if((currState.colorMaskR != renderState.colorMaskR) ||
+	   (currState.colorMaskG != renderState.colorMaskG) ||
+	   (currState.colorMaskB != renderState.colorMaskB) ||
+	   (currState.colorMaskA != renderState.colorMaskA))
+	{
+		return false;
+	}
+	if(currState.depthMask != renderState.depthMask) return false;
+	if(currState.depthTest != renderState.depthTest) return false;
+	if(currState.depthTest && (currState.depthFunc != renderState.depthFunc)) return false;
+	if(memcmp(&m_vertexParams, &vertexParams, sizeof(VERTEXPARAMS)) != 0) return false;
+	if(memcmp(&m_fragmentParams, &fragmentParams, sizeof(FRAGMENTPARAMS)) != 0) return false;
+	return true;
+}
+
 bool CGSH_OpenGL::CanRegionRepeatClampModeSimplified(uint32 clampMin, uint32 clampMax)
 {
 	for(unsigned int j = 1; j < 0x3FF; j = ((j << 1) | 1))
@@ -1363,26 +1546,108 @@ void CGSH_OpenGL::SetupTexture(uint64 primReg, uint64 tex0Reg, uint64 tex1Reg, u
 	m_validGlState &= ~GLSTATE_FRAGMENT_PARAMS;
 }
 
+uint64 CGSH_OpenGL::MakeBufferKey(uint32 basePtr, uint32 width)
+{
+	return (static_cast<uint64>(basePtr) << 32) | width;
+}
+
+void CGSH_OpenGL::AddFramebuffer(const FramebufferPtr& framebuffer)
+{
+	m_framebuffers.push_back(framebuffer);
+	m_framebufferIndex[MakeBufferKey(framebuffer->m_basePtr, framebuffer->m_width)].push_back(framebuffer);
+
+	uint32 areaSize = framebuffer->m_cachedArea.GetSize();
+	if(areaSize == 0) return;
+
+	uint32 startPage = std::min<uint32>(framebuffer->m_basePtr / CGsPixelFormats::PAGESIZE, FRAMEBUFFER_PAGE_INDEX_SIZE - 1);
+	uint32 endPage = std::min<uint32>((framebuffer->m_basePtr + areaSize - 1) / CGsPixelFormats::PAGESIZE, FRAMEBUFFER_PAGE_INDEX_SIZE - 1);
+	for(uint32 page = startPage; page <= endPage; page++)
+	{
+		m_framebufferPageIndex[page].push_back(framebuffer.get());
+	}
+}
+
+void CGSH_OpenGL::AddDepthbuffer(const DepthbufferPtr& depthbuffer)
+{
+	m_depthbuffers.push_back(depthbuffer);
+	m_depthbufferIndex.insert(std::make_pair(MakeBufferKey(depthbuffer->m_basePtr, depthbuffer->m_width), depthbuffer));
+}
+
+void CGSH_OpenGL::ClearFramebuffers()
+{
+	m_framebuffers.clear();
+	m_depthbuffers.clear();
+	m_framebufferIndex.clear();
+	m_depthbufferIndex.clear();
+	for(auto& pageFramebuffers : m_framebufferPageIndex)
+	{
+		pageFramebuffers.clear();
+	}
+}
+
+const CGSH_OpenGL::FramebufferList* CGSH_OpenGL::FindFramebufferCandidates(uint32 basePtr, uint32 width) const
+{
+	//Returns framebuffers starting at basePtr with the specified width, in creation order
+	auto indexIterator = m_framebufferIndex.find(MakeBufferKey(basePtr, width));
+	return (indexIterator != std::end(m_framebufferIndex)) ? &indexIterator->second : nullptr;
+}
+
+void CGSH_OpenGL::InvalidateFramebuffers(uint32 address, uint32 size, bool isUpperByteTransfer)
+{
+	if(size == 0) return;
+
+	uint32 startPage = std::min<uint32>(address / CGsPixelFormats::PAGESIZE, FRAMEBUFFER_PAGE_INDEX_SIZE - 1);
+	uint32 endPage = std::min<uint32>((address + size - 1) / CGsPixelFormats::PAGESIZE, FRAMEBUFFER_PAGE_INDEX_SIZE - 1);
+	for(uint32 page = startPage; page <= endPage; page++)
+	{
+		for(auto framebuffer : m_framebufferPageIndex[page])
+		{
+			//Framebuffers cover contiguous pages, only visit them on the first page they share with the range
+			uint32 framebufferStartPage = std::min<uint32>(framebuffer->m_basePtr / CGsPixelFormats::PAGESIZE, FRAMEBUFFER_PAGE_INDEX_SIZE - 1);
+			if(std::max(framebufferStartPage, startPage) != page) continue;
+			if((framebuffer->m_psm == PSMCT24) && isUpperByteTransfer) continue;
+			framebuffer->m_cachedArea.Invalidate(address, size);
+			m_resourceCacheStats.framebufferInvalidations++;
+		}
+	}
+}
+
 CGSH_OpenGL::FramebufferPtr CGSH_OpenGL::FindFramebuffer(const FRAME& frame) const
 {
-	auto framebufferIterator = std::find_if(std::begin(m_framebuffers), std::end(m_framebuffers),
-	                                        [&](const FramebufferPtr& framebuffer) {
-		                                        return (framebuffer->m_basePtr == frame.GetBasePtr()) &&
-		                                               IsCompatibleFramebufferPSM(framebuffer->m_psm, frame.nPsm) &&
-		                                               (framebuffer->m_width == frame.GetWidth());
-	                                        });
+	if(auto candidateFramebuffers = FindFramebufferCandidates(frame.GetBasePtr(), frame.GetWidth()))
+	{
+		for(const auto& framebuffer : *candidateFramebuffers)
+		{
+			m_resourceCacheStats.framebufferProbes++;
+			if(IsCompatibleFramebufferPSM(framebuffer->m_psm, frame.nPsm))
+			{
+				m_resourceCacheStats.framebufferHits++;
+				return framebuffer;
+			}
+		}
+	}
 
-	return (framebufferIterator != std::end(m_framebuffers)) ? *(framebufferIterator) : FramebufferPtr();
+	m_resourceCacheStats.framebufferMisses++;
+	return FramebufferPtr();
 }
 
 CGSH_OpenGL::DepthbufferPtr CGSH_OpenGL::FindDepthbuffer(const ZBUF& zbuf, const FRAME& frame) const
 {
-	auto depthbufferIterator = std::find_if(std::begin(m_depthbuffers), std::end(m_depthbuffers),
-	                                        [&](const DepthbufferPtr& depthbuffer) {
-		                                        return (depthbuffer->m_basePtr == zbuf.GetBasePtr()) && (depthbuffer->m_width == frame.GetWidth());
-	                                        });
+	auto depthbufferIterator = m_depthbufferIndex.find(MakeBufferKey(zbuf.GetBasePtr(), frame.GetWidth()));
+	if(depthbufferIterator == std::end(m_depthbufferIndex))
+	{
+		m_resourceCacheStats.depthbufferMisses++;
+		return DepthbufferPtr();
+	}
 
-	return (depthbufferIterator != std::end(m_depthbuffers)) ? *(depthbufferIterator) : DepthbufferPtr();
+	m_resourceCacheStats.depthbufferHits++;
+	return depthbufferIterator->second;
+}
+
+CGSH_OpenGL::RESOURCE_CACHE_STATS CGSH_OpenGL::GetResourceCacheStats()
+{
+	std::lock_guard<std::mutex> statsLock(m_lastResourceCacheStatsMutex);
+	return m_lastResourceCacheStats;
 }
 
 /////////////////////////////////////////////////////////////
@@ -1716,6 +1981,9 @@ void CGSH_OpenGL::FlushVertexBuffer()
 
 void CGSH_OpenGL::DoRenderPass()
 {
+	//Textures used by this draw might still be decoding
+	CompletePendingTextureUploads();
+
 	if((m_validGlState & GLSTATE_VERTEX_PARAMS) == 0)
 	{
 		glBindBuffer(GL_UNIFORM_BUFFER, m_vertexParamsBuffer);
@@ -1758,12 +2026,26 @@ void CGSH_OpenGL::DoRenderPass()
 		m_validGlState |= GLSTATE_BLEND;
 	}
 
+	if((m_validGlState & GLSTATE_BLENDFUNC) == 0)
+	{
+		glBlendColor(0, 0, 0, m_renderState.blendConstant);
+		glBlendFuncSeparate(m_renderState.blendSrcFactor, m_renderState.blendDstFactor, GL_ONE, GL_ZERO);
+		glBlendEquationSeparate(m_renderState.blendEquation, GL_FUNC_ADD);
+		m_validGlState |= GLSTATE_BLENDFUNC;
+	}
+
 	if((m_validGlState & GLSTATE_DEPTHTEST) == 0)
 	{
 		m_renderState.depthTest ? glEnable(GL_DEPTH_TEST) : glDisable(GL_DEPTH_TEST);
 		m_validGlState |= GLSTATE_DEPTHTEST;
 	}
 
+	if((m_validGlState & GLSTATE_DEPTHFUNC) == 0)
+	{
+		glDepthFunc(m_renderState.depthFunc);
+		m_validGlState |= GLSTATE_DEPTHFUNC;
+	}
+
 	if((m_validGlState & GLSTATE_COLORMASK) == 0)
 	{
 		glColorMask(
@@ -1812,30 +2094,31 @@ void CGSH_OpenGL::DoRenderPass()
 
 	glBindVertexArray(m_primVertexArray);
 
-	GLenum primitiveMode = GL_NONE;
-	switch(m_primitiveType)
+	GLenum primitiveMode = GetPrimitiveMode(m_primitiveType);
+	assert(primitiveMode != GL_NONE);
+
+	glDrawArrays(primitiveMode, 0, m_vertexBuffer.size());
+
+	m_drawCallCount++;
+}
+
+GLenum CGSH_OpenGL::GetPrimitiveMode(unsigned int primitiveType)
+{
+	switch(primitiveType)
 	{
 	case PRIM_POINT:
-		primitiveMode = GL_POINTS;
-		break;
+		return GL_POINTS;
 	case PRIM_LINE:
 	case PRIM_LINESTRIP:
-		primitiveMode = GL_LINES;
-		break;
+		return GL_LINES;
 	case PRIM_TRIANGLE:
 	case PRIM_TRIANGLESTRIP:
 	case PRIM_TRIANGLEFAN:
 	case PRIM_SPRITE:
-		primitiveMode = GL_TRIANGLES;
-		break;
+		return GL_TRIANGLES;
 	default:
-		assert(false);
-		break;
+		return GL_NONE;
 	}
-
-	glDrawArrays(primitiveMode, 0, m_vertexBuffer.size());
-
-	m_drawCallCount++;
 }
 
 void CGSH_OpenGL::DrawToDepth(unsigned int primitiveType, uint64 primReg)
@@ -1945,7 +2228,9 @@ void CGSH_OpenGL::WriteRegisterImpl(uint8 nRegister, uint64 nData)
 void CGSH_OpenGL::ProcessPrim(uint64 value)
 {
 	unsigned int newPrimitiveType = static_cast<unsigned int>(value & 0x07);
-	if(newPrimitiveType != m_primitiveType)
+	//All primitive types are expanded into points, lines or triangles,
+	//vertices can be kept in the same batch if they end up using the same topology
+	if(GetPrimitiveMode(newPrimitiveType) != GetPrimitiveMode(m_primitiveType))
 	{
 		FlushVertexBuffer();
 	}
@@ -2112,16 +2397,14 @@ void CGSH_OpenGL::ProcessHostToLocalTransfer()
 		m_textureCache.InvalidateRange(transferAddress, transferSize);
 
 		bool isUpperByteTransfer = (bltBuf.nDstPsm == PSMT8H) || (bltBuf.nDstPsm == PSMT4HL) || (bltBuf.nDstPsm == PSMT4HH);
-		for(const auto& framebuffer : m_framebuffers)
-		{
-			if((framebuffer->m_psm == PSMCT24) && isUpperByteTransfer) continue;
-			framebuffer->m_cachedArea.Invalidate(transferAddress, transferSize);
-		}
+		InvalidateFramebuffers(transferAddress, transferSize, isUpperByteTransfer);
 	}
 }
 
 void CGSH_OpenGL::ProcessLocalToHostTransfer()
 {
+	WaitTextureDecodes();
+
 	//This is constrained to work only with ps2autotest, will be unconstrained later
 
 	auto bltBuf = make_convertible<BITBLTBUF>(m_nReg[GS_REG_BITBLTBUF]);
@@ -2170,28 +2453,22 @@ void CGSH_OpenGL::ProcessLocalToHostTransfer()
 
 void CGSH_OpenGL::ProcessLocalToLocalTransfer()
 {
+	WaitTextureDecodes();
+
 	auto bltBuf = make_convertible<BITBLTBUF>(m_nReg[GS_REG_BITBLTBUF]);
-	auto srcFramebufferIterator = std::find_if(m_framebuffers.begin(), m_framebuffers.end(),
-	                                           [&](const FramebufferPtr& framebuffer) {
-		                                           return (framebuffer->m_basePtr == bltBuf.GetSrcPtr()) &&
-		                                                  (framebuffer->m_width == bltBuf.GetSrcWidth());
-	                                           });
-	auto dstFramebufferIterator = std::find_if(m_framebuffers.begin(), m_framebuffers.end(),
-	                                           [&](const FramebufferPtr& framebuffer) {
-		                                           return (framebuffer->m_basePtr == bltBuf.GetDstPtr()) &&
-		                                                  (framebuffer->m_width == bltBuf.GetDstWidth());
-	                                           });
-
-	bool foundSrc = srcFramebufferIterator != std::end(m_framebuffers);
-	bool foundDest = dstFramebufferIterator != std::end(m_framebuffers);
+	auto srcFramebuffers = FindFramebufferCandidates(bltBuf.GetSrcPtr(), bltBuf.GetSrcWidth());
+	auto dstFramebuffers = FindFramebufferCandidates(bltBuf.GetDstPtr(), bltBuf.GetDstWidth());
+
+	bool foundSrc = (srcFramebuffers != nullptr);
+	bool foundDest = (dstFramebuffers != nullptr);
 
 	if(foundSrc && foundDest)
 	{
 		FlushVertexBuffer();
 		m_renderState.isValid = false;
 
-		const auto& srcFramebuffer = (*srcFramebufferIterator);
-		const auto& dstFramebuffer = (*dstFramebufferIterator);
+		const auto& srcFramebuffer = srcFramebuffers->front();
+		const auto& dstFramebuffer = dstFramebuffers->front();
 
 		glBindFramebuffer(GL_FRAMEBUFFER, dstFramebuffer->m_framebuffer);
 		glBindFramebuffer(GL_READ_FRAMEBUFFER, srcFramebuffer->m_framebuffer);
@@ -2214,7 +2491,7 @@ void CGSH_OpenGL::ProcessLocalToLocalTransfer()
 		auto trxReg = make_convertible<TRXREG>(m_nReg[GS_REG_TRXREG]);
 		auto imgbuffer = Framework::CBitmap(trxReg.nRRW * m_fbScale, trxReg.nRRH * m_fbScale, 32);
 
-		glBindFramebuffer(GL_FRAMEBUFFER, (*srcFramebufferIterator)->m_framebuffer);
+		glBindFramebuffer(GL_FRAMEBUFFER, srcFramebuffers->front()->m_framebuffer);
 		glReadPixels(trxPos.nSSAX * m_fbScale, trxPos.nSSAY * m_fbScale, trxReg.nRRW * m_fbScale, trxReg.nRRH * m_fbScale, GL_RGBA, GL_UNSIGNED_BYTE, imgbuffer.GetPixels());
 		CHECKGLERROR();
 
@@ -2243,6 +2520,13 @@ void CGSH_OpenGL::ProcessLocalToLocalTransfer()
 	}
 }
 
+void CGSH_OpenGL::TransferWrite(const uint8* imageData, uint32 length)
+{
+	//Workers might still be reading the area we're about to write to
+	WaitTextureDecodes();
+	CGSHandler::TransferWrite(imageData, length);
+}
+
 void CGSH_OpenGL::ProcessClutTransfer(uint32 csa, uint32)
 {
 	FlushVertexBuffer();
@@ -2357,6 +2641,9 @@ Framework::CBitmap CGSH_OpenGL::GetTextureImpl(uint64 tex0Reg, uint32 maxMip, ui
 		return Framework::CBitmap();
 	}
 
+	CompletePendingTextureUploads();
+	glBindTexture(GL_TEXTURE_2D, texInfo.textureHandle);
+
 	auto texFormat = GetTextureFormatInfo(tex0.nPsm);
 	auto bitsPerPixel =
 	    [format = tex0.nPsm]() {
@@ -1,11 +1,17 @@
 #pragma once
 
+#include <array>
 #include <list>
+#include <mutex>
 #include <unordered_map>
+#include <unordered_set>
+#include "filesystem_def.h"
 #include "../GSHandler.h"
 #include "../GsDebuggerInterface.h"
 #include "../GsCachedArea.h"
+#include "../GsPixelFormats.h"
 #include "../GsTextureCache.h"
+#include "../GsWorkerPool.h"
 #include "opengl/OpenGlDef.h"
 #include "opengl/Program.h"
 #include "opengl/Shader.h"
@@ -20,6 +26,12 @@
 #define USE_DUALSOURCE_BLENDING
 #endif
 
+#if !defined(GLES_COMPATIBILITY) && !defined(__APPLE__)
+//- Texture staging area can be a persistently mapped buffer (GL_ARB_buffer_storage),
+//  not available on GLES and macOS where we upload from client memory instead.
+#define USE_PERSISTENT_TEXTURE_STAGING
+#endif
+
 class CGSH_OpenGL : public CGSHandler, public CGsDebuggerInterface
 {
 public:
@@ -54,6 +66,23 @@ public:
 
 	const VERTEX* GetInputVertices() const override;
 
+	struct RESOURCE_CACHE_STATS
+	{
+		uint32 paletteHits = 0;
+		uint32 paletteMisses = 0;
+		uint32 paletteProbes = 0;
+		uint32 framebufferHits = 0;
+		uint32 framebufferMisses = 0;
+		uint32 framebufferProbes = 0;
+		uint32 depthbufferHits = 0;
+		uint32 depthbufferMisses = 0;
+		uint32 framebufferInvalidations = 0;
+	};
+
+	//Returns lookup counters for the palette, framebuffer and depth buffer caches
+	//gathered during the last frame. Probes count how many entries lookups had to compare.
+	RESOURCE_CACHE_STATS GetResourceCacheStats();
+
 protected:
 	void PalCache_Flush();
 	void LoadPreferences();
@@ -61,6 +90,8 @@ protected:
 	void ReleaseImpl() override;
 	void ResetImpl() override;
 	void NotifyPreferencesChangedImpl() override;
+	void TransferWrite(const uint8*, uint32) override;
+	void NotifyTitleChangedImpl(const std::string&) override;
 	void FlipImpl(const DISPLAY_INFO&) override;
 
 	GLuint m_presentFramebuffer = 0;
@@ -144,12 +175,17 @@ private:
 		GLsizei scissorWidth;
 		GLsizei scissorHeight;
 		bool blendEnabled;
+		GLenum blendEquation = GL_FUNC_ADD;
+		GLenum blendSrcFactor = GL_ONE;
+		GLenum blendDstFactor = GL_ZERO;
+		float blendConstant = 0;
 		bool colorMaskR;
 		bool colorMaskG;
 		bool colorMaskB;
 		bool colorMaskA;
 		bool depthMask;
 		bool depthTest;
+		GLenum depthFunc = GL_ALWAYS;
 	};
 
 	//These need to match the layout of the shader's uniform block
@@ -186,7 +222,16 @@ private:
 		CVTBUFFERSIZE = 0x800000,
 	};
 
-	typedef void (CGSH_OpenGL::*TEXTUREUPDATER)(uint32, uint32, unsigned int, unsigned int, unsigned int, unsigned int);
+	enum
+	{
+		TEXTURE_STAGING_SEGMENT_SIZE = 0x400000,
+		TEXTURE_STAGING_SEGMENT_COUNT = 4,
+		TEXTURE_STAGING_SIZE = TEXTURE_STAGING_SEGMENT_SIZE * TEXTURE_STAGING_SEGMENT_COUNT,
+		TEXTURE_DECODE_MIN_BAND_HEIGHT = 64,
+	};
+
+	//Texture updaters decode GS memory into a linear buffer, they are run on worker threads
+	typedef void (CGSH_OpenGL::*TEXTUREUPDATER)(uint8*, uint32, uint32, unsigned int, unsigned int, unsigned int, unsigned int) const;
 
 	enum
 	{
@@ -207,6 +252,14 @@ private:
 
 	typedef std::unordered_map<ShaderCapsInt, Framework::OpenGl::ProgramPtr> ShaderMap;
 
+	struct SHADERBINARY
+	{
+		GLenum format = 0;
+		std::vector<uint8> data;
+	};
+	typedef std::unordered_map<ShaderCapsInt, SHADERBINARY> ShaderBinaryMap;
+	typedef std::unordered_set<ShaderCapsInt> ShaderCapsSet;
+
 	class CPalette
 	{
 	public:
@@ -223,9 +276,12 @@ private:
 		uint32 m_csa;
 		GLuint m_texture;
 		uint32 m_contents[256];
+		uint64 m_contentsHash;
 	};
 	typedef std::shared_ptr<CPalette> PalettePtr;
 	typedef std::list<PalettePtr> PaletteList;
+	typedef std::unordered_map<uint32, PaletteList::iterator> PaletteKeyIndex;
+	typedef std::unordered_multimap<uint64, PaletteList::iterator> PaletteContentsIndex;
 
 	class CFramebuffer
 	{
@@ -249,6 +305,7 @@ private:
 	};
 	typedef std::shared_ptr<CFramebuffer> FramebufferPtr;
 	typedef std::vector<FramebufferPtr> FramebufferList;
+	typedef std::unordered_map<uint64, FramebufferList> FramebufferIndex;
 
 	class CDepthbuffer
 	{
@@ -264,6 +321,7 @@ private:
 	};
 	typedef std::shared_ptr<CDepthbuffer> DepthbufferPtr;
 	typedef std::vector<DepthbufferPtr> DepthbufferList;
+	typedef std::unordered_map<uint64, DepthbufferPtr> DepthbufferIndex;
 
 	struct TEXTURE_INFO
 	{
@@ -279,6 +337,19 @@ private:
 		GLenum internalFormat;
 		GLenum format;
 		GLenum type;
+		uint32 pixelSize;
+	};
+
+	struct PENDING_TEXTURE_UPLOAD
+	{
+		GLuint textureHandle = 0;
+		GLenum format = 0;
+		GLenum type = 0;
+		uint32 texX = 0;
+		uint32 texY = 0;
+		uint32 texWidth = 0;
+		uint32 texHeight = 0;
+		uint32 stagingOffset = 0;
 	};
 
 	enum class PRIM_VERTEX_ATTRIB
@@ -328,6 +399,11 @@ private:
 	std::string GenerateAlphaTestSection(ALPHA_TEST_METHOD, ALPHA_TEST_FAIL_METHOD);
 	std::string GenerateAlphaBlendSection(ALPHABLEND_ABD, ALPHABLEND_ABD, ALPHABLEND_C, ALPHABLEND_ABD);
 
+	void LoadShaderCache();
+	Framework::OpenGl::ProgramPtr LoadShaderFromCache(const SHADERCAPS&);
+	void SaveShaderToCache(const SHADERCAPS&, const Framework::OpenGl::ProgramPtr&);
+	void RecordTitleShader(const SHADERCAPS&);
+
 	Framework::OpenGl::ProgramPtr GeneratePresentProgram();
 	Framework::OpenGl::CBuffer GeneratePresentVertexBuffer();
 	Framework::OpenGl::CVertexArray GeneratePresentVertexArray();
@@ -353,7 +429,10 @@ private:
 	void SetRenderingContext(uint64);
 	void SetupTestFunctions(uint64);
 	void SetupDepthBuffer(uint64, uint64);
-	void SetupFramebuffer(uint64, uint64, uint64, uint64);
+	void SetupColorMask(uint64, uint64);
+	void SetupFramebuffer(uint64, uint64, uint64);
+	bool IsSameDrawState(const RENDERSTATE&, const VERTEXPARAMS&, const FRAGMENTPARAMS&) const;
+	static GLenum GetPrimitiveMode(unsigned int);
 	void SetupBlendingFunction(uint64);
 	void SetupFogColor(uint64);
 
@@ -372,23 +451,30 @@ private:
 
 	void DumpTexture(unsigned int, unsigned int, uint32);
 
+	void CreateTextureStaging();
+	void ReleaseTextureStaging();
+	uint8* AllocateTextureStaging(uint32, uint32&);
+	void QueueTextureUpdate(GLuint, const TEXTUREFORMAT_INFO&, uint32, uint32, uint32, uint32, uint32, uint32, uint32);
+	void WaitTextureDecodes();
+	void CompletePendingTextureUploads();
+
 	Framework::CBitmap GetFramebufferImpl(uint64);
 	Framework::CBitmap GetTextureImpl(uint64, uint32, uint64, uint64, uint32);
 
 	//Texture updaters
-	void TexUpdater_Invalid(uint32, uint32, unsigned int, unsigned int, unsigned int, unsigned int);
+	void TexUpdater_Invalid(uint8*, uint32, uint32, unsigned int, unsigned int, unsigned int, unsigned int) const;
 
-	void TexUpdater_Psm32(uint32, uint32, unsigned int, unsigned int, unsigned int, unsigned int);
+	void TexUpdater_Psm32(uint8*, uint32, uint32, unsigned int, unsigned int, unsigned int, unsigned int) const;
 	template <typename>
-	void TexUpdater_Psm16(uint32, uint32, unsigned int, unsigned int, unsigned int, unsigned int);
+	void TexUpdater_Psm16(uint8*, uint32, uint32, unsigned int, unsigned int, unsigned int, unsigned int) const;
 
-	void TexUpdater_Psm8(uint32, uint32, unsigned int, unsigned int, unsigned int, unsigned int);
-	void TexUpdater_Psm4(uint32, uint32, unsigned int, unsigned int, unsigned int, unsigned int);
+	void TexUpdater_Psm8(uint8*, uint32, uint32, unsigned int, unsigned int, unsigned int, unsigned int) const;
+	void TexUpdater_Psm4(uint8*, uint32, uint32, unsigned int, unsigned int, unsigned int, unsigned int) const;
 
 	template <typename>
-	void TexUpdater_Psm48(uint32, uint32, unsigned int, unsigned int, unsigned int, unsigned int);
+	void TexUpdater_Psm48(uint8*, uint32, uint32, unsigned int, unsigned int, unsigned int, unsigned int) const;
 	template <uint32, uint32>
-	void TexUpdater_Psm48H(uint32, uint32, unsigned int, unsigned int, unsigned int, unsigned int);
+	void TexUpdater_Psm48H(uint8*, uint32, uint32, unsigned int, unsigned int, unsigned int, unsigned int) const;
 
 	//Context variables (put this in a struct or something?)
 	float m_nPrimOfsX;
@@ -409,6 +495,16 @@ private:
 	GLuint PalCache_Search(unsigned int, const uint32*);
 	void PalCache_Insert(const TEX0&, const uint32*, GLuint);
 	void PalCache_Invalidate(uint32);
+	void PalCache_SetLive(PaletteList::iterator);
+	void PalCache_RemoveFromIndex(PaletteList::iterator);
+	static uint32 PalCache_MakeKey(bool, uint32, uint32);
+
+	static uint64 MakeBufferKey(uint32, uint32);
+	void AddFramebuffer(const FramebufferPtr&);
+	void AddDepthbuffer(const DepthbufferPtr&);
+	void ClearFramebuffers();
+	const FramebufferList* FindFramebufferCandidates(uint32, uint32) const;
+	void InvalidateFramebuffers(uint32, uint32, bool);
 
 	void PopulateFramebuffer(const FramebufferPtr&);
 	void CommitFramebufferDirtyPages(const FramebufferPtr&, unsigned int, unsigned int);
@@ -429,9 +525,27 @@ private:
 
 	TextureCache m_textureCache;
 	PaletteList m_paletteCache;
+	PaletteKeyIndex m_paletteKeyIndex;
+	PaletteContentsIndex m_paletteContentsIndex;
 	FramebufferList m_framebuffers;
 	DepthbufferList m_depthbuffers;
 
+	//Framebuffers and depth buffers indexed by base pointer and width
+	FramebufferIndex m_framebufferIndex;
+	DepthbufferIndex m_depthbufferIndex;
+
+	//Framebuffers covering each page of GS RAM, used to invalidate only the framebuffers
+	//touched by a transfer. Framebuffers can extend past the end of RAM, hence the extra pages.
+	enum
+	{
+		FRAMEBUFFER_PAGE_INDEX_SIZE = (RAMSIZE * 2) / CGsPixelFormats::PAGESIZE,
+	};
+	std::array<std::vector<CFramebuffer*>, FRAMEBUFFER_PAGE_INDEX_SIZE> m_framebufferPageIndex;
+
+	mutable RESOURCE_CACHE_STATS m_resourceCacheStats;
+	std::mutex m_lastResourceCacheStatsMutex;
+	RESOURCE_CACHE_STATS m_lastResourceCacheStats;
+
 	Framework::OpenGl::CBuffer m_primBuffer;
 	Framework::OpenGl::CVertexArray m_primVertexArray;
 
@@ -463,10 +577,22 @@ private:
 		GLSTATE_FRAMEBUFFER = 0x0100,
 		GLSTATE_VIEWPORT = 0x0200,
 		GLSTATE_DEPTHTEST = 0x0400,
+		GLSTATE_BLENDFUNC = 0x0800,
+		GLSTATE_DEPTHFUNC = 0x1000,
 	};
 
 	ShaderMap m_shaders;
 	RENDERSTATE m_renderState;
+
+	//Program binaries saved on disk, specific to the current driver
+	bool m_hasProgramBinarySupport = false;
+	fs::path m_shaderCachePath;
+	ShaderBinaryMap m_shaderBinaries;
+
+	//Shaders used by the current title, compiled ahead of time when the title starts
+	fs::path m_titleShadersPath;
+	ShaderCapsSet m_titleShaders;
+
 	uint32 m_validGlState = 0;
 	VERTEXPARAMS m_vertexParams;
 	FRAGMENTPARAMS m_fragmentParams;
@@ -478,4 +604,16 @@ private:
 	//within the shader, such alpha blending
 	bool m_hasFramebufferFetchExtension = false;
 	bool m_hasFramebufferFetchDepthExtension = false;
+
+	//Textures are decoded by worker threads into the staging area and uploaded
+	//right before the next draw, or earlier if the staging area needs to be recycled
+	CGsWorkerPool m_textureDecodeWorkers;
+	bool m_hasPersistentTextureStaging = false;
+	Framework::OpenGl::CBuffer m_textureStagingBuffer;
+	uint8* m_textureStagingPtr = nullptr;
+	std::vector<uint8> m_textureStagingMemory;
+	uint32 m_textureStagingSegment = 0;
+	uint32 m_textureStagingOffset = 0;
+	std::array<GLsync, TEXTURE_STAGING_SEGMENT_COUNT> m_textureStagingFences = {};
+	std::vector<PENDING_TEXTURE_UPLOAD> m_pendingTextureUploads;
 };
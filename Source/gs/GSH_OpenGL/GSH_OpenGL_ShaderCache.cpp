@@ -0,0 +1,262 @@
+#include <cassert>
+#include <cctype>
+#include <cstring>
+#include "GSH_OpenGL.h"
+#include "AppConfig.h"
+#include "PathUtils.h"
+#include "StdStreamUtils.h"
+#include "string_format.h"
+
+/////////////////////////////////////////////////////////////
+// Shader Cache
+/////////////////////////////////////////////////////////////
+
+//Both files start with a magic and a version and then contain a list of records
+//that are appended as new shaders are created. Binaries file records are
+//(caps, format, size, data) and title file records are (caps).
+
+#define SHADER_CACHE_DIRECTORY "shadercache"
+#define SHADER_CACHE_TITLES_DIRECTORY "titles"
+
+//Increment this when changes to shader generation are made
+static const uint32 g_shaderCacheVersion = 1;
+static const uint32 g_shaderBinariesMagic = 0x42534C47; //'GLSB'
+static const uint32 g_titleShadersMagic = 0x54534C47;   //'GLST'
+
+static uint64 HashString(uint64 hash, const char* value)
+{
+	//FNV-1a
+	if(!value) return hash;
+	for(; *value != 0; value++)
+	{
+		hash ^= static_cast<uint8>(*value);
+		hash *= 0x100000001B3ULL;
+	}
+	return hash;
+}
+
+static std::string MakeTitleFileName(const std::string& titleId)
+{
+	auto result = titleId;
+	for(auto& character : result)
+	{
+		if(!isalnum(static_cast<unsigned char>(character)) && (character != '_') && (character != '.'))
+		{
+			character = '_';
+		}
+	}
+	return result + ".keys";
+}
+
+static bool CheckCacheFileHeader(Framework::CStream& stream, uint64 fileSize, uint32 magic)
+{
+	if(fileSize < 8) return false;
+	if(stream.Read32() != magic) return false;
+	if(stream.Read32() != g_shaderCacheVersion) return false;
+	return true;
+}
+
+static void CreateCacheFile(const fs::path& path, uint32 magic)
+{
+	auto stream = Framework::CreateOutputStdStream(path.native());
+	stream.Write32(magic);
+	stream.Write32(g_shaderCacheVersion);
+}
+
+template <typename WriteFunction>
+static void AppendToCacheFile(const fs::path& path, const WriteFunction& writeFunction)
+{
+	auto stream = fs::exists(path) ? Framework::CreateUpdateExistingStdStream(path.native()) : Framework::CreateOutputStdStream(path.native());
+	stream.Seek(0, Framework::STREAM_SEEK_END);
+	writeFunction(stream);
+}
+
+void CGSH_OpenGL::LoadShaderCache()
+{
+	m_shaderBinaries.clear();
+	m_shaderCachePath.clear();
+
+	if(!m_hasProgramBinarySupport) return;
+
+	//Binaries are only valid for the driver that produced them
+	uint64 driverHash = 0xCBF29CE484222325ULL;
+	driverHash = HashString(driverHash, reinterpret_cast<const char*>(glGetString(GL_VENDOR)));
+	driverHash = HashString(driverHash, reinterpret_cast<const char*>(glGetString(GL_RENDERER)));
+	driverHash = HashString(driverHash, reinterpret_cast<const char*>(glGetString(GL_VERSION)));
+	driverHash = HashString(driverHash, reinterpret_cast<const char*>(glGetString(GL_SHADING_LANGUAGE_VERSION)));
+	driverHash ^= (m_hasFramebufferFetchExtension ? 1 : 0) | (m_hasFramebufferFetchDepthExtension ? 2 : 0);
+
+	try
+	{
+		auto cacheDirectoryPath = CAppConfig::GetInstance().GetBasePath() / SHADER_CACHE_DIRECTORY;
+		Framework::PathUtils::EnsurePathExists(cacheDirectoryPath);
+
+		auto shaderCachePath = cacheDirectoryPath / string_format("opengl_%016llx.bin", static_cast<unsigned long long>(driverHash));
+
+		bool valid = false;
+		if(fs::exists(shaderCachePath))
+		{
+			uint64 fileSize = fs::file_size(shaderCachePath);
+			auto stream = Framework::CreateInputStdStream(shaderCachePath.native());
+			valid = CheckCacheFileHeader(stream, fileSize, g_shaderBinariesMagic);
+			uint64 position = 8;
+			while(valid && ((fileSize - position) >= 16))
+			{
+				auto caps = stream.Read64();
+				SHADERBINARY binary;
+				binary.format = stream.Read32();
+				uint32 size = stream.Read32();
+				position += 16;
+				//Stop on truncated records, might happen if we didn't finish writing a record
+				if(size > (fileSize - position)) break;
+				binary.data.resize(size);
+				stream.Read(binary.data.data(), size);
+				position += size;
+				//Records written later replace earlier ones
+				m_shaderBinaries[caps] = std::move(binary);
+			}
+		}
+
+		if(!valid)
+		{
+			m_shaderBinaries.clear();
+			CreateCacheFile(shaderCachePath, g_shaderBinariesMagic);
+		}
+
+		m_shaderCachePath = shaderCachePath;
+	}
+	catch(...)
+	{
+		//Cache is optional, shaders will simply be compiled
+		m_shaderBinaries.clear();
+		m_shaderCachePath.clear();
+	}
+}
+
+Framework::OpenGl::ProgramPtr CGSH_OpenGL::LoadShaderFromCache(const SHADERCAPS& caps)
+{
+	if(!m_hasProgramBinarySupport) return Framework::OpenGl::ProgramPtr();
+
+	auto binaryIterator = m_shaderBinaries.find(caps);
+	if(binaryIterator == std::end(m_shaderBinaries)) return Framework::OpenGl::ProgramPtr();
+
+	const auto& binary = binaryIterator->second;
+	auto result = std::make_shared<Framework::OpenGl::CProgram>();
+	glProgramBinary(*result, binary.format, binary.data.data(), static_cast<GLsizei>(binary.data.size()));
+
+	GLint linkStatus = GL_FALSE;
+	glGetProgramiv(*result, GL_LINK_STATUS, &linkStatus);
+
+	//Binary won't be needed anymore, program will live in the shader map
+	m_shaderBinaries.erase(binaryIterator);
+
+	if(linkStatus != GL_TRUE)
+	{
+		//Driver didn't accept the binary (format not supported anymore, etc.).
+		//Clear any error generated by glProgramBinary, shader will be compiled
+		//and saved again.
+		glGetError();
+		return Framework::OpenGl::ProgramPtr();
+	}
+
+	return result;
+}
+
+void CGSH_OpenGL::SaveShaderToCache(const SHADERCAPS& caps, const Framework::OpenGl::ProgramPtr& program)
+{
+	if(!m_hasProgramBinarySupport || m_shaderCachePath.empty()) return;
+
+	GLint binaryLength = 0;
+	glGetProgramiv(*program, GL_PROGRAM_BINARY_LENGTH, &binaryLength);
+	if(binaryLength <= 0) return;
+
+	SHADERBINARY binary;
+	binary.data.resize(binaryLength);
+	GLsizei actualLength = 0;
+	glGetProgramBinary(*program, binaryLength, &actualLength, &binary.format, binary.data.data());
+	CHECKGLERROR();
+	if(actualLength <= 0) return;
+
+	try
+	{
+		AppendToCacheFile(m_shaderCachePath,
+		                  [&](Framework::CStream& stream) {
+			                  stream.Write64(caps);
+			                  stream.Write32(binary.format);
+			                  stream.Write32(actualLength);
+			                  stream.Write(binary.data.data(), actualLength);
+		                  });
+	}
+	catch(...)
+	{
+	}
+}
+
+void CGSH_OpenGL::RecordTitleShader(const SHADERCAPS& caps)
+{
+	if(m_titleShadersPath.empty()) return;
+	if(!m_titleShaders.insert(caps).second) return;
+
+	try
+	{
+		AppendToCacheFile(m_titleShadersPath,
+		                  [&](Framework::CStream& stream) {
+			                  stream.Write64(caps);
+		                  });
+	}
+	catch(...)
+	{
+	}
+}
+
+void CGSH_OpenGL::NotifyTitleChangedImpl(const std::string& titleId)
+{
+	m_titleShaders.clear();
+	m_titleShadersPath.clear();
+
+	if(titleId.empty()) return;
+
+	std::vector<ShaderCapsInt> titleShaders;
+
+	try
+	{
+		auto titlesDirectoryPath = CAppConfig::GetInstance().GetBasePath() / SHADER_CACHE_DIRECTORY / SHADER_CACHE_TITLES_DIRECTORY;
+		Framework::PathUtils::EnsurePathExists(titlesDirectoryPath);
+
+		auto titleShadersPath = titlesDirectoryPath / MakeTitleFileName(titleId);
+
+		bool valid = false;
+		if(fs::exists(titleShadersPath))
+		{
+			uint64 fileSize = fs::file_size(titleShadersPath);
+			auto stream = Framework::CreateInputStdStream(titleShadersPath.native());
+			valid = CheckCacheFileHeader(stream, fileSize, g_titleShadersMagic);
+			if(valid)
+			{
+				uint64 recordCount = (fileSize - 8) / 8;
+				titleShaders.resize(recordCount);
+				stream.Read(titleShaders.data(), recordCount * 8);
+			}
+		}
+
+		if(!valid)
+		{
+			titleShaders.clear();
+			CreateCacheFile(titleShadersPath, g_titleShadersMagic);
+		}
+
+		m_titleShadersPath = titleShadersPath;
+	}
+	catch(...)
+	{
+		return;
+	}
+
+	//Warm up: build every shader this title used in previous sessions now instead
+	//of stalling the first time they are needed.
+	for(const auto& caps : titleShaders)
+	{
+		m_titleShaders.insert(caps);
+		GetShaderFromCaps(make_convertible<SHADERCAPS>(caps));
+	}
+}
@@ -10,6 +10,7 @@
 #include "GSH_OpenGL.h"
 #include "StdStream.h"
 #include "bitmap/BMP.h"
+#include "xxhash.h"
 #include "../GsPixelFormats.h"
 
 /////////////////////////////////////////////////////////////
@@ -86,19 +87,19 @@ CGSH_OpenGL::TEXTUREFORMAT_INFO CGSH_OpenGL::GetTextureFormatInfo(uint32 psm)
 	case PSMCT24:
 	case PSMCT32_UNK:
 	case PSMCT24_UNK:
-		return TEXTUREFORMAT_INFO{GL_RGBA8, GL_RGBA, GL_UNSIGNED_BYTE};
+		return TEXTUREFORMAT_INFO{GL_RGBA8, GL_RGBA, GL_UNSIGNED_BYTE, 4};
 	case PSMCT16:
 	case PSMCT16S:
-		return TEXTUREFORMAT_INFO{GL_RGB5_A1, GL_RGBA, GL_UNSIGNED_SHORT_5_5_5_1};
+		return TEXTUREFORMAT_INFO{GL_RGB5_A1, GL_RGBA, GL_UNSIGNED_SHORT_5_5_5_1, 2};
 	case PSMT8:
 	case PSMT4:
 	case PSMT8H:
 	case PSMT4HL:
 	case PSMT4HH:
-		return TEXTUREFORMAT_INFO{GL_R8, GL_RED, GL_UNSIGNED_BYTE};
+		return TEXTUREFORMAT_INFO{GL_R8, GL_RED, GL_UNSIGNED_BYTE, 1};
 	default:
 		assert(false);
-		return TEXTUREFORMAT_INFO{GL_RGBA8, GL_RGBA, GL_UNSIGNED_BYTE};
+		return TEXTUREFORMAT_INFO{GL_RGBA8, GL_RGBA, GL_UNSIGNED_BYTE, 4};
 	}
 }
 
@@ -108,27 +109,28 @@ CGSH_OpenGL::TEXTURE_INFO CGSH_OpenGL::SearchTextureFramebuffer(const TEX0& tex0
 	FramebufferPtr framebuffer;
 
 	//First pass, look for an exact match
-	for(const auto& candidateFramebuffer : m_framebuffers)
+	if(auto candidateFramebuffers = FindFramebufferCandidates(tex0.GetBufPtr(), tex0.GetBufWidth()))
 	{
-		//Case: TEX0 points at the start of a frame buffer with the same width
-		if(candidateFramebuffer->m_basePtr == tex0.GetBufPtr() &&
-		   candidateFramebuffer->m_width == tex0.GetBufWidth() &&
-		   IsCompatibleFramebufferPSM(candidateFramebuffer->m_psm, tex0.nPsm))
+		for(const auto& candidateFramebuffer : *candidateFramebuffers)
 		{
-			framebuffer = candidateFramebuffer;
-			break;
-		}
+			m_resourceCacheStats.framebufferProbes++;
 
-		//Case: TEX0 point at the start of a frame buffer with the same width
-		//but uses upper 8-bits (alpha) as an indexed texture (used in Yakuza)
-		else if(candidateFramebuffer->m_basePtr == tex0.GetBufPtr() &&
-		        candidateFramebuffer->m_width == tex0.GetBufWidth() &&
-		        candidateFramebuffer->m_psm == CGSHandler::PSMCT32 &&
-		        tex0.nPsm == CGSHandler::PSMT8H)
-		{
-			framebuffer = candidateFramebuffer;
-			texInfo.alphaAsIndex = true;
-			break;
+			//Case: TEX0 points at the start of a frame buffer with the same width
+			if(IsCompatibleFramebufferPSM(candidateFramebuffer->m_psm, tex0.nPsm))
+			{
+				framebuffer = candidateFramebuffer;
+				break;
+			}
+
+			//Case: TEX0 point at the start of a frame buffer with the same width
+			//but uses upper 8-bits (alpha) as an indexed texture (used in Yakuza)
+			else if(candidateFramebuffer->m_psm == CGSHandler::PSMCT32 &&
+			        tex0.nPsm == CGSHandler::PSMT8H)
+			{
+				framebuffer = candidateFramebuffer;
+				texInfo.alphaAsIndex = true;
+				break;
+			}
 		}
 	}
 
@@ -203,6 +205,9 @@ CGSH_OpenGL::TEXTURE_INFO CGSH_OpenGL::PrepareTexture(const TEX0& tex0)
 		texHeight = std::min<uint32>(texHeight, TEX0_MAX_TEXTURE_SIZE);
 		auto texFormat = GetTextureFormatInfo(tex0.nPsm);
 
+		//Inserting might evict a texture that still has uploads pending
+		CompletePendingTextureUploads();
+
 		{
 			auto textureHandle = Framework::OpenGl::CTexture::Create();
 			glBindTexture(GL_TEXTURE_2D, textureHandle);
@@ -217,10 +222,9 @@ CGSH_OpenGL::TEXTURE_INFO CGSH_OpenGL::PrepareTexture(const TEX0& tex0)
 
 	texInfo.textureHandle = texture->m_textureHandle;
 
-	glBindTexture(GL_TEXTURE_2D, texture->m_textureHandle);
 	auto& cachedArea = texture->m_cachedArea;
 	auto texturePageSize = CGsPixelFormats::GetPsmPageSize(tex0.nPsm);
-	auto areaRect = cachedArea.GetAreaPageRect();
+	auto texFormat = GetTextureFormatInfo(tex0.nPsm);
 
 	while(cachedArea.HasDirtyPages())
 	{
@@ -244,7 +248,7 @@ CGSH_OpenGL::TEXTURE_INFO CGSH_OpenGL::PrepareTexture(const TEX0& tex0)
 		{
 			texHeight = tex0.GetHeight() - texY;
 		}
-		((this)->*(m_textureUpdater[tex0.nPsm]))(tex0.GetBufPtr(), tex0.nBufWidth, texX, texY, texWidth, texHeight);
+		QueueTextureUpdate(texture->m_textureHandle, texFormat, tex0.nPsm, tex0.GetBufPtr(), tex0.nBufWidth, texX, texY, texWidth, texHeight);
 	}
 
 	cachedArea.ClearDirtyPages();
@@ -252,6 +256,180 @@ CGSH_OpenGL::TEXTURE_INFO CGSH_OpenGL::PrepareTexture(const TEX0& tex0)
 	return texInfo;
 }
 
+/////////////////////////////////////////////////////////////
+// Texture Uploading
+/////////////////////////////////////////////////////////////
+
+void CGSH_OpenGL::CreateTextureStaging()
+{
+	m_textureStagingSegment = 0;
+	m_textureStagingOffset = 0;
+	m_textureStagingPtr = nullptr;
+
+#ifdef USE_PERSISTENT_TEXTURE_STAGING
+	if(m_hasPersistentTextureStaging)
+	{
+		static const GLbitfield mapFlags = GL_MAP_WRITE_BIT | GL_MAP_PERSISTENT_BIT | GL_MAP_COHERENT_BIT;
+		m_textureStagingBuffer = Framework::OpenGl::CBuffer::Create();
+		glBindBuffer(GL_PIXEL_UNPACK_BUFFER, m_textureStagingBuffer);
+		glBufferStorage(GL_PIXEL_UNPACK_BUFFER, TEXTURE_STAGING_SIZE, nullptr, mapFlags);
+		m_textureStagingPtr = reinterpret_cast<uint8*>(glMapBufferRange(GL_PIXEL_UNPACK_BUFFER, 0, TEXTURE_STAGING_SIZE, mapFlags));
+		glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+		if(!m_textureStagingPtr)
+		{
+			//Mapping failed, fallback on client memory
+			glGetError();
+			m_textureStagingBuffer.Reset();
+			m_hasPersistentTextureStaging = false;
+		}
+	}
+#endif
+
+	if(!m_textureStagingPtr)
+	{
+		m_textureStagingMemory.resize(TEXTURE_STAGING_SIZE);
+		m_textureStagingPtr = m_textureStagingMemory.data();
+	}
+}
+
+void CGSH_OpenGL::ReleaseTextureStaging()
+{
+	CompletePendingTextureUploads();
+	for(auto& fence : m_textureStagingFences)
+	{
+		if(fence)
+		{
+			glDeleteSync(fence);
+			fence = 0;
+		}
+	}
+	//Deleting the buffer also unmaps it
+	m_textureStagingBuffer.Reset();
+	m_textureStagingMemory.clear();
+	m_textureStagingPtr = nullptr;
+}
+
+uint8* CGSH_OpenGL::AllocateTextureStaging(uint32 size, uint32& offset)
+{
+	if(size > TEXTURE_STAGING_SEGMENT_SIZE) return nullptr;
+
+	uint32 segmentEnd = (m_textureStagingSegment + 1) * TEXTURE_STAGING_SEGMENT_SIZE;
+	if((m_textureStagingOffset + size) > segmentEnd)
+	{
+		//Move on to the next segment. Everything that was written in the current segment
+		//is uploaded and we make sure the GPU is done reading from the next one.
+		CompletePendingTextureUploads();
+		if(m_hasPersistentTextureStaging)
+		{
+			m_textureStagingFences[m_textureStagingSegment] = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+		}
+		m_textureStagingSegment = (m_textureStagingSegment + 1) % TEXTURE_STAGING_SEGMENT_COUNT;
+		m_textureStagingOffset = m_textureStagingSegment * TEXTURE_STAGING_SEGMENT_SIZE;
+		auto& fence = m_textureStagingFences[m_textureStagingSegment];
+		if(fence)
+		{
+			while(glClientWaitSync(fence, GL_SYNC_FLUSH_COMMANDS_BIT, 1000000000ULL) == GL_TIMEOUT_EXPIRED)
+			{
+			}
+			glDeleteSync(fence);
+			fence = 0;
+		}
+	}
+
+	offset = m_textureStagingOffset;
+	m_textureStagingOffset += size;
+	return m_textureStagingPtr + offset;
+}
+
+void CGSH_OpenGL::QueueTextureUpdate(GLuint textureHandle, const TEXTUREFORMAT_INFO& texFormat, uint32 psm, uint32 bufPtr, uint32 bufWidth,
+                                     uint32 texX, uint32 texY, uint32 texWidth, uint32 texHeight)
+{
+	auto updater = m_textureUpdater[psm];
+	uint32 rowSize = texWidth * texFormat.pixelSize;
+
+	//Some updaters work on 16 lines blocks, make sure they don't write past the end of our area.
+	//Also keep every area aligned on 256 bytes, which is more than enough for unpack requirements.
+	uint32 stagingHeight = (texHeight + 15) & ~15;
+	uint32 stagingSize = ((rowSize * stagingHeight) + 0xFF) & ~0xFF;
+
+	uint32 stagingOffset = 0;
+	uint8* staging = AllocateTextureStaging(stagingSize, stagingOffset);
+	if(!staging)
+	{
+		//Doesn't fit in the staging area, do it right now. Pending uploads need to go
+		//through first, otherwise they could overwrite this update with older data.
+		CompletePendingTextureUploads();
+		((this)->*(updater))(m_pCvtBuffer, bufPtr, bufWidth, texX, texY, texWidth, texHeight);
+		glBindTexture(GL_TEXTURE_2D, textureHandle);
+		glTexSubImage2D(GL_TEXTURE_2D, 0, texX, texY, texWidth, texHeight, texFormat.format, texFormat.type, m_pCvtBuffer);
+		CHECKGLERROR();
+		m_validGlState &= ~GLSTATE_TEXTURE;
+		return;
+	}
+
+	PENDING_TEXTURE_UPLOAD upload;
+	upload.textureHandle = textureHandle;
+	upload.format = texFormat.format;
+	upload.type = texFormat.type;
+	upload.texX = texX;
+	upload.texY = texY;
+	upload.texWidth = texWidth;
+	upload.texHeight = texHeight;
+	upload.stagingOffset = stagingOffset;
+	m_pendingTextureUploads.push_back(upload);
+
+	//Split the area in bands, one per worker (GS thread will also help when waiting).
+	//Bands are aligned on 32 lines to keep the SIMD updaters on block boundaries.
+	uint32 bandCount = m_textureDecodeWorkers.GetThreadCount() + 1;
+	uint32 bandHeight = (texHeight + bandCount - 1) / bandCount;
+	bandHeight = std::max<uint32>((bandHeight + 31) & ~31, TEXTURE_DECODE_MIN_BAND_HEIGHT);
+	for(uint32 bandY = 0; bandY < texHeight; bandY += bandHeight)
+	{
+		uint32 currentBandHeight = std::min<uint32>(bandHeight, texHeight - bandY);
+		uint8* bandStaging = staging + (bandY * rowSize);
+		m_textureDecodeWorkers.Enqueue(
+		    [this, updater, bandStaging, bufPtr, bufWidth, texX, bandTexY = texY + bandY, texWidth, currentBandHeight]() {
+			    ((this)->*(updater))(bandStaging, bufPtr, bufWidth, texX, bandTexY, texWidth, currentBandHeight);
+		    });
+	}
+}
+
+void CGSH_OpenGL::WaitTextureDecodes()
+{
+	m_textureDecodeWorkers.WaitAll();
+}
+
+void CGSH_OpenGL::CompletePendingTextureUploads()
+{
+	if(m_pendingTextureUploads.empty()) return;
+
+	WaitTextureDecodes();
+
+	glActiveTexture(GL_TEXTURE0);
+	if(m_hasPersistentTextureStaging)
+	{
+		glBindBuffer(GL_PIXEL_UNPACK_BUFFER, m_textureStagingBuffer);
+	}
+
+	for(const auto& upload : m_pendingTextureUploads)
+	{
+		const void* pixels = m_hasPersistentTextureStaging
+		                         ? reinterpret_cast<const void*>(static_cast<uintptr_t>(upload.stagingOffset))
+		                         : m_textureStagingPtr + upload.stagingOffset;
+		glBindTexture(GL_TEXTURE_2D, upload.textureHandle);
+		glTexSubImage2D(GL_TEXTURE_2D, 0, upload.texX, upload.texY, upload.texWidth, upload.texHeight, upload.format, upload.type, pixels);
+		CHECKGLERROR();
+	}
+
+	if(m_hasPersistentTextureStaging)
+	{
+		glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+	}
+
+	m_pendingTextureUploads.clear();
+	m_validGlState &= ~GLSTATE_TEXTURE;
+}
+
 GLuint CGSH_OpenGL::PreparePalette(const TEX0& tex0)
 {
 	GLuint textureHandle = PalCache_Search(tex0);
@@ -299,16 +477,16 @@ void CGSH_OpenGL::DumpTexture(unsigned int nWidth, unsigned int nHeight, uint32
 #endif
 }
 
-void CGSH_OpenGL::TexUpdater_Invalid(uint32 bufPtr, uint32 bufWidth, unsigned int texX, unsigned int texY, unsigned int texWidth, unsigned int texHeight)
+void CGSH_OpenGL::TexUpdater_Invalid(uint8* dstBuffer, uint32 bufPtr, uint32 bufWidth, unsigned int texX, unsigned int texY, unsigned int texWidth, unsigned int texHeight) const
 {
 	assert(0);
 }
 
-void CGSH_OpenGL::TexUpdater_Psm32(uint32 bufPtr, uint32 bufWidth, unsigned int texX, unsigned int texY, unsigned int texWidth, unsigned int texHeight)
+void CGSH_OpenGL::TexUpdater_Psm32(uint8* dstBuffer, uint32 bufPtr, uint32 bufWidth, unsigned int texX, unsigned int texY, unsigned int texWidth, unsigned int texHeight) const
 {
 	CGsPixelFormats::CPixelIndexorPSMCT32 indexor(m_pRAM, bufPtr, bufWidth);
 
-	uint32* dst = reinterpret_cast<uint32*>(m_pCvtBuffer);
+	uint32* dst = reinterpret_cast<uint32*>(dstBuffer);
 	for(unsigned int y = 0; y < texHeight; y++)
 	{
 		for(unsigned int x = 0; x < texWidth; x++)
@@ -318,35 +496,71 @@ void CGSH_OpenGL::TexUpdater_Psm32(uint32 bufPtr, uint32 bufWidth, unsigned int
 
 		dst += texWidth;
 	}
+}
+
+#if defined(FRAMEWORK_SIMD_USE_SSE)
+#include <emmintrin.h>
+#elif defined(FRAMEWORK_SIMD_USE_NEON)
+#include <arm_neon.h>
+#endif
 
-	glTexSubImage2D(GL_TEXTURE_2D, 0, texX, texY, texWidth, texHeight, GL_RGBA, GL_UNSIGNED_BYTE, m_pCvtBuffer);
-	CHECKGLERROR();
+//Converts a row of A1B5G5R5 pixels to R5G5B5A1 in place
+static void ConvertPsm16Row(uint16* pixels, unsigned int count)
+{
+	unsigned int x = 0;
+#if defined(FRAMEWORK_SIMD_USE_SSE)
+	const __m128i greenMask = _mm_set1_epi16(0x03E0);
+	const __m128i blueMask = _mm_set1_epi16(0x7C00);
+	for(; (x + 8) <= count; x += 8)
+	{
+		__m128i pixel = _mm_loadu_si128(reinterpret_cast<const __m128i*>(pixels + x));
+		__m128i r = _mm_slli_epi16(pixel, 11);
+		__m128i g = _mm_slli_epi16(_mm_and_si128(pixel, greenMask), 1);
+		__m128i b = _mm_srli_epi16(_mm_and_si128(pixel, blueMask), 9);
+		__m128i a = _mm_srli_epi16(pixel, 15);
+		__m128i result = _mm_or_si128(_mm_or_si128(r, g), _mm_or_si128(b, a));
+		_mm_storeu_si128(reinterpret_cast<__m128i*>(pixels + x), result);
+	}
+#elif defined(FRAMEWORK_SIMD_USE_NEON)
+	const uint16x8_t greenMask = vdupq_n_u16(0x03E0);
+	const uint16x8_t blueMask = vdupq_n_u16(0x7C00);
+	for(; (x + 8) <= count; x += 8)
+	{
+		uint16x8_t pixel = vld1q_u16(pixels + x);
+		uint16x8_t r = vshlq_n_u16(pixel, 11);
+		uint16x8_t g = vshlq_n_u16(vandq_u16(pixel, greenMask), 1);
+		uint16x8_t b = vshrq_n_u16(vandq_u16(pixel, blueMask), 9);
+		uint16x8_t a = vshrq_n_u16(pixel, 15);
+		vst1q_u16(pixels + x, vorrq_u16(vorrq_u16(r, g), vorrq_u16(b, a)));
+	}
+#endif
+	for(; x < count; x++)
+	{
+		uint16 pixel = pixels[x];
+		pixels[x] =
+		    (((pixel & 0x001F) >> 0) << 11) | //R
+		    (((pixel & 0x03E0) >> 5) << 6) |  //G
+		    (((pixel & 0x7C00) >> 10) << 1) | //B
+		    (pixel >> 15);                    //A
+	}
 }
 
 template <typename IndexorType>
-void CGSH_OpenGL::TexUpdater_Psm16(uint32 bufPtr, uint32 bufWidth, unsigned int texX, unsigned int texY, unsigned int texWidth, unsigned int texHeight)
+void CGSH_OpenGL::TexUpdater_Psm16(uint8* dstBuffer, uint32 bufPtr, uint32 bufWidth, unsigned int texX, unsigned int texY, unsigned int texWidth, unsigned int texHeight) const
 {
 	IndexorType indexor(m_pRAM, bufPtr, bufWidth);
 
-	auto dst = reinterpret_cast<uint16*>(m_pCvtBuffer);
+	auto dst = reinterpret_cast<uint16*>(dstBuffer);
 	for(unsigned int y = 0; y < texHeight; y++)
 	{
 		for(unsigned int x = 0; x < texWidth; x++)
 		{
-			auto pixel = indexor.GetPixel(texX + x, texY + y);
-			auto cvtPixel =
-			    (((pixel & 0x001F) >> 0) << 11) | //R
-			    (((pixel & 0x03E0) >> 5) << 6) |  //G
-			    (((pixel & 0x7C00) >> 10) << 1) | //B
-			    (pixel >> 15);                    //A
-			dst[x] = cvtPixel;
+			dst[x] = indexor.GetPixel(texX + x, texY + y);
 		}
+		ConvertPsm16Row(dst, texWidth);
 
 		dst += texWidth;
 	}
-
-	glTexSubImage2D(GL_TEXTURE_2D, 0, texX, texY, texWidth, texHeight, GL_RGBA, GL_UNSIGNED_SHORT_5_5_5_1, m_pCvtBuffer);
-	CHECKGLERROR();
 }
 
 #if defined(FRAMEWORK_SIMD_USE_SSE)
@@ -556,18 +770,18 @@ void convertColumn8(uint8* dest, const int destStride, uint8* src, int colNum)
 */
 #endif
 
-void CGSH_OpenGL::TexUpdater_Psm8(uint32 bufPtr, uint32 bufWidth, unsigned int texX, unsigned int texY, unsigned int texWidth, unsigned int texHeight)
+void CGSH_OpenGL::TexUpdater_Psm8(uint8* dstBuffer, uint32 bufPtr, uint32 bufWidth, unsigned int texX, unsigned int texY, unsigned int texWidth, unsigned int texHeight) const
 {
 	if(texWidth < 16)
 	{
 		// Widths are powers of 2, so anything over 16 will be an integral number of columns wide.
 		// Note: for small textures it still may be a win to do the SIMD swizzle and then cut out the sub-region to
 		// correct the row stride.
-		return CGSH_OpenGL::TexUpdater_Psm48<CGsPixelFormats::CPixelIndexorPSMT8>(bufPtr, bufWidth, texX, texY, texWidth, texHeight);
+		return CGSH_OpenGL::TexUpdater_Psm48<CGsPixelFormats::CPixelIndexorPSMT8>(dstBuffer, bufPtr, bufWidth, texX, texY, texWidth, texHeight);
 	}
 
 	CGsPixelFormats::CPixelIndexorPSMT8 indexor(m_pRAM, bufPtr, bufWidth);
-	uint8* dst = m_pCvtBuffer;
+	uint8* dst = dstBuffer;
 	for(unsigned int y = 0; y < texHeight; y += 16)
 	{
 		for(unsigned int x = 0; x < texWidth; x += 16)
@@ -589,12 +803,9 @@ void CGSH_OpenGL::TexUpdater_Psm8(uint32 bufPtr, uint32 bufWidth, unsigned int t
 
 		dst += texWidth * 16;
 	}
-
-	glTexSubImage2D(GL_TEXTURE_2D, 0, texX, texY, texWidth, texHeight, GL_RED, GL_UNSIGNED_BYTE, m_pCvtBuffer);
-	CHECKGLERROR();
 }
 
-void CGSH_OpenGL::TexUpdater_Psm4(unsigned int bufPtr, unsigned int bufWidth, unsigned int texX, unsigned int texY, unsigned int texWidth, unsigned int texHeight)
+void CGSH_OpenGL::TexUpdater_Psm4(uint8* dstBuffer, uint32 bufPtr, uint32 bufWidth, unsigned int texX, unsigned int texY, unsigned int texWidth, unsigned int texHeight) const
 {
 	if(texWidth < 16)
 	{
@@ -602,12 +813,12 @@ void CGSH_OpenGL::TexUpdater_Psm4(unsigned int bufPtr, unsigned int bufWidth, un
 		// 16 wide textures are dealt with as a special case in the SIMD code.
 		// Note: for small textures it still may be a win to do the SIMD swizzle and then cut out the sub-region to
 		// correct the row stride.
-		return CGSH_OpenGL::TexUpdater_Psm48<CGsPixelFormats::CPixelIndexorPSMT4>(bufPtr, bufWidth, texX, texY, texWidth, texHeight);
+		return CGSH_OpenGL::TexUpdater_Psm48<CGsPixelFormats::CPixelIndexorPSMT4>(dstBuffer, bufPtr, bufWidth, texX, texY, texWidth, texHeight);
 	}
 
 	CGsPixelFormats::CPixelIndexorPSMT4 indexor(m_pRAM, bufPtr, bufWidth);
 
-	uint8* dst = m_pCvtBuffer;
+	uint8* dst = dstBuffer;
 	for(unsigned int y = 0; y < texHeight; y += 16)
 	{
 		for(unsigned int x = 0; x < texWidth; x += 32)
@@ -631,16 +842,14 @@ void CGSH_OpenGL::TexUpdater_Psm4(unsigned int bufPtr, unsigned int bufWidth, un
 
 		dst += texWidth * 16;
 	}
-	glTexSubImage2D(GL_TEXTURE_2D, 0, texX, texY, texWidth, texHeight, GL_RED, GL_UNSIGNED_BYTE, m_pCvtBuffer);
-	CHECKGLERROR();
 }
 
 template <typename IndexorType>
-void CGSH_OpenGL::TexUpdater_Psm48(uint32 bufPtr, uint32 bufWidth, unsigned int texX, unsigned int texY, unsigned int texWidth, unsigned int texHeight)
+void CGSH_OpenGL::TexUpdater_Psm48(uint8* dstBuffer, uint32 bufPtr, uint32 bufWidth, unsigned int texX, unsigned int texY, unsigned int texWidth, unsigned int texHeight) const
 {
 	IndexorType indexor(m_pRAM, bufPtr, bufWidth);
 
-	uint8* dst = m_pCvtBuffer;
+	uint8* dst = dstBuffer;
 	for(unsigned int y = 0; y < texHeight; y++)
 	{
 		for(unsigned int x = 0; x < texWidth; x++)
@@ -651,17 +860,14 @@ void CGSH_OpenGL::TexUpdater_Psm48(uint32 bufPtr, uint32 bufWidth, unsigned int
 
 		dst += texWidth;
 	}
-
-	glTexSubImage2D(GL_TEXTURE_2D, 0, texX, texY, texWidth, texHeight, GL_RED, GL_UNSIGNED_BYTE, m_pCvtBuffer);
-	CHECKGLERROR();
 }
 
 template <uint32 shiftAmount, uint32 mask>
-void CGSH_OpenGL::TexUpdater_Psm48H(uint32 bufPtr, uint32 bufWidth, unsigned int texX, unsigned int texY, unsigned int texWidth, unsigned int texHeight)
+void CGSH_OpenGL::TexUpdater_Psm48H(uint8* dstBuffer, uint32 bufPtr, uint32 bufWidth, unsigned int texX, unsigned int texY, unsigned int texWidth, unsigned int texHeight) const
 {
 	CGsPixelFormats::CPixelIndexorPSMCT32 indexor(m_pRAM, bufPtr, bufWidth);
 
-	uint8* dst = m_pCvtBuffer;
+	uint8* dst = dstBuffer;
 	for(unsigned int y = 0; y < texHeight; y++)
 	{
 		for(unsigned int x = 0; x < texWidth; x++)
@@ -673,9 +879,6 @@ void CGSH_OpenGL::TexUpdater_Psm48H(uint32 bufPtr, uint32 bufWidth, unsigned int
 
 		dst += texWidth;
 	}
-
-	glTexSubImage2D(GL_TEXTURE_2D, 0, texX, texY, texWidth, texHeight, GL_RED, GL_UNSIGNED_BYTE, m_pCvtBuffer);
-	CHECKGLERROR();
 }
 
 /////////////////////////////////////////////////////////////
@@ -688,6 +891,7 @@ CGSH_OpenGL::CPalette::CPalette()
     , m_cpsm(0)
     , m_csa(0)
     , m_texture(0)
+    , m_contentsHash(0)
 {
 }
 
@@ -717,42 +921,47 @@ void CGSH_OpenGL::CPalette::Invalidate(uint32 csa)
 // Palette Caching
 /////////////////////////////////////////////////////////////
 
+uint32 CGSH_OpenGL::PalCache_MakeKey(bool isIDTEX4, uint32 cpsm, uint32 csa)
+{
+	return (isIDTEX4 ? 0x10000 : 0) | (cpsm << 8) | csa;
+}
+
 GLuint CGSH_OpenGL::PalCache_Search(const TEX0& tex0)
 {
-	for(auto paletteIterator(m_paletteCache.begin());
-	    paletteIterator != m_paletteCache.end(); paletteIterator++)
+	auto key = PalCache_MakeKey(CGsPixelFormats::IsPsmIDTEX4(tex0.nPsm), tex0.nCPSM, tex0.nCSA);
+	auto indexIterator = m_paletteKeyIndex.find(key);
+	if(indexIterator == std::end(m_paletteKeyIndex))
 	{
-		auto palette = *paletteIterator;
-		if(!palette->m_live) continue;
-		if(CGsPixelFormats::IsPsmIDTEX4(tex0.nPsm) != palette->m_isIDTEX4) continue;
-		if(tex0.nCPSM != palette->m_cpsm) continue;
-		if(tex0.nCSA != palette->m_csa) continue;
-		m_paletteCache.erase(paletteIterator);
-		m_paletteCache.push_front(palette);
-		return palette->m_texture;
+		return 0;
 	}
 
-	return 0;
+	auto paletteIterator = indexIterator->second;
+	assert((*paletteIterator)->m_live);
+	m_paletteCache.splice(m_paletteCache.begin(), m_paletteCache, paletteIterator);
+	m_resourceCacheStats.paletteHits++;
+	return (*paletteIterator)->m_texture;
 }
 
 GLuint CGSH_OpenGL::PalCache_Search(unsigned int entryCount, const uint32* contents)
 {
-	for(auto paletteIterator(m_paletteCache.begin());
-	    paletteIterator != m_paletteCache.end(); paletteIterator++)
+	uint64 contentsHash = XXH3_64bits(contents, sizeof(uint32) * entryCount);
+	auto indexRange = m_paletteContentsIndex.equal_range(contentsHash);
+	for(auto indexIterator = indexRange.first; indexIterator != indexRange.second; indexIterator++)
 	{
-		auto palette = *paletteIterator;
+		auto paletteIterator = indexIterator->second;
+		const auto& palette = *paletteIterator;
 
-		if(palette->m_texture == 0) continue;
+		m_resourceCacheStats.paletteProbes++;
 
 		unsigned int palEntryCount = palette->m_isIDTEX4 ? 16 : 256;
 		if(palEntryCount != entryCount) continue;
 
 		if(memcmp(contents, palette->m_contents, sizeof(uint32) * entryCount) != 0) continue;
 
-		palette->m_live = true;
+		PalCache_SetLive(paletteIterator);
 
-		m_paletteCache.erase(paletteIterator);
-		m_paletteCache.push_front(palette);
+		m_paletteCache.splice(m_paletteCache.begin(), m_paletteCache, paletteIterator);
+		m_resourceCacheStats.paletteHits++;
 		return palette->m_texture;
 	}
 
@@ -761,7 +970,10 @@ GLuint CGSH_OpenGL::PalCache_Search(unsigned int entryCount, const uint32* conte
 
 void CGSH_OpenGL::PalCache_Insert(const TEX0& tex0, const uint32* contents, GLuint textureHandle)
 {
-	auto texture = *m_paletteCache.rbegin();
+	auto paletteIterator = std::prev(m_paletteCache.end());
+	PalCache_RemoveFromIndex(paletteIterator);
+
+	auto texture = *paletteIterator;
 	texture->Free();
 
 	unsigned int entryCount = CGsPixelFormats::IsPsmIDTEX4(tex0.nPsm) ? 16 : 256;
@@ -770,21 +982,70 @@ void CGSH_OpenGL::PalCache_Insert(const TEX0& tex0, const uint32* contents, GLui
 	texture->m_cpsm = tex0.nCPSM;
 	texture->m_csa = tex0.nCSA;
 	texture->m_texture = textureHandle;
-	texture->m_live = true;
 	memcpy(texture->m_contents, contents, entryCount * sizeof(uint32));
+	texture->m_contentsHash = XXH3_64bits(contents, entryCount * sizeof(uint32));
 
-	m_paletteCache.pop_back();
-	m_paletteCache.push_front(texture);
+	m_paletteContentsIndex.insert(std::make_pair(texture->m_contentsHash, paletteIterator));
+	PalCache_SetLive(paletteIterator);
+
+	m_paletteCache.splice(m_paletteCache.begin(), m_paletteCache, paletteIterator);
+	m_resourceCacheStats.paletteMisses++;
+}
+
+void CGSH_OpenGL::PalCache_SetLive(PaletteList::iterator paletteIterator)
+{
+	const auto& palette = *paletteIterator;
+	auto key = PalCache_MakeKey(palette->m_isIDTEX4, palette->m_cpsm, palette->m_csa);
+	auto indexResult = m_paletteKeyIndex.insert(std::make_pair(key, paletteIterator));
+	if(!indexResult.second && (indexResult.first->second != paletteIterator))
+	{
+		//Another palette was live with the same parameters, this one is more recent
+		(*indexResult.first->second)->m_live = false;
+		indexResult.first->second = paletteIterator;
+	}
+	palette->m_live = true;
+}
+
+void CGSH_OpenGL::PalCache_RemoveFromIndex(PaletteList::iterator paletteIterator)
+{
+	const auto& palette = *paletteIterator;
+	if(palette->m_texture == 0) return;
+
+	if(palette->m_live)
+	{
+		auto key = PalCache_MakeKey(palette->m_isIDTEX4, palette->m_cpsm, palette->m_csa);
+		auto keyIterator = m_paletteKeyIndex.find(key);
+		if((keyIterator != std::end(m_paletteKeyIndex)) && (keyIterator->second == paletteIterator))
+		{
+			m_paletteKeyIndex.erase(keyIterator);
+		}
+	}
+
+	auto indexRange = m_paletteContentsIndex.equal_range(palette->m_contentsHash);
+	for(auto indexIterator = indexRange.first; indexIterator != indexRange.second; indexIterator++)
+	{
+		if(indexIterator->second == paletteIterator)
+		{
+			m_paletteContentsIndex.erase(indexIterator);
+			break;
+		}
+	}
 }
 
 void CGSH_OpenGL::PalCache_Invalidate(uint32 csa)
 {
-	std::for_each(std::begin(m_paletteCache), std::end(m_paletteCache),
-	              [csa](PalettePtr& palette) { palette->Invalidate(csa); });
+	//Only live palettes are referenced by the key index
+	for(auto& indexPair : m_paletteKeyIndex)
+	{
+		(*indexPair.second)->Invalidate(csa);
+	}
+	m_paletteKeyIndex.clear();
 }
 
 void CGSH_OpenGL::PalCache_Flush()
 {
 	std::for_each(std::begin(m_paletteCache), std::end(m_paletteCache),
 	              [](PalettePtr& palette) { palette->Free(); });
+	m_paletteKeyIndex.clear();
+	m_paletteContentsIndex.clear();
 }
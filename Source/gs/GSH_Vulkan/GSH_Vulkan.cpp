@@ -165,6 +165,7 @@ void CGSH_Vulkan::InitializeImpl()
 	m_context->commandBufferPool = Framework::Vulkan::CCommandBufferPool(m_context->device, renderQueueFamily);
 
 	CreateDescriptorPool();
+	CreatePipelineCache();
 	CreateMemoryBuffer();
 	CreateClutBuffer();
 
@@ -205,11 +206,12 @@ void CGSH_Vulkan::InitializeImpl()
 	m_context->annotations.SetImageViewName(m_context->swizzleTablePSMZ16SView, "Swizzle Table View PSMZ16S");
 
 	m_frameCommandBuffer = std::make_shared<CFrameCommandBuffer>(m_context);
+	m_stagingRing = std::make_shared<CStagingRing>(m_context, m_frameCommandBuffer);
 	m_clutLoad = std::make_shared<CClutLoad>(m_context, m_frameCommandBuffer);
 #if GSH_VULKAN_IS_DESKTOP
-	m_draw = std::make_shared<CDrawDesktop>(m_context, m_frameCommandBuffer);
+	m_draw = std::make_shared<CDrawDesktop>(m_context, m_frameCommandBuffer, m_stagingRing);
 #elif GSH_VULKAN_IS_MOBILE
-	m_draw = std::make_shared<CDrawMobile>(m_context, m_frameCommandBuffer);
+	m_draw = std::make_shared<CDrawMobile>(m_context, m_frameCommandBuffer, m_stagingRing);
 #else
 #error Unsupported Vulkan flavor
 #endif
@@ -217,16 +219,21 @@ void CGSH_Vulkan::InitializeImpl()
 	{
 		m_present = std::make_shared<CPresent>(m_context);
 	}
-	m_transferHost = std::make_shared<CTransferHost>(m_context, m_frameCommandBuffer);
+	m_transferHost = std::make_shared<CTransferHost>(m_context, m_frameCommandBuffer, m_stagingRing);
 	m_transferLocal = std::make_shared<CTransferLocal>(m_context, m_frameCommandBuffer);
 
 	m_frameCommandBuffer->RegisterWriter(m_draw.get());
 	m_frameCommandBuffer->RegisterWriter(m_transferHost.get());
+	m_frameCommandBuffer->RegisterWriter(m_stagingRing.get());
 	m_frameCommandBuffer->BeginFrame();
 }
 
 void CGSH_Vulkan::ReleaseImpl()
 {
+	StopPipelinePrewarm();
+	SaveTitlePipelines();
+	m_titlePipelinesPath.clear();
+
 	ResetImpl();
 
 	//Flush any pending rendering commands
@@ -237,6 +244,7 @@ void CGSH_Vulkan::ReleaseImpl()
 	m_present.reset();
 	m_transferHost.reset();
 	m_transferLocal.reset();
+	m_stagingRing.reset();
 	m_frameCommandBuffer.reset();
 
 	m_context->device.vkDestroyImageView(m_context->device, m_context->swizzleTablePSMCT32View, nullptr);
@@ -257,6 +265,7 @@ void CGSH_Vulkan::ReleaseImpl()
 	m_swizzleTablePSMZ16.Reset();
 	m_swizzleTablePSMZ16S.Reset();
 
+	DestroyPipelineCache();
 	m_context->device.vkDestroyDescriptorPool(m_context->device, m_context->descriptorPool, nullptr);
 	m_context->clutBuffer.Reset();
 	m_context->memoryBuffer.Reset();
@@ -1382,7 +1391,7 @@ void CGSH_Vulkan::WriteRegisterImpl(uint8 registerId, uint64 data)
 {
 	//Some games such as Silent Hill 2 don't finish their transfers
 	//completely: make sure we push the data to the GS's RAM nevertheless.
-	if(!m_xferBuffer.empty() && (registerId != GS_REG_HWREG))
+	if(m_transferHost->HasPendingTransfer() && (registerId != GS_REG_HWREG))
 	{
 		ProcessHostToLocalTransfer();
 	}
@@ -1447,9 +1456,7 @@ void CGSH_Vulkan::ProcessHostToLocalTransfer()
 	pipelineCaps.dstFormat = bltBuf.nDstPsm;
 
 	m_transferHost->SetPipelineCaps(pipelineCaps);
-	m_transferHost->DoTransfer(m_xferBuffer);
-
-	m_xferBuffer.clear();
+	m_transferHost->DoTransfer();
 }
 
 void CGSH_Vulkan::ProcessLocalToHostTransfer()
@@ -1583,13 +1590,13 @@ void CGSH_Vulkan::ProcessClutTransfer(uint32 csa, uint32)
 
 void CGSH_Vulkan::BeginTransferWrite()
 {
-	assert(m_xferBuffer.empty());
-	m_xferBuffer.clear();
+	assert(!m_transferHost->HasPendingTransfer());
+	m_transferHost->BeginTransfer(m_trxCtx.nSize);
 }
 
 void CGSH_Vulkan::TransferWrite(const uint8* imageData, uint32 length)
 {
-	m_xferBuffer.insert(m_xferBuffer.end(), imageData, imageData + length);
+	m_transferHost->WriteTransfer(imageData, length);
 }
 
 void CGSH_Vulkan::WriteBackMemoryCache()
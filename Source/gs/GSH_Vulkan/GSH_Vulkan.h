@@ -8,11 +8,15 @@
 #include "GSH_VulkanClutLoad.h"
 #include "GSH_VulkanDraw.h"
 #include "GSH_VulkanPresent.h"
+#include "GSH_VulkanStagingRing.h"
 #include "GSH_VulkanTransferHost.h"
 #include "GSH_VulkanTransferLocal.h"
 #include <vector>
 #include <map>
 #include <cstring>
+#include <thread>
+#include <atomic>
+#include "filesystem_def.h"
 #include "../GSHandler.h"
 #include "../GsDebuggerInterface.h"
 #include "../GsCachedArea.h"
@@ -59,6 +63,7 @@ protected:
 	void InitializeImpl() override;
 	void ReleaseImpl() override;
 	void ResetImpl() override;
+	void NotifyTitleChangedImpl(const std::string&) override;
 	void MarkNewFrame() override;
 	void FlipImpl(const DISPLAY_INFO&) override;
 	void BeginTransferWrite() override;
@@ -90,6 +95,21 @@ private:
 		CLUT_CACHE_SIZE = 32,
 	};
 
+	enum PIPELINE_KIND : uint32
+	{
+		PIPELINE_KIND_DRAW,
+		PIPELINE_KIND_TRANSFERHOST,
+		PIPELINE_KIND_TRANSFERLOCAL,
+		PIPELINE_KIND_CLUTLOAD,
+	};
+
+	struct TITLE_PIPELINE
+	{
+		uint32 kind = 0;
+		uint64 caps = 0;
+	};
+	typedef std::vector<TITLE_PIPELINE> TitlePipelineArray;
+
 	struct REG_STATE
 	{
 		bool isValid = false;
@@ -149,6 +169,12 @@ private:
 	void CreateMemoryBuffer();
 	void CreateClutBuffer();
 
+	void CreatePipelineCache();
+	void DestroyPipelineCache();
+	void SaveTitlePipelines();
+	void StartPipelinePrewarm(TitlePipelineArray);
+	void StopPipelinePrewarm();
+
 	void ProcessPrim(uint64);
 	void VertexKick(uint8, uint64);
 	void SetRenderingContext(uint64);
@@ -229,6 +255,7 @@ private:
 	}
 
 	GSH_Vulkan::FrameCommandBufferPtr m_frameCommandBuffer;
+	GSH_Vulkan::StagingRingPtr m_stagingRing;
 	GSH_Vulkan::ClutLoadPtr m_clutLoad;
 	GSH_Vulkan::DrawPtr m_draw;
 	GSH_Vulkan::PresentPtr m_present;
@@ -252,9 +279,15 @@ private:
 	uint32 m_texHeight = 0;
 	CLUTKEY m_clutStates[CLUT_CACHE_SIZE];
 	uint32 m_nextClutCacheIndex = 0;
-	std::vector<uint8> m_xferBuffer;
 	std::map<uint64, LOCAL_TO_HOST_XFER_HISTORY> m_xferHistory;
 
+	//VkPipelineCache contents are saved on disk, pipelines used by the current
+	//title are recreated on a background thread when the title starts
+	fs::path m_pipelineCachePath;
+	fs::path m_titlePipelinesPath;
+	std::thread m_prewarmThread;
+	std::atomic<bool> m_prewarmCancelled{false};
+
 	//Optimization for Virtua Fighter 2, Sega Rally 95
 	float m_lastLineU = 0;
 	float m_lastLineV = 0;
@@ -12,13 +12,17 @@ namespace GSH_Vulkan
 	class CClutLoad
 	{
 	public:
+		typedef uint32 PipelineCapsInt;
+
 		CClutLoad(const ContextPtr&, const FrameCommandBufferPtr&);
 
 		void DoClutLoad(uint32, const CGSHandler::TEX0&, const CGSHandler::TEXCLUT&);
 
-	private:
-		typedef uint32 PipelineCapsInt;
+		void PrewarmPipeline(PipelineCapsInt);
+		std::vector<PipelineCapsInt> GetPipelineKeys() const;
+		void ResetPipelineKeys();
 
+	private:
 		struct PIPELINE_CAPS : public convertible<PipelineCapsInt>
 		{
 			uint32 idx8 : 1;
@@ -0,0 +1,289 @@
+#include <cassert>
+#include <cctype>
+#include <cstring>
+#include "GSH_Vulkan.h"
+#include "AppConfig.h"
+#include "PathUtils.h"
+#include "StdStreamUtils.h"
+#include "string_format.h"
+#include "Log.h"
+
+#define LOG_NAME ("gsh_vulkan")
+
+/////////////////////////////////////////////////////////////
+// Pipeline Cache
+/////////////////////////////////////////////////////////////
+
+//Pipeline cache file contains a magic, a version, the size of the data returned
+//by vkGetPipelineCacheData and the data itself. Title file contains a magic, a
+//version and a list of (kind, caps) records.
+
+#define PIPELINE_CACHE_DIRECTORY "shadercache"
+#define PIPELINE_CACHE_TITLES_DIRECTORY "titles"
+
+//Increment this when changes to shader generation are made
+static const uint32 g_pipelineCacheVersion = 1;
+static const uint32 g_pipelineCacheMagic = 0x4350564B;  //'KVPC'
+static const uint32 g_titlePipelinesMagic = 0x5450564B; //'KVPT'
+
+static std::string MakeTitleFileName(const std::string& titleId)
+{
+	auto result = titleId;
+	for(auto& character : result)
+	{
+		if(!isalnum(static_cast<unsigned char>(character)) && (character != '_') && (character != '.'))
+		{
+			character = '_';
+		}
+	}
+	return result + ".vkkeys";
+}
+
+static bool CheckCacheFileHeader(Framework::CStream& stream, uint64 fileSize, uint32 magic)
+{
+	if(fileSize < 8) return false;
+	if(stream.Read32() != magic) return false;
+	if(stream.Read32() != g_pipelineCacheVersion) return false;
+	return true;
+}
+
+static bool IsPipelineCacheDataCompatible(const std::vector<uint8>& data, const VkPhysicalDeviceProperties& properties)
+{
+	//Check VkPipelineCacheHeaderVersionOne ourselves, some drivers don't handle mismatching data gracefully
+	static const uint32 headerSize = 16 + VK_UUID_SIZE;
+	if(data.size() < headerSize) return false;
+	uint32 fields[4] = {};
+	memcpy(fields, data.data(), sizeof(fields));
+	if(fields[0] < headerSize) return false;
+	if(fields[1] != VK_PIPELINE_CACHE_HEADER_VERSION_ONE) return false;
+	if(fields[2] != properties.vendorID) return false;
+	if(fields[3] != properties.deviceID) return false;
+	if(memcmp(data.data() + 16, properties.pipelineCacheUUID, VK_UUID_SIZE) != 0) return false;
+	return true;
+}
+
+void CGSH_Vulkan::CreatePipelineCache()
+{
+	assert(m_context->pipelineCache == VK_NULL_HANDLE);
+
+	VkPhysicalDeviceProperties properties = {};
+	m_instance.vkGetPhysicalDeviceProperties(m_context->physicalDevice, &properties);
+
+	std::vector<uint8> initialData;
+	m_pipelineCachePath.clear();
+
+	try
+	{
+		auto cacheDirectoryPath = CAppConfig::GetInstance().GetBasePath() / PIPELINE_CACHE_DIRECTORY;
+		Framework::PathUtils::EnsurePathExists(cacheDirectoryPath);
+
+		auto pipelineCachePath = cacheDirectoryPath / string_format("vulkan_%08x_%08x.bin", properties.vendorID, properties.deviceID);
+		if(fs::exists(pipelineCachePath))
+		{
+			uint64 fileSize = fs::file_size(pipelineCachePath);
+			auto stream = Framework::CreateInputStdStream(pipelineCachePath.native());
+			if(CheckCacheFileHeader(stream, fileSize, g_pipelineCacheMagic) && (fileSize >= 16))
+			{
+				uint64 dataSize = stream.Read64();
+				if(dataSize == (fileSize - 16))
+				{
+					initialData.resize(dataSize);
+					stream.Read(initialData.data(), dataSize);
+				}
+			}
+		}
+
+		m_pipelineCachePath = pipelineCachePath;
+	}
+	catch(...)
+	{
+		initialData.clear();
+	}
+
+	if(!IsPipelineCacheDataCompatible(initialData, properties))
+	{
+		initialData.clear();
+	}
+
+	VkPipelineCacheCreateInfo pipelineCacheCreateInfo = {};
+	pipelineCacheCreateInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_CACHE_CREATE_INFO;
+	pipelineCacheCreateInfo.initialDataSize = initialData.size();
+	pipelineCacheCreateInfo.pInitialData = initialData.empty() ? nullptr : initialData.data();
+
+	auto result = m_context->device.vkCreatePipelineCache(m_context->device, &pipelineCacheCreateInfo, nullptr, &m_context->pipelineCache);
+	if(result != VK_SUCCESS)
+	{
+		//Try again without the data we've loaded
+		pipelineCacheCreateInfo.initialDataSize = 0;
+		pipelineCacheCreateInfo.pInitialData = nullptr;
+		result = m_context->device.vkCreatePipelineCache(m_context->device, &pipelineCacheCreateInfo, nullptr, &m_context->pipelineCache);
+		CHECKVULKANERROR(result);
+	}
+
+	CLog::GetInstance().Print(LOG_NAME, "Created pipeline cache with %d bytes of initial data.\r\n", static_cast<int>(pipelineCacheCreateInfo.initialDataSize));
+}
+
+void CGSH_Vulkan::DestroyPipelineCache()
+{
+	if(m_context->pipelineCache == VK_NULL_HANDLE) return;
+
+	if(!m_pipelineCachePath.empty())
+	{
+		size_t dataSize = 0;
+		auto result = m_context->device.vkGetPipelineCacheData(m_context->device, m_context->pipelineCache, &dataSize, nullptr);
+		if((result == VK_SUCCESS) && (dataSize != 0))
+		{
+			std::vector<uint8> data(dataSize);
+			result = m_context->device.vkGetPipelineCacheData(m_context->device, m_context->pipelineCache, &dataSize, data.data());
+			if(result == VK_SUCCESS)
+			{
+				try
+				{
+					auto stream = Framework::CreateOutputStdStream(m_pipelineCachePath.native());
+					stream.Write32(g_pipelineCacheMagic);
+					stream.Write32(g_pipelineCacheVersion);
+					stream.Write64(dataSize);
+					stream.Write(data.data(), dataSize);
+				}
+				catch(...)
+				{
+				}
+			}
+		}
+	}
+
+	m_context->device.vkDestroyPipelineCache(m_context->device, m_context->pipelineCache, nullptr);
+	m_context->pipelineCache = VK_NULL_HANDLE;
+	m_pipelineCachePath.clear();
+}
+
+void CGSH_Vulkan::SaveTitlePipelines()
+{
+	if(m_titlePipelinesPath.empty()) return;
+
+	//Every pipeline used since the title was started is recorded, this includes
+	//the ones that were prewarmed from the previous session's list.
+	TitlePipelineArray titlePipelines;
+	auto addPipelines =
+	    [&titlePipelines](uint32 kind, const auto& keys) {
+		    for(const auto& key : keys)
+		    {
+			    TITLE_PIPELINE titlePipeline;
+			    titlePipeline.kind = kind;
+			    titlePipeline.caps = key;
+			    titlePipelines.push_back(titlePipeline);
+		    }
+	    };
+	addPipelines(PIPELINE_KIND_DRAW, m_draw->GetPipelineKeys());
+	addPipelines(PIPELINE_KIND_TRANSFERHOST, m_transferHost->GetPipelineKeys());
+	addPipelines(PIPELINE_KIND_TRANSFERLOCAL, m_transferLocal->GetPipelineKeys());
+	addPipelines(PIPELINE_KIND_CLUTLOAD, m_clutLoad->GetPipelineKeys());
+
+	try
+	{
+		auto stream = Framework::CreateOutputStdStream(m_titlePipelinesPath.native());
+		stream.Write32(g_titlePipelinesMagic);
+		stream.Write32(g_pipelineCacheVersion);
+		for(const auto& titlePipeline : titlePipelines)
+		{
+			stream.Write32(titlePipeline.kind);
+			stream.Write64(titlePipeline.caps);
+		}
+	}
+	catch(...)
+	{
+	}
+}
+
+void CGSH_Vulkan::StartPipelinePrewarm(TitlePipelineArray titlePipelines)
+{
+	assert(!m_prewarmThread.joinable());
+	if(titlePipelines.empty()) return;
+
+	m_prewarmCancelled = false;
+	m_prewarmThread = std::thread(
+	    [this, titlePipelines = std::move(titlePipelines)]() {
+		    //Pipelines are created against m_context->pipelineCache, which is internally synchronized.
+		    //Pipeline caches of every component are protected by a mutex, if the GS thread needs a
+		    //pipeline before we got to it, it will create it itself and ours will be discarded.
+		    for(const auto& titlePipeline : titlePipelines)
+		    {
+			    if(m_prewarmCancelled) break;
+			    switch(titlePipeline.kind)
+			    {
+			    case PIPELINE_KIND_DRAW:
+				    m_draw->PrewarmPipeline(titlePipeline.caps);
+				    break;
+			    case PIPELINE_KIND_TRANSFERHOST:
+				    m_transferHost->PrewarmPipeline(static_cast<CTransferHost::PipelineCapsInt>(titlePipeline.caps));
+				    break;
+			    case PIPELINE_KIND_TRANSFERLOCAL:
+				    m_transferLocal->PrewarmPipeline(static_cast<CTransferLocal::PipelineCapsInt>(titlePipeline.caps));
+				    break;
+			    case PIPELINE_KIND_CLUTLOAD:
+				    m_clutLoad->PrewarmPipeline(static_cast<CClutLoad::PipelineCapsInt>(titlePipeline.caps));
+				    break;
+			    default:
+				    break;
+			    }
+		    }
+		    CLog::GetInstance().Print(LOG_NAME, "Done prewarming %d pipelines.\r\n", static_cast<int>(titlePipelines.size()));
+	    });
+}
+
+void CGSH_Vulkan::StopPipelinePrewarm()
+{
+	if(!m_prewarmThread.joinable()) return;
+	m_prewarmCancelled = true;
+	m_prewarmThread.join();
+}
+
+void CGSH_Vulkan::NotifyTitleChangedImpl(const std::string& titleId)
+{
+	if(!m_draw) return;
+
+	StopPipelinePrewarm();
+	SaveTitlePipelines();
+	m_titlePipelinesPath.clear();
+
+	//Pipelines stay in the cache, but only the ones used by the new title will be saved for it
+	m_draw->ResetPipelineKeys();
+	m_transferHost->ResetPipelineKeys();
+	m_transferLocal->ResetPipelineKeys();
+	m_clutLoad->ResetPipelineKeys();
+
+	if(titleId.empty()) return;
+
+	TitlePipelineArray titlePipelines;
+
+	try
+	{
+		auto titlesDirectoryPath = CAppConfig::GetInstance().GetBasePath() / PIPELINE_CACHE_DIRECTORY / PIPELINE_CACHE_TITLES_DIRECTORY;
+		Framework::PathUtils::EnsurePathExists(titlesDirectoryPath);
+
+		auto titlePipelinesPath = titlesDirectoryPath / MakeTitleFileName(titleId);
+		if(fs::exists(titlePipelinesPath))
+		{
+			uint64 fileSize = fs::file_size(titlePipelinesPath);
+			auto stream = Framework::CreateInputStdStream(titlePipelinesPath.native());
+			if(CheckCacheFileHeader(stream, fileSize, g_titlePipelinesMagic))
+			{
+				uint64 recordCount = (fileSize - 8) / 12;
+				titlePipelines.resize(recordCount);
+				for(auto& titlePipeline : titlePipelines)
+				{
+					titlePipeline.kind = stream.Read32();
+					titlePipeline.caps = stream.Read64();
+				}
+			}
+		}
+
+		m_titlePipelinesPath = titlePipelinesPath;
+	}
+	catch(...)
+	{
+		return;
+	}
+
+	StartPipelinePrewarm(std::move(titlePipelines));
+}
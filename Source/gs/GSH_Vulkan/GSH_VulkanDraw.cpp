@@ -16,44 +16,27 @@ using namespace GSH_Vulkan;
 #define VERTEX_ATTRIB_LOCATION_TEXCOORD 3
 #define VERTEX_ATTRIB_LOCATION_FOG 4
 
-#define MAX_VERTEX_COUNT 1024 * 512
-
-CDraw::CDraw(const ContextPtr& context, const FrameCommandBufferPtr& frameCommandBuffer)
+CDraw::CDraw(const ContextPtr& context, const FrameCommandBufferPtr& frameCommandBuffer, const StagingRingPtr& stagingRing)
     : m_context(context)
     , m_frameCommandBuffer(frameCommandBuffer)
+    , m_stagingRing(stagingRing)
     , m_pipelineCache(context->device)
 {
-	for(auto& frame : m_frames)
-	{
-		frame.vertexBuffer = Framework::Vulkan::CBuffer(
-		    m_context->device, m_context->physicalDeviceMemoryProperties,
-		    VK_BUFFER_USAGE_VERTEX_BUFFER_BIT, VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT,
-		    sizeof(PRIM_VERTEX) * MAX_VERTEX_COUNT);
-
-		auto result = m_context->device.vkMapMemory(m_context->device, frame.vertexBuffer.GetMemory(),
-		                                            0, VK_WHOLE_SIZE, 0, reinterpret_cast<void**>(&frame.vertexBufferPtr));
-		CHECKVULKANERROR(result);
-
-		frame.mipParamsBuffer = Framework::Vulkan::CBuffer(
-		    m_context->device, m_context->physicalDeviceMemoryProperties,
-		    VK_BUFFER_USAGE_UNIFORM_BUFFER_BIT, VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT,
-		    sizeof(DRAW_PIPELINE_MIPPARAMS_UNIFORMS) * MAX_MIPPARAMS_COUNT);
-
-		result = m_context->device.vkMapMemory(m_context->device, frame.mipParamsBuffer.GetMemory(),
-		                                       0, VK_WHOLE_SIZE, 0, reinterpret_cast<void**>(&frame.mipParamsBufferPtr));
-		CHECKVULKANERROR(result);
-	}
-
 	m_pipelineCaps <<= 0;
 }
 
 CDraw::~CDraw()
 {
-	for(auto& frame : m_frames)
-	{
-		m_context->device.vkUnmapMemory(m_context->device, frame.vertexBuffer.GetMemory());
-		m_context->device.vkUnmapMemory(m_context->device, frame.mipParamsBuffer.GetMemory());
-	}
+}
+
+std::vector<CDraw::PipelineCapsInt> CDraw::GetPipelineKeys() const
+{
+	return m_pipelineCache.GetTitleKeys();
+}
+
+void CDraw::ResetPipelineKeys()
+{
+	m_pipelineCache.ResetTitleKeys();
 }
 
 void CDraw::SetPipelineCaps(const PIPELINE_CAPS& caps)
@@ -116,17 +99,11 @@ void CDraw::SetMipParams(const MipBufs& mipBufs, uint32 maxMip, float lodK, uint
 	assert(m_pipelineCaps.textureUseDynamicMipLOD);
 	//Assume it's always dirty, check for changes should be done by caller
 	FlushVertices();
-	auto& frame = m_frames[m_frameCommandBuffer->GetCurrentFrame()];
-	m_mipParamsIndex++;
-	assert(m_mipParamsIndex < MAX_MIPPARAMS_COUNT);
-	if(m_mipParamsIndex < MAX_MIPPARAMS_COUNT)
-	{
-		auto mipParamsUniforms = frame.mipParamsBufferPtr + m_mipParamsIndex;
-		mipParamsUniforms->mipBufs = mipBufs;
-		mipParamsUniforms->maxMip = maxMip;
-		mipParamsUniforms->lodK = lodK;
-		mipParamsUniforms->lodL = lodL;
-	}
+	m_mipParams.mipBufs = mipBufs;
+	m_mipParams.maxMip = maxMip;
+	m_mipParams.lodK = lodK;
+	m_mipParams.lodL = lodL;
+	m_mipParamsDirty = true;
 }
 
 void CDraw::SetClutBufferOffset(uint32 clutBufferOffset)
@@ -223,10 +200,13 @@ void CDraw::SetMemoryCopyParams(uint32 memoryCopyAddress, uint32 memoryCopySize)
 void CDraw::AddVertices(const PRIM_VERTEX* vertexBeginPtr, const PRIM_VERTEX* vertexEndPtr)
 {
 	auto amount = vertexEndPtr - vertexBeginPtr;
-	if((m_passVertexEnd + amount) > MAX_VERTEX_COUNT)
+	assert(amount <= VERTEX_BLOCK_COUNT);
+	if(!m_vertexBuffer.IsValid() || ((m_passVertexEnd + amount) > VERTEX_BLOCK_COUNT))
 	{
-		m_frameCommandBuffer->Flush();
-		assert((m_passVertexEnd + amount) <= MAX_VERTEX_COUNT);
+		//Draw what we have in the current block and continue in a new one
+		FlushRenderPass();
+		m_vertexBuffer = m_stagingRing->Allocate(sizeof(PRIM_VERTEX) * VERTEX_BLOCK_COUNT, sizeof(PRIM_VERTEX));
+		m_passVertexStart = m_passVertexEnd = 0;
 	}
 	if(m_pipelineCaps.textureUseMemoryCopy)
 	{
@@ -251,8 +231,7 @@ void CDraw::AddVertices(const PRIM_VERTEX* vertexBeginPtr, const PRIM_VERTEX* ve
 			m_memoryCopyRegion.Insert(rect);
 		}
 	}
-	auto& frame = m_frames[m_frameCommandBuffer->GetCurrentFrame()];
-	memcpy(frame.vertexBufferPtr + m_passVertexEnd, vertexBeginPtr, amount * sizeof(PRIM_VERTEX));
+	memcpy(GetVertexBufferPtr() + m_passVertexEnd, vertexBeginPtr, amount * sizeof(PRIM_VERTEX));
 	m_passVertexEnd += amount;
 }
 
@@ -263,8 +242,24 @@ void CDraw::PreFlushFrameCommandBuffer()
 
 void CDraw::PostFlushFrameCommandBuffer()
 {
+	//Staging memory is only guaranteed to be kept alive for the frame it was allocated in
+	m_vertexBuffer = CStagingRing::ALLOCATION();
 	m_passVertexStart = m_passVertexEnd = 0;
-	m_mipParamsIndex = 0;
+	m_mipParamsBuffer = CStagingRing::ALLOCATION();
+	m_mipParamsDirty = true;
+}
+
+CDraw::PRIM_VERTEX* CDraw::GetVertexBufferPtr() const
+{
+	return reinterpret_cast<PRIM_VERTEX*>(m_vertexBuffer.ptr);
+}
+
+void CDraw::CommitMipParams()
+{
+	if(!m_mipParamsDirty) return;
+	m_mipParamsBuffer = m_stagingRing->Allocate(sizeof(DRAW_PIPELINE_MIPPARAMS_UNIFORMS), sizeof(DRAW_PIPELINE_MIPPARAMS_UNIFORMS));
+	memcpy(m_mipParamsBuffer.ptr, &m_mipParams, sizeof(DRAW_PIPELINE_MIPPARAMS_UNIFORMS));
+	m_mipParamsDirty = false;
 }
 
 std::vector<VkVertexInputAttributeDescription> CDraw::GetVertexAttributes()
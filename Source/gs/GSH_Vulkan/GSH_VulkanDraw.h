@@ -4,6 +4,7 @@
 #include "GSH_VulkanContext.h"
 #include "GSH_VulkanFrameCommandBuffer.h"
 #include "GSH_VulkanPipelineCache.h"
+#include "GSH_VulkanStagingRing.h"
 #include "vulkan/ShaderModule.h"
 #include "vulkan/Buffer.h"
 #include "vulkan/Image.h"
@@ -15,11 +16,6 @@ namespace GSH_Vulkan
 	class CDraw : public IFrameCommandBufferWriter
 	{
 	public:
-		enum
-		{
-			MAX_FRAMES = CFrameCommandBuffer::MAX_FRAMES,
-		};
-
 		typedef uint64 PipelineCapsInt;
 
 		enum PIPELINE_PRIMITIVE_TYPE
@@ -83,7 +79,7 @@ namespace GSH_Vulkan
 
 		using MipBufs = std::array<std::pair<uint32, uint32>, 6>;
 
-		CDraw(const ContextPtr&, const FrameCommandBufferPtr&);
+		CDraw(const ContextPtr&, const FrameCommandBufferPtr&, const StagingRingPtr&);
 		virtual ~CDraw();
 
 		virtual void SetPipelineCaps(const PIPELINE_CAPS&);
@@ -104,6 +100,10 @@ namespace GSH_Vulkan
 		virtual void FlushVertices() = 0;
 		virtual void FlushRenderPass() = 0;
 
+		virtual void PrewarmPipeline(PipelineCapsInt) = 0;
+		std::vector<PipelineCapsInt> GetPipelineKeys() const;
+		void ResetPipelineKeys();
+
 		void PreFlushFrameCommandBuffer() override;
 		void PostFlushFrameCommandBuffer() override;
 
@@ -113,7 +113,7 @@ namespace GSH_Vulkan
 			DRAW_AREA_SIZE = 2048
 		};
 
-		static constexpr uint32 MAX_MIPPARAMS_COUNT = 2048;
+		static constexpr uint32 VERTEX_BLOCK_COUNT = 0x10000;
 
 		typedef uint32 DescriptorSetCapsInt;
 
@@ -124,7 +124,7 @@ namespace GSH_Vulkan
 			uint32 textureUseDynamicMipLOD : 1;
 			uint32 framebufferFormat : 6;
 			uint32 depthbufferFormat : 6;
-			uint32 frameNumber : 2;
+			uint32 mipParamsChunk : 12;
 		};
 		static_assert(sizeof(DESCRIPTORSET_CAPS) == sizeof(DescriptorSetCapsInt));
 		typedef std::unordered_map<DescriptorSetCapsInt, VkDescriptorSet> DescriptorSetCache;
@@ -186,32 +186,30 @@ namespace GSH_Vulkan
 		//Needs to accomodate minUniformBufferOffsetAlignment, which seems to be at most 0x100 in the wild
 		static_assert((sizeof(DRAW_PIPELINE_MIPPARAMS_UNIFORMS) & 0xFF) == 0);
 
-		struct FRAMECONTEXT
-		{
-			Framework::Vulkan::CBuffer vertexBuffer;
-			PRIM_VERTEX* vertexBufferPtr = nullptr;
-
-			Framework::Vulkan::CBuffer mipParamsBuffer;
-			DRAW_PIPELINE_MIPPARAMS_UNIFORMS* mipParamsBufferPtr = nullptr;
-		};
-
 		static std::vector<VkVertexInputAttributeDescription> GetVertexAttributes();
 		Framework::Vulkan::CShaderModule CreateVertexShader(const PIPELINE_CAPS&);
 
+		PRIM_VERTEX* GetVertexBufferPtr() const;
+		void CommitMipParams();
+
 		static constexpr float DEPTH_MAX = 4294967296.0f;
 
 		ContextPtr m_context;
 		FrameCommandBufferPtr m_frameCommandBuffer;
+		StagingRingPtr m_stagingRing;
 		PipelineCache m_pipelineCache;
 		DescriptorSetCache m_descriptorSetCache;
 
-		FRAMECONTEXT m_frames[MAX_FRAMES];
-
+		//Vertices are accumulated in blocks allocated from the staging ring,
+		//pass vertex indices are relative to the current block
+		CStagingRing::ALLOCATION m_vertexBuffer;
 		uint32 m_passVertexStart = 0;
 		uint32 m_passVertexEnd = 0;
 		bool m_renderPassBegun = false;
 
-		uint32 m_mipParamsIndex = 0;
+		DRAW_PIPELINE_MIPPARAMS_UNIFORMS m_mipParams = {};
+		CStagingRing::ALLOCATION m_mipParamsBuffer;
+		bool m_mipParamsDirty = true;
 
 		PIPELINE_CAPS m_pipelineCaps;
 		DRAW_PIPELINE_PUSHCONSTANTS m_pushConstants;
@@ -21,8 +21,8 @@ enum DESCRIPTORS
 
 using namespace GSH_Vulkan;
 
-CDrawDesktop::CDrawDesktop(const ContextPtr& context, const FrameCommandBufferPtr& frameCommandBuffer)
-    : CDraw(context, frameCommandBuffer)
+CDrawDesktop::CDrawDesktop(const ContextPtr& context, const FrameCommandBufferPtr& frameCommandBuffer, const StagingRingPtr& stagingRing)
+    : CDraw(context, frameCommandBuffer, stagingRing)
 {
 	CreateRenderPass();
 	CreateDrawImage();
@@ -301,7 +301,7 @@ PIPELINE CDrawDesktop::CreateDrawPipeline(const PIPELINE_CAPS& caps)
 	pipelineCreateInfo.renderPass = m_renderPass;
 	pipelineCreateInfo.layout = drawPipeline.pipelineLayout;
 
-	result = m_context->device.vkCreateGraphicsPipelines(m_context->device, VK_NULL_HANDLE, 1, &pipelineCreateInfo, nullptr, &drawPipeline.pipeline);
+	result = m_context->device.vkCreateGraphicsPipelines(m_context->device, m_context->pipelineCache, 1, &pipelineCreateInfo, nullptr, &drawPipeline.pipeline);
 	CHECKVULKANERROR(result);
 
 	return drawPipeline;
@@ -329,8 +329,6 @@ VkDescriptorSet CDrawDesktop::PrepareDescriptorSet(VkDescriptorSetLayout descrip
 		CHECKVULKANERROR(result);
 	}
 
-	auto& frame = m_frames[caps.frameNumber];
-
 	//Update descriptor set
 	{
 		VkDescriptorBufferInfo descriptorMemoryBufferInfo = {};
@@ -346,7 +344,7 @@ VkDescriptorSet CDrawDesktop::PrepareDescriptorSet(VkDescriptorSetLayout descrip
 		descriptorClutBufferInfo.range = sizeof(uint32) * CGSHandler::CLUTENTRYCOUNT;
 
 		VkDescriptorBufferInfo descriptorMipParamsUniformInfo = {};
-		descriptorMipParamsUniformInfo.buffer = frame.mipParamsBuffer;
+		descriptorMipParamsUniformInfo.buffer = (caps.hasTexture && caps.textureUseDynamicMipLOD) ? m_stagingRing->GetChunkBuffer(caps.mipParamsChunk) : VK_NULL_HANDLE;
 		descriptorMipParamsUniformInfo.range = sizeof(DRAW_PIPELINE_MIPPARAMS_UNIFORMS);
 
 		VkDescriptorImageInfo descriptorTexSwizzleTableImageInfo = {};
@@ -951,7 +949,6 @@ void CDrawDesktop::FlushVertices()
 	uint32 vertexCount = m_passVertexEnd - m_passVertexStart;
 	if(vertexCount == 0) return;
 
-	auto& frame = m_frames[m_frameCommandBuffer->GetCurrentFrame()];
 	auto commandBuffer = m_frameCommandBuffer->GetCommandBuffer();
 
 	if(m_pipelineCaps.textureUseMemoryCopy)
@@ -1023,7 +1020,11 @@ void CDrawDesktop::FlushVertices()
 	descriptorSetCaps.depthbufferFormat = m_pipelineCaps.depthbufferFormat;
 	descriptorSetCaps.textureFormat = m_pipelineCaps.textureFormat;
 	descriptorSetCaps.textureUseDynamicMipLOD = m_pipelineCaps.textureUseDynamicMipLOD;
-	descriptorSetCaps.frameNumber = m_frameCommandBuffer->GetCurrentFrame();
+	if(m_pipelineCaps.hasTexture && m_pipelineCaps.textureUseDynamicMipLOD)
+	{
+		CommitMipParams();
+		descriptorSetCaps.mipParamsChunk = m_mipParamsBuffer.chunkIndex;
+	}
 
 	auto descriptorSet = PrepareDescriptorSet(drawPipeline->descriptorSetLayout, descriptorSetCaps);
 
@@ -1038,7 +1039,7 @@ void CDrawDesktop::FlushVertices()
 	}
 	if(m_pipelineCaps.hasTexture && m_pipelineCaps.textureUseDynamicMipLOD)
 	{
-		descriptorDynamicOffsets.push_back(m_mipParamsIndex * sizeof(DRAW_PIPELINE_MIPPARAMS_UNIFORMS));
+		descriptorDynamicOffsets.push_back(m_mipParamsBuffer.offset);
 	}
 
 	m_context->device.vkCmdBindDescriptorSets(commandBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS, drawPipeline->pipelineLayout,
@@ -1046,8 +1047,8 @@ void CDrawDesktop::FlushVertices()
 
 	m_context->device.vkCmdBindPipeline(commandBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS, drawPipeline->pipeline);
 
-	VkDeviceSize vertexBufferOffset = (m_passVertexStart * sizeof(PRIM_VERTEX));
-	VkBuffer vertexBuffer = frame.vertexBuffer;
+	VkDeviceSize vertexBufferOffset = m_vertexBuffer.offset + (m_passVertexStart * sizeof(PRIM_VERTEX));
+	VkBuffer vertexBuffer = m_vertexBuffer.buffer;
 	m_context->device.vkCmdBindVertexBuffers(commandBuffer, 0, 1, &vertexBuffer, &vertexBufferOffset);
 
 	m_context->device.vkCmdPushConstants(commandBuffer, drawPipeline->pipelineLayout, VK_SHADER_STAGE_FRAGMENT_BIT,
@@ -1068,3 +1069,10 @@ void CDrawDesktop::FlushRenderPass()
 		m_renderPassBegun = false;
 	}
 }
+
+void CDrawDesktop::PrewarmPipeline(PipelineCapsInt capsInt)
+{
+	auto caps = make_convertible<PIPELINE_CAPS>(capsInt);
+	if(m_pipelineCache.HasPipeline(caps)) return;
+	m_pipelineCache.RegisterPipeline(caps, CreateDrawPipeline(caps));
+}
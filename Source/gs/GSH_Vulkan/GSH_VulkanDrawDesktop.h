@@ -7,12 +7,14 @@ namespace GSH_Vulkan
 	class CDrawDesktop : public CDraw
 	{
 	public:
-		CDrawDesktop(const ContextPtr&, const FrameCommandBufferPtr&);
+		CDrawDesktop(const ContextPtr&, const FrameCommandBufferPtr&, const StagingRingPtr&);
 		virtual ~CDrawDesktop();
 
 		void FlushVertices() override;
 		void FlushRenderPass() override;
 
+		void PrewarmPipeline(PipelineCapsInt) override;
+
 	private:
 		void CreateRenderPass();
 		void CreateFramebuffer();
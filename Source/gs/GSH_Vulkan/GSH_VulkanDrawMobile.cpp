@@ -26,12 +26,11 @@ using namespace GSH_Vulkan;
 #define DESCRIPTOR_LOCATION_IMAGE_INPUT_DEPTH 6
 
 #define DRAW_AREA_SIZE 2048
-#define MAX_VERTEX_COUNT 1024 * 512
 
 #define DEPTH_MAX (4294967296.0f)
 
-CDrawMobile::CDrawMobile(const ContextPtr& context, const FrameCommandBufferPtr& frameCommandBuffer)
-    : CDraw(context, frameCommandBuffer)
+CDrawMobile::CDrawMobile(const ContextPtr& context, const FrameCommandBufferPtr& frameCommandBuffer, const StagingRingPtr& stagingRing)
+    : CDraw(context, frameCommandBuffer, stagingRing)
     , m_loadPipelineCache(context->device)
     , m_storePipelineCache(context->device)
 {
@@ -118,10 +117,10 @@ void CDrawMobile::FlushVertices()
 	uint32 vertexCount = m_passVertexEnd - m_passVertexStart;
 	if(vertexCount == 0) return;
 
-	auto& frame = m_frames[m_frameCommandBuffer->GetCurrentFrame()];
 	auto commandBuffer = m_frameCommandBuffer->GetCommandBuffer();
 
-	for(auto vertex = frame.vertexBufferPtr + m_passVertexStart; vertex != frame.vertexBufferPtr + m_passVertexEnd; vertex++)
+	auto vertexBufferPtr = GetVertexBufferPtr();
+	for(auto vertex = vertexBufferPtr + m_passVertexStart; vertex != vertexBufferPtr + m_passVertexEnd; vertex++)
 	{
 		m_renderPassMinX = std::min(vertex->x, m_renderPassMinX);
 		m_renderPassMinY = std::min(vertex->y, m_renderPassMinY);
@@ -223,8 +222,8 @@ void CDrawMobile::FlushVertices()
 
 	m_context->device.vkCmdBindPipeline(commandBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS, drawPipeline->pipeline);
 
-	VkDeviceSize vertexBufferOffset = (m_passVertexStart * sizeof(PRIM_VERTEX));
-	VkBuffer vertexBuffer = frame.vertexBuffer;
+	VkDeviceSize vertexBufferOffset = m_vertexBuffer.offset + (m_passVertexStart * sizeof(PRIM_VERTEX));
+	VkBuffer vertexBuffer = m_vertexBuffer.buffer;
 	m_context->device.vkCmdBindVertexBuffers(commandBuffer, 0, 1, &vertexBuffer, &vertexBufferOffset);
 
 	m_context->device.vkCmdPushConstants(commandBuffer, drawPipeline->pipelineLayout, VK_SHADER_STAGE_FRAGMENT_BIT,
@@ -235,6 +234,26 @@ void CDrawMobile::FlushVertices()
 	m_passVertexStart = m_passVertexEnd;
 }
 
+void CDrawMobile::PrewarmPipeline(PipelineCapsInt capsInt)
+{
+	auto caps = make_convertible<PIPELINE_CAPS>(capsInt);
+	if(!m_pipelineCache.HasPipeline(caps))
+	{
+		m_pipelineCache.RegisterPipeline(caps, CreateDrawPipeline(caps));
+	}
+
+	//Load/store pipelines used around this draw pipeline
+	auto strippedCaps = MakeLoadStorePipelineCaps(caps);
+	if(!m_loadPipelineCache.HasPipeline(strippedCaps))
+	{
+		m_loadPipelineCache.RegisterPipeline(strippedCaps, CreateLoadPipeline(strippedCaps));
+	}
+	if(!m_storePipelineCache.HasPipeline(strippedCaps))
+	{
+		m_storePipelineCache.RegisterPipeline(strippedCaps, CreateStorePipeline(strippedCaps));
+	}
+}
+
 void CDrawMobile::FlushRenderPass()
 {
 	FlushVertices();
@@ -830,7 +849,7 @@ PIPELINE CDrawMobile::CreateDrawPipeline(const PIPELINE_CAPS& caps)
 	pipelineCreateInfo.renderPass = m_renderPass;
 	pipelineCreateInfo.layout = drawPipeline.pipelineLayout;
 
-	result = m_context->device.vkCreateGraphicsPipelines(m_context->device, VK_NULL_HANDLE, 1, &pipelineCreateInfo, nullptr, &drawPipeline.pipeline);
+	result = m_context->device.vkCreateGraphicsPipelines(m_context->device, m_context->pipelineCache, 1, &pipelineCreateInfo, nullptr, &drawPipeline.pipeline);
 	CHECKVULKANERROR(result);
 
 	return drawPipeline;
@@ -1387,7 +1406,7 @@ PIPELINE CDrawMobile::CreateLoadPipeline(const PIPELINE_CAPS& caps)
 	pipelineCreateInfo.renderPass = m_renderPass;
 	pipelineCreateInfo.layout = loadPipeline.pipelineLayout;
 
-	result = m_context->device.vkCreateGraphicsPipelines(m_context->device, VK_NULL_HANDLE, 1, &pipelineCreateInfo, nullptr, &loadPipeline.pipeline);
+	result = m_context->device.vkCreateGraphicsPipelines(m_context->device, m_context->pipelineCache, 1, &pipelineCreateInfo, nullptr, &loadPipeline.pipeline);
 	CHECKVULKANERROR(result);
 
 	return loadPipeline;
@@ -1546,7 +1565,7 @@ PIPELINE CDrawMobile::CreateStorePipeline(const PIPELINE_CAPS& caps)
 	pipelineCreateInfo.renderPass = m_renderPass;
 	pipelineCreateInfo.layout = storePipeline.pipelineLayout;
 
-	result = m_context->device.vkCreateGraphicsPipelines(m_context->device, VK_NULL_HANDLE, 1, &pipelineCreateInfo, nullptr, &storePipeline.pipeline);
+	result = m_context->device.vkCreateGraphicsPipelines(m_context->device, m_context->pipelineCache, 1, &pipelineCreateInfo, nullptr, &storePipeline.pipeline);
 	CHECKVULKANERROR(result);
 
 	return storePipeline;
@@ -8,7 +8,7 @@ namespace GSH_Vulkan
 	class CDrawMobile : public CDraw
 	{
 	public:
-		CDrawMobile(const ContextPtr&, const FrameCommandBufferPtr&);
+		CDrawMobile(const ContextPtr&, const FrameCommandBufferPtr&, const StagingRingPtr&);
 		virtual ~CDrawMobile();
 
 		void SetPipelineCaps(const PIPELINE_CAPS&) override;
@@ -19,6 +19,8 @@ namespace GSH_Vulkan
 		void FlushVertices() override;
 		void FlushRenderPass() override;
 
+		void PrewarmPipeline(PipelineCapsInt) override;
+
 	private:
 		VkDescriptorSet PrepareDescriptorSet(VkDescriptorSetLayout, const DESCRIPTORSET_CAPS&);
 
@@ -2,6 +2,9 @@
 
 #include "vulkan/Device.h"
 #include <unordered_map>
+#include <unordered_set>
+#include <vector>
+#include <mutex>
 
 namespace GSH_Vulkan
 {
@@ -12,6 +15,13 @@ namespace GSH_Vulkan
 		VkPipeline pipeline = VK_NULL_HANDLE;
 	};
 
+	//Pipelines can be registered from the prewarm thread while the GS thread
+	//is looking them up, all accesses to the shared map are protected by a mutex.
+	//Returned pointers stay valid since map nodes are never moved or erased.
+	//TryGetPipeline is only used by the GS thread, which keeps its own lookup map
+	//and only takes the lock the first time it sees a key. The prewarm thread uses
+	//HasPipeline instead. Keys of pipelines used since the last title change are
+	//tracked separately, pipelines stay in the cache across titles.
 	template <typename KeyType>
 	class CPipelineCache
 	{
@@ -25,30 +35,72 @@ namespace GSH_Vulkan
 		{
 			for(const auto& pipelinePair : m_pipelines)
 			{
-				auto& pipeline = pipelinePair.second;
-				m_device->vkDestroyPipeline(*m_device, pipeline.pipeline, nullptr);
-				m_device->vkDestroyPipelineLayout(*m_device, pipeline.pipelineLayout, nullptr);
-				m_device->vkDestroyDescriptorSetLayout(*m_device, pipeline.descriptorSetLayout, nullptr);
+				DestroyPipeline(pipelinePair.second);
 			}
 		}
 
-		const PIPELINE* TryGetPipeline(const KeyType& key) const
+		const PIPELINE* TryGetPipeline(const KeyType& key)
 		{
+			auto lookupIterator = m_lookupPipelines.find(key);
+			if(lookupIterator != std::end(m_lookupPipelines)) return lookupIterator->second;
+
+			std::lock_guard<std::mutex> lock(m_mutex);
 			auto pipelineIterator = m_pipelines.find(key);
-			return (pipelineIterator == std::end(m_pipelines)) ? nullptr : &pipelineIterator->second;
+			if(pipelineIterator == std::end(m_pipelines)) return nullptr;
+			m_titleKeys.insert(key);
+			m_lookupPipelines.insert(std::make_pair(key, &pipelineIterator->second));
+			return &pipelineIterator->second;
+		}
+
+		bool HasPipeline(const KeyType& key) const
+		{
+			std::lock_guard<std::mutex> lock(m_mutex);
+			return m_pipelines.find(key) != std::end(m_pipelines);
 		}
 
 		const PIPELINE* RegisterPipeline(const KeyType& key, const PIPELINE& pipeline)
 		{
-			assert(TryGetPipeline(key) == nullptr);
-			m_pipelines.insert(std::make_pair(key, pipeline));
-			return TryGetPipeline(key);
+			std::lock_guard<std::mutex> lock(m_mutex);
+			auto insertResult = m_pipelines.insert(std::make_pair(key, pipeline));
+			m_titleKeys.insert(key);
+			if(!insertResult.second)
+			{
+				//Someone else created the same pipeline in the meantime, keep theirs
+				DestroyPipeline(pipeline);
+			}
+			return &insertResult.first->second;
+		}
+
+		std::vector<KeyType> GetTitleKeys() const
+		{
+			std::lock_guard<std::mutex> lock(m_mutex);
+			return std::vector<KeyType>(std::begin(m_titleKeys), std::end(m_titleKeys));
+		}
+
+		//Must be called from the GS thread
+		void ResetTitleKeys()
+		{
+			std::lock_guard<std::mutex> lock(m_mutex);
+			m_titleKeys.clear();
+			m_lookupPipelines.clear();
 		}
 
 	private:
 		typedef std::unordered_map<KeyType, PIPELINE> PipelineMap;
+		typedef std::unordered_map<KeyType, const PIPELINE*> LookupPipelineMap;
+		typedef std::unordered_set<KeyType> KeySet;
+
+		void DestroyPipeline(const PIPELINE& pipeline) const
+		{
+			m_device->vkDestroyPipeline(*m_device, pipeline.pipeline, nullptr);
+			m_device->vkDestroyPipelineLayout(*m_device, pipeline.pipelineLayout, nullptr);
+			m_device->vkDestroyDescriptorSetLayout(*m_device, pipeline.descriptorSetLayout, nullptr);
+		}
 
 		const Framework::Vulkan::CDevice* m_device = nullptr;
+		mutable std::mutex m_mutex;
 		PipelineMap m_pipelines;
+		KeySet m_titleKeys;
+		LookupPipelineMap m_lookupPipelines;
 	};
 }
@@ -0,0 +1,160 @@
+#include <algorithm>
+#include "GSH_VulkanStagingRing.h"
+#include "vulkan/Utils.h"
+
+using namespace GSH_Vulkan;
+
+#define DEFAULT_CHUNK_SIZE 0x1000000
+
+CStagingRing::CStagingRing(const ContextPtr& context, const FrameCommandBufferPtr& frameCommandBuffer)
+    : m_context(context)
+    , m_frameCommandBuffer(frameCommandBuffer)
+{
+}
+
+CStagingRing::~CStagingRing()
+{
+	for(auto& chunk : m_chunks)
+	{
+		m_context->device.vkUnmapMemory(m_context->device, chunk.buffer.GetMemory());
+	}
+}
+
+CStagingRing::ALLOCATION CStagingRing::Allocate(uint32 size, uint32 alignment)
+{
+	assert(alignment != 0);
+	assert((alignment & (alignment - 1)) == 0);
+
+	uint32 offset = (m_currentOffset + (alignment - 1)) & ~(alignment - 1);
+	if(
+	    (m_currentChunk == INVALID_CHUNK) ||
+	    ((offset + size) > m_chunks[m_currentChunk].size))
+	{
+		SelectChunk(size);
+		offset = 0;
+	}
+
+	MarkUsed(m_currentChunk);
+	m_currentOffset = offset + size;
+
+	const auto& chunk = m_chunks[m_currentChunk];
+
+	ALLOCATION allocation;
+	allocation.chunkIndex = m_currentChunk;
+	allocation.buffer = chunk.buffer;
+	allocation.offset = offset;
+	allocation.size = size;
+	allocation.ptr = chunk.bufferPtr + offset;
+	return allocation;
+}
+
+void CStagingRing::MarkUsed(uint32 chunkIndex)
+{
+	auto& chunk = m_chunks[chunkIndex];
+	if(chunk.lastUseSerial == m_frameSerial) return;
+	chunk.lastUseSerial = m_frameSerial;
+	chunk.frameUseCount++;
+	m_frameChunks[m_frameCommandBuffer->GetCurrentFrame()].push_back(chunkIndex);
+}
+
+void CStagingRing::Pin(uint32 chunkIndex)
+{
+	auto& chunk = m_chunks[chunkIndex];
+	chunk.pinCount++;
+}
+
+void CStagingRing::Unpin(uint32 chunkIndex)
+{
+	auto& chunk = m_chunks[chunkIndex];
+	assert(chunk.pinCount != 0);
+	chunk.pinCount--;
+	TryRecycleChunk(chunkIndex);
+}
+
+VkBuffer CStagingRing::GetChunkBuffer(uint32 chunkIndex) const
+{
+	return m_chunks[chunkIndex].buffer;
+}
+
+uint32 CStagingRing::CreateChunk(uint32 size)
+{
+	CHUNK chunk;
+	chunk.size = size;
+	chunk.buffer = Framework::Vulkan::CBuffer(
+	    m_context->device, m_context->physicalDeviceMemoryProperties,
+	    VK_BUFFER_USAGE_STORAGE_BUFFER_BIT | VK_BUFFER_USAGE_VERTEX_BUFFER_BIT | VK_BUFFER_USAGE_UNIFORM_BUFFER_BIT,
+	    VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT,
+	    size);
+
+	auto result = m_context->device.vkMapMemory(m_context->device, chunk.buffer.GetMemory(),
+	                                            0, VK_WHOLE_SIZE, 0, reinterpret_cast<void**>(&chunk.bufferPtr));
+	CHECKVULKANERROR(result);
+
+	uint32 chunkIndex = static_cast<uint32>(m_chunks.size());
+	m_chunks.push_back(std::move(chunk));
+	return chunkIndex;
+}
+
+void CStagingRing::SelectChunk(uint32 minSize)
+{
+	uint32 prevChunk = m_currentChunk;
+
+	//Pick the smallest free chunk that can hold the allocation
+	auto bestChunkIterator = std::end(m_freeChunks);
+	for(auto chunkIterator = std::begin(m_freeChunks); chunkIterator != std::end(m_freeChunks); chunkIterator++)
+	{
+		const auto& chunk = m_chunks[*chunkIterator];
+		if(chunk.size < minSize) continue;
+		if((bestChunkIterator == std::end(m_freeChunks)) || (chunk.size < m_chunks[*bestChunkIterator].size))
+		{
+			bestChunkIterator = chunkIterator;
+		}
+	}
+
+	if(bestChunkIterator != std::end(m_freeChunks))
+	{
+		m_currentChunk = *bestChunkIterator;
+		m_freeChunks.erase(bestChunkIterator);
+	}
+	else
+	{
+		m_currentChunk = CreateChunk(std::max<uint32>(DEFAULT_CHUNK_SIZE, minSize));
+	}
+	m_currentOffset = 0;
+
+	if(prevChunk != INVALID_CHUNK)
+	{
+		TryRecycleChunk(prevChunk);
+	}
+}
+
+void CStagingRing::TryRecycleChunk(uint32 chunkIndex)
+{
+	const auto& chunk = m_chunks[chunkIndex];
+	if(chunkIndex == m_currentChunk) return;
+	if(chunk.frameUseCount != 0) return;
+	if(chunk.pinCount != 0) return;
+	assert(std::find(std::begin(m_freeChunks), std::end(m_freeChunks), chunkIndex) == std::end(m_freeChunks));
+	m_freeChunks.push_back(chunkIndex);
+}
+
+void CStagingRing::PreFlushFrameCommandBuffer()
+{
+}
+
+void CStagingRing::PostFlushFrameCommandBuffer()
+{
+	//The next frame will wait on its fence before recording anything, which means
+	//the chunks it used the last time around are not accessed by the GPU anymore.
+	m_frameSerial++;
+	uint32 nextFrame = (m_frameCommandBuffer->GetCurrentFrame() + 1) % MAX_FRAMES;
+	auto& frameChunks = m_frameChunks[nextFrame];
+	for(auto chunkIndex : frameChunks)
+	{
+		auto& chunk = m_chunks[chunkIndex];
+		assert(chunk.frameUseCount != 0);
+		chunk.frameUseCount--;
+		TryRecycleChunk(chunkIndex);
+	}
+	frameChunks.clear();
+}
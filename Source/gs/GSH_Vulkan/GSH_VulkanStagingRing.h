@@ -0,0 +1,83 @@
+#pragma once
+
+#include <memory>
+#include <vector>
+#include "GSH_VulkanContext.h"
+#include "GSH_VulkanFrameCommandBuffer.h"
+#include "vulkan/Buffer.h"
+
+namespace GSH_Vulkan
+{
+	//Host visible memory used to upload data (transfers, vertices, uniforms) to the GPU.
+	//Allocations are carved linearly out of chunks. A chunk is recycled once every frame
+	//that referenced it has been executed and no allocation inside it is pinned anymore.
+	class CStagingRing : public IFrameCommandBufferWriter
+	{
+	public:
+		enum
+		{
+			MAX_FRAMES = CFrameCommandBuffer::MAX_FRAMES,
+		};
+
+		static constexpr uint32 INVALID_CHUNK = ~0U;
+
+		struct ALLOCATION
+		{
+			uint32 chunkIndex = INVALID_CHUNK;
+			VkBuffer buffer = VK_NULL_HANDLE;
+			uint32 offset = 0;
+			uint32 size = 0;
+			uint8* ptr = nullptr;
+
+			bool IsValid() const
+			{
+				return chunkIndex != INVALID_CHUNK;
+			}
+		};
+
+		CStagingRing(const ContextPtr&, const FrameCommandBufferPtr&);
+		virtual ~CStagingRing();
+
+		ALLOCATION Allocate(uint32, uint32);
+
+		//Makes sure the chunk is kept alive until the current frame has completed
+		void MarkUsed(uint32);
+
+		//Pinned chunks are never recycled, used for allocations that are filled over several frames
+		void Pin(uint32);
+		void Unpin(uint32);
+
+		VkBuffer GetChunkBuffer(uint32) const;
+
+		void PreFlushFrameCommandBuffer() override;
+		void PostFlushFrameCommandBuffer() override;
+
+	private:
+		struct CHUNK
+		{
+			Framework::Vulkan::CBuffer buffer;
+			uint8* bufferPtr = nullptr;
+			uint32 size = 0;
+			uint32 frameUseCount = 0;
+			uint32 pinCount = 0;
+			uint32 lastUseSerial = 0;
+		};
+
+		uint32 CreateChunk(uint32);
+		void SelectChunk(uint32);
+		void TryRecycleChunk(uint32);
+
+		ContextPtr m_context;
+		FrameCommandBufferPtr m_frameCommandBuffer;
+
+		std::vector<CHUNK> m_chunks;
+		std::vector<uint32> m_freeChunks;
+		std::vector<uint32> m_frameChunks[MAX_FRAMES];
+		uint32 m_frameSerial = 1;
+
+		uint32 m_currentChunk = INVALID_CHUNK;
+		uint32 m_currentOffset = 0;
+	};
+
+	typedef std::shared_ptr<CStagingRing> StagingRingPtr;
+}
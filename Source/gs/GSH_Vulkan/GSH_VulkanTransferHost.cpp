@@ -9,8 +9,6 @@
 
 using namespace GSH_Vulkan;
 
-#define XFER_BUFFER_SIZE 0x600000
-
 #define DESCRIPTOR_LOCATION_MEMORY 0
 #define DESCRIPTOR_LOCATION_XFERBUFFER 1
 #define DESCRIPTOR_LOCATION_SWIZZLETABLE_DST 2
@@ -19,33 +17,19 @@ using namespace GSH_Vulkan;
 
 #define TRANSFER_USE_8_16_BIT GSH_VULKAN_IS_DESKTOP
 
-CTransferHost::CTransferHost(const ContextPtr& context, const FrameCommandBufferPtr& frameCommandBuffer)
+CTransferHost::CTransferHost(const ContextPtr& context, const FrameCommandBufferPtr& frameCommandBuffer, const StagingRingPtr& stagingRing)
     : m_context(context)
     , m_frameCommandBuffer(frameCommandBuffer)
+    , m_stagingRing(stagingRing)
     , m_pipelineCache(context->device)
 {
-	for(auto& frame : m_frames)
-	{
-		frame.xferBuffer = Framework::Vulkan::CBuffer(
-		    m_context->device, m_context->physicalDeviceMemoryProperties,
-		    VK_BUFFER_USAGE_STORAGE_BUFFER_BIT, VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT,
-		    XFER_BUFFER_SIZE);
-
-		auto result = m_context->device.vkMapMemory(m_context->device, frame.xferBuffer.GetMemory(),
-		                                            0, VK_WHOLE_SIZE, 0, reinterpret_cast<void**>(&frame.xferBufferPtr));
-		CHECKVULKANERROR(result);
-	}
-
 	m_localSize = std::min<uint32>(context->computeWorkgroupInvocations, 1024);
 	m_pipelineCaps <<= 0;
 }
 
 CTransferHost::~CTransferHost()
 {
-	for(auto& frame : m_frames)
-	{
-		m_context->device.vkUnmapMemory(m_context->device, frame.xferBuffer.GetMemory());
-	}
+	ReleaseXferBuffer();
 }
 
 void CTransferHost::SetPipelineCaps(const PIPELINE_CAPS& pipelineCaps)
@@ -53,23 +37,69 @@ void CTransferHost::SetPipelineCaps(const PIPELINE_CAPS& pipelineCaps)
 	m_pipelineCaps = pipelineCaps;
 }
 
-void CTransferHost::DoTransfer(const XferBuffer& inputData)
+void CTransferHost::PrewarmPipeline(PipelineCapsInt capsInt)
+{
+	auto caps = make_convertible<PIPELINE_CAPS>(capsInt);
+	if(m_pipelineCache.HasPipeline(caps)) return;
+	m_pipelineCache.RegisterPipeline(caps, CreateXferPipeline(caps));
+}
+
+std::vector<CTransferHost::PipelineCapsInt> CTransferHost::GetPipelineKeys() const
+{
+	return m_pipelineCache.GetTitleKeys();
+}
+
+void CTransferHost::ResetPipelineKeys()
+{
+	m_pipelineCache.ResetTitleKeys();
+}
+
+void CTransferHost::BeginTransfer(uint32 size)
 {
-	auto result = VK_SUCCESS;
+	ReleaseXferBuffer();
+	//Reserve space for the whole transfer, data will be written there as it arrives
+	m_xferBuffer = m_stagingRing->Allocate((size + 3) & ~3, m_context->storageBufferAlignment);
+	m_stagingRing->Pin(m_xferBuffer.chunkIndex);
+	m_xferWritten = 0;
+	m_xferDispatched = 0;
+}
 
-	uint32 xferBufferRemainSize = XFER_BUFFER_SIZE - m_xferBufferOffset;
-	if(xferBufferRemainSize < inputData.size())
+void CTransferHost::WriteTransfer(const uint8* data, uint32 length)
+{
+	if(!m_xferBuffer.IsValid() || ((m_xferWritten + length) > m_xferBuffer.size))
 	{
-		m_frameCommandBuffer->Flush();
-		assert((XFER_BUFFER_SIZE - m_xferBufferOffset) >= inputData.size());
+		//Transfer is bigger than what was announced, move pending data to a bigger buffer
+		uint32 pendingSize = m_xferWritten - m_xferDispatched;
+		auto prevXferBuffer = m_xferBuffer;
+		m_xferBuffer = m_stagingRing->Allocate((pendingSize + length + 3) & ~3, m_context->storageBufferAlignment);
+		m_stagingRing->Pin(m_xferBuffer.chunkIndex);
+		if(prevXferBuffer.IsValid())
+		{
+			memcpy(m_xferBuffer.ptr, prevXferBuffer.ptr + m_xferDispatched, pendingSize);
+			m_stagingRing->Unpin(prevXferBuffer.chunkIndex);
+		}
+		m_xferWritten = pendingSize;
+		m_xferDispatched = 0;
 	}
+	memcpy(m_xferBuffer.ptr + m_xferWritten, data, length);
+	m_xferWritten += length;
+}
+
+bool CTransferHost::HasPendingTransfer() const
+{
+	return m_xferWritten != m_xferDispatched;
+}
+
+void CTransferHost::DoTransfer()
+{
+	if(!HasPendingTransfer()) return;
 
-	auto& frame = m_frames[m_frameCommandBuffer->GetCurrentFrame()];
+	uint32 xferSize = m_xferWritten - m_xferDispatched;
+	uint32 xferOffset = m_xferBuffer.offset + m_xferDispatched;
+	assert((xferOffset & 0x03) == 0);
+	Params.xferBufferOffset = xferOffset / 4;
 
-	assert(inputData.size() <= XFER_BUFFER_SIZE);
-	memcpy(frame.xferBufferPtr + m_xferBufferOffset, inputData.data(), inputData.size());
-	assert((m_xferBufferOffset & 0x03) == 0);
-	Params.xferBufferOffset = m_xferBufferOffset / 4;
+	m_stagingRing->MarkUsed(m_xferBuffer.chunkIndex);
 
 	//Find pipeline and create it if we've never encountered it before
 	auto xferPipeline = m_pipelineCache.TryGetPipeline(m_pipelineCaps);
@@ -85,25 +115,25 @@ void CTransferHost::DoTransfer(const XferBuffer& inputData)
 		assert(false);
 	case CGSHandler::PSMCT32:
 	case CGSHandler::PSMZ32:
-		pixelCount = inputData.size() / 4;
+		pixelCount = xferSize / 4;
 		break;
 	case CGSHandler::PSMCT24:
 	case CGSHandler::PSMZ24:
-		pixelCount = inputData.size() / 3;
+		pixelCount = xferSize / 3;
 		break;
 	case CGSHandler::PSMCT16S:
 	case CGSHandler::PSMCT16:
 	case CGSHandler::PSMZ16S:
-		pixelCount = inputData.size() / 2;
+		pixelCount = xferSize / 2;
 		break;
 	case CGSHandler::PSMT8:
 	case CGSHandler::PSMT8H:
-		pixelCount = inputData.size();
+		pixelCount = xferSize;
 		break;
 	case CGSHandler::PSMT4:
 	case CGSHandler::PSMT4HL:
 	case CGSHandler::PSMT4HH:
-		pixelCount = inputData.size() * 2;
+		pixelCount = xferSize * 2;
 		break;
 	}
 
@@ -112,7 +142,7 @@ void CTransferHost::DoTransfer(const XferBuffer& inputData)
 
 	auto descriptorSetCaps = make_convertible<DESCRIPTORSET_CAPS>(0);
 	descriptorSetCaps.dstPsm = m_pipelineCaps.dstFormat;
-	descriptorSetCaps.frameIdx = m_frameCommandBuffer->GetCurrentFrame();
+	descriptorSetCaps.chunkIndex = m_xferBuffer.chunkIndex;
 
 	auto descriptorSet = PrepareDescriptorSet(xferPipeline->descriptorSetLayout, descriptorSetCaps);
 	auto commandBuffer = m_frameCommandBuffer->GetCommandBuffer();
@@ -132,8 +162,20 @@ void CTransferHost::DoTransfer(const XferBuffer& inputData)
 	m_context->device.vkCmdPushConstants(commandBuffer, xferPipeline->pipelineLayout, VK_SHADER_STAGE_COMPUTE_BIT, 0, sizeof(XFERPARAMS), &Params);
 	m_context->device.vkCmdDispatch(commandBuffer, workUnits, 1, 1);
 
-	m_xferBufferOffset += inputData.size();
-	m_xferBufferOffset = (m_xferBufferOffset + (m_context->storageBufferAlignment - 1)) & -m_context->storageBufferAlignment;
+	m_xferDispatched = m_xferWritten;
+	if(m_xferDispatched == m_xferBuffer.size)
+	{
+		ReleaseXferBuffer();
+	}
+}
+
+void CTransferHost::ReleaseXferBuffer()
+{
+	if(!m_xferBuffer.IsValid()) return;
+	m_stagingRing->Unpin(m_xferBuffer.chunkIndex);
+	m_xferBuffer = CStagingRing::ALLOCATION();
+	m_xferWritten = 0;
+	m_xferDispatched = 0;
 }
 
 VkDescriptorSet CTransferHost::PrepareDescriptorSet(VkDescriptorSetLayout descriptorSetLayout, const DESCRIPTORSET_CAPS& caps)
@@ -167,7 +209,7 @@ VkDescriptorSet CTransferHost::PrepareDescriptorSet(VkDescriptorSetLayout descri
 		descriptorMemoryBufferInfo.range = VK_WHOLE_SIZE;
 
 		VkDescriptorBufferInfo descriptorBufferInfo = {};
-		descriptorBufferInfo.buffer = m_frames[caps.frameIdx].xferBuffer;
+		descriptorBufferInfo.buffer = m_stagingRing->GetChunkBuffer(caps.chunkIndex);
 		descriptorBufferInfo.range = VK_WHOLE_SIZE;
 
 		VkDescriptorImageInfo descriptorDstSwizzleTableInfo = {};
@@ -245,7 +287,6 @@ void CTransferHost::PreFlushFrameCommandBuffer()
 
 void CTransferHost::PostFlushFrameCommandBuffer()
 {
-	m_xferBufferOffset = 0;
 }
 
 Framework::Vulkan::CShaderModule CTransferHost::CreateXferShader(const PIPELINE_CAPS& caps)
@@ -520,7 +561,7 @@ PIPELINE CTransferHost::CreateXferPipeline(const PIPELINE_CAPS& caps)
 		createInfo.stage.module = xferShader;
 		createInfo.layout = xferPipeline.pipelineLayout;
 
-		result = m_context->device.vkCreateComputePipelines(m_context->device, VK_NULL_HANDLE, 1, &createInfo, nullptr, &xferPipeline.pipeline);
+		result = m_context->device.vkCreateComputePipelines(m_context->device, m_context->pipelineCache, 1, &createInfo, nullptr, &xferPipeline.pipeline);
 		CHECKVULKANERROR(result);
 	}
 
@@ -4,6 +4,7 @@
 #include "GSH_VulkanContext.h"
 #include "GSH_VulkanFrameCommandBuffer.h"
 #include "GSH_VulkanPipelineCache.h"
+#include "GSH_VulkanStagingRing.h"
 #include "Convertible.h"
 #include "vulkan/ShaderModule.h"
 #include "nuanceur/Builder.h"
@@ -13,13 +14,7 @@ namespace GSH_Vulkan
 	class CTransferHost : public IFrameCommandBufferWriter
 	{
 	public:
-		enum
-		{
-			MAX_FRAMES = CFrameCommandBuffer::MAX_FRAMES,
-		};
-
 		typedef uint32 PipelineCapsInt;
-		typedef std::vector<uint8> XferBuffer;
 
 		struct PIPELINE_CAPS : public convertible<PipelineCapsInt>
 		{
@@ -39,12 +34,19 @@ namespace GSH_Vulkan
 		};
 		static_assert(sizeof(XFERPARAMS) == 0x20, "XFERPARAMS must be 32 bytes large.");
 
-		CTransferHost(const ContextPtr&, const FrameCommandBufferPtr&);
+		CTransferHost(const ContextPtr&, const FrameCommandBufferPtr&, const StagingRingPtr&);
 		virtual ~CTransferHost();
 
 		void SetPipelineCaps(const PIPELINE_CAPS&);
 
-		void DoTransfer(const XferBuffer&);
+		void PrewarmPipeline(PipelineCapsInt);
+		std::vector<PipelineCapsInt> GetPipelineKeys() const;
+		void ResetPipelineKeys();
+
+		void BeginTransfer(uint32);
+		void WriteTransfer(const uint8*, uint32);
+		bool HasPendingTransfer() const;
+		void DoTransfer();
 
 		void PreFlushFrameCommandBuffer() override;
 		void PostFlushFrameCommandBuffer() override;
@@ -52,12 +54,6 @@ namespace GSH_Vulkan
 		XFERPARAMS Params;
 
 	private:
-		struct FRAMECONTEXT
-		{
-			Framework::Vulkan::CBuffer xferBuffer;
-			uint8* xferBufferPtr = nullptr;
-		};
-
 		typedef CPipelineCache<PipelineCapsInt> PipelineCache;
 
 		typedef uint32 DescriptorSetCapsInt;
@@ -65,7 +61,7 @@ namespace GSH_Vulkan
 		struct DESCRIPTORSET_CAPS : public convertible<DescriptorSetCapsInt>
 		{
 			uint32 dstPsm : 6;
-			uint32 frameIdx : 26;
+			uint32 chunkIndex : 26;
 		};
 		static_assert(sizeof(DESCRIPTORSET_CAPS) == sizeof(DescriptorSetCapsInt));
 		typedef std::unordered_map<DescriptorSetCapsInt, VkDescriptorSet> DescriptorSetCache;
@@ -75,6 +71,8 @@ namespace GSH_Vulkan
 		Framework::Vulkan::CShaderModule CreateXferShader(const PIPELINE_CAPS&);
 		PIPELINE CreateXferPipeline(const PIPELINE_CAPS&);
 
+		void ReleaseXferBuffer();
+
 		Nuanceur::CUintRvalue XferStream_Read32(Nuanceur::CShaderBuilder&, Nuanceur::CArrayUintValue, Nuanceur::CIntValue, Nuanceur::CIntValue);
 		Nuanceur::CUintRvalue XferStream_Read24(Nuanceur::CShaderBuilder&, Nuanceur::CArrayUintValue, Nuanceur::CIntValue, Nuanceur::CIntValue);
 		Nuanceur::CUintRvalue XferStream_Read16(Nuanceur::CShaderBuilder&, Nuanceur::CArrayUintValue, Nuanceur::CIntValue, Nuanceur::CIntValue);
@@ -83,13 +81,16 @@ namespace GSH_Vulkan
 
 		ContextPtr m_context;
 		FrameCommandBufferPtr m_frameCommandBuffer;
+		StagingRingPtr m_stagingRing;
 		PipelineCache m_pipelineCache;
 		DescriptorSetCache m_descriptorSetCache;
 		uint32 m_localSize = 0;
 
-		FRAMECONTEXT m_frames[MAX_FRAMES];
-
-		uint32 m_xferBufferOffset = 0;
+		//Image data is written straight in staging memory as it comes in,
+		//[m_xferDispatched, m_xferWritten) is the range that hasn't been sent to the GPU yet
+		CStagingRing::ALLOCATION m_xferBuffer;
+		uint32 m_xferWritten = 0;
+		uint32 m_xferDispatched = 0;
 
 		PIPELINE_CAPS m_pipelineCaps;
 	};
@@ -39,6 +39,23 @@ void CTransferLocal::SetPipelineCaps(const PIPELINE_CAPS& pipelineCaps)
 	m_pipelineCaps = pipelineCaps;
 }
 
+void CTransferLocal::PrewarmPipeline(PipelineCapsInt capsInt)
+{
+	auto caps = make_convertible<PIPELINE_CAPS>(capsInt);
+	if(m_pipelineCache.HasPipeline(caps)) return;
+	m_pipelineCache.RegisterPipeline(caps, CreatePipeline(caps));
+}
+
+std::vector<CTransferLocal::PipelineCapsInt> CTransferLocal::GetPipelineKeys() const
+{
+	return m_pipelineCache.GetTitleKeys();
+}
+
+void CTransferLocal::ResetPipelineKeys()
+{
+	m_pipelineCache.ResetTitleKeys();
+}
+
 void CTransferLocal::DoTransfer()
 {
 	//Find pipeline and create it if we've never encountered it before
@@ -452,7 +469,7 @@ PIPELINE CTransferLocal::CreatePipeline(const PIPELINE_CAPS& caps)
 		createInfo.stage.module = xferShader;
 		createInfo.layout = xferPipeline.pipelineLayout;
 
-		result = m_context->device.vkCreateComputePipelines(m_context->device, VK_NULL_HANDLE, 1, &createInfo, nullptr, &xferPipeline.pipeline);
+		result = m_context->device.vkCreateComputePipelines(m_context->device, m_context->pipelineCache, 1, &createInfo, nullptr, &xferPipeline.pipeline);
 		CHECKVULKANERROR(result);
 	}
 
@@ -43,6 +43,10 @@ namespace GSH_Vulkan
 
 		void SetPipelineCaps(const PIPELINE_CAPS&);
 
+		void PrewarmPipeline(PipelineCapsInt);
+		std::vector<PipelineCapsInt> GetPipelineKeys() const;
+		void ResetPipelineKeys();
+
 		void DoTransfer();
 
 		XFERPARAMS Params;
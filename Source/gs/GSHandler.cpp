@@ -6,10 +6,12 @@
 #include "../states/MemoryStateFile.h"
 #include "../states/RegisterStateFile.h"
 #include "../FrameDump.h"
+#include "../FrameDumpWriter.h"
 #include "../ee/INTC.h"
 #include "GSHandler.h"
 #include "GsPixelFormats.h"
 #include "string_format.h"
+#include "StdStreamUtils.h"
 #include "ThreadUtils.h"
 
 //Shadow Hearts 2 looks for this specific value
@@ -116,6 +118,10 @@ CGSHandler::~CGSHandler()
 		SendGSCall([this]() { m_threadDone = true; });
 		m_thread.join();
 	}
+	if(m_frameDumpCloseThread.joinable())
+	{
+		m_frameDumpCloseThread.join();
+	}
 	delete[] m_pRAM;
 	delete[] m_pCLUT;
 	for(int i = 0; i < MAX_INFLIGHT_FRAMES; i++)
@@ -136,6 +142,11 @@ void CGSHandler::NotifyPreferencesChanged()
 	SendGSCall([this]() { NotifyPreferencesChangedImpl(); });
 }
 
+void CGSHandler::NotifyTitleChanged(const std::string& titleId)
+{
+	SendGSCall([this, titleId]() { NotifyTitleChangedImpl(titleId); });
+}
+
 void CGSHandler::SetIntc(CINTC* intc)
 {
 	m_intc = intc;
@@ -189,6 +200,10 @@ void CGSHandler::NotifyPreferencesChangedImpl()
 {
 }
 
+void CGSHandler::NotifyTitleChangedImpl(const std::string&)
+{
+}
+
 void CGSHandler::SetPresentationParams(const PRESENTATION_PARAMS& presentationParams)
 {
 	m_presentationParams = presentationParams;
@@ -347,9 +362,81 @@ void CGSHandler::TriggerFrameDump(const FrameDumpCallback& frameDumpCallback)
 #endif
 }
 
+void CGSHandler::TriggerFrameDumpCapture(const fs::path& path, uint32 frameCount, const FrameDumpCaptureCallback& frameDumpCaptureCallback)
+{
+#ifdef DEBUGGER_INCLUDED
+	assert(frameCount != 0);
+	m_mailBox.SendCall(
+	    [=]() {
+		    if(m_frameDumpWriter || !m_frameDumpCapturePath.empty())
+		    {
+			    if(frameDumpCaptureCallback)
+			    {
+				    frameDumpCaptureCallback(false);
+			    }
+			    return;
+		    }
+		    m_frameDumpCapturePath = path;
+		    m_frameDumpCaptureFramesLeft = frameCount;
+		    m_frameDumpCaptureCallback = frameDumpCaptureCallback;
+	    });
+#endif
+}
+
 void CGSHandler::UpdateFrameDumpState()
 {
 #ifdef DEBUGGER_INCLUDED
+	if(m_frameDumpWriter)
+	{
+		m_frameDumpWriter->EndFrame();
+		m_frameDumpCaptureFramesLeft--;
+		if(m_frameDumpCaptureFramesLeft == 0)
+		{
+			//Closing waits for pending chunks to be compressed and written out, don't block the GS thread
+			if(m_frameDumpCloseThread.joinable())
+			{
+				m_frameDumpCloseThread.join();
+			}
+			m_frameDumpCloseThread = std::thread(
+			    [frameDumpWriter = std::move(m_frameDumpWriter), frameDumpCaptureCallback = std::move(m_frameDumpCaptureCallback)]() {
+				    frameDumpWriter->Close();
+				    if(frameDumpCaptureCallback)
+				    {
+					    frameDumpCaptureCallback(!frameDumpWriter->HasFailed());
+				    }
+			    });
+			m_frameDumpCaptureCallback = FrameDumpCaptureCallback();
+		}
+	}
+	else if(!m_frameDumpCapturePath.empty())
+	{
+		auto capturePath = std::move(m_frameDumpCapturePath);
+		m_frameDumpCapturePath.clear();
+
+		std::shared_ptr<Framework::CStream> captureStream;
+		try
+		{
+			captureStream = std::make_shared<Framework::CStdStream>(Framework::CreateOutputStdStream(capturePath.native()));
+		}
+		catch(...)
+		{
+			if(m_frameDumpCaptureCallback)
+			{
+				m_frameDumpCaptureCallback(false);
+				m_frameDumpCaptureCallback = FrameDumpCaptureCallback();
+			}
+		}
+
+		if(captureStream)
+		{
+			//This is expected to be called from the GS thread
+			SyncMemoryCache();
+
+			m_frameDumpWriter = std::make_unique<CFrameDumpWriter>(std::move(captureStream));
+			m_frameDumpWriter->WriteInitialState(GetRam(), GetRegisters(), GetSMODE2());
+		}
+	}
+
 	if(m_frameDump && !m_frameDump->GetPackets().empty())
 	{
 		m_frameDumpCallback(*m_frameDump.get());
@@ -640,6 +727,10 @@ void CGSHandler::FeedImageData(const void* data, uint32 length)
 		    {
 			    m_frameDump->AddImagePacket(imageData, length);
 		    }
+		    if(m_frameDumpWriter)
+		    {
+			    m_frameDumpWriter->AddImagePacket(imageData, length);
+		    }
 #endif
 		    FeedImageDataImpl(imageData, length);
 		    delete[] imageData;
@@ -669,6 +760,10 @@ void CGSHandler::ProcessWriteBuffer(const CGsPacketMetadata* metadata)
 			    {
 				    m_frameDump->AddRegisterPacket(packet, packetSize, &metadata);
 			    }
+			    if(m_frameDumpWriter)
+			    {
+				    m_frameDumpWriter->AddRegisterPacket(packet, packetSize, &metadata);
+			    }
 		    });
 	}
 #endif
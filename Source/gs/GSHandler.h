@@ -5,17 +5,20 @@
 #include <functional>
 #include <atomic>
 #include <array>
+#include <string>
 #include "signal/Signal.h"
 
 #include "bitmap/Bitmap.h"
 #include "Types.h"
 #include "Convertible.h"
+#include "filesystem_def.h"
 #include "../MailBox.h"
 #include "../Integer64.h"
 #include "zip/ZipArchiveWriter.h"
 #include "zip/ZipArchiveReader.h"
 
 class CFrameDump;
+class CFrameDumpWriter;
 class CGsPacketMetadata;
 class CINTC;
 
@@ -814,6 +817,7 @@ public:
 	typedef std::function<CGSHandler*()> FactoryFunction;
 
 	typedef std::function<void(const CFrameDump&)> FrameDumpCallback;
+	typedef std::function<void(bool)> FrameDumpCaptureCallback;
 
 	typedef Framework::CSignal<void()> FlipCompleteEvent;
 	typedef Framework::CSignal<void(uint32)> NewFrameEvent;
@@ -823,6 +827,7 @@ public:
 
 	static void RegisterPreferences();
 	void NotifyPreferencesChanged();
+	void NotifyTitleChanged(const std::string&);
 
 	void SetIntc(CINTC*);
 	void Reset();
@@ -834,6 +839,9 @@ public:
 	void Copy(CGSHandler*);
 
 	void TriggerFrameDump(const FrameDumpCallback&);
+	//Output file is only created once the capture starts. Requests made while a capture is
+	//in progress are rejected, the callback is called with a failure.
+	void TriggerFrameDumpCapture(const fs::path&, uint32, const FrameDumpCaptureCallback&);
 
 	void InitFromFrameDump(CFrameDump*);
 
@@ -860,6 +868,15 @@ public:
 		m_currentWriteBuffer[m_writeBufferSize++] = write;
 	}
 
+	//Reserves space for 'count' writes in the write buffer. Returns nullptr if there isn't enough space left.
+	inline RegisterWrite* ReserveRegisterWrites(uint32 count)
+	{
+		if((m_writeBufferSize + count) > REGISTERWRITEBUFFER_SIZE) return nullptr;
+		auto writes = m_currentWriteBuffer + m_writeBufferSize;
+		m_writeBufferSize += count;
+		return writes;
+	}
+
 	void ProcessWriteBuffer(const CGsPacketMetadata*);
 	void SubmitWriteBuffer();
 	void FlushWriteBuffer();
@@ -1037,6 +1054,7 @@ protected:
 	void ResetBase();
 	virtual void ResetImpl();
 	virtual void NotifyPreferencesChangedImpl();
+	virtual void NotifyTitleChangedImpl(const std::string&);
 	virtual void FlipImpl(const DISPLAY_INFO&);
 	virtual void MarkNewFrame();
 	virtual void WriteRegisterImpl(uint8, uint64);
@@ -1130,6 +1148,11 @@ protected:
 	bool m_threadDone = false;
 	std::unique_ptr<CFrameDump> m_frameDump;
 	FrameDumpCallback m_frameDumpCallback;
+	std::unique_ptr<CFrameDumpWriter> m_frameDumpWriter;
+	fs::path m_frameDumpCapturePath;
+	uint32 m_frameDumpCaptureFramesLeft = 0;
+	FrameDumpCaptureCallback m_frameDumpCaptureCallback;
+	std::thread m_frameDumpCloseThread;
 	bool m_regsDirty = false;
 	bool m_drawEnabled = true;
 	CINTC* m_intc = nullptr;
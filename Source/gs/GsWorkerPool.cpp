@@ -0,0 +1,92 @@
+#include <algorithm>
+#include "GsWorkerPool.h"
+
+CGsWorkerPool::CGsWorkerPool(unsigned int threadCount)
+{
+	for(unsigned int i = 0; i < threadCount; i++)
+	{
+		m_threads.emplace_back([this]() { WorkerProc(); });
+	}
+}
+
+CGsWorkerPool::~CGsWorkerPool()
+{
+	{
+		std::unique_lock<std::mutex> lock(m_mutex);
+		m_terminate = true;
+	}
+	m_jobAvailableCondition.notify_all();
+	for(auto& thread : m_threads)
+	{
+		thread.join();
+	}
+}
+
+unsigned int CGsWorkerPool::GetDefaultThreadCount()
+{
+	//Leave room for the EE and GS threads
+	unsigned int hardwareThreadCount = std::thread::hardware_concurrency();
+	if(hardwareThreadCount <= 2) return 0;
+	return std::min<unsigned int>(hardwareThreadCount - 2, 4);
+}
+
+unsigned int CGsWorkerPool::GetThreadCount() const
+{
+	return static_cast<unsigned int>(m_threads.size());
+}
+
+void CGsWorkerPool::Enqueue(JobType job)
+{
+	if(m_threads.empty())
+	{
+		job();
+		return;
+	}
+	{
+		std::unique_lock<std::mutex> lock(m_mutex);
+		m_jobs.push_back(std::move(job));
+		m_pendingJobCount++;
+	}
+	m_jobAvailableCondition.notify_one();
+}
+
+void CGsWorkerPool::WaitAll()
+{
+	std::unique_lock<std::mutex> lock(m_mutex);
+	while(m_pendingJobCount != 0)
+	{
+		if(!m_jobs.empty())
+		{
+			auto job = std::move(m_jobs.front());
+			m_jobs.pop_front();
+			lock.unlock();
+			job();
+			lock.lock();
+			m_pendingJobCount--;
+		}
+		else
+		{
+			m_jobsDoneCondition.wait(lock, [this]() { return !m_jobs.empty() || (m_pendingJobCount == 0); });
+		}
+	}
+}
+
+void CGsWorkerPool::WorkerProc()
+{
+	std::unique_lock<std::mutex> lock(m_mutex);
+	while(true)
+	{
+		m_jobAvailableCondition.wait(lock, [this]() { return m_terminate || !m_jobs.empty(); });
+		if(m_terminate) break;
+		auto job = std::move(m_jobs.front());
+		m_jobs.pop_front();
+		lock.unlock();
+		job();
+		lock.lock();
+		m_pendingJobCount--;
+		if(m_pendingJobCount == 0)
+		{
+			m_jobsDoneCondition.notify_all();
+		}
+	}
+}
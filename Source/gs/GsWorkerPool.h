@@ -0,0 +1,40 @@
+#pragma once
+
+#include <functional>
+#include <deque>
+#include <vector>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+
+//Small pool of worker threads used by GS handlers to offload CPU work
+//(ex.: texture decoding). Jobs are not ordered and must not depend on each other.
+class CGsWorkerPool
+{
+public:
+	typedef std::function<void()> JobType;
+
+	CGsWorkerPool(unsigned int);
+	virtual ~CGsWorkerPool();
+
+	static unsigned int GetDefaultThreadCount();
+
+	unsigned int GetThreadCount() const;
+
+	void Enqueue(JobType);
+
+	//Waits until all enqueued jobs are completed. Calling thread helps out by
+	//running jobs that haven't been picked up by workers yet.
+	void WaitAll();
+
+private:
+	void WorkerProc();
+
+	std::vector<std::thread> m_threads;
+	std::deque<JobType> m_jobs;
+	std::mutex m_mutex;
+	std::condition_variable m_jobAvailableCondition;
+	std::condition_variable m_jobsDoneCondition;
+	unsigned int m_pendingJobCount = 0;
+	bool m_terminate = false;
+};
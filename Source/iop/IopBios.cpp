@@ -345,6 +345,7 @@ void CIopBios::PreLoadState()
 			modulePairIterator++;
 		}
 	}
+	m_hleImports.clear();
 	m_sifCmd->ClearServers();
 }
 
@@ -795,6 +796,7 @@ int32 CIopBios::UnloadModule(uint32 loadedModuleId)
 	//TODO: Remove module from IOP module list?
 	//TODO: Invalidate MIPS analysis range?
 	m_cpu.m_executor->ClearActiveBlocksInRange(loadedModule->start, loadedModule->end, false);
+	m_hleImports.clear();
 
 	if(loadedModule->ownsMemory)
 	{
@@ -3255,11 +3257,7 @@ void CIopBios::HandleException()
 	m_rescheduleNeeded = false;
 
 	uint32 searchAddress = m_cpu.m_pAddrTranslator(&m_cpu, m_cpu.m_State.nCOP0[CCOP_SCU::EPC]);
-
-	const auto* memoryMapElem = m_cpu.m_pMemoryMap->GetReadMap(searchAddress);
-	assert(memoryMapElem != nullptr);
-	assert(memoryMapElem->nType == CMemoryMap::MEMORYMAP_TYPE_MEMORY);
-	auto memory = reinterpret_cast<const uint32*>(reinterpret_cast<uint8*>(memoryMapElem->pPointer) + (searchAddress - memoryMapElem->nStart));
+	auto memory = GetHleCallMemory(searchAddress);
 
 	uint32 callInstruction = memory[0];
 	if(callInstruction == 0x0000000C)
@@ -3291,38 +3289,37 @@ void CIopBios::HandleException()
 	}
 	else
 	{
-		//Search for the import record
-		uint32 instruction = callInstruction;
-		while(instruction != 0x41E00000)
-		{
-			memory--;
-			instruction = memory[0];
-		}
-		uint32 functionId = callInstruction & 0xFFFF;
-		FRAMEWORK_MAYBE_UNUSED uint32 version = memory[2];
-		auto moduleName = ReadModuleName(reinterpret_cast<const uint8*>(memory + 3));
+		InvokeHleImport(GetHleImport(searchAddress, memory));
+	}
 
-#ifdef _DEBUG
-		if(moduleName == "libsd")
-		{
-			Iop::CLibSd::TraceCall(m_cpu, functionId);
-		}
-#endif
+	if(m_rescheduleNeeded)
+	{
+		assert((m_cpu.m_State.nCOP0[CCOP_SCU::STATUS] & CMIPS::STATUS_EXL) == 0);
+		m_rescheduleNeeded = false;
+		Reschedule();
+	}
 
-		auto module(m_modules.find(moduleName));
-		if(module != m_modules.end())
-		{
-			module->second->Invoke(m_cpu, functionId);
-		}
-		else
-		{
-#ifdef _DEBUG
-			CLog::GetInstance().Warn(LOGNAME, "%08X: Trying to call a function from non-existing module (%s, %d).\r\n",
-			                         m_cpu.m_State.nPC, std::string(moduleName).c_str(), functionId);
-#endif
-		}
+	m_cpu.m_State.nHasException = 0;
+}
+
+bool CIopBios::HandleHleCall()
+{
+	//Import stubs are 'JR RA' followed by 'ADDIU R0, R0, functionId' in the delay slot.
+	//If we're not in a delay slot, let HandleException deal with it.
+	if(m_cpu.m_State.nDelayedJumpAddr == MIPS_INVALID_PC)
+	{
+		return false;
 	}
 
+	uint32 stubAddress = m_cpu.m_pAddrTranslator(&m_cpu, m_cpu.m_State.nCOP0[CCOP_SCU::EPC]);
+	const auto& hleImport = GetHleImport(stubAddress, GetHleCallMemory(stubAddress));
+
+	//Commit the jump before calling the handler, this matches the state HandleException would
+	//see. Handlers are allowed to change PC, the block epilog will jump to whatever they've set.
+	m_cpu.m_State.nPC = m_cpu.m_State.nDelayedJumpAddr;
+
+	m_rescheduleNeeded = false;
+	InvokeHleImport(hleImport);
 	if(m_rescheduleNeeded)
 	{
 		assert((m_cpu.m_State.nCOP0[CCOP_SCU::STATUS] & CMIPS::STATUS_EXL) == 0);
@@ -3330,7 +3327,68 @@ void CIopBios::HandleException()
 		Reschedule();
 	}
 
-	m_cpu.m_State.nHasException = 0;
+	m_cpu.m_State.nDelayedJumpAddr = m_cpu.m_State.nPC;
+	return true;
+}
+
+const uint32* CIopBios::GetHleCallMemory(uint32 address)
+{
+	const auto* memoryMapElem = m_cpu.m_pMemoryMap->GetReadMap(address);
+	assert(memoryMapElem != nullptr);
+	assert(memoryMapElem->nType == CMemoryMap::MEMORYMAP_TYPE_MEMORY);
+	return reinterpret_cast<const uint32*>(reinterpret_cast<uint8*>(memoryMapElem->pPointer) + (address - memoryMapElem->nStart));
+}
+
+const CIopBios::HLE_IMPORT& CIopBios::GetHleImport(uint32 stubAddress, const uint32* memory)
+{
+	uint32 callInstruction = memory[0];
+	auto hleImportIterator = m_hleImports.find(stubAddress);
+	if((hleImportIterator != std::end(m_hleImports)) && (hleImportIterator->second.callInstruction == callInstruction))
+	{
+		return hleImportIterator->second;
+	}
+
+	//Search for the import record
+	uint32 instruction = callInstruction;
+	while(instruction != 0x41E00000)
+	{
+		memory--;
+		instruction = memory[0];
+	}
+	FRAMEWORK_MAYBE_UNUSED uint32 version = memory[2];
+	auto moduleName = ReadModuleName(reinterpret_cast<const uint8*>(memory + 3));
+
+	HLE_IMPORT hleImport;
+	hleImport.functionId = callInstruction & 0xFFFF;
+	hleImport.callInstruction = callInstruction;
+	auto module(m_modules.find(moduleName));
+	if(module != m_modules.end())
+	{
+		hleImport.module = module->second.get();
+	}
+	else
+	{
+#ifdef _DEBUG
+		CLog::GetInstance().Warn(LOGNAME, "%08X: Trying to call a function from non-existing module (%s, %d).\r\n",
+		                         m_cpu.m_State.nPC, std::string(moduleName).c_str(), hleImport.functionId);
+#endif
+	}
+
+	return m_hleImports[stubAddress] = hleImport;
+}
+
+void CIopBios::InvokeHleImport(const HLE_IMPORT& hleImport)
+{
+	if(!hleImport.module) return;
+
+#ifdef _DEBUG
+	if(hleImport.module->GetId() == "libsd")
+	{
+		Iop::CLibSd::TraceCall(m_cpu, hleImport.functionId);
+	}
+#endif
+
+	hleImport.module->Invoke(m_cpu, hleImport.functionId);
 }
 
 void CIopBios::HandleInterrupt()
@@ -3399,6 +3457,7 @@ void CIopBios::ReturnFromException()
 void CIopBios::DeleteModules()
 {
 	m_modules.clear();
+	m_hleImports.clear();
 
 #ifdef _IOP_EMULATE_MODULES
 	m_padman.reset();
@@ -3442,6 +3501,7 @@ void CIopBios::UnloadUserComponents()
 		UnloadModule(loadedModuleIterator);
 	}
 	std::experimental::erase_if(m_modules, [](const auto& modulePair) { return std::dynamic_pointer_cast<Iop::CDynamic>(modulePair.second); });
+	m_hleImports.clear();
 	m_intrHandlers.FreeAll();
 	m_semaphores.FreeAll();
 	m_sifCmd->ClearServers();
@@ -3527,6 +3587,7 @@ bool CIopBios::RegisterModule(const Iop::ModulePtr& module)
 	bool registered = (m_modules.find(module->GetId()) != std::end(m_modules));
 	if(registered) return false;
 	m_modules[module->GetId()] = module;
+	m_hleImports.clear();
 	return true;
 }
 
@@ -3535,6 +3596,7 @@ bool CIopBios::ReleaseModule(const std::string& moduleName)
 	auto moduleIterator = m_modules.find(moduleName);
 	if(moduleIterator == std::end(m_modules)) return false;
 	m_modules.erase(moduleIterator);
+	m_hleImports.clear();
 	return true;
 }
 
@@ -3562,6 +3624,7 @@ uint32 CIopBios::LoadExecutable(CELF32& elf, ExecutableRange& executableRange, u
 	    elf.GetContent() + programHeader->nOffset,
 	    programHeader->nFileSize);
 	RelocateElf(elf, baseAddress, programHeader->nFileSize);
+	m_hleImports.clear();
 
 	executableRange.first = baseAddress;
 	executableRange.second = baseAddress + programHeader->nMemorySize;
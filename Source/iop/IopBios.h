@@ -4,6 +4,7 @@
 #include <list>
 #include <map>
 #include <set>
+#include <unordered_map>
 #include "../MIPSAssembler.h"
 #include "../MIPS.h"
 #include "../ELF.h"
@@ -186,6 +187,10 @@ public:
 	void HandleException() override;
 	void HandleInterrupt() override;
 
+	//Called directly from jitted code when an import stub is reached, returns false if the call
+	//couldn't be handled this way and needs to go through HandleException.
+	bool HandleHleCall();
+
 	void Reschedule();
 
 	void CountTicks(uint32) override;
@@ -606,6 +611,14 @@ private:
 	typedef std::set<Iop::CModule*> ModuleSet;
 	typedef std::pair<uint32, uint32> ExecutableRange;
 
+	struct HLE_IMPORT
+	{
+		Iop::CModule* module = nullptr;
+		uint32 functionId = 0;
+		uint32 callInstruction = 0;
+	};
+	typedef std::unordered_map<uint32, HLE_IMPORT> HleImportMapType;
+
 	void LoadThreadContext(uint32);
 	void SaveThreadContext(uint32);
 	uint32 GetNextReadyThread();
@@ -627,6 +640,10 @@ private:
 	std::string_view ReadModuleName(uint32);
 	void DeleteModules();
 
+	const uint32* GetHleCallMemory(uint32);
+	const HLE_IMPORT& GetHleImport(uint32, const uint32*);
+	void InvokeHleImport(const HLE_IMPORT&);
+
 	void UnloadUserComponents();
 
 	int32 LoadHleModule(const Iop::ModulePtr&);
@@ -683,6 +700,9 @@ private:
 
 	IopModuleMapType m_modules;
 
+	//Import stubs resolved to their module, indexed by stub address
+	HleImportMapType m_hleImports;
+
 	OsVariableWrapper<uint32> m_currentThreadId;
 
 #ifdef DEBUGGER_INCLUDED
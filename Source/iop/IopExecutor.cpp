@@ -0,0 +1,28 @@
+#include "IopExecutor.h"
+
+CIopExecutor::CIopExecutor(CMIPS& context, uint32 maxAddress)
+    : CGenericMipsExecutor(context, maxAddress, BLOCK_CATEGORY_PS2_IOP)
+{
+}
+
+BasicBlockPtr CIopExecutor::BlockFactory(CMIPS& context, uint32 start, uint32 end)
+{
+	auto blockKey = GetCachedBlockKey(start, end);
+
+	bool isCacheableBlock = !m_context.HasBreakpointInRange(start, end);
+	if(isCacheableBlock)
+	{
+		if(auto basicBlock = FindCachedBlock<CBasicBlock>(context, blockKey, start, end))
+		{
+			return basicBlock;
+		}
+	}
+
+	auto result = std::make_shared<CBasicBlock>(context, start, end, m_blockCategory);
+	result->Compile();
+	if(isCacheableBlock)
+	{
+		m_cachedBlocks.Insert(blockKey, result);
+	}
+	return result;
+}
@@ -0,0 +1,14 @@
+#pragma once
+
+#include "../GenericMipsExecutor.h"
+
+//IOP code is invalidated in large chunks (module unloads, state loads). Compiled code is kept
+//around, indexed by its contents, so that blocks whose code didn't change don't need to be recompiled.
+class CIopExecutor : public CGenericMipsExecutor<BlockLookupOneWay>
+{
+public:
+	CIopExecutor(CMIPS&, uint32);
+	virtual ~CIopExecutor() = default;
+
+	BasicBlockPtr BlockFactory(CMIPS&, uint32, uint32) override;
+};
@@ -9,6 +9,13 @@
 #include "../states/RegisterStateUtils.h"
 #include "../states/RegisterStateFile.h"
 #include "Iop_SpuBase.h"
+#include "SimdDefs.h"
+
+#if defined(FRAMEWORK_SIMD_USE_SSE)
+#include <emmintrin.h>
+#elif defined(FRAMEWORK_SIMD_USE_NEON)
+#include <arm_neon.h>
+#endif
 
 using namespace Iop;
 
@@ -332,6 +339,11 @@ void CSpuBase::SetReverbEnabled(bool enabled)
 	m_reverbEnabled = enabled;
 }
 
+void CSpuBase::SetBlockMixingEnabled(bool enabled)
+{
+	m_blockMixingEnabled = enabled;
+}
+
 uint16 CSpuBase::GetControl() const
 {
 	return m_ctrl;
@@ -691,6 +703,84 @@ void CSpuBase::MixSamples(int32 inputSample, int32 volumeLevel, int16* output)
 	*output = static_cast<int16>(resultSample);
 }
 
+//Same as calling MixSamples on every sample, but processes several samples at once
+void CSpuBase::MixSampleBlock(int16* output, const int16* inputSamples, const int16* volumeLevels, unsigned int sampleCount)
+{
+	unsigned int i = 0;
+#if defined(FRAMEWORK_SIMD_USE_SSE)
+	for(; (i + 8) <= sampleCount; i += 8)
+	{
+		__m128i input = _mm_loadu_si128(reinterpret_cast<const __m128i*>(inputSamples + i));
+		__m128i volume = _mm_loadu_si128(reinterpret_cast<const __m128i*>(volumeLevels + i));
+		__m128i current = _mm_loadu_si128(reinterpret_cast<const __m128i*>(output + i));
+
+		__m128i productLo = _mm_mullo_epi16(input, volume);
+		__m128i productHi = _mm_mulhi_epi16(input, volume);
+		__m128i product[2] =
+		    {
+		        _mm_unpacklo_epi16(productLo, productHi),
+		        _mm_unpackhi_epi16(productLo, productHi),
+		    };
+		__m128i result[2] =
+		    {
+		        _mm_srai_epi32(_mm_unpacklo_epi16(current, current), 16),
+		        _mm_srai_epi32(_mm_unpackhi_epi16(current, current), 16),
+		    };
+
+		for(unsigned int half = 0; half < 2; half++)
+		{
+			//Division by 0x7FFF, truncated towards zero. Exact since abs(product) <= 0x40000000.
+			__m128i sign = _mm_srai_epi32(product[half], 31);
+			__m128i absProduct = _mm_sub_epi32(_mm_xor_si128(product[half], sign), sign);
+			__m128i quotient = _mm_add_epi32(absProduct, _mm_srli_epi32(absProduct, 15));
+			quotient = _mm_srli_epi32(_mm_add_epi32(quotient, _mm_set1_epi32(1)), 15);
+			quotient = _mm_sub_epi32(_mm_xor_si128(quotient, sign), sign);
+			result[half] = _mm_add_epi32(result[half], quotient);
+		}
+
+		//Saturating pack does the clamping
+		_mm_storeu_si128(reinterpret_cast<__m128i*>(output + i), _mm_packs_epi32(result[0], result[1]));
+	}
+#elif defined(FRAMEWORK_SIMD_USE_NEON)
+	for(; (i + 8) <= sampleCount; i += 8)
+	{
+		int16x8_t input = vld1q_s16(inputSamples + i);
+		int16x8_t volume = vld1q_s16(volumeLevels + i);
+		int16x8_t current = vld1q_s16(output + i);
+
+		int32x4_t product[2] =
+		    {
+		        vmull_s16(vget_low_s16(input), vget_low_s16(volume)),
+		        vmull_s16(vget_high_s16(input), vget_high_s16(volume)),
+		    };
+		int32x4_t result[2] =
+		    {
+		        vmovl_s16(vget_low_s16(current)),
+		        vmovl_s16(vget_high_s16(current)),
+		    };
+
+		for(unsigned int half = 0; half < 2; half++)
+		{
+			//Division by 0x7FFF, truncated towards zero. Exact since abs(product) <= 0x40000000.
+			uint32x4_t negative = vcltq_s32(product[half], vdupq_n_s32(0));
+			uint32x4_t absProduct = vreinterpretq_u32_s32(vabsq_s32(product[half]));
+			uint32x4_t quotient = vaddq_u32(absProduct, vshrq_n_u32(absProduct, 15));
+			quotient = vshrq_n_u32(vaddq_u32(quotient, vdupq_n_u32(1)), 15);
+			int32x4_t signedQuotient = vreinterpretq_s32_u32(quotient);
+			signedQuotient = vbslq_s32(negative, vnegq_s32(signedQuotient), signedQuotient);
+			result[half] = vaddq_s32(result[half], signedQuotient);
+		}
+
+		//Saturating narrow does the clamping
+		vst1q_s16(output + i, vcombine_s16(vqmovn_s32(result[0]), vqmovn_s32(result[1])));
+	}
+#endif
+	for(; i < sampleCount; i++)
+	{
+		MixSamples(inputSamples[i], volumeLevels[i], output + i);
+	}
+}
+
 void CSpuBase::Render(int16* samples, unsigned int sampleCount)
 {
 	bool updateReverb = m_reverbEnabled && (m_ctrl & CONTROL_REVERB) && (m_reverbWorkAddrStart < m_reverbWorkAddrEnd);
@@ -701,63 +791,46 @@ void CSpuBase::Render(int16* samples, unsigned int sampleCount)
 	unsigned int ticks = sampleCount / 2;
 	memset(samples, 0, sizeof(int16) * sampleCount);
 
+	//Channels are independent from each other, when possible, run each of them over the whole
+	//block and mix their output in one go instead of going through every channel at each tick.
+	bool mixAsBlock = m_blockMixingEnabled && CanMixChannelsAsBlock(ticks);
+	if(mixAsBlock)
+	{
+		MixChannelsAsBlock(samples, ticks, updateReverb);
+	}
+
 	for(unsigned int j = 0; j < ticks; j++)
 	{
 		int16 reverbSample[2] = {};
-		//Update channels
-		for(unsigned int i = 0; i < 24; i++)
+		if(mixAsBlock)
 		{
-			auto& channel(m_channel[i]);
-			auto& reader(m_reader[i]);
-			if(channel.status == KEY_ON)
+			if(updateReverb)
 			{
-				reader.SetParamsRead(channel.address, channel.repeat);
-				reader.ClearEndFlag();
-				channel.status = ATTACK;
-				channel.adsrVolume = 0;
+				reverbSample[0] = m_mixReverb[(j * 2) + 0];
+				reverbSample[1] = m_mixReverb[(j * 2) + 1];
 			}
-			else
+		}
+		else
+		{
+			//Update channels
+			for(unsigned int i = 0; i < 24; i++)
 			{
-				if(reader.IsDone())
-				{
-					channel.status = STOPPED;
-					channel.adsrVolume = 0;
-					reader.ClearIsDone();
-				}
-				if(reader.DidChangeRepeat() && !channel.repeatSet)
-				{
-					channel.repeat = reader.GetRepeat();
-					reader.ClearDidChangeRepeat();
-				}
-				//Update repeat in case it has been changed externally (needed for FFX)
-				reader.SetRepeat(channel.repeat);
-			}
-
-			int32 readSample = reader.GetSample();
-			channel.current = reader.GetCurrent();
-
-			UpdateAdsr(channel);
-			channel.volumeLeftAbs = ComputeChannelVolume(channel.volumeLeft, channel.volumeLeftAbs);
-			channel.volumeRightAbs = ComputeChannelVolume(channel.volumeRight, channel.volumeRightAbs);
+				int32 inputSample = UpdateChannel(i);
+				if(inputSample == 0) continue;
 
-			if(readSample == 0) continue;
+				const auto& channel(m_channel[i]);
+				int32 volumeLeft = channel.volumeLeftAbs >> 16;
+				int32 volumeRight = channel.volumeRightAbs >> 16;
 
-			//Mix in adsrVolume
-			int32 inputSample = (readSample * static_cast<int32>(channel.adsrVolume >> 16)) / static_cast<int32>(MAX_ADSR_VOLUME >> 16);
+				MixSamples(inputSample, volumeLeft, samples + 0);
+				MixSamples(inputSample, volumeRight, samples + 1);
 
-			if(inputSample == 0) continue;
-
-			int32 volumeLeft = channel.volumeLeftAbs >> 16;
-			int32 volumeRight = channel.volumeRightAbs >> 16;
-
-			MixSamples(inputSample, volumeLeft, samples + 0);
-			MixSamples(inputSample, volumeRight, samples + 1);
-
-			//Mix in reverb if enabled for this channel
-			if(updateReverb && (m_channelReverb.f & (1 << i)))
-			{
-				MixSamples(inputSample, volumeLeft, reverbSample + 0);
-				MixSamples(inputSample, volumeRight, reverbSample + 1);
+				//Mix in reverb if enabled for this channel
+				if(updateReverb && (m_channelReverb.f & (1 << i)))
+				{
+					MixSamples(inputSample, volumeLeft, reverbSample + 0);
+					MixSamples(inputSample, volumeRight, reverbSample + 1);
+				}
 			}
 		}
 
@@ -826,6 +899,115 @@ void CSpuBase::Render(int16* samples, unsigned int sampleCount)
 	}
 }
 
+int32 CSpuBase::UpdateChannel(unsigned int channelIndex)
+{
+	auto& channel(m_channel[channelIndex]);
+	auto& reader(m_reader[channelIndex]);
+	if(channel.status == KEY_ON)
+	{
+		reader.SetParamsRead(channel.address, channel.repeat);
+		reader.ClearEndFlag();
+		channel.status = ATTACK;
+		channel.adsrVolume = 0;
+	}
+	else
+	{
+		if(reader.IsDone())
+		{
+			channel.status = STOPPED;
+			channel.adsrVolume = 0;
+			reader.ClearIsDone();
+		}
+		if(reader.DidChangeRepeat() && !channel.repeatSet)
+		{
+			channel.repeat = reader.GetRepeat();
+			reader.ClearDidChangeRepeat();
+		}
+		//Update repeat in case it has been changed externally (needed for FFX)
+		reader.SetRepeat(channel.repeat);
+	}
+
+	int32 readSample = reader.GetSample();
+	channel.current = reader.GetCurrent();
+
+	UpdateAdsr(channel);
+	channel.volumeLeftAbs = ComputeChannelVolume(channel.volumeLeft, channel.volumeLeftAbs);
+	channel.volumeRightAbs = ComputeChannelVolume(channel.volumeRight, channel.volumeRightAbs);
+
+	if(readSample == 0) return 0;
+
+	//Mix in adsrVolume
+	return (readSample * static_cast<int32>(channel.adsrVolume >> 16)) / static_cast<int32>(MAX_ADSR_VOLUME >> 16);
+}
+
+bool CSpuBase::CanMixChannelsAsBlock(unsigned int ticks) const
+{
+	//Running channels over the whole block changes the order in which sample data is read
+	//relative to reverb writes. This only matters if a channel reads from the reverb work area.
+	bool updateReverb = m_reverbEnabled && (m_ctrl & CONTROL_REVERB) && (m_reverbWorkAddrStart < m_reverbWorkAddrEnd);
+	if(!updateReverb) return true;
+
+	auto overlapsReverbArea =
+	    [&](uint32 address, uint32 size) {
+		    uint32 endAddress = address + size;
+		    if(endAddress > m_ramSize)
+		    {
+			    //Reads wrap around, be conservative
+			    return true;
+		    }
+		    return (address < m_reverbWorkAddrEnd) && (endAddress > m_reverbWorkAddrStart);
+	    };
+
+	for(unsigned int i = 0; i < 24; i++)
+	{
+		const auto& channel(m_channel[i]);
+		const auto& reader(m_reader[i]);
+		uint32 readAheadSize = reader.GetReadAheadSize(ticks);
+		if(overlapsReverbArea(channel.address, readAheadSize)) return false;
+		if(overlapsReverbArea(channel.repeat, readAheadSize)) return false;
+		if(overlapsReverbArea(reader.GetRepeat(), readAheadSize)) return false;
+		if(overlapsReverbArea(reader.GetCurrent() & ~0xF, readAheadSize)) return false;
+	}
+	return true;
+}
+
+void CSpuBase::MixChannelsAsBlock(int16* samples, unsigned int ticks, bool updateReverb)
+{
+	unsigned int sampleCount = ticks * 2;
+	m_mixInput.resize(sampleCount);
+	m_mixVolume.resize(sampleCount);
+	if(updateReverb)
+	{
+		m_mixReverb.assign(sampleCount, 0);
+	}
+
+	for(unsigned int i = 0; i < 24; i++)
+	{
+		const auto& channel(m_channel[i]);
+		bool hasSamples = false;
+		for(unsigned int j = 0; j < ticks; j++)
+		{
+			int32 inputSample = UpdateChannel(i);
+			assert((inputSample >= SHRT_MIN) && (inputSample <= SHRT_MAX));
+			m_mixInput[(j * 2) + 0] = static_cast<int16>(inputSample);
+			m_mixInput[(j * 2) + 1] = static_cast<int16>(inputSample);
+			m_mixVolume[(j * 2) + 0] = static_cast<int16>(channel.volumeLeftAbs >> 16);
+			m_mixVolume[(j * 2) + 1] = static_cast<int16>(channel.volumeRightAbs >> 16);
+			hasSamples |= (inputSample != 0);
+		}
+
+		if(!hasSamples) continue;
+
+		MixSampleBlock(samples, m_mixInput.data(), m_mixVolume.data(), sampleCount);
+
+		//Mix in reverb if enabled for this channel
+		if(updateReverb && (m_channelReverb.f & (1 << i)))
+		{
+			MixSampleBlock(m_mixReverb.data(), m_mixInput.data(), m_mixVolume.data(), sampleCount);
+		}
+	}
+}
+
 uint32 CSpuBase::GetAdsrDelta(unsigned int index) const
 {
 	return m_adsrLogTable[index + 32];
@@ -1460,6 +1642,16 @@ void CSpuBase::CSampleReader::SetRepeat(uint32 repeatAddr)
 	m_repeatAddr = repeatAddr & (m_ramSize - 1);
 }
 
+//Gives an upper bound of the amount of sample data that can be read in the next ticks, starting from
+//the current address, the repeat address or a new start address.
+uint32 CSpuBase::CSampleReader::GetReadAheadSize(unsigned int ticks) const
+{
+	uint32 blockCount = static_cast<uint32>((static_cast<uint64>(ticks) * m_sampleStep) / (PITCH_BASE * BUFFER_SAMPLES));
+	//Account for the blocks already buffered and partial blocks at both ends
+	blockCount += 4;
+	return blockCount * 0x10;
+}
+
 uint32 CSpuBase::CSampleReader::GetCurrent() const
 {
 	//Simulate a kind of progress inside the current sample address.
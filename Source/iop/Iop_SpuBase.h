@@ -1,6 +1,7 @@
 #pragma once
 
 #include <map>
+#include <vector>
 #include "Types.h"
 #include "BasicUnion.h"
 #include "Convertible.h"
@@ -218,6 +219,7 @@ namespace Iop
 
 		void SetVolumeAdjust(float);
 		void SetReverbEnabled(bool);
+		void SetBlockMixingEnabled(bool);
 
 		void SetBaseSamplingRate(uint32);
 		void SetDestinationSamplingRate(uint32);
@@ -272,6 +274,9 @@ namespace Iop
 
 		void Render(int16*, unsigned int);
 
+		static void MixSamples(int32, int32, int16*);
+		static void MixSampleBlock(int16*, const int16*, const int16*, unsigned int);
+
 		static bool g_reverbParamIsAddress[REVERB_PARAM_COUNT];
 
 	private:
@@ -310,6 +315,7 @@ namespace Iop
 			uint32 GetRepeat() const;
 			void SetRepeat(uint32);
 			uint32 GetCurrent() const;
+			uint32 GetReadAheadSize(unsigned int) const;
 			bool IsDone() const;
 			void ClearIsDone();
 			bool GetEndFlag() const;
@@ -377,6 +383,10 @@ namespace Iop
 			MAX_ADSR_VOLUME = 0x7FFFFFFF,
 		};
 
+		int32 UpdateChannel(unsigned int);
+		bool CanMixChannelsAsBlock(unsigned int) const;
+		void MixChannelsAsBlock(int16*, unsigned int, bool);
+
 		void UpdateAdsr(CHANNEL&);
 		void UpdateReverb(int16[2], int16*);
 		uint32 GetAdsrDelta(unsigned int) const;
@@ -385,7 +395,6 @@ namespace Iop
 		uint32 GetReverbOffset(unsigned int) const;
 		float GetReverbCoef(unsigned int) const;
 
-		static void MixSamples(int32, int32, int16*);
 		int32 ComputeChannelVolume(const CHANNEL_VOLUME&, int32);
 
 		static const uint32 g_linearIncreaseSweepDeltas[0x80];
@@ -415,12 +424,18 @@ namespace Iop
 		CSampleReader m_reader[MAX_CHANNEL];
 		uint32 m_adsrLogTable[160];
 		bool m_reverbEnabled;
+		bool m_blockMixingEnabled = true;
 		float m_volumeAdjust;
 
 		CBlockSampleReader m_blockReader;
 		uint32 m_soundInputDataAddr = 0;
 		uint32 m_blockWritePtr = 0;
 
+		//Work buffers used when mixing channels one block at a time
+		std::vector<int16> m_mixInput;
+		std::vector<int16> m_mixVolume;
+		std::vector<int16> m_mixReverb;
+
 		static_assert((sizeof(decltype(m_reverb)) % 16) == 0, "sizeof(m_reverb) must be a multiple of 16 (needed for saved state).");
 	};
 }
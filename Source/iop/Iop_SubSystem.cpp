@@ -1,6 +1,6 @@
 #include "Iop_SubSystem.h"
 #include "IopBios.h"
-#include "GenericMipsExecutor.h"
+#include "IopExecutor.h"
 #include "../psx/PsxBios.h"
 #include "../states/MemoryStateFile.h"
 #include "../states/RegisterStateFile.h"
@@ -43,14 +43,28 @@ CSubSystem::CSubSystem(bool ps2Mode)
 {
 	if(ps2Mode)
 	{
-		m_bios = std::make_shared<CIopBios>(m_cpu, m_ram, m_scratchPad);
+		auto iopBios = std::make_shared<CIopBios>(m_cpu, m_ram, m_scratchPad);
+		m_cpu.m_hleCallHandler =
+		    [this, iopBios = iopBios.get()](CMIPS*) {
+			    if(!iopBios->HandleHleCall()) return false;
+			    //Handler might have enabled interrupts, make sure pending ones get serviced
+			    if(
+			        m_intc.HasPendingInterrupt() &&
+			        (m_cpu.m_State.nHasException == MIPS_EXCEPTION_NONE) &&
+			        ((m_cpu.m_State.nCOP0[CCOP_SCU::STATUS] & CMIPS::STATUS_IE) == CMIPS::STATUS_IE))
+			    {
+				    m_cpu.m_State.nHasException = MIPS_EXCEPTION_CHECKPENDINGINT;
+			    }
+			    return true;
+		    };
+		m_bios = iopBios;
 	}
 	else
 	{
 		m_bios = std::make_shared<CPsxBios>(m_cpu, m_ram, PS2::IOP_BASE_RAM_SIZE);
 	}
 
-	m_cpu.m_executor = std::make_unique<CGenericMipsExecutor<BlockLookupOneWay>>(m_cpu, (IOP_RAM_SIZE * 4), BLOCK_CATEGORY_PS2_IOP);
+	m_cpu.m_executor = std::make_unique<CIopExecutor>(m_cpu, (IOP_RAM_SIZE * 4));
 
 	//Read memory map
 	m_cpu.m_pMemoryMap->InsertReadMap((0 * IOP_RAM_SIZE), (0 * IOP_RAM_SIZE) + IOP_RAM_SIZE - 1, m_ram, 0x01);
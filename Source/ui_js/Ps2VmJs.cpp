@@ -13,6 +13,8 @@ extern "C" void SWL_Proxy(uint32, uint32, CMIPS*);
 extern "C" void SWR_Proxy(uint32, uint32, CMIPS*);
 extern "C" void SDL_Proxy(uint32, uint64, CMIPS*);
 extern "C" void SDR_Proxy(uint32, uint64, CMIPS*);
+extern "C" uint32 HleCall_Proxy(CMIPS*);
+extern "C" uint32 Syscall_Proxy(CMIPS*);
 
 void CPs2VmJs::CreateVM()
 {
@@ -40,6 +42,8 @@ void CPs2VmJs::CreateVM()
 
 	Jitter::CWasmFunctionRegistry::RegisterFunction(reinterpret_cast<uintptr_t>(&SDL_Proxy), "_SDL_Proxy", "viji");
 	Jitter::CWasmFunctionRegistry::RegisterFunction(reinterpret_cast<uintptr_t>(&SDR_Proxy), "_SDR_Proxy", "viji");
+	Jitter::CWasmFunctionRegistry::RegisterFunction(reinterpret_cast<uintptr_t>(&HleCall_Proxy), "_HleCall_Proxy", "ii");
+	Jitter::CWasmFunctionRegistry::RegisterFunction(reinterpret_cast<uintptr_t>(&Syscall_Proxy), "_Syscall_Proxy", "ii");
 
 	CPS2VM::CreateVM();
 }
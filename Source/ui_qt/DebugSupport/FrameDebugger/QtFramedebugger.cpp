@@ -442,7 +442,7 @@ void QtFramedebugger::on_actionLoad_Dump_triggered()
 {
 	QFileDialog dialog(this);
 	dialog.setFileMode(QFileDialog::ExistingFile);
-	dialog.setNameFilter(tr("Play! Frame Dumps (*.dmp.zip);;All files (*.*)"));
+	dialog.setNameFilter(tr("Play! Frame Dumps (*.dmp *.dmp.zip);;All files (*.*)"));
 	if(dialog.exec())
 	{
 		auto filePath = dialog.selectedFiles().first();
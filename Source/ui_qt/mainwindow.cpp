@@ -598,7 +598,22 @@ void MainWindow::updateStats()
 	auto cpuUtilisation = CStatsManager::GetInstance().GetCpuUtilisationInfo();
 	uint32 dcpf = (frames != 0) ? (drawCalls / frames) : 0;
 #ifdef PROFILE
-	m_profileStatsLabel->setText(QString::fromStdString(CStatsManager::GetInstance().GetProfilingInfo()));
+	{
+		auto profilingInfo = CStatsManager::GetInstance().GetProfilingInfo();
+		auto glHandler = m_virtualMachine ? dynamic_cast<CGSH_OpenGL*>(m_virtualMachine->GetGSHandler()) : nullptr;
+		if(glHandler)
+		{
+			auto cacheStats = glHandler->GetResourceCacheStats();
+			profilingInfo += string_format("Palette:     %6d hits %6d misses %6d probes\r\n",
+			                               cacheStats.paletteHits, cacheStats.paletteMisses, cacheStats.paletteProbes);
+			profilingInfo += string_format("Framebuffer: %6d hits %6d misses %6d probes %6d invalidations\r\n",
+			                               cacheStats.framebufferHits, cacheStats.framebufferMisses, cacheStats.framebufferProbes,
+			                               cacheStats.framebufferInvalidations);
+			profilingInfo += string_format("Depthbuffer: %6d hits %6d misses\r\n",
+			                               cacheStats.depthbufferHits, cacheStats.depthbufferMisses);
+		}
+		m_profileStatsLabel->setText(QString::fromStdString(profilingInfo));
+	}
 #endif
 	m_fpsLabel->setText(QString("%1%2 f/s, %3 dc/f").arg(frames).arg(unlockedFps ? " (U)" : "").arg(dcpf));
 
@@ -1064,30 +1079,32 @@ fs::path MainWindow::GetFrameDumpDirectoryPath()
 
 void MainWindow::DumpNextFrame()
 {
-	m_virtualMachine->m_ee->m_gs->TriggerFrameDump(
-	    [&](const CFrameDump& frameDump) {
-		    try
-		    {
-			    auto frameDumpDirectoryPath = GetFrameDumpDirectoryPath();
-			    Framework::PathUtils::EnsurePathExists(frameDumpDirectoryPath);
-			    for(unsigned int i = 0; i < UINT_MAX; i++)
-			    {
-				    auto frameDumpFileName = string_format("framedump_%08d.dmp.zip", i);
-				    auto frameDumpPath = frameDumpDirectoryPath / fs::path(frameDumpFileName);
-				    if(!fs::exists(frameDumpPath))
-				    {
-					    auto dumpStream = Framework::CreateOutputStdStream(frameDumpPath.native());
-					    frameDump.Write(dumpStream);
-					    m_msgLabel->setText(QString("Dumped frame to '%1'.").arg(frameDumpFileName.c_str()));
-					    return;
-				    }
-			    }
-		    }
-		    catch(...)
-		    {
-		    }
-		    m_msgLabel->setText(QString("Failed to dump frame."));
-	    });
+	try
+	{
+		auto frameDumpDirectoryPath = GetFrameDumpDirectoryPath();
+		Framework::PathUtils::EnsurePathExists(frameDumpDirectoryPath);
+		for(unsigned int i = 0; i < UINT_MAX; i++)
+		{
+			auto frameDumpFileName = string_format("framedump_%08d.dmp", i);
+			auto frameDumpPath = frameDumpDirectoryPath / fs::path(frameDumpFileName);
+			if(!fs::exists(frameDumpPath))
+			{
+				m_virtualMachine->m_ee->m_gs->TriggerFrameDumpCapture(
+				    frameDumpPath, 1,
+				    [this, frameDumpFileName](bool succeeded) {
+					    //Called from the GS handler's thread, label needs to be updated on the UI thread
+					    auto message = succeeded ? QString("Dumped frame to '%1'.").arg(frameDumpFileName.c_str()) : QString("Failed to dump frame.");
+					    QMetaObject::invokeMethod(
+					        this, [this, message]() { m_msgLabel->setText(message); }, Qt::QueuedConnection);
+				    });
+				return;
+			}
+		}
+	}
+	catch(...)
+	{
+	}
+	m_msgLabel->setText(QString("Failed to dump frame."));
 }
 
 void MainWindow::ToggleGsDraw()
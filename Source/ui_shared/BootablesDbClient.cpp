@@ -23,6 +23,16 @@ static const char* g_bootablesTableCreateStatement =
     "    bootableType INTEGER DEFAULT 0"
     ")";
 
+static const char* g_scanCacheTableCreateStatement =
+    "CREATE TABLE IF NOT EXISTS scanCache"
+    "("
+    "    path TEXT PRIMARY KEY,"
+    "    size INTEGER DEFAULT 0,"
+    "    modifiedTime INTEGER DEFAULT 0,"
+    "    bootableType INTEGER DEFAULT 0,"
+    "    discId VARCHAR(10) DEFAULT ''"
+    ")";
+
 CClient::CClient()
 {
 	m_dbPath = CAppConfig::GetInstance().GetBasePath() / g_dbFileName;
@@ -43,6 +53,11 @@ CClient::CClient()
 		statement.StepNoResult();
 	}
 
+	{
+		Framework::CSqliteStatement statement(m_db, g_scanCacheTableCreateStatement);
+		statement.StepNoResult();
+	}
+
 	{
 		auto path = Framework::PathUtils::GetAppResourcesPath() / "states.db";
 		std::error_code errorCode;
@@ -101,6 +116,17 @@ std::vector<Bootable> CClient::GetBootables(int32_t sortMethod)
 	return bootables;
 }
 
+std::set<std::string> CClient::GetBootablePaths()
+{
+	std::set<std::string> paths;
+	Framework::CSqliteStatement statement(m_db, "SELECT path FROM bootables");
+	while(statement.Step())
+	{
+		paths.insert(reinterpret_cast<const char*>(sqlite3_column_text(statement, 0)));
+	}
+	return paths;
+}
+
 void CClient::RegisterBootable(const fs::path& path, const char* title, const char* discId, BootableUtils::BOOTABLE_TYPE bootableType)
 {
 	Framework::CSqliteStatement statement(m_db, "INSERT OR IGNORE INTO bootables (path, title, discId, bootableType) VALUES (?,?,?,?)");
@@ -158,6 +184,58 @@ void CClient::SetOverview(const fs::path& path, const char* overview)
 	statement.StepNoResult();
 }
 
+ScanCache CClient::GetScanCache()
+{
+	ScanCache scanCache;
+	Framework::CSqliteStatement statement(m_db, "SELECT path, size, modifiedTime, bootableType, discId FROM scanCache");
+	while(statement.Step())
+	{
+		ScanCacheEntry entry;
+		entry.size = sqlite3_column_int64(statement, 1);
+		entry.modifiedTime = sqlite3_column_int64(statement, 2);
+		entry.bootableType = static_cast<BootableUtils::BOOTABLE_TYPE>(sqlite3_column_int(statement, 3));
+		entry.discId = reinterpret_cast<const char*>(sqlite3_column_text(statement, 4));
+		scanCache.emplace(reinterpret_cast<const char*>(sqlite3_column_text(statement, 0)), std::move(entry));
+	}
+	return scanCache;
+}
+
+void CClient::SetScanCacheEntry(const fs::path& path, const ScanCacheEntry& entry)
+{
+	Framework::CSqliteStatement statement(m_db, "INSERT OR REPLACE INTO scanCache (path, size, modifiedTime, bootableType, discId) VALUES (?,?,?,?,?)");
+	statement.BindText(1, Framework::PathUtils::GetNativeStringFromPath(path).c_str());
+	sqlite3_bind_int64(statement, 2, entry.size);
+	sqlite3_bind_int64(statement, 3, entry.modifiedTime);
+	statement.BindInteger(4, entry.bootableType);
+	statement.BindText(5, entry.discId.c_str(), true);
+	statement.StepNoResult();
+}
+
+void CClient::RemoveScanCacheEntry(const std::string& nativePath)
+{
+	Framework::CSqliteStatement statement(m_db, "DELETE FROM scanCache WHERE path = ?");
+	statement.BindText(1, nativePath.c_str());
+	statement.StepNoResult();
+}
+
+void CClient::BeginTransaction()
+{
+	Framework::CSqliteStatement statement(m_db, "BEGIN TRANSACTION");
+	statement.StepNoResult();
+}
+
+void CClient::CommitTransaction()
+{
+	Framework::CSqliteStatement statement(m_db, "COMMIT TRANSACTION");
+	statement.StepNoResult();
+}
+
+void CClient::RollbackTransaction()
+{
+	Framework::CSqliteStatement statement(m_db, "ROLLBACK TRANSACTION");
+	statement.StepNoResult();
+}
+
 BootableStateList CClient::GetGameStates(std::string discId)
 {
 	BootableStateList states;
@@ -2,6 +2,8 @@
 
 #include <string>
 #include <vector>
+#include <map>
+#include <set>
 #include "filesystem_def.h"
 #include "Types.h"
 #include "Singleton.h"
@@ -30,6 +32,16 @@ namespace BootablesDb
 		BootableUtils::BOOTABLE_TYPE bootableType = BootableUtils::UNKNOWN;
 	};
 
+	//Result of a previous probe of a file, used to avoid opening it again when rescanning
+	struct ScanCacheEntry
+	{
+		uint64 size = 0;
+		int64 modifiedTime = 0;
+		BootableUtils::BOOTABLE_TYPE bootableType = BootableUtils::UNKNOWN;
+		std::string discId;
+	};
+	using ScanCache = std::map<std::string, ScanCacheEntry>;
+
 	class CClient : public CSingleton<CClient>
 	{
 	public:
@@ -49,6 +61,7 @@ namespace BootablesDb
 		Bootable GetBootable(const fs::path&);
 		std::vector<Bootable> GetBootables(int32_t = SORT_METHOD_NONE);
 		BootableStateList GetStates();
+		std::set<std::string> GetBootablePaths();
 
 		void RegisterBootable(const fs::path&, const char*, const char*, BootableUtils::BOOTABLE_TYPE);
 		void UnregisterBootable(const fs::path&);
@@ -59,6 +72,14 @@ namespace BootablesDb
 		void SetLastBootedTime(const fs::path&, time_t);
 		void SetOverview(const fs::path& path, const char* overview);
 
+		ScanCache GetScanCache();
+		void SetScanCacheEntry(const fs::path&, const ScanCacheEntry&);
+		void RemoveScanCacheEntry(const std::string&);
+
+		void BeginTransaction();
+		void CommitTransaction();
+		void RollbackTransaction();
+
 	private:
 		Bootable ReadBootable(Framework::CSqliteStatement&);
 		BootableStateList GetGameStates(std::string);
@@ -1,4 +1,8 @@
 #include <algorithm>
+#include <deque>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
 #include "AppConfig.h"
 #include "BootablesProcesses.h"
 #include "BootablesDbClient.h"
@@ -22,9 +26,21 @@
 
 //#define SCAN_LOG
 
+//Number of scan results accumulated before being committed to the database
+#define SCAN_COMMIT_BATCH_SIZE 256
+#define SCAN_MAX_THREAD_COUNT 8
+
+#ifdef _WIN32
+#define SCAN_PATH_SEPARATORS "\\/"
+#else
+#define SCAN_PATH_SEPARATORS "/"
+#endif
+
 static void BootableLog(const char* format, ...)
 {
 #ifdef SCAN_LOG
+	static std::mutex logMutex;
+	std::lock_guard logLock(logMutex);
 	static FILE* logStream = nullptr;
 	if(!logStream)
 	{
@@ -94,45 +110,372 @@ bool TryUpdateLastBootedTime(const fs::path& path)
 	}
 }
 
-void ScanBootables(const fs::path& parentPath, bool recursive)
+namespace
 {
-	BootableLog("Entering ScanBootables(path = '%s', recursive = %d);\r\n",
-	            parentPath.string().c_str(), static_cast<int>(recursive));
-	try
+	struct SCAN_JOB
 	{
-		std::error_code ec;
-		for(auto pathIterator = fs::directory_iterator(parentPath, ec);
-		    pathIterator != fs::directory_iterator(); pathIterator.increment(ec))
+		fs::path path;
+		bool isDirectory = false;
+		BootablesDb::ScanCacheEntry fileInfo;
+	};
+
+	struct SCAN_RESULT
+	{
+		fs::path path;
+		BootablesDb::ScanCacheEntry entry;
+		bool needsCacheUpdate = false;
+	};
+
+	//Directories are listed and files are probed by worker threads. The database is only
+	//accessed by the thread that started the scan, results are committed in batches.
+	class CBootableScanner
+	{
+	public:
+		CBootableScanner(bool recursive)
+		    : m_recursive(recursive)
+		{
+			auto& client = BootablesDb::CClient::GetInstance();
+			m_registeredPaths = client.GetBootablePaths();
+			m_scanCache = client.GetScanCache();
+		}
+
+		void Scan(const fs::path& parentPath)
+		{
+			SCAN_JOB rootJob;
+			rootJob.path = parentPath;
+			rootJob.isDirectory = true;
+			QueueJob(std::move(rootJob));
+
+			unsigned int threadCount = std::clamp<unsigned int>(std::thread::hardware_concurrency(), 2, SCAN_MAX_THREAD_COUNT);
+			std::vector<std::thread> threads;
+			for(unsigned int i = 0; i < threadCount; i++)
+			{
+				threads.emplace_back([this]() { WorkerProc(); });
+			}
+
+			while(true)
+			{
+				std::vector<SCAN_RESULT> results;
+				bool done = false;
+				{
+					std::unique_lock lock(m_mutex);
+					m_resultsCondition.wait(lock, [this]() { return (m_results.size() >= SCAN_COMMIT_BATCH_SIZE) || (m_pendingJobCount == 0); });
+					results.swap(m_results);
+					done = (m_pendingJobCount == 0);
+				}
+				CommitResults(results);
+				if(done) break;
+			}
+
+			for(auto& thread : threads)
+			{
+				thread.join();
+			}
+
+			PruneScanCache(parentPath);
+		}
+
+	private:
+		void QueueJob(SCAN_JOB job)
+		{
+			std::lock_guard lock(m_mutex);
+			m_jobs.push_back(std::move(job));
+			m_pendingJobCount++;
+			m_jobAvailableCondition.notify_one();
+		}
+
+		void WorkerProc()
+		{
+			while(true)
+			{
+				SCAN_JOB job;
+				{
+					std::unique_lock lock(m_mutex);
+					m_jobAvailableCondition.wait(lock, [this]() { return !m_jobs.empty() || (m_pendingJobCount == 0); });
+					if(m_jobs.empty()) break;
+					job = std::move(m_jobs.front());
+					m_jobs.pop_front();
+				}
+
+				if(job.isDirectory)
+				{
+					ListDirectory(job.path);
+				}
+				else
+				{
+					ProbeFile(job);
+				}
+
+				{
+					std::lock_guard lock(m_mutex);
+					m_pendingJobCount--;
+					if(m_pendingJobCount == 0)
+					{
+						m_jobAvailableCondition.notify_all();
+						m_resultsCondition.notify_one();
+					}
+				}
+			}
+		}
+
+		void ListDirectory(const fs::path& parentPath)
 		{
-			auto& path = pathIterator->path();
-			BootableLog("Checking '%s'... ", path.string().c_str());
+			BootableLog("Listing '%s'.\r\n", parentPath.string().c_str());
 			try
 			{
+				std::error_code ec;
+				auto pathIterator = fs::directory_iterator(parentPath, ec);
 				if(ec)
 				{
-					BootableLog(" failed to get status: %s.\r\n", ec.message().c_str());
-					continue;
+					BootableLog("Failed to list directory: %s.\r\n", ec.message().c_str());
+					AddFailedDirectory(parentPath);
+					return;
 				}
-				if(recursive && fs::is_directory(path))
+				for(; pathIterator != fs::directory_iterator(); pathIterator.increment(ec))
 				{
-					BootableLog("is directory.\r\n");
-					ScanBootables(path, recursive);
-					continue;
+					if(ec)
+					{
+						//Iteration stops here, remaining entries won't be seen
+						BootableLog("Failed to get status: %s.\r\n", ec.message().c_str());
+						AddFailedDirectory(parentPath);
+						continue;
+					}
+					try
+					{
+						const auto& entry = *pathIterator;
+						if(entry.is_directory(ec))
+						{
+							if(m_recursive)
+							{
+								SCAN_JOB job;
+								job.path = entry.path();
+								job.isDirectory = true;
+								QueueJob(std::move(job));
+							}
+							continue;
+						}
+						CheckFile(entry);
+					}
+					catch(const std::exception& exception)
+					{
+						//Failed to process a path, keep going
+						BootableLog("Exception while checking '%s': %s\r\n", pathIterator->path().string().c_str(), exception.what());
+					}
 				}
-				BootableLog("registering... ");
-				bool success = TryRegisterBootable(path);
-				BootableLog("result = %d\r\n", static_cast<int>(success));
 			}
 			catch(const std::exception& exception)
 			{
-				//Failed to process a path, keep going
-				BootableLog(" exception: %s\r\n", exception.what());
+				BootableLog("Caught an exception while trying to list directory: %s\r\n", exception.what());
+				AddFailedDirectory(parentPath);
+			}
+		}
+
+		void AddFailedDirectory(const fs::path& path)
+		{
+			std::lock_guard lock(m_mutex);
+			m_failedDirectories.push_back(MakeDirectoryPrefix(path));
+		}
+
+		void CheckFile(const fs::directory_entry& entry)
+		{
+			const auto& path = entry.path();
+			auto nativePath = Framework::PathUtils::GetNativeStringFromPath(path);
+			{
+				std::lock_guard lock(m_mutex);
+				m_seenPaths.insert(nativePath);
 			}
+			if(m_registeredPaths.count(nativePath)) return;
+
+			std::error_code ec;
+			SCAN_JOB job;
+			job.path = path;
+			job.fileInfo.size = entry.file_size(ec);
+			if(ec) return;
+			job.fileInfo.modifiedTime = entry.last_write_time(ec).time_since_epoch().count();
+			if(ec) return;
+
+			auto cacheIterator = m_scanCache.find(nativePath);
+			if(cacheIterator != std::end(m_scanCache))
+			{
+				const auto& cacheEntry = cacheIterator->second;
+				if((cacheEntry.size == job.fileInfo.size) && (cacheEntry.modifiedTime == job.fileInfo.modifiedTime))
+				{
+					//File was already probed and didn't change, no need to open it again
+					BootableLog("'%s' found in scan cache.\r\n", path.string().c_str());
+					if(cacheEntry.bootableType != BootableUtils::UNKNOWN)
+					{
+						SCAN_RESULT result;
+						result.path = path;
+						result.entry = cacheEntry;
+						AddResult(std::move(result));
+					}
+					return;
+				}
+			}
+
+			QueueJob(std::move(job));
 		}
+
+		void ProbeFile(const SCAN_JOB& job)
+		{
+			SCAN_RESULT result;
+			result.path = job.path;
+			result.entry = job.fileInfo;
+			result.needsCacheUpdate = true;
+			try
+			{
+				auto bootableType = BootableUtils::GetBootableType(job.path);
+				if(bootableType == BootableUtils::PS2_DISC)
+				{
+					if(!DiskUtils::TryGetDiskId(job.path, &result.entry.discId))
+					{
+						bootableType = BootableUtils::UNKNOWN;
+					}
+				}
+				result.entry.bootableType = bootableType;
+			}
+			catch(...)
+			{
+				result.entry.bootableType = BootableUtils::UNKNOWN;
+			}
+			BootableLog("Probed '%s', type = %d.\r\n", job.path.string().c_str(), static_cast<int>(result.entry.bootableType));
+			AddResult(std::move(result));
+		}
+
+		void AddResult(SCAN_RESULT result)
+		{
+			std::lock_guard lock(m_mutex);
+			m_results.push_back(std::move(result));
+			if(m_results.size() >= SCAN_COMMIT_BATCH_SIZE)
+			{
+				m_resultsCondition.notify_one();
+			}
+		}
+
+		void CommitResults(const std::vector<SCAN_RESULT>& results)
+		{
+			if(results.empty()) return;
+			auto& client = BootablesDb::CClient::GetInstance();
+			try
+			{
+				client.BeginTransaction();
+				try
+				{
+					for(const auto& result : results)
+					{
+						if(result.entry.bootableType != BootableUtils::UNKNOWN)
+						{
+							client.RegisterBootable(result.path, result.path.filename().string().c_str(),
+							                        result.entry.discId.c_str(), result.entry.bootableType);
+						}
+						if(result.needsCacheUpdate)
+						{
+							client.SetScanCacheEntry(result.path, result.entry);
+						}
+					}
+					client.CommitTransaction();
+				}
+				catch(...)
+				{
+					client.RollbackTransaction();
+					throw;
+				}
+			}
+			catch(const std::exception& exception)
+			{
+				BootableLog("Caught an exception while committing scan results: %s\r\n", exception.what());
+			}
+		}
+
+		static std::string MakeDirectoryPrefix(const fs::path& path)
+		{
+			auto prefix = Framework::PathUtils::GetNativeStringFromPath(path);
+			if(!prefix.empty() && (prefix.find_last_of(SCAN_PATH_SEPARATORS) != (prefix.size() - 1)))
+			{
+				prefix += static_cast<char>(fs::path::preferred_separator);
+			}
+			return prefix;
+		}
+
+		static bool HasPrefix(const std::string& path, const std::string& prefix)
+		{
+			return path.compare(0, prefix.size(), prefix) == 0;
+		}
+
+		//Drops cache entries of files that were in the scanned directories but that
+		//weren't found this time (removed or renamed). Entries under directories that
+		//couldn't be listed are kept.
+		void PruneScanCache(const fs::path& parentPath)
+		{
+			auto rootPrefix = MakeDirectoryPrefix(parentPath);
+			std::vector<std::string> stalePaths;
+			for(const auto& cachePair : m_scanCache)
+			{
+				const auto& path = cachePair.first;
+				if(m_seenPaths.count(path)) continue;
+				if(!HasPrefix(path, rootPrefix)) continue;
+				if(!m_recursive && (path.find_first_of(SCAN_PATH_SEPARATORS, rootPrefix.size()) != std::string::npos)) continue;
+				bool inFailedDirectory = std::any_of(std::begin(m_failedDirectories), std::end(m_failedDirectories),
+				                                     [&path](const std::string& failedPrefix) { return HasPrefix(path, failedPrefix); });
+				if(inFailedDirectory) continue;
+				stalePaths.push_back(path);
+			}
+
+			if(stalePaths.empty()) return;
+			auto& client = BootablesDb::CClient::GetInstance();
+			try
+			{
+				client.BeginTransaction();
+				try
+				{
+					for(const auto& stalePath : stalePaths)
+					{
+						BootableLog("Removing '%s' from scan cache.\r\n", stalePath.c_str());
+						client.RemoveScanCacheEntry(stalePath);
+					}
+					client.CommitTransaction();
+				}
+				catch(...)
+				{
+					client.RollbackTransaction();
+					throw;
+				}
+			}
+			catch(const std::exception& exception)
+			{
+				BootableLog("Caught an exception while pruning scan cache: %s\r\n", exception.what());
+			}
+		}
+
+		bool m_recursive = true;
+
+		//Read only while workers are running
+		std::set<std::string> m_registeredPaths;
+		BootablesDb::ScanCache m_scanCache;
+
+		std::mutex m_mutex;
+		std::condition_variable m_jobAvailableCondition;
+		std::condition_variable m_resultsCondition;
+		std::deque<SCAN_JOB> m_jobs;
+		unsigned int m_pendingJobCount = 0;
+		std::vector<SCAN_RESULT> m_results;
+		std::set<std::string> m_seenPaths;
+		std::vector<std::string> m_failedDirectories;
+	};
+}
+
+void ScanBootables(const fs::path& parentPath, bool recursive)
+{
+	BootableLog("Entering ScanBootables(path = '%s', recursive = %d);\r\n",
+	            parentPath.string().c_str(), static_cast<int>(recursive));
+	try
+	{
+		CBootableScanner scanner(recursive);
+		scanner.Scan(parentPath);
 	}
 	catch(const std::exception& exception)
 	{
-		BootableLog("Caught an exception while trying to list directory: %s\r\n", exception.what());
+		BootableLog("Caught an exception while scanning: %s\r\n", exception.what());
 	}
 	BootableLog("Exiting ScanBootables(path = '%s', recursive = %d);\r\n",
 	            parentPath.string().c_str(), static_cast<int>(recursive));
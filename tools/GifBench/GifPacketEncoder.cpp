@@ -0,0 +1,172 @@
+#include <cassert>
+#include <algorithm>
+#include "GifPacketEncoder.h"
+#include "ee/GIF.h"
+
+#define MAX_LOOPS (0x7FFF)
+
+static bool IsXyzRegister(uint8 reg)
+{
+	return (reg == GS_REG_XYZ2) || (reg == GS_REG_XYZ3) || (reg == GS_REG_XYZF2) || (reg == GS_REG_XYZF3);
+}
+
+static bool IsFogXyzRegister(uint8 reg)
+{
+	return (reg == GS_REG_XYZF2) || (reg == GS_REG_XYZF3);
+}
+
+CGifPacketEncoder::GifPacket CGifPacketEncoder::EncodeRegisterWrites(const CGsPacket::RegisterWriteArray& writes)
+{
+	GifPacket packet;
+	uint32 lastTagOffset = 0;
+	uint32 writeIndex = 0;
+	while(writeIndex < writes.size())
+	{
+		lastTagOffset = static_cast<uint32>(packet.size());
+
+		if(uint32 runLength = GetVertexRunLength(writes, writeIndex, true); runLength != 0)
+		{
+			EncodeVertexRun(packet, writes, writeIndex, runLength, true);
+			writeIndex += runLength * 3;
+			continue;
+		}
+
+		if(uint32 runLength = GetVertexRunLength(writes, writeIndex, false); runLength != 0)
+		{
+			EncodeVertexRun(packet, writes, writeIndex, runLength, false);
+			writeIndex += runLength * 2;
+			continue;
+		}
+
+		//Gather everything until the next vertex run and send it with A+D
+		uint32 adCount = 0;
+		while(((writeIndex + adCount) < writes.size()) && (adCount < MAX_LOOPS))
+		{
+			uint32 index = writeIndex + adCount;
+			if((adCount != 0) && (GetVertexRunLength(writes, index, true) || GetVertexRunLength(writes, index, false))) break;
+			adCount++;
+		}
+		WriteTag(packet, adCount, 0, 1, 0x0E);
+		for(uint32 i = 0; i < adCount; i++)
+		{
+			const auto& write = writes[writeIndex + i];
+			WriteQword(packet, static_cast<uint32>(write.second), static_cast<uint32>(write.second >> 32), write.first, 0);
+		}
+		writeIndex += adCount;
+	}
+	if(!packet.empty())
+	{
+		SetEop(packet, lastTagOffset);
+	}
+	return packet;
+}
+
+CGifPacketEncoder::GifPacket CGifPacketEncoder::EncodeImageData(const CGsPacket::ImageDataArray& imageData)
+{
+	assert((imageData.size() % 0x10) == 0);
+	GifPacket packet;
+	uint32 qwc = static_cast<uint32>(imageData.size() / 0x10);
+	uint32 qwOffset = 0;
+	while(qwOffset < qwc)
+	{
+		uint32 loops = std::min<uint32>(qwc - qwOffset, MAX_LOOPS);
+		uint32 tagOffset = static_cast<uint32>(packet.size());
+		WriteTag(packet, loops, 2, 0, 0);
+		auto data = imageData.data() + (qwOffset * 0x10);
+		packet.insert(std::end(packet), data, data + (loops * 0x10));
+		qwOffset += loops;
+		if(qwOffset == qwc)
+		{
+			SetEop(packet, tagOffset);
+		}
+	}
+	return packet;
+}
+
+void CGifPacketEncoder::WriteTag(GifPacket& packet, uint32 loops, uint32 cmd, uint32 nreg, uint64 regs)
+{
+	CGIF::TAG tag = {};
+	tag.loops = loops;
+	tag.cmd = cmd;
+	tag.nreg = nreg;
+	tag.regs = regs;
+	auto tagBytes = reinterpret_cast<const uint8*>(&tag);
+	packet.insert(std::end(packet), tagBytes, tagBytes + sizeof(CGIF::TAG));
+}
+
+void CGifPacketEncoder::WriteQword(GifPacket& packet, uint32 w0, uint32 w1, uint32 w2, uint32 w3)
+{
+	uint32 qword[4] = {w0, w1, w2, w3};
+	auto qwordBytes = reinterpret_cast<const uint8*>(qword);
+	packet.insert(std::end(packet), qwordBytes, qwordBytes + sizeof(qword));
+}
+
+void CGifPacketEncoder::SetEop(GifPacket& packet, uint32 tagOffset)
+{
+	auto tag = reinterpret_cast<CGIF::TAG*>(packet.data() + tagOffset);
+	tag->eop = 1;
+}
+
+uint32 CGifPacketEncoder::GetVertexRunLength(const CGsPacket::RegisterWriteArray& writes, uint32 writeIndex, bool textured)
+{
+	uint32 vertexSize = textured ? 3 : 2;
+	uint32 runLength = 0;
+	bool hasFog = false;
+	while(((writeIndex + vertexSize) <= writes.size()) && (runLength < MAX_LOOPS))
+	{
+		const auto* vertex = writes.data() + writeIndex;
+		if(textured && (vertex[0].first != GS_REG_ST)) break;
+		if(vertex[vertexSize - 2].first != GS_REG_RGBAQ) break;
+		uint8 xyzReg = vertex[vertexSize - 1].first;
+		if(!IsXyzRegister(xyzReg)) break;
+		if(runLength == 0)
+		{
+			hasFog = IsFogXyzRegister(xyzReg);
+		}
+		else if(hasFog != IsFogXyzRegister(xyzReg))
+		{
+			break;
+		}
+		runLength++;
+		writeIndex += vertexSize;
+	}
+	return runLength;
+}
+
+void CGifPacketEncoder::EncodeVertexRun(GifPacket& packet, const CGsPacket::RegisterWriteArray& writes, uint32 writeIndex, uint32 runLength, bool textured)
+{
+	uint32 vertexSize = textured ? 3 : 2;
+	const auto* vertex = writes.data() + writeIndex;
+	bool hasFog = IsFogXyzRegister(vertex[vertexSize - 1].first);
+	uint64 xyzRegDesc = hasFog ? 0x04 : 0x05;
+	uint64 regs = textured ? (0x02 | (0x01 << 4) | (xyzRegDesc << 8)) : (0x01 | (xyzRegDesc << 4));
+	WriteTag(packet, runLength, 0, vertexSize, regs);
+	for(uint32 i = 0; i < runLength; i++)
+	{
+		uint64 rgbaq = vertex[vertexSize - 2].second;
+		if(textured)
+		{
+			uint64 st = vertex[0].second;
+			WriteQword(packet, static_cast<uint32>(st), static_cast<uint32>(st >> 32), static_cast<uint32>(rgbaq >> 32), 0);
+		}
+		WriteQword(packet,
+		           static_cast<uint32>(rgbaq >> 0) & 0xFF, static_cast<uint32>(rgbaq >> 8) & 0xFF,
+		           static_cast<uint32>(rgbaq >> 16) & 0xFF, static_cast<uint32>(rgbaq >> 24) & 0xFF);
+		uint8 xyzReg = vertex[vertexSize - 1].first;
+		uint64 xyz = vertex[vertexSize - 1].second;
+		uint32 adc = ((xyzReg == GS_REG_XYZ3) || (xyzReg == GS_REG_XYZF3)) ? 0x8000 : 0;
+		if(hasFog)
+		{
+			WriteQword(packet,
+			           static_cast<uint32>(xyz >> 0) & 0xFFFF, static_cast<uint32>(xyz >> 16) & 0xFFFF,
+			           (static_cast<uint32>(xyz >> 32) & 0xFFFFFF) << 4, ((static_cast<uint32>(xyz >> 56) & 0xFF) << 4) | adc);
+		}
+		else
+		{
+			WriteQword(packet,
+			           static_cast<uint32>(xyz >> 0) & 0xFFFF, static_cast<uint32>(xyz >> 16) & 0xFFFF,
+			           static_cast<uint32>(xyz >> 32), adc);
+		}
+		vertex += vertexSize;
+	}
+}
@@ -0,0 +1,24 @@
+#pragma once
+
+#include <vector>
+#include "FrameDump.h"
+
+//Converts register writes recorded in a frame dump back into GIF packets.
+//Vertex data (ST/RGBAQ/XYZ) is encoded using PACKED mode loops, like a VU1 program would output it,
+//and everything else is sent using A+D.
+class CGifPacketEncoder
+{
+public:
+	typedef std::vector<uint8> GifPacket;
+
+	static GifPacket EncodeRegisterWrites(const CGsPacket::RegisterWriteArray&);
+	static GifPacket EncodeImageData(const CGsPacket::ImageDataArray&);
+
+private:
+	static void WriteTag(GifPacket&, uint32, uint32, uint32, uint64);
+	static void WriteQword(GifPacket&, uint32, uint32, uint32, uint32);
+	static void SetEop(GifPacket&, uint32);
+
+	static uint32 GetVertexRunLength(const CGsPacket::RegisterWriteArray&, uint32, bool);
+	static void EncodeVertexRun(GifPacket&, const CGsPacket::RegisterWriteArray&, uint32, uint32, bool);
+};
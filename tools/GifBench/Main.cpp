@@ -0,0 +1,116 @@
+#include <cstdio>
+#include <chrono>
+#include "PS2VM.h"
+#include "FrameDump.h"
+#include "StdStreamUtils.h"
+#include "filesystem_def.h"
+#include "gs/GSH_Null.h"
+#include "GifPacketEncoder.h"
+
+struct ENCODEDPACKET
+{
+	unsigned int pathIndex = 0;
+	CGifPacketEncoder::GifPacket data;
+};
+
+typedef std::vector<ENCODEDPACKET> EncodedPacketArray;
+
+static EncodedPacketArray EncodeFrameDump(const CFrameDump& frameDump)
+{
+	EncodedPacketArray encodedPackets;
+	unsigned int lastPathIndex = 0;
+	for(const auto& packet : frameDump.GetPackets())
+	{
+		ENCODEDPACKET encodedPacket;
+		if(packet.registerWrites.empty())
+		{
+			//Image packets don't have metadata, they belong to the path that sent the preceding packet
+			encodedPacket.pathIndex = lastPathIndex;
+			encodedPacket.data = CGifPacketEncoder::EncodeImageData(packet.imageData);
+		}
+		else
+		{
+			encodedPacket.pathIndex = packet.metadata.pathIndex;
+			encodedPacket.data = CGifPacketEncoder::EncodeRegisterWrites(packet.registerWrites);
+		}
+		if(encodedPacket.data.empty()) continue;
+		lastPathIndex = encodedPacket.pathIndex;
+		encodedPackets.push_back(std::move(encodedPacket));
+	}
+	return encodedPackets;
+}
+
+int main(int argc, const char** argv)
+{
+	if(argc < 2)
+	{
+		printf("Usage: GifBench <frame dump path> [iterations]\n");
+		return -1;
+	}
+
+	auto frameDumpPath = fs::path(argv[1]);
+	uint32 iterations = (argc >= 3) ? strtoul(argv[2], nullptr, 0) : 100;
+
+	CFrameDump frameDump;
+	{
+		auto inputStream = Framework::CreateInputStdStream(frameDumpPath.native());
+		frameDump.Read(inputStream);
+	}
+
+	auto encodedPackets = EncodeFrameDump(frameDump);
+
+	CPS2VM virtualMachine;
+	virtualMachine.Initialize();
+	virtualMachine.CreateGSHandler(CGSH_Null::GetFactoryFunction());
+
+	auto& gif = virtualMachine.m_ee->m_gif;
+	auto gs = virtualMachine.GetGSHandler();
+	gs->InitFromFrameDump(&frameDump);
+
+	static const unsigned int PATH_COUNT = 4;
+	std::chrono::nanoseconds pathTimes[PATH_COUNT] = {};
+	uint64 pathBytes[PATH_COUNT] = {};
+	uint64 pathPackets[PATH_COUNT] = {};
+
+	bool succeeded = true;
+	for(uint32 i = 0; (i < iterations) && succeeded; i++)
+	{
+		for(const auto& encodedPacket : encodedPackets)
+		{
+			uint32 packetSize = static_cast<uint32>(encodedPacket.data.size());
+			auto startTime = std::chrono::high_resolution_clock::now();
+			uint32 processed = gif.ProcessSinglePacket(encodedPacket.data.data(), packetSize, 0, packetSize, CGsPacketMetadata(encodedPacket.pathIndex));
+			auto endTime = std::chrono::high_resolution_clock::now();
+			if(processed != packetSize)
+			{
+				fprintf(stderr, "Error: GIF processed %u bytes out of a %u bytes packet (PATH%u).\n", processed, packetSize, encodedPacket.pathIndex);
+				succeeded = false;
+				break;
+			}
+			unsigned int pathIndex = encodedPacket.pathIndex % PATH_COUNT;
+			pathTimes[pathIndex] += endTime - startTime;
+			pathBytes[pathIndex] += processed;
+			pathPackets[pathIndex]++;
+		}
+		//Hand everything over to the GS thread and wait for it to be done before reusing the write buffer
+		gs->FlushWriteBuffer();
+		gs->SendGSCall([]() {}, true, true);
+	}
+
+	std::chrono::nanoseconds totalTime = {};
+	for(unsigned int pathIndex = 1; pathIndex < PATH_COUNT; pathIndex++)
+	{
+		if(pathPackets[pathIndex] == 0) continue;
+		auto pathTimeMs = std::chrono::duration<double, std::milli>(pathTimes[pathIndex]).count();
+		auto throughput = (pathTimeMs != 0) ? (static_cast<double>(pathBytes[pathIndex]) / (1024.0 * 1024.0)) / (pathTimeMs / 1000.0) : 0;
+		printf("PATH%u: %llu packets, %llu bytes, %.3fms, %.2fMB/s\n", pathIndex,
+		       static_cast<unsigned long long>(pathPackets[pathIndex]), static_cast<unsigned long long>(pathBytes[pathIndex]),
+		       pathTimeMs, throughput);
+		totalTime += pathTimes[pathIndex];
+	}
+	printf("Total: %.3fms for %u iteration(s).\n", std::chrono::duration<double, std::milli>(totalTime).count(), iterations);
+
+	virtualMachine.DestroyGSHandler();
+	virtualMachine.Destroy();
+	return succeeded ? 0 : -1;
+}
@@ -0,0 +1,404 @@
+#include <cstdio>
+#include <algorithm>
+#include <chrono>
+#include <map>
+#include <memory>
+#include <string>
+#include "FrameDump.h"
+#include "StdStreamUtils.h"
+#include "filesystem_def.h"
+#include "gs/GSH_Null.h"
+#if HAS_GSH_VULKAN
+#include "gs/GSH_Vulkan/GSH_VulkanOffscreen.h"
+#endif
+
+#define DEFAULT_ITERATION_COUNT 10
+#define DEFAULT_TOP_DRAW_COUNT 10
+
+typedef std::chrono::high_resolution_clock Clock;
+
+struct BENCHMARK_PARAMS
+{
+	fs::path frameDumpPath;
+	std::string handlerName = "null";
+	uint32 iterationCount = DEFAULT_ITERATION_COUNT;
+	uint32 topDrawCount = DEFAULT_TOP_DRAW_COUNT;
+};
+
+enum SEGMENT_TYPE
+{
+	SEGMENT_TYPE_REGISTERS,
+	SEGMENT_TYPE_DRAW,
+	SEGMENT_TYPE_IMAGE,
+};
+
+//Packets are split in segments that are replayed and timed separately.
+//A new segment is started at every PRIM write, which gives one segment per draw.
+struct SEGMENT
+{
+	SEGMENT_TYPE type = SEGMENT_TYPE_REGISTERS;
+	unsigned int pathIndex = 0;
+	uint32 packetIndex = 0;
+	uint32 cmdIndex = 0;
+	const CGSHandler::RegisterWrite* writesBegin = nullptr;
+	const CGSHandler::RegisterWrite* writesEnd = nullptr;
+	const CGsPacket::ImageDataArray* imageData = nullptr;
+	unsigned int primType = CGSHandler::PRIM_INVALID;
+	uint32 kickCount = 0;
+	CGsPacketMetadata metadata;
+};
+
+typedef std::vector<SEGMENT> SegmentArray;
+
+struct TIMING
+{
+	Clock::time_point startTime;
+	std::chrono::nanoseconds duration = {};
+};
+
+struct STATS
+{
+	uint64 count = 0;
+	uint64 kickCount = 0;
+	uint64 byteCount = 0;
+	std::chrono::nanoseconds totalTime = {};
+};
+
+static void PrintUsage()
+{
+	printf("Usage: GsReplayBench <frame dump path> [--handler <null");
+#if HAS_GSH_VULKAN
+	printf("|vulkan");
+#endif
+	printf(">] [--iterations <count>] [--top <count>]\n");
+}
+
+static bool ParseParams(int argc, const char** argv, BENCHMARK_PARAMS& params)
+{
+	if(argc < 2) return false;
+	params.frameDumpPath = fs::path(argv[1]);
+	for(int i = 2; i < argc; i++)
+	{
+		std::string arg = argv[i];
+		if((arg == "--handler") && ((i + 1) < argc))
+		{
+			params.handlerName = argv[++i];
+		}
+		else if((arg == "--iterations") && ((i + 1) < argc))
+		{
+			params.iterationCount = strtoul(argv[++i], nullptr, 0);
+		}
+		else if((arg == "--top") && ((i + 1) < argc))
+		{
+			params.topDrawCount = strtoul(argv[++i], nullptr, 0);
+		}
+		else
+		{
+			return false;
+		}
+	}
+	return (params.iterationCount != 0);
+}
+
+static std::unique_ptr<CGSHandler> CreateHandler(const std::string& handlerName)
+{
+	if(handlerName == "null")
+	{
+		return std::make_unique<CGSH_Null>();
+	}
+#if HAS_GSH_VULKAN
+	if(handlerName == "vulkan")
+	{
+		return std::make_unique<CGSH_VulkanOffscreen>();
+	}
+#endif
+	return std::unique_ptr<CGSHandler>();
+}
+
+static const char* GetPrimTypeName(unsigned int primType)
+{
+	switch(primType)
+	{
+	case CGSHandler::PRIM_POINT:
+		return "Point";
+	case CGSHandler::PRIM_LINE:
+		return "Line";
+	case CGSHandler::PRIM_LINESTRIP:
+		return "LineStrip";
+	case CGSHandler::PRIM_TRIANGLE:
+		return "Triangle";
+	case CGSHandler::PRIM_TRIANGLESTRIP:
+		return "TriangleStrip";
+	case CGSHandler::PRIM_TRIANGLEFAN:
+		return "TriangleFan";
+	case CGSHandler::PRIM_SPRITE:
+		return "Sprite";
+	default:
+		return "Invalid";
+	}
+}
+
+static bool IsVertexKick(uint8 registerId)
+{
+	return (registerId == GS_REG_XYZ2) || (registerId == GS_REG_XYZF2);
+}
+
+static SegmentArray BuildSegments(CFrameDump& frameDump)
+{
+	SegmentArray segments;
+
+	auto currentPrim = make_convertible<CGSHandler::PRIM>(frameDump.GetInitialGsRegisters()[GS_REG_PRIM]);
+	unsigned int lastPathIndex = 0;
+	uint32 cmdIndex = 0;
+
+	const auto& packets = frameDump.GetPackets();
+	for(uint32 packetIndex = 0; packetIndex < packets.size(); packetIndex++)
+	{
+		const auto& packet = packets[packetIndex];
+		if(packet.registerWrites.empty())
+		{
+			//Image packets don't have metadata, they belong to the path that sent the preceding packet
+			SEGMENT segment;
+			segment.type = SEGMENT_TYPE_IMAGE;
+			segment.pathIndex = lastPathIndex;
+			segment.packetIndex = packetIndex;
+			segment.cmdIndex = cmdIndex;
+			segment.imageData = &packet.imageData;
+			segments.push_back(segment);
+			continue;
+		}
+
+		lastPathIndex = packet.metadata.pathIndex;
+		const auto* writesBegin = packet.registerWrites.data();
+		const auto* writesEnd = writesBegin + packet.registerWrites.size();
+
+		SEGMENT segment;
+		segment.pathIndex = packet.metadata.pathIndex;
+		segment.packetIndex = packetIndex;
+		segment.cmdIndex = cmdIndex;
+		segment.writesBegin = writesBegin;
+		segment.metadata = packet.metadata;
+		for(auto write = writesBegin; write != writesEnd; write++, cmdIndex++)
+		{
+			if((write->first == GS_REG_PRIM) && (write != segment.writesBegin))
+			{
+				segment.writesEnd = write;
+				segments.push_back(segment);
+				segment.type = SEGMENT_TYPE_REGISTERS;
+				segment.cmdIndex = cmdIndex;
+				segment.writesBegin = write;
+				segment.kickCount = 0;
+			}
+			if(write->first == GS_REG_PRIM)
+			{
+				currentPrim <<= write->second;
+			}
+			if(IsVertexKick(write->first))
+			{
+				segment.type = SEGMENT_TYPE_DRAW;
+				segment.primType = currentPrim.nType;
+				segment.kickCount++;
+			}
+		}
+		segment.writesEnd = writesEnd;
+		segments.push_back(segment);
+	}
+
+	return segments;
+}
+
+static void ReplaySegments(CGSHandler* gs, const SegmentArray& segments, std::vector<TIMING>& timings)
+{
+	//Keep some room in the write buffer, we don't want to write past its end
+	static const uint32 WRITEBUFFER_FLUSH_THRESHOLD = 0x80000;
+	uint32 pendingWrites = 0;
+
+	for(uint32 segmentIndex = 0; segmentIndex < segments.size(); segmentIndex++)
+	{
+		const auto& segment = segments[segmentIndex];
+		auto timing = &timings[segmentIndex];
+
+		uint32 writeCount = static_cast<uint32>(segment.writesEnd - segment.writesBegin);
+		if((pendingWrites + writeCount) > WRITEBUFFER_FLUSH_THRESHOLD)
+		{
+			//Wait for the GS thread to be done with the buffer before it gets reused
+			gs->FlushWriteBuffer();
+			gs->SendGSCall([]() {}, true, true);
+			pendingWrites = 0;
+		}
+
+		//Timestamps are taken on the GS thread, right before and after the segment is processed
+		gs->SendGSCall([timing]() { timing->startTime = Clock::now(); });
+		if(segment.type == SEGMENT_TYPE_IMAGE)
+		{
+			gs->FeedImageData(segment.imageData->data(), static_cast<uint32>(segment.imageData->size()));
+		}
+		else
+		{
+			for(auto write = segment.writesBegin; write != segment.writesEnd; write++)
+			{
+				gs->WriteRegister(*write);
+			}
+			gs->ProcessWriteBuffer(&segment.metadata);
+			gs->SubmitWriteBuffer();
+			pendingWrites += writeCount;
+		}
+		gs->SendGSCall([timing]() { timing->duration += Clock::now() - timing->startTime; });
+	}
+}
+
+static double ToMs(std::chrono::nanoseconds duration)
+{
+	return std::chrono::duration<double, std::milli>(duration).count();
+}
+
+static void PrintStats(const char* name, const STATS& stats, uint32 iterationCount)
+{
+	if(stats.count == 0) return;
+	double totalMs = ToMs(stats.totalTime) / iterationCount;
+	double averageUs = (totalMs * 1000.0) / stats.count;
+	printf("  %-24s %8llu %10llu %12llu %12.3f %12.3f\n", name,
+	       static_cast<unsigned long long>(stats.count), static_cast<unsigned long long>(stats.kickCount),
+	       static_cast<unsigned long long>(stats.byteCount), totalMs, averageUs);
+}
+
+int main(int argc, const char** argv)
+{
+	BENCHMARK_PARAMS params;
+	if(!ParseParams(argc, argv, params))
+	{
+		PrintUsage();
+		return -1;
+	}
+
+	CFrameDump frameDump;
+	try
+	{
+		auto inputStream = Framework::CreateInputStdStream(params.frameDumpPath.native());
+		frameDump.Read(inputStream);
+	}
+	catch(const std::exception& exception)
+	{
+		printf("Failed to open frame dump: %s\n", exception.what());
+		return -1;
+	}
+
+	auto gs = CreateHandler(params.handlerName);
+	if(!gs)
+	{
+		printf("Unknown GS handler '%s'.\n", params.handlerName.c_str());
+		PrintUsage();
+		return -1;
+	}
+
+	gs->SetLoggingEnabled(false);
+	gs->Initialize();
+
+	auto segments = BuildSegments(frameDump);
+	std::vector<TIMING> timings(segments.size());
+
+	std::chrono::nanoseconds minFrameTime = std::chrono::nanoseconds::max();
+	std::chrono::nanoseconds totalFrameTime = {};
+
+	for(uint32 i = 0; i < params.iterationCount; i++)
+	{
+		gs->Reset();
+		gs->InitFromFrameDump(&frameDump);
+		gs->SendGSCall([]() {}, true, true);
+
+		auto startTime = Clock::now();
+		ReplaySegments(gs.get(), segments, timings);
+		gs->FlushWriteBuffer();
+		gs->Finish(true);
+		auto frameTime = Clock::now() - startTime;
+
+		minFrameTime = std::min<std::chrono::nanoseconds>(minFrameTime, frameTime);
+		totalFrameTime += frameTime;
+	}
+
+	//Per packet type stats
+	std::map<std::string, STATS> packetTypeStats;
+	std::map<std::string, STATS> drawStats;
+	for(uint32 segmentIndex = 0; segmentIndex < segments.size(); segmentIndex++)
+	{
+		const auto& segment = segments[segmentIndex];
+		const auto& timing = timings[segmentIndex];
+
+		char packetTypeName[32];
+		uint64 byteCount = 0;
+		if(segment.type == SEGMENT_TYPE_IMAGE)
+		{
+			snprintf(packetTypeName, sizeof(packetTypeName), "PATH%d Image", segment.pathIndex);
+			byteCount = segment.imageData->size();
+		}
+		else
+		{
+			snprintf(packetTypeName, sizeof(packetTypeName), "PATH%d Registers", segment.pathIndex);
+			byteCount = (segment.writesEnd - segment.writesBegin) * sizeof(CGSHandler::RegisterWrite);
+		}
+
+		auto& packetStats = packetTypeStats[packetTypeName];
+		packetStats.count++;
+		packetStats.kickCount += segment.kickCount;
+		packetStats.byteCount += byteCount;
+		packetStats.totalTime += timing.duration;
+
+		if(segment.type == SEGMENT_TYPE_DRAW)
+		{
+			auto& primStats = drawStats[GetPrimTypeName(segment.primType)];
+			primStats.count++;
+			primStats.kickCount += segment.kickCount;
+			primStats.byteCount += byteCount;
+			primStats.totalTime += timing.duration;
+		}
+	}
+
+	printf("Replayed '%s' %d time(s) with the '%s' handler (%d packets, %d segments).\n",
+	       params.frameDumpPath.string().c_str(), params.iterationCount, params.handlerName.c_str(),
+	       static_cast<uint32>(frameDump.GetPackets().size()), static_cast<uint32>(segments.size()));
+	printf("Frame time: min %.3fms, avg %.3fms\n", ToMs(minFrameTime), ToMs(totalFrameTime) / params.iterationCount);
+
+	printf("\nPer packet type (times are per iteration):\n");
+	printf("  %-24s %8s %10s %12s %12s %12s\n", "Type", "Count", "Kicks", "Bytes", "Total (ms)", "Avg (us)");
+	for(const auto& statsPair : packetTypeStats)
+	{
+		PrintStats(statsPair.first.c_str(), statsPair.second, params.iterationCount);
+	}
+
+	printf("\nPer draw primitive type (times are per iteration):\n");
+	printf("  %-24s %8s %10s %12s %12s %12s\n", "Primitive", "Draws", "Kicks", "Bytes", "Total (ms)", "Avg (us)");
+	for(const auto& statsPair : drawStats)
+	{
+		PrintStats(statsPair.first.c_str(), statsPair.second, params.iterationCount);
+	}
+
+	if(params.topDrawCount != 0)
+	{
+		std::vector<uint32> drawIndices;
+		for(uint32 segmentIndex = 0; segmentIndex < segments.size(); segmentIndex++)
+		{
+			if(segments[segmentIndex].type != SEGMENT_TYPE_DRAW) continue;
+			drawIndices.push_back(segmentIndex);
+		}
+		std::sort(drawIndices.begin(), drawIndices.end(),
+		          [&timings](uint32 lhs, uint32 rhs) { return timings[lhs].duration > timings[rhs].duration; });
+		if(drawIndices.size() > params.topDrawCount)
+		{
+			drawIndices.resize(params.topDrawCount);
+		}
+
+		printf("\nSlowest draws (times are per iteration):\n");
+		printf("  %8s %8s %-14s %8s %12s\n", "Packet", "Cmd", "Primitive", "Kicks", "Time (us)");
+		for(auto segmentIndex : drawIndices)
+		{
+			const auto& segment = segments[segmentIndex];
+			double timeUs = (ToMs(timings[segmentIndex].duration) * 1000.0) / params.iterationCount;
+			printf("  %8d %8d %-14s %8d %12.3f\n", segment.packetIndex, segment.cmdIndex,
+			       GetPrimTypeName(segment.primType), segment.kickCount, timeUs);
+		}
+	}
+
+	gs->Release();
+	gs.reset();
+	return 0;
+}
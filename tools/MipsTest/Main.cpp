@@ -0,0 +1,26 @@
+#include <functional>
+#include <memory>
+#include "TraceExitTest.h"
+
+typedef std::function<CTest*()> TestFactoryFunction;
+
+// clang-format off
+static const TestFactoryFunction s_factories[] =
+{
+	[]() { return new CTraceExitTest(); },
+};
+// clang-format on
+
+int main(int argc, const char** argv)
+{
+	auto virtualMachine = std::make_unique<CTestVm>();
+
+	for(const auto& factory : s_factories)
+	{
+		virtualMachine->Reset();
+		auto test = factory();
+		test->Execute(*virtualMachine);
+		delete test;
+	}
+	return 0;
+}
@@ -0,0 +1,36 @@
+#pragma once
+
+#include "AlignedAlloc.h"
+#include "MIPS.h"
+#include "MA_MIPSIV.h"
+#include "iop/IopExecutor.h"
+
+class CTestVm
+{
+public:
+	enum
+	{
+		RAM_SIZE = 0x10000,
+	};
+
+	CTestVm();
+	virtual ~CTestVm();
+
+	void Reset();
+	void ExecuteTest(uint32);
+
+	void* operator new(size_t allocSize)
+	{
+		return framework_aligned_alloc(allocSize, 0x10);
+	}
+
+	void operator delete(void* ptr)
+	{
+		return framework_aligned_free(ptr);
+	}
+
+	CMIPS m_cpu;
+	CMA_MIPSIV m_cpuArch;
+	CIopExecutor m_executor;
+	uint8* m_ram = nullptr;
+};
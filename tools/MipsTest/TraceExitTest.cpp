@@ -0,0 +1,60 @@
+#include "TraceExitTest.h"
+#include "MIPSAssembler.h"
+
+static void AssembleProgram(uint32* ram)
+{
+	CMIPSAssembler assembler(ram);
+
+	auto takenLabel = assembler.CreateLabel();
+
+	//Forward conditional branch, block is extended through its fall-through path
+	assembler.BNE(CMIPS::A0, CMIPS::R0, takenLabel);
+	assembler.NOP();
+
+	//0x08
+	assembler.ADDIU(CMIPS::T0, CMIPS::R0, 1);
+	assembler.SYSCALL();
+
+	//0x10
+	assembler.NOP();
+	assembler.NOP();
+
+	//0x18
+	assembler.MarkLabel(takenLabel);
+	assembler.ADDIU(CMIPS::T1, CMIPS::R0, 2);
+	assembler.SYSCALL();
+}
+
+static void Run(CTestVm& virtualMachine, uint32 branchCondition)
+{
+	auto& state = virtualMachine.m_cpu.m_State;
+	state.nGPR[CMIPS::A0].nV0 = branchCondition;
+	state.nGPR[CMIPS::T0].nV0 = 0;
+	state.nGPR[CMIPS::T1].nV0 = 0;
+	virtualMachine.ExecuteTest(0);
+}
+
+void CTraceExitTest::Execute(CTestVm& virtualMachine)
+{
+	AssembleProgram(reinterpret_cast<uint32*>(virtualMachine.m_ram));
+
+	const auto& state = virtualMachine.m_cpu.m_State;
+
+	//Taken branch leaves the trace early, goes through the dispatcher since target block doesn't exist yet
+	Run(virtualMachine, 1);
+	TEST_VERIFY(state.nGPR[CMIPS::T0].nV0 == 0);
+	TEST_VERIFY(state.nGPR[CMIPS::T1].nV0 == 2);
+	TEST_VERIFY(state.nPC == 0x20);
+
+	//Target block exists now, side exit is linked to it
+	Run(virtualMachine, 1);
+	TEST_VERIFY(state.nGPR[CMIPS::T0].nV0 == 0);
+	TEST_VERIFY(state.nGPR[CMIPS::T1].nV0 == 2);
+	TEST_VERIFY(state.nPC == 0x20);
+
+	//Not taken, runs through the whole trace
+	Run(virtualMachine, 0);
+	TEST_VERIFY(state.nGPR[CMIPS::T0].nV0 == 1);
+	TEST_VERIFY(state.nGPR[CMIPS::T1].nV0 == 0);
+	TEST_VERIFY(state.nPC == 0x10);
+}
@@ -0,0 +1,265 @@
+#include <cstdio>
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <future>
+#include <map>
+#include <nlohmann/json.hpp>
+#include "PS2VM.h"
+#include "PS2VM_Preferences.h"
+#include "AppConfig.h"
+#include "BasicBlock.h"
+#include "StdStreamUtils.h"
+#include "filesystem_def.h"
+#include "gs/GSH_Null.h"
+#include "MemoryUsage.h"
+
+#define DEFAULT_FRAME_COUNT 3000
+#define DEFAULT_TIMEOUT_SECONDS 600
+
+struct BENCHMARK_PARAMS
+{
+	fs::path bootablePath;
+	fs::path outputPath;
+	uint32 frameCount = DEFAULT_FRAME_COUNT;
+	uint32 timeoutSeconds = DEFAULT_TIMEOUT_SECONDS;
+};
+
+static void PrintUsage()
+{
+	printf("Usage: PerfBench <disc image or ELF path> [--frames <count>] [--timeout <seconds>] [--output <json path>]\n");
+}
+
+static bool ParseParams(int argc, const char** argv, BENCHMARK_PARAMS& params)
+{
+	if(argc < 2) return false;
+	params.bootablePath = fs::path(argv[1]);
+	for(int i = 2; i < argc; i++)
+	{
+		std::string arg = argv[i];
+		if((arg == "--frames") && ((i + 1) < argc))
+		{
+			params.frameCount = strtoul(argv[++i], nullptr, 0);
+		}
+		else if((arg == "--timeout") && ((i + 1) < argc))
+		{
+			params.timeoutSeconds = strtoul(argv[++i], nullptr, 0);
+		}
+		else if((arg == "--output") && ((i + 1) < argc))
+		{
+			params.outputPath = fs::path(argv[++i]);
+		}
+		else
+		{
+			return false;
+		}
+	}
+	return (params.frameCount != 0) && (params.timeoutSeconds != 0);
+}
+
+static bool IsExecutablePath(const fs::path& path)
+{
+	auto extension = path.extension().string();
+	std::transform(extension.begin(), extension.end(), extension.begin(), ::tolower);
+	return extension == ".elf";
+}
+
+#ifdef JIT_STATS_ENABLED
+static nlohmann::json MakeCompileStatsJson(BLOCK_CATEGORY category)
+{
+	auto stats = CBasicBlock::GetCompileStats(category);
+	nlohmann::json result;
+	result["blockCount"] = stats.blockCount;
+	result["codeSize"] = stats.codeSize;
+	result["compileTimeMs"] = static_cast<double>(stats.compileTime) / 1000000.0;
+	return result;
+}
+#endif
+
+static nlohmann::json MakeCodeCacheStatsJson(const CMipsExecutor& executor, double elapsedSeconds)
+{
+	auto stats = executor.GetCodeCacheStats();
+	nlohmann::json result;
+	result["activeBlockCount"] = stats.activeBlockCount;
+	result["activeCodeSize"] = stats.activeCodeSize;
+	result["cachedBlockCount"] = stats.cachedBlockCount;
+	result["cachedCodeSize"] = stats.cachedCodeSize;
+	result["evictedBlockCount"] = stats.evictedBlockCount;
+	result["recompiledBlockCount"] = stats.recompiledBlockCount;
+	result["evictedActiveBlockCount"] = stats.evictedActiveBlockCount;
+	result["flushCount"] = stats.flushCount;
+	result["arenaUsedSize"] = stats.arenaUsedSize;
+	result["evictionsPerSecond"] = (elapsedSeconds != 0) ? (static_cast<double>(stats.evictedBlockCount) / elapsedSeconds) : 0;
+	result["recompilesPerSecond"] = (elapsedSeconds != 0) ? (static_cast<double>(stats.recompiledBlockCount) / elapsedSeconds) : 0;
+	return result;
+}
+
+int main(int argc, const char** argv)
+{
+	BENCHMARK_PARAMS params;
+	if(!ParseParams(argc, argv, params))
+	{
+		PrintUsage();
+		return -1;
+	}
+
+	CPS2VM virtualMachine;
+	virtualMachine.Initialize();
+	virtualMachine.CreateGSHandler(CGSH_Null::GetFactoryFunction());
+
+	//Run as fast as possible. No pad or sound handler is created, which means that
+	//input is fixed (no buttons pressed) and SPU output is discarded.
+	auto& appConfig = CAppConfig::GetInstance();
+	bool prevLimitFrameRate = appConfig.GetPreferenceBoolean(PREF_PS2_LIMIT_FRAMERATE);
+	auto prevCdrom0Path = appConfig.GetPreferencePath(PREF_PS2_CDROM0_PATH);
+	appConfig.SetPreferenceBoolean(PREF_PS2_LIMIT_FRAMERATE, false);
+	virtualMachine.ReloadFrameRateLimit();
+
+#ifdef JIT_STATS_ENABLED
+	CBasicBlock::ResetCompileStats();
+#endif
+
+	bool isExecutable = IsExecutablePath(params.bootablePath);
+	try
+	{
+		if(isExecutable)
+		{
+			virtualMachine.Reset();
+			virtualMachine.m_ee->m_os->BootFromFile(params.bootablePath);
+		}
+		else
+		{
+			appConfig.SetPreferencePath(PREF_PS2_CDROM0_PATH, params.bootablePath);
+			virtualMachine.Reset();
+			virtualMachine.m_ee->m_os->BootFromCDROM();
+		}
+	}
+	catch(const std::exception& exception)
+	{
+		fprintf(stderr, "Failed to boot '%s': %s\n", params.bootablePath.string().c_str(), exception.what());
+		appConfig.SetPreferenceBoolean(PREF_PS2_LIMIT_FRAMERATE, prevLimitFrameRate);
+		appConfig.SetPreferencePath(PREF_PS2_CDROM0_PATH, prevCdrom0Path);
+		virtualMachine.DestroyGSHandler();
+		virtualMachine.Destroy();
+		return -1;
+	}
+
+	typedef std::chrono::high_resolution_clock Clock;
+
+	std::map<std::string, uint64> zoneTimes;
+	uint32 frameCount = 0;
+	std::atomic<uint64> drawCallCount(0);
+	Clock::time_point endTime;
+	std::promise<void> donePromise;
+	auto doneFuture = donePromise.get_future();
+
+	//Called from the emulator thread at every vblank start
+	auto newFrameConnection = virtualMachine.OnNewFrame.Connect(
+	    [&]() {
+		    if(frameCount == params.frameCount) return;
+#ifdef PROFILE
+		    for(const auto& zone : CProfiler::GetInstance().GetStats())
+		    {
+			    zoneTimes[zone.name] += zone.totalTime;
+		    }
+#endif
+		    frameCount++;
+		    if(frameCount == params.frameCount)
+		    {
+			    endTime = Clock::now();
+			    virtualMachine.PauseAsync();
+			    donePromise.set_value();
+		    }
+	    });
+
+	//Called from the GS thread
+	auto gsNewFrameConnection = virtualMachine.GetGSHandler()->OnNewFrame.Connect(
+	    [&](uint32 drawCalls) {
+		    drawCallCount += drawCalls;
+	    });
+
+	auto startTime = Clock::now();
+	virtualMachine.Resume();
+	bool done = (doneFuture.wait_for(std::chrono::seconds(params.timeoutSeconds)) == std::future_status::ready);
+	virtualMachine.Pause();
+
+	newFrameConnection.reset();
+	gsNewFrameConnection.reset();
+
+	if(!done)
+	{
+		//Guest never reached the frame target (hung or stopped presenting frames)
+		fprintf(stderr, "Timed out after %u seconds, %u out of %u frames were emulated.\n", params.timeoutSeconds, frameCount, params.frameCount);
+		appConfig.SetPreferenceBoolean(PREF_PS2_LIMIT_FRAMERATE, prevLimitFrameRate);
+		appConfig.SetPreferencePath(PREF_PS2_CDROM0_PATH, prevCdrom0Path);
+		virtualMachine.DestroyGSHandler();
+		virtualMachine.Destroy();
+		return -1;
+	}
+
+	double elapsedSeconds = std::chrono::duration<double>(endTime - startTime).count();
+
+	nlohmann::json result;
+	result["bootable"] = params.bootablePath.string();
+	result["bootableType"] = isExecutable ? "elf" : "disc";
+	result["executableName"] = virtualMachine.m_ee->m_os->GetExecutableName();
+	result["frames"] = frameCount;
+	result["elapsedSeconds"] = elapsedSeconds;
+	result["framesPerSecond"] = (elapsedSeconds != 0) ? (static_cast<double>(frameCount) / elapsedSeconds) : 0;
+	result["drawCalls"] = drawCallCount.load();
+	result["peakResidentSize"] = MemoryUsage::GetPeakResidentSize();
+
+	{
+		nlohmann::json zones = nlohmann::json::object();
+		for(const auto& zoneTimePair : zoneTimes)
+		{
+			zones[zoneTimePair.first] = static_cast<double>(zoneTimePair.second) / 1000000.0;
+		}
+#ifdef PROFILE
+		result["profilingEnabled"] = true;
+#else
+		result["profilingEnabled"] = false;
+#endif
+		result["zoneTimesMs"] = zones;
+	}
+
+	{
+		nlohmann::json jit;
+#ifdef JIT_STATS_ENABLED
+		jit["statsEnabled"] = true;
+		jit["ee"] = MakeCompileStatsJson(BLOCK_CATEGORY_PS2_EE);
+		jit["iop"] = MakeCompileStatsJson(BLOCK_CATEGORY_PS2_IOP);
+		jit["vu"] = MakeCompileStatsJson(BLOCK_CATEGORY_PS2_VU);
+#else
+		jit["statsEnabled"] = false;
+#endif
+		result["jit"] = jit;
+	}
+
+	{
+		nlohmann::json codeCache;
+		codeCache["ee"] = MakeCodeCacheStatsJson(*virtualMachine.m_ee->m_EE.m_executor, elapsedSeconds);
+		codeCache["iop"] = MakeCodeCacheStatsJson(*virtualMachine.m_iop->m_cpu.m_executor, elapsedSeconds);
+		codeCache["vu0"] = MakeCodeCacheStatsJson(*virtualMachine.m_ee->m_VU0.m_executor, elapsedSeconds);
+		codeCache["vu1"] = MakeCodeCacheStatsJson(*virtualMachine.m_ee->m_VU1.m_executor, elapsedSeconds);
+		result["codeCache"] = codeCache;
+	}
+
+	auto resultString = result.dump(4);
+	if(params.outputPath.empty())
+	{
+		printf("%s\n", resultString.c_str());
+	}
+	else
+	{
+		auto outputStream = Framework::CreateOutputStdStream(params.outputPath.native());
+		outputStream.Write(resultString.c_str(), resultString.size());
+	}
+
+	appConfig.SetPreferenceBoolean(PREF_PS2_LIMIT_FRAMERATE, prevLimitFrameRate);
+	appConfig.SetPreferencePath(PREF_PS2_CDROM0_PATH, prevCdrom0Path);
+
+	virtualMachine.DestroyGSHandler();
+	virtualMachine.Destroy();
+	return 0;
+}
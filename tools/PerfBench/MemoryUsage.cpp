@@ -0,0 +1,33 @@
+#include "MemoryUsage.h"
+
+#ifdef _WIN32
+#include <windows.h>
+#include <psapi.h>
+#else
+#include <sys/resource.h>
+#endif
+
+uint64 MemoryUsage::GetPeakResidentSize()
+{
+#ifdef _WIN32
+	PROCESS_MEMORY_COUNTERS counters = {};
+	if(!GetProcessMemoryInfo(GetCurrentProcess(), &counters, sizeof(counters)))
+	{
+		return 0;
+	}
+	return counters.PeakWorkingSetSize;
+#else
+	struct rusage usage = {};
+	if(getrusage(RUSAGE_SELF, &usage) != 0)
+	{
+		return 0;
+	}
+#ifdef __APPLE__
+	//Already in bytes on Darwin
+	return usage.ru_maxrss;
+#else
+	//Kilobytes on Linux and BSDs
+	return static_cast<uint64>(usage.ru_maxrss) * 1024;
+#endif
+#endif
+}
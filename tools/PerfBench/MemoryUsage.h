@@ -0,0 +1,9 @@
+#pragma once
+
+#include "Types.h"
+
+namespace MemoryUsage
+{
+	//Returns the peak resident memory used by the process, in bytes
+	uint64 GetPeakResidentSize();
+}
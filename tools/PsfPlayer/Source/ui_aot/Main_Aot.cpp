@@ -34,6 +34,8 @@ extern "C" void SWL_Proxy(uint32, uint32, CMIPS*);
 extern "C" void SWR_Proxy(uint32, uint32, CMIPS*);
 extern "C" void SDR_Proxy(uint32, uint64, CMIPS*);
 extern "C" void SDL_Proxy(uint32, uint64, CMIPS*);
+extern "C" uint32 HleCall_Proxy(CMIPS*);
+extern "C" uint32 Syscall_Proxy(CMIPS*);
 
 void Gather(const char* archivePathName, const char* outputPathName)
 {
@@ -307,6 +309,8 @@ void Compile(const char* databasePathName, const char* cpuArchName, const char*
 	objectFile->AddExternalSymbol("_SWR_Proxy", reinterpret_cast<uintptr_t>(&SWR_Proxy));
 	objectFile->AddExternalSymbol("_SDL_Proxy", reinterpret_cast<uintptr_t>(&SDL_Proxy));
 	objectFile->AddExternalSymbol("_SDR_Proxy", reinterpret_cast<uintptr_t>(&SDR_Proxy));
+	objectFile->AddExternalSymbol("_HleCall_Proxy", reinterpret_cast<uintptr_t>(&HleCall_Proxy));
+	objectFile->AddExternalSymbol("_Syscall_Proxy", reinterpret_cast<uintptr_t>(&Syscall_Proxy));
 	objectFile->AddExternalSymbol("_NextBlockTrampoline", reinterpret_cast<uintptr_t>(&NextBlockTrampoline));
 	objectFile->AddExternalSymbol("_EmptyBlockHandler", reinterpret_cast<uintptr_t>(&EmptyBlockHandler));
 
@@ -0,0 +1,255 @@
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+#include <cstdlib>
+#include <atomic>
+#include <chrono>
+#include <future>
+#include <thread>
+#include <vector>
+#include "filesystem_def.h"
+#include "PsfVm.h"
+#include "PsfLoader.h"
+#include "PsfArchive.h"
+#include "PsfStreamProvider.h"
+#include "PsfTags.h"
+#include "PlaybackController.h"
+#include "Playlist.h"
+#include "ThreadPool.h"
+#include "stricmp.h"
+#include "SH_WaveFile.h"
+
+struct RENDER_JOB
+{
+	CPsfPathToken filePath;
+	fs::path archivePath;
+	fs::path outputPath;
+	std::string name;
+};
+typedef std::vector<RENDER_JOB> RenderJobList;
+
+struct RENDER_RESULT
+{
+	double trackTime = 0;
+	double renderTime = 0;
+};
+
+static bool IsArchivePath(const fs::path& path)
+{
+	auto extension = path.extension().string();
+	return !stricmp(extension.c_str(), ".zip") || !stricmp(extension.c_str(), ".rar");
+}
+
+static bool IsLoadablePath(const fs::path& path)
+{
+	auto extension = path.extension().string();
+	if(extension.empty()) return false;
+	return CPlaylist::IsLoadableExtension(extension.c_str() + 1);
+}
+
+static void AddArchiveJobs(RenderJobList& jobs, const fs::path& archivePath, const fs::path& outputDirPath)
+{
+	auto archive = CPsfArchive::CreateFromPath(archivePath);
+	//Tracks from different archives might share names, keep them apart
+	auto archiveOutputDirPath = outputDirPath / archivePath.stem();
+	for(const auto& fileInfo : archive->GetFiles())
+	{
+		fs::path itemPath = fileInfo.name;
+		if(!IsLoadablePath(itemPath)) continue;
+
+		RENDER_JOB job;
+		job.filePath = CArchivePsfStreamProvider::GetPathTokenFromFilePath(fileInfo.name);
+		job.archivePath = archivePath;
+		job.outputPath = archiveOutputDirPath / itemPath.replace_extension(".wav");
+		job.name = archivePath.filename().string() + ":" + fileInfo.name;
+		jobs.push_back(std::move(job));
+	}
+}
+
+static void AddFileJob(RenderJobList& jobs, const fs::path& filePath, const fs::path& outputDirPath)
+{
+	RENDER_JOB job;
+	job.filePath = CPhysicalPsfStreamProvider::GetPathTokenFromFilePath(filePath);
+	job.outputPath = outputDirPath / filePath.filename().replace_extension(".wav");
+	job.name = filePath.string();
+	jobs.push_back(std::move(job));
+}
+
+//In benchmark mode, no sound handler is set. Audio is still rendered by the SPUs, but isn't written anywhere.
+static RENDER_RESULT RenderTrack(const RENDER_JOB& job, bool benchmark)
+{
+	CPsfVm virtualMachine;
+
+	CPsfBase::TagMap tags;
+	CPsfLoader::LoadPsf(virtualMachine, job.filePath, job.archivePath, &tags);
+
+	//Handler is created and owned by the VM thread, keep a pointer to check on it once we're done
+	CSH_WaveFile* waveFile = nullptr;
+	if(!benchmark)
+	{
+		fs::create_directories(job.outputPath.parent_path());
+
+		std::exception_ptr handlerException;
+		virtualMachine.SetSpuHandler(
+		    [&]() -> CSoundHandler* {
+			    try
+			    {
+				    waveFile = new CSH_WaveFile(job.outputPath);
+			    }
+			    catch(...)
+			    {
+				    handlerException = std::current_exception();
+			    }
+			    return waveFile;
+		    });
+		if(handlerException)
+		{
+			std::rethrow_exception(handlerException);
+		}
+	}
+
+	//Track length and fade out are handled like in the player, but without any audio pacing,
+	//the sound handler never runs out of buffers so the VM thread runs as fast as it can.
+	CPlaybackController playbackController;
+	std::promise<void> completedPromise;
+	auto completedFuture = completedPromise.get_future();
+
+	auto volumeChangedConnection = playbackController.VolumeChanged.Connect(
+	    [&](float volume) { virtualMachine.SetVolumeAdjust(volume); });
+	auto playbackCompletedConnection = playbackController.PlaybackCompleted.Connect(
+	    [&]() { completedPromise.set_value(); });
+	auto newFrameConnection = virtualMachine.OnNewFrame.Connect(
+	    [&]() { playbackController.Tick(); });
+
+	auto startTime = std::chrono::steady_clock::now();
+	playbackController.Play(CPsfTags(tags));
+	virtualMachine.Resume();
+	completedFuture.wait();
+	virtualMachine.Pause();
+	auto endTime = std::chrono::steady_clock::now();
+
+	newFrameConnection.reset();
+
+	if(waveFile)
+	{
+		waveFile->Close();
+		bool failed = waveFile->HasFailed();
+		virtualMachine.SetSpuHandler(nullptr);
+
+		if(failed)
+		{
+			throw std::runtime_error("Failed to write output file.");
+		}
+	}
+
+	RENDER_RESULT result;
+	result.trackTime = static_cast<double>(playbackController.GetFrameCount()) / 60.0;
+	result.renderTime = std::chrono::duration<double>(endTime - startTime).count();
+	return result;
+}
+
+static void PrintUsage()
+{
+	printf("Usage:\r\n");
+	printf("\tPsfBatchRender [-j jobCount] [-o outputDirectory] [-b] files...\r\n");
+	printf("\r\n");
+	printf("Files can be PSF, PSF2 or PSFP tracks or archives (zip, rar) containing them.\r\n");
+	printf("Every track is rendered to a WAV file, using as many VMs in parallel as there are CPU cores by default.\r\n");
+	printf("With -b, nothing is written and the rendering speed of each track is reported relative to real time.\r\n");
+}
+
+int main(int argc, char** argv)
+{
+	unsigned int jobCount = std::max<unsigned int>(std::thread::hardware_concurrency(), 1);
+	fs::path outputDirPath = fs::current_path();
+	std::vector<fs::path> inputPaths;
+	bool benchmark = false;
+
+	for(int i = 1; i < argc; i++)
+	{
+		if(!strcmp(argv[i], "-j") && ((i + 1) < argc))
+		{
+			jobCount = std::max<int>(atoi(argv[++i]), 1);
+		}
+		else if(!strcmp(argv[i], "-o") && ((i + 1) < argc))
+		{
+			outputDirPath = fs::path(argv[++i]);
+		}
+		else if(!strcmp(argv[i], "-b"))
+		{
+			benchmark = true;
+		}
+		else
+		{
+			inputPaths.push_back(fs::path(argv[i]));
+		}
+	}
+
+	if(inputPaths.empty())
+	{
+		PrintUsage();
+		return -1;
+	}
+
+	RenderJobList jobs;
+	for(const auto& inputPath : inputPaths)
+	{
+		try
+		{
+			if(IsArchivePath(inputPath))
+			{
+				AddArchiveJobs(jobs, inputPath, outputDirPath);
+			}
+			else if(IsLoadablePath(inputPath))
+			{
+				AddFileJob(jobs, inputPath, outputDirPath);
+			}
+			else
+			{
+				printf("Skipping '%s', unsupported file type.\r\n", inputPath.string().c_str());
+			}
+		}
+		catch(const std::exception& exception)
+		{
+			printf("Failed to open '%s', reason: '%s'.\r\n", inputPath.string().c_str(), exception.what());
+		}
+	}
+
+	std::atomic<unsigned int> failedCount = 0;
+	std::atomic<unsigned int> slowCount = 0;
+	{
+		Framework::CThreadPool threadPool(jobCount);
+		for(const auto& job : jobs)
+		{
+			threadPool.Enqueue(
+			    [&job, &failedCount, &slowCount, benchmark]() {
+				    try
+				    {
+					    auto result = RenderTrack(job, benchmark);
+					    double speed = (result.renderTime != 0) ? (result.trackTime / result.renderTime) : 0;
+					    printf("Rendered %s (%.1fs of audio in %.1fs, %.2fx real time).\r\n",
+					           job.name.c_str(), result.trackTime, result.renderTime, speed);
+					    if(speed < 1.0)
+					    {
+						    slowCount++;
+					    }
+				    }
+				    catch(const std::exception& exception)
+				    {
+					    printf("Failed to render '%s', reason: '%s'.\r\n", job.name.c_str(), exception.what());
+					    failedCount++;
+				    }
+				    fflush(stdout);
+			    });
+		}
+	}
+
+	printf("Rendered %d track(s), %d failure(s).\r\n",
+	       static_cast<int>(jobs.size() - failedCount), static_cast<int>(failedCount));
+	if(benchmark)
+	{
+		printf("%d track(s) rendered slower than real time.\r\n", static_cast<int>(slowCount));
+		if(slowCount != 0) return -1;
+	}
+	return (failedCount == 0) ? 0 : -1;
+}
@@ -0,0 +1,114 @@
+#include "SH_WaveFile.h"
+#include <cstring>
+#include "StdStreamUtils.h"
+
+#define CHANNEL_COUNT 2
+
+#pragma pack(push, 1)
+struct WAVE_HEADER
+{
+	char riffId[4];
+	uint32 riffSize;
+	char waveId[4];
+	char fmtId[4];
+	uint32 fmtSize;
+	uint16 format;
+	uint16 channelCount;
+	uint32 sampleRate;
+	uint32 byteRate;
+	uint16 blockAlign;
+	uint16 bitsPerSample;
+	char dataId[4];
+	uint32 dataSize;
+};
+#pragma pack(pop)
+static_assert(sizeof(WAVE_HEADER) == 44, "WAVE_HEADER must be 44 bytes.");
+
+CSH_WaveFile::CSH_WaveFile(const fs::path& outputPath)
+{
+	m_outputStream = Framework::CreateOutputStdStream(outputPath.native());
+	//Sizes are not known yet, header is rewritten when the file is closed
+	WriteHeader();
+}
+
+CSH_WaveFile::~CSH_WaveFile()
+{
+	Close();
+}
+
+void CSH_WaveFile::Close()
+{
+	if(m_outputStream.IsEmpty()) return;
+	try
+	{
+		m_outputStream.Seek(0, Framework::STREAM_SEEK_SET);
+		WriteHeader();
+		m_outputStream.Flush();
+	}
+	catch(...)
+	{
+		m_failed = true;
+	}
+	m_outputStream.Clear();
+}
+
+void CSH_WaveFile::Reset()
+{
+}
+
+void CSH_WaveFile::Write(int16* samples, unsigned int sampleCount, unsigned int sampleRate)
+{
+	m_sampleRate = sampleRate;
+	if(m_failed || m_outputStream.IsEmpty()) return;
+	uint64 size = sampleCount * sizeof(int16);
+	if(m_outputStream.Write(samples, size) != size)
+	{
+		m_failed = true;
+		return;
+	}
+	m_sampleCount += sampleCount;
+}
+
+bool CSH_WaveFile::HasFreeBuffers()
+{
+	return true;
+}
+
+void CSH_WaveFile::RecycleBuffers()
+{
+}
+
+bool CSH_WaveFile::HasFailed() const
+{
+	return m_failed;
+}
+
+uint64 CSH_WaveFile::GetSampleCount() const
+{
+	return m_sampleCount;
+}
+
+void CSH_WaveFile::WriteHeader()
+{
+	uint32 dataSize = static_cast<uint32>(m_sampleCount * sizeof(int16));
+
+	WAVE_HEADER header = {};
+	memcpy(header.riffId, "RIFF", 4);
+	header.riffSize = dataSize + sizeof(WAVE_HEADER) - 8;
+	memcpy(header.waveId, "WAVE", 4);
+	memcpy(header.fmtId, "fmt ", 4);
+	header.fmtSize = 16;
+	header.format = 1; //PCM
+	header.channelCount = CHANNEL_COUNT;
+	header.sampleRate = m_sampleRate;
+	header.byteRate = m_sampleRate * CHANNEL_COUNT * sizeof(int16);
+	header.blockAlign = CHANNEL_COUNT * sizeof(int16);
+	header.bitsPerSample = 16;
+	memcpy(header.dataId, "data", 4);
+	header.dataSize = dataSize;
+
+	if(m_outputStream.Write(&header, sizeof(WAVE_HEADER)) != sizeof(WAVE_HEADER))
+	{
+		m_failed = true;
+	}
+}
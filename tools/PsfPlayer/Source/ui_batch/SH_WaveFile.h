@@ -0,0 +1,31 @@
+#pragma once
+
+#include "sound/SoundHandler.h"
+#include "StdStream.h"
+#include "filesystem_def.h"
+
+//Writes everything it receives to a 16-bit stereo WAV file. Never blocks the emulation.
+class CSH_WaveFile : public CSoundHandler
+{
+public:
+	CSH_WaveFile(const fs::path&);
+	virtual ~CSH_WaveFile();
+
+	void Reset() override;
+	void Write(int16*, unsigned int, unsigned int) override;
+	bool HasFreeBuffers() override;
+	void RecycleBuffers() override;
+
+	void Close();
+
+	bool HasFailed() const;
+	uint64 GetSampleCount() const;
+
+private:
+	void WriteHeader();
+
+	Framework::CStdStream m_outputStream;
+	uint32 m_sampleRate = 44100;
+	uint64 m_sampleCount = 0;
+	bool m_failed = false;
+};
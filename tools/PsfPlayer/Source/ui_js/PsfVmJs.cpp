@@ -8,6 +8,8 @@ extern "C" uint32 LWL_Proxy(uint32, uint32, CMIPS*);
 extern "C" uint32 LWR_Proxy(uint32, uint32, CMIPS*);
 extern "C" void SWL_Proxy(uint32, uint32, CMIPS*);
 extern "C" void SWR_Proxy(uint32, uint32, CMIPS*);
+extern "C" uint32 HleCall_Proxy(CMIPS*);
+extern "C" uint32 Syscall_Proxy(CMIPS*);
 
 CPsfVmJs::CPsfVmJs()
 {
@@ -26,6 +28,8 @@ CPsfVmJs::CPsfVmJs()
 
 		Jitter::CWasmFunctionRegistry::RegisterFunction(reinterpret_cast<uintptr_t>(&SWL_Proxy), "_SWL_Proxy", "viii");
 		Jitter::CWasmFunctionRegistry::RegisterFunction(reinterpret_cast<uintptr_t>(&SWR_Proxy), "_SWR_Proxy", "viii");
+		Jitter::CWasmFunctionRegistry::RegisterFunction(reinterpret_cast<uintptr_t>(&HleCall_Proxy), "_HleCall_Proxy", "ii");
+		Jitter::CWasmFunctionRegistry::RegisterFunction(reinterpret_cast<uintptr_t>(&Syscall_Proxy), "_Syscall_Proxy", "ii");
 	},
 	                   true);
 }
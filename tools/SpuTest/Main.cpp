@@ -1,6 +1,7 @@
 #include <functional>
 #include "DefaultAppConfig.h"
 #include "KeyOnOffTest.h"
+#include "MixSampleBlockTest.h"
 #include "MultiCoreIrqTest.h"
 #include "SetRepeatTest.h"
 #include "SetRepeatTest2.h"
@@ -13,6 +14,7 @@ typedef std::function<CTest*()> TestFactoryFunction;
 static const TestFactoryFunction s_factories[] =
 {
 	[]() { return new CKeyOnOffTest(); },
+	[]() { return new CMixSampleBlockTest(); },
 	[]() { return new CMultiCoreIrqTest(); },
 	[]() { return new CSetRepeatTest(); },
 	[]() { return new CSetRepeatTest2(); },
@@ -0,0 +1,129 @@
+#include "MixSampleBlockTest.h"
+
+#include <algorithm>
+#include <climits>
+#include <cstring>
+#include <random>
+
+#include "Ps2Const.h"
+
+static constexpr uint32 REVERB_WORK_ADDR_START = 0x20000;
+static constexpr uint32 SAMPLE_BLOCK_COUNT = 0x80;
+static constexpr unsigned int VOICE_USED_COUNT = 4;
+
+void CMixSampleBlockTest::Execute()
+{
+	TestMixSampleBlock();
+
+	//Sample data away from the reverb work area, channels are mixed as a block
+	TestRender(0x5000, 0x7FFF);
+
+	//Reverb writes over the sample data being read, mixing must go through every channel at each tick.
+	//Reverb input is muted to make sure only zeroes are written over the sample data (keeps ADPCM headers valid).
+	TestRender(REVERB_WORK_ADDR_START, 0);
+}
+
+void CMixSampleBlockTest::TestMixSampleBlock()
+{
+	static const int16 edgeValues[] = {SHRT_MIN, SHRT_MIN + 1, -0x4000, -1, 0, 1, 0x4000, SHRT_MAX - 1, SHRT_MAX};
+	static const unsigned int edgeValueCount = sizeof(edgeValues) / sizeof(edgeValues[0]);
+
+	std::mt19937 generator(0x5350);
+	auto getValue =
+	    [&]() {
+		    //Use edge values often to exercise rounding and saturation
+		    uint32 value = generator();
+		    if((value & 3) == 0)
+		    {
+			    return edgeValues[(value >> 2) % edgeValueCount];
+		    }
+		    return static_cast<int16>(value >> 16);
+	    };
+
+	//Sizes not multiple of 8 also go through the scalar tail
+	for(unsigned int sampleCount = 0; sampleCount < 80; sampleCount++)
+	{
+		std::vector<int16> input(sampleCount);
+		std::vector<int16> volume(sampleCount);
+		std::vector<int16> output(sampleCount);
+		for(unsigned int i = 0; i < sampleCount; i++)
+		{
+			input[i] = getValue();
+			volume[i] = getValue();
+			output[i] = getValue();
+		}
+
+		auto reference = output;
+		for(unsigned int i = 0; i < sampleCount; i++)
+		{
+			Iop::CSpuBase::MixSamples(input[i], volume[i], reference.data() + i);
+		}
+
+		Iop::CSpuBase::MixSampleBlock(output.data(), input.data(), volume.data(), sampleCount);
+		TEST_VERIFY(output == reference);
+	}
+}
+
+void CMixSampleBlockTest::TestRender(uint32 sampleAddress, uint16 reverbInputCoef)
+{
+	auto blockOutput = Render(sampleAddress, reverbInputCoef, true);
+	auto tickOutput = Render(sampleAddress, reverbInputCoef, false);
+
+	//Make sure we're not only comparing silence
+	TEST_VERIFY(std::any_of(tickOutput.begin(), tickOutput.end(), [](int16 sample) { return sample != 0; }));
+	TEST_VERIFY(blockOutput == tickOutput);
+}
+
+std::vector<int16> CMixSampleBlockTest::Render(uint32 sampleAddress, uint16 reverbInputCoef, bool blockMixingEnabled)
+{
+	constexpr unsigned int DST_SAMPLE_RATE = 44100;
+	constexpr unsigned int RENDER_TICKS = 0x100;
+	constexpr unsigned int RENDER_COUNT = 0x20;
+
+	memset(m_ram, 0, PS2::SPU_RAM_SIZE);
+	m_spuSampleCache.Clear();
+	m_spuCore0.Reset();
+	m_spuCore0.SetDestinationSamplingRate(DST_SAMPLE_RATE);
+	m_spuCore0.SetBlockMixingEnabled(blockMixingEnabled);
+
+	//Set some looping samples
+	std::mt19937 generator(0x5350);
+	for(uint32 i = 0; i < SAMPLE_BLOCK_COUNT; i++)
+	{
+		uint8* block = m_ram + sampleAddress + (i * 0x10);
+		block[0] = 0x04;
+		block[1] = (i == 0) ? 0x04 : ((i == (SAMPLE_BLOCK_COUNT - 1)) ? 0x03 : 0x00);
+		for(unsigned int j = 2; j < 0x10; j++)
+		{
+			block[j] = static_cast<uint8>(generator());
+		}
+	}
+
+	//Setup voices
+	for(unsigned int i = 0; i < VOICE_USED_COUNT; i++)
+	{
+		SetVoiceRegister(0, i, Iop::Spu2::CCore::VP_PITCH, 0x1000 + (i * 0x100));
+		SetVoiceRegister(0, i, Iop::Spu2::CCore::VP_VOLL, 0x3FFF);
+		SetVoiceRegister(0, i, Iop::Spu2::CCore::VP_VOLR, 0x2000);
+		SetVoiceAddress(0, i, Iop::Spu2::CCore::VA_SSA_HI, sampleAddress + (i * 0x10));
+	}
+
+	//Setup reverb, input goes straight to the work area and back to the output
+	SetCoreRegister(0, Iop::Spu2::CCore::CORE_ATTR, Iop::CSpuBase::CONTROL_REVERB);
+	SetCoreAddress(0, Iop::Spu2::CCore::A_ESA_HI, REVERB_WORK_ADDR_START);
+	SetCoreRegister(0, Iop::Spu2::CCore::A_EEA_HI, REVERB_WORK_ADDR_START >> 17);
+	SetCoreRegister(0, Iop::Spu2::CCore::S_VMIXER_HI, (1 << VOICE_USED_COUNT) - 1);
+	m_spuCore0.SetReverbParam(Iop::CSpuBase::IN_COEF_L, reverbInputCoef);
+	m_spuCore0.SetReverbParam(Iop::CSpuBase::IN_COEF_R, reverbInputCoef);
+	m_spuCore0.SetReverbParam(Iop::CSpuBase::IIR_ALPHA, 0x7FFF);
+
+	//Send KEY-ON
+	SetCoreRegister(0, Iop::Spu2::CCore::A_KON_HI, (1 << VOICE_USED_COUNT) - 1);
+
+	std::vector<int16> output(RENDER_TICKS * 2 * RENDER_COUNT);
+	for(unsigned int i = 0; i < RENDER_COUNT; i++)
+	{
+		m_spuCore0.Render(output.data() + (i * RENDER_TICKS * 2), RENDER_TICKS * 2);
+	}
+	return output;
+}
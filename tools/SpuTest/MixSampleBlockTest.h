@@ -0,0 +1,15 @@
+#pragma once
+
+#include <vector>
+#include "Test.h"
+
+class CMixSampleBlockTest : public CTest
+{
+public:
+	void Execute() override;
+
+private:
+	void TestMixSampleBlock();
+	void TestRender(uint32, uint16);
+	std::vector<int16> Render(uint32, uint16, bool);
+};
@@ -0,0 +1,76 @@
+#include "AccurateAddSubTest.h"
+#include "VuAssembler.h"
+
+void CAccurateAddSubTest::Execute(CTestVm& virtualMachine)
+{
+	virtualMachine.Reset();
+	virtualMachine.m_executor.SetAccurateAddSubEnabled(true);
+
+	auto microMem = reinterpret_cast<uint32*>(virtualMachine.m_microMem);
+
+	CVuAssembler assembler(microMem);
+
+	//Bits of the smaller operand that are shifted out during alignment are dropped: 1.0 - 2^-30 gives 1.0.
+	//+Infinity in fs needs to be clamped to FLT_MAX before the operation.
+
+	//VF3 = VF1 - VF2
+	assembler.Write(
+	    CVuAssembler::Upper::SUB(CVuAssembler::DEST_XY, CVuAssembler::VF3, CVuAssembler::VF1, CVuAssembler::VF2),
+	    CVuAssembler::Lower::NOP());
+
+	//VF4 = VF1 + VF6
+	assembler.Write(
+	    CVuAssembler::Upper::ADD(CVuAssembler::DEST_XY, CVuAssembler::VF4, CVuAssembler::VF1, CVuAssembler::VF6),
+	    CVuAssembler::Lower::NOP());
+
+	//VF5 = VF1 + VF6.x
+	assembler.Write(
+	    CVuAssembler::Upper::ADDbc(CVuAssembler::DEST_XY, CVuAssembler::VF5, CVuAssembler::VF1, CVuAssembler::VF6, CVuAssembler::BC_X),
+	    CVuAssembler::Lower::NOP());
+
+	//VF7 = ACC + VF6 * VF1.x
+	assembler.Write(
+	    CVuAssembler::Upper::MADDbc(CVuAssembler::DEST_X, CVuAssembler::VF7, CVuAssembler::VF6, CVuAssembler::VF1, CVuAssembler::BC_X),
+	    CVuAssembler::Lower::NOP());
+
+	//VF8 = ACC - VF2 * VF1.x
+	assembler.Write(
+	    CVuAssembler::Upper::MSUBbc(CVuAssembler::DEST_X, CVuAssembler::VF8, CVuAssembler::VF2, CVuAssembler::VF1, CVuAssembler::BC_X),
+	    CVuAssembler::Lower::NOP());
+
+	assembler.Write(
+	    CVuAssembler::Upper::NOP() | CVuAssembler::Upper::E_BIT,
+	    CVuAssembler::Lower::NOP());
+
+	assembler.Write(
+	    CVuAssembler::Upper::NOP(),
+	    CVuAssembler::Lower::NOP());
+
+	//VF1 = (1.0, +Inf)
+	virtualMachine.m_cpu.m_State.nCOP2[1].nV0 = 0x3F800000;
+	virtualMachine.m_cpu.m_State.nCOP2[1].nV1 = 0x7F800000;
+
+	//VF2 = (2^-30, 0)
+	virtualMachine.m_cpu.m_State.nCOP2[2].nV0 = 0x30800000;
+	virtualMachine.m_cpu.m_State.nCOP2[2].nV1 = 0;
+
+	//VF6 = (-2^-30, 0)
+	virtualMachine.m_cpu.m_State.nCOP2[6].nV0 = 0xB0800000;
+	virtualMachine.m_cpu.m_State.nCOP2[6].nV1 = 0;
+
+	//ACC = (1.0)
+	virtualMachine.m_cpu.m_State.nCOP2A.nV0 = 0x3F800000;
+
+	virtualMachine.ExecuteTest(0);
+
+	virtualMachine.m_executor.SetAccurateAddSubEnabled(false);
+
+	TEST_VERIFY(virtualMachine.m_cpu.m_State.nCOP2[3].nV0 == 0x3F800000);
+	TEST_VERIFY(virtualMachine.m_cpu.m_State.nCOP2[3].nV1 == 0x7F7FFFFF);
+	TEST_VERIFY(virtualMachine.m_cpu.m_State.nCOP2[4].nV0 == 0x3F800000);
+	TEST_VERIFY(virtualMachine.m_cpu.m_State.nCOP2[4].nV1 == 0x7F7FFFFF);
+	TEST_VERIFY(virtualMachine.m_cpu.m_State.nCOP2[5].nV0 == 0x3F800000);
+	TEST_VERIFY(virtualMachine.m_cpu.m_State.nCOP2[5].nV1 == 0x7F7FFFFF);
+	TEST_VERIFY(virtualMachine.m_cpu.m_State.nCOP2[7].nV0 == 0x3F800000);
+	TEST_VERIFY(virtualMachine.m_cpu.m_State.nCOP2[8].nV0 == 0x3F800000);
+}
@@ -0,0 +1,72 @@
+#include "FlagsTest5.h"
+#include "VuAssembler.h"
+
+void CFlagsTest5::Execute(CTestVm& virtualMachine)
+{
+	virtualMachine.Reset();
+
+	auto microMem = reinterpret_cast<uint32*>(virtualMachine.m_microMem);
+
+	//MAC flags produced at the end of a block need to stay available for
+	//the block we branch to, even when program analysis is enabled
+
+	CVuAssembler assembler(microMem);
+
+	auto targetLabel = assembler.CreateLabel();
+
+	//pipe = 0		//macTime = 0 + 4 = 4
+	assembler.Write(
+	    CVuAssembler::Upper::SUB(CVuAssembler::DEST_XYZW, CVuAssembler::VF1, CVuAssembler::VF3, CVuAssembler::VF2),
+	    CVuAssembler::Lower::NOP());
+
+	//pipe = 1
+	assembler.Write(
+	    CVuAssembler::Upper::NOP(),
+	    CVuAssembler::Lower::B(targetLabel));
+
+	//pipe = 2
+	assembler.Write(
+	    CVuAssembler::Upper::NOP(),
+	    CVuAssembler::Lower::NOP());
+
+	//Never executed
+	assembler.Write(
+	    CVuAssembler::Upper::NOP() | CVuAssembler::Upper::E_BIT,
+	    CVuAssembler::Lower::NOP());
+
+	assembler.Write(
+	    CVuAssembler::Upper::NOP(),
+	    CVuAssembler::Lower::NOP());
+
+	assembler.MarkLabel(targetLabel);
+
+	//pipe = 3
+	assembler.Write(
+	    CVuAssembler::Upper::NOP(),
+	    CVuAssembler::Lower::NOP());
+
+	//pipe = 4		//SUB result is visible
+	assembler.Write(
+	    CVuAssembler::Upper::NOP(),
+	    CVuAssembler::Lower::FMAND(CVuAssembler::VI1, CVuAssembler::VI2));
+
+	assembler.Write(
+	    CVuAssembler::Upper::NOP() | CVuAssembler::Upper::E_BIT,
+	    CVuAssembler::Lower::NOP());
+
+	assembler.Write(
+	    CVuAssembler::Upper::NOP(),
+	    CVuAssembler::Lower::NOP());
+
+	virtualMachine.m_cpu.m_State.nCOP2[2].nV0 = 0x3F800000; //VF2 = (1, 1, 1, 1)
+	virtualMachine.m_cpu.m_State.nCOP2[2].nV1 = 0x3F800000;
+	virtualMachine.m_cpu.m_State.nCOP2[2].nV2 = 0x3F800000;
+	virtualMachine.m_cpu.m_State.nCOP2[2].nV3 = 0x3F800000;
+
+	virtualMachine.m_cpu.m_State.nCOP2VI[2] = 0xFFFF;
+
+	virtualMachine.ExecuteTest(0);
+
+	//Check that all S flags are set and all Z flags are cleared
+	TEST_VERIFY(virtualMachine.m_cpu.m_State.nCOP2VI[1] == 0xF0);
+}
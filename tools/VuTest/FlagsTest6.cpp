@@ -0,0 +1,95 @@
+#include "FlagsTest6.h"
+#include "VuAssembler.h"
+
+static void AssembleProgram(uint32* microMem)
+{
+	CVuAssembler assembler(microMem);
+
+	auto targetLabel = assembler.CreateLabel();
+
+	//pipe = 0		//macTime = 0 + 4 = 4
+	assembler.Write(
+	    CVuAssembler::Upper::SUB(CVuAssembler::DEST_XYZW, CVuAssembler::VF1, CVuAssembler::VF3, CVuAssembler::VF2),
+	    CVuAssembler::Lower::NOP());
+
+	//pipe = 1
+	assembler.Write(
+	    CVuAssembler::Upper::NOP(),
+	    CVuAssembler::Lower::B(targetLabel));
+
+	//pipe = 2
+	assembler.Write(
+	    CVuAssembler::Upper::NOP(),
+	    CVuAssembler::Lower::NOP());
+
+	assembler.MarkLabel(targetLabel);
+
+	//pipe = 3		//Overwrites the SUB result before anything can look at it
+	assembler.Write(
+	    CVuAssembler::Upper::ADD(CVuAssembler::DEST_XYZW, CVuAssembler::VF4, CVuAssembler::VF2, CVuAssembler::VF2),
+	    CVuAssembler::Lower::NOP());
+
+	assembler.Write(
+	    CVuAssembler::Upper::NOP(),
+	    CVuAssembler::Lower::NOP());
+
+	assembler.Write(
+	    CVuAssembler::Upper::NOP(),
+	    CVuAssembler::Lower::NOP());
+
+	assembler.Write(
+	    CVuAssembler::Upper::NOP(),
+	    CVuAssembler::Lower::NOP());
+
+	assembler.Write(
+	    CVuAssembler::Upper::NOP() | CVuAssembler::Upper::E_BIT,
+	    CVuAssembler::Lower::NOP());
+
+	assembler.Write(
+	    CVuAssembler::Upper::NOP(),
+	    CVuAssembler::Lower::NOP());
+}
+
+static bool HasSignFlagsInMacPipe(CTestVm& virtualMachine)
+{
+	const auto& pipeMac = virtualMachine.m_cpu.m_State.pipeMac;
+	for(uint32 i = 0; i < FLAG_PIPELINE_SLOTS; i++)
+	{
+		if(pipeMac.values[i] & 0xF0) return true;
+	}
+	return false;
+}
+
+static void SetupRegisters(CTestVm& virtualMachine)
+{
+	virtualMachine.m_cpu.m_State.nCOP2[2].nV0 = 0x3F800000; //VF2 = (1, 1, 1, 1)
+	virtualMachine.m_cpu.m_State.nCOP2[2].nV1 = 0x3F800000;
+	virtualMachine.m_cpu.m_State.nCOP2[2].nV2 = 0x3F800000;
+	virtualMachine.m_cpu.m_State.nCOP2[2].nV3 = 0x3F800000;
+}
+
+void CFlagsTest6::Execute(CTestVm& virtualMachine)
+{
+	auto microMem = reinterpret_cast<uint32*>(virtualMachine.m_microMem);
+
+	//The MAC flags produced by SUB are overwritten by ADD in the block we branch
+	//to before being observed, program analysis should remove that update
+
+	virtualMachine.Reset();
+	AssembleProgram(microMem);
+	SetupRegisters(virtualMachine);
+	virtualMachine.ExecuteTest(0);
+
+	TEST_VERIFY(!HasSignFlagsInMacPipe(virtualMachine));
+	TEST_VERIFY((virtualMachine.m_cpu.m_State.nCOP2MF & 0xF0) == 0);
+
+	//Without program analysis, the SUB result must make it to the pipe
+	virtualMachine.Reset();
+	virtualMachine.m_executor.SetProgramAnalysisEnabled(false);
+	AssembleProgram(microMem);
+	SetupRegisters(virtualMachine);
+	virtualMachine.ExecuteTest(0);
+	virtualMachine.m_executor.SetProgramAnalysisEnabled(true);
+
+	TEST_VERIFY(HasSignFlagsInMacPipe(virtualMachine));
+}
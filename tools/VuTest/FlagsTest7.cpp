@@ -0,0 +1,83 @@
+#include "FlagsTest7.h"
+#include "VuAssembler.h"
+
+static void AssembleProgram(uint32* microMem)
+{
+	CVuAssembler assembler(microMem);
+
+	auto targetLabel = assembler.CreateLabel();
+
+	//pipe = 0		//macTime = 0 + 4 = 4
+	assembler.Write(
+	    CVuAssembler::Upper::SUB(CVuAssembler::DEST_XYZW, CVuAssembler::VF1, CVuAssembler::VF3, CVuAssembler::VF2),
+	    CVuAssembler::Lower::NOP());
+
+	//pipe = 1
+	assembler.Write(
+	    CVuAssembler::Upper::NOP(),
+	    CVuAssembler::Lower::B(targetLabel));
+
+	//pipe = 2
+	assembler.Write(
+	    CVuAssembler::Upper::NOP(),
+	    CVuAssembler::Lower::NOP());
+
+	assembler.MarkLabel(targetLabel);
+
+	//pipe = 3
+	assembler.Write(
+	    CVuAssembler::Upper::NOP(),
+	    CVuAssembler::Lower::NOP());
+
+	//pipe = 4
+	assembler.Write(
+	    CVuAssembler::Upper::NOP(),
+	    CVuAssembler::Lower::NOP());
+
+	//pipe = 5		//Sign status flag is derived from the SUB's MAC flags
+	assembler.Write(
+	    CVuAssembler::Upper::NOP(),
+	    CVuAssembler::Lower::FSAND(CVuAssembler::VI1, 0x2));
+
+	assembler.Write(
+	    CVuAssembler::Upper::NOP() | CVuAssembler::Upper::E_BIT,
+	    CVuAssembler::Lower::NOP());
+
+	assembler.Write(
+	    CVuAssembler::Upper::NOP(),
+	    CVuAssembler::Lower::NOP());
+}
+
+static void SetupRegisters(CTestVm& virtualMachine)
+{
+	virtualMachine.m_cpu.m_State.nCOP2[2].nV0 = 0x3F800000; //VF2 = (1, 1, 1, 1)
+	virtualMachine.m_cpu.m_State.nCOP2[2].nV1 = 0x3F800000;
+	virtualMachine.m_cpu.m_State.nCOP2[2].nV2 = 0x3F800000;
+	virtualMachine.m_cpu.m_State.nCOP2[2].nV3 = 0x3F800000;
+	virtualMachine.m_cpu.m_State.nCOP2VI[1] = 0;
+}
+
+void CFlagsTest7::Execute(CTestVm& virtualMachine)
+{
+	auto microMem = reinterpret_cast<uint32*>(virtualMachine.m_microMem);
+
+	//The MAC flags produced by SUB are only observed through a status flag read
+	//in the block we branch to, program analysis must keep that update
+
+	virtualMachine.Reset();
+	AssembleProgram(microMem);
+	SetupRegisters(virtualMachine);
+	virtualMachine.ExecuteTest(0);
+
+	TEST_VERIFY(virtualMachine.m_cpu.m_State.nCOP2VI[1] == 0x2);
+
+	//Same result without program analysis
+	virtualMachine.Reset();
+	virtualMachine.m_executor.SetProgramAnalysisEnabled(false);
+	AssembleProgram(microMem);
+	SetupRegisters(virtualMachine);
+	virtualMachine.ExecuteTest(0);
+	virtualMachine.m_executor.SetProgramAnalysisEnabled(true);
+
+	TEST_VERIFY(virtualMachine.m_cpu.m_State.nCOP2VI[1] == 0x2);
+}
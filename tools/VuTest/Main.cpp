@@ -3,6 +3,7 @@
 #include <fenv.h>
 #include "DefaultAppConfig.h"
 #include "FpUtils.h"
+#include "AccurateAddSubTest.h"
 #include "AddTest.h"
 #include "BranchTest.h"
 #include "DynamicStallTest.h"
@@ -12,6 +13,9 @@
 #include "FlagsTest2.h"
 #include "FlagsTest3.h"
 #include "FlagsTest4.h"
+#include "FlagsTest5.h"
+#include "FlagsTest6.h"
+#include "FlagsTest7.h"
 #include "IntBranchDelayTest.h"
 #include "IntBranchDelayTest2.h"
 #include "IntBranchDelayTest3.h"
@@ -30,6 +34,7 @@ typedef std::function<CTest*()> TestFactoryFunction;
 // clang-format off
 static const TestFactoryFunction s_factories[] =
 {
+	[]() { return new CAccurateAddSubTest(); },
 	[]() { return new CAddTest(); },
 	[]() { return new CBranchTest(); },
 	[]() { return new CDynamicStallTest(); },
@@ -39,6 +44,9 @@ static const TestFactoryFunction s_factories[] =
 	[]() { return new CFlagsTest2(); },
 	[]() { return new CFlagsTest3(); },
 	[]() { return new CFlagsTest4(); },
+	[]() { return new CFlagsTest5(); },
+	[]() { return new CFlagsTest6(); },
+	[]() { return new CFlagsTest7(); },
 	[]() { return new CIntBranchDelayTest(); },
 	[]() { return new CIntBranchDelayTest2(); },
 	[]() { return new CIntBranchDelayTest3(); },
@@ -17,6 +17,8 @@ CTestVm::CTestVm()
 	m_cpu.m_pAddrTranslator = CMIPS::TranslateAddress64;
 
 	m_cpu.m_vuMem = m_vuMem;
+
+	m_executor.SetProgramAnalysisEnabled(true);
 }
 
 CTestVm::~CTestVm()
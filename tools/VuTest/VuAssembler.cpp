@@ -82,6 +82,16 @@ void CVuAssembler::Write(uint32 upperOp, BRANCHOP lowerOp)
 //UPPER OPs
 //---------------------------------------------------------------------------------
 
+uint32 CVuAssembler::Upper::ADD(DEST dest, VF_REGISTER fd, VF_REGISTER fs, VF_REGISTER ft)
+{
+	uint32 result = 0x00000028;
+	result |= (fd << 6);
+	result |= (fs << 11);
+	result |= (ft << 16);
+	result |= (dest << 21);
+	return result;
+}
+
 uint32 CVuAssembler::Upper::ADDbc(DEST dest, VF_REGISTER fd, VF_REGISTER fs, VF_REGISTER ft, BROADCAST bc)
 {
 	uint32 result = 0x00000000;
@@ -217,6 +227,17 @@ uint32 CVuAssembler::Upper::MINI(DEST dest, VF_REGISTER fd, VF_REGISTER fs, VF_R
 	return result;
 }
 
+uint32 CVuAssembler::Upper::MSUBbc(DEST dest, VF_REGISTER fd, VF_REGISTER fs, VF_REGISTER ft, BROADCAST bc)
+{
+	uint32 result = 0x0000000C;
+	result |= bc;
+	result |= (fd << 6);
+	result |= (fs << 11);
+	result |= (ft << 16);
+	result |= (dest << 21);
+	return result;
+}
+
 uint32 CVuAssembler::Upper::NOP()
 {
 	return 0x000002FF;
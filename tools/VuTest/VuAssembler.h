@@ -132,6 +132,7 @@ public:
 			E_BIT = 0x40000000,
 		};
 
+		static uint32 ADD(DEST, VF_REGISTER, VF_REGISTER, VF_REGISTER);
 		static uint32 ADDbc(DEST, VF_REGISTER, VF_REGISTER, VF_REGISTER, BROADCAST);
 		static uint32 ADDi(DEST, VF_REGISTER, VF_REGISTER);
 		static uint32 CLIP(VF_REGISTER, VF_REGISTER);
@@ -146,6 +147,7 @@ public:
 		static uint32 MAX(DEST, VF_REGISTER, VF_REGISTER, VF_REGISTER);
 		static uint32 MAXbc(DEST, VF_REGISTER, VF_REGISTER, VF_REGISTER, BROADCAST);
 		static uint32 MINI(DEST, VF_REGISTER, VF_REGISTER, VF_REGISTER);
+		static uint32 MSUBbc(DEST, VF_REGISTER, VF_REGISTER, VF_REGISTER, BROADCAST);
 		static uint32 NOP();
 		static uint32 OPMULA(VF_REGISTER, VF_REGISTER);
 		static uint32 OPMSUB(VF_REGISTER, VF_REGISTER, VF_REGISTER);